@@ -0,0 +1,146 @@
+
+
+from pymod import asset_tid
+from pymod import io
+
+
+# typedef struct font_2d_glyph
+# {
+#     uint32_t    codepoint_ ;
+#     uint16_t    texture_index_ ;
+#     uint16_t    group_index_ ;
+#     float       advance_ ;
+#     float       offset_x_ ;
+#     float       offset_y_ ;
+#     float       w_ ;
+#     float       h_ ;
+#     float       u0_ ;
+#     float       v0_ ;
+#     float       u1_ ;
+#     float       v1_ ;
+#     uint32_t    pad_ ;
+# } font_2d_glyph ;
+class AssetFont2DGlyph:
+    def __init__(self):
+        self.codepoint_     = 0
+        self.texture_index_ = 0
+        self.group_index_   = 0
+        self.advance_       = 0
+        self.offset_x_      = 0
+        self.offset_y_      = 0
+        self.w_             = 0
+        self.h_             = 0
+        self.u0_            = 0
+        self.v0_            = 0
+        self.u1_            = 0
+        self.v1_            = 0
+
+    def write(self, w):
+        assert(w.check_alignment())
+        w.u32(self.codepoint_)
+        w.u16(self.texture_index_)
+        w.u16(self.group_index_)
+        w.f32(self.advance_)
+        w.f32(self.offset_x_)
+        w.f32(self.offset_y_)
+        w.f32(self.w_)
+        w.f32(self.h_)
+        w.f32(self.u0_)
+        w.f32(self.v0_)
+        w.f32(self.u1_)
+        w.f32(self.v1_)
+        w.u32(0)
+        assert(w.check_alignment())
+
+
+# typedef struct font_2d_group
+# {
+#     uint16_t    font_size_ ;
+#     uint16_t    glyph_start_ ;
+#     uint16_t    glyph_count_ ;
+#     uint16_t    pad_ ;
+#     float       line_height_ ;
+#     float       ascender_ ;
+#     float       space_advance_ ;
+#     float       pad2_ ;
+# } font_2d_group ;
+class AssetFont2DGroup:
+    def __init__(self):
+        self.font_size_     = 0
+        self.glyph_start_   = 0
+        self.glyph_count_   = 0
+        self.line_height_   = 0
+        self.ascender_      = 0
+        self.space_advance_ = 0
+
+    def write(self, w):
+        assert(self.glyph_count_ > 0)
+        assert(w.check_alignment())
+        w.u16(self.font_size_)
+        w.u16(self.glyph_start_)
+        w.u16(self.glyph_count_)
+        w.u16(0)
+        w.f32(self.line_height_)
+        w.f32(self.ascender_)
+        w.f32(self.space_advance_)
+        w.f32(0)
+        assert(w.check_alignment())
+
+
+# typedef struct font_2d
+# {
+#     uint16_t            tid_ ;
+#     uint16_t            groups_count_ ;
+#     uint16_t            glyphs_count_ ;
+#     uint16_t            textures_count_ ;
+#     uint32_t            groups_offset_ ;
+#     uint32_t            glyphs_offset_ ;
+# } font_2d ;
+class AssetFont2D:
+    def __init__(self):
+        self.om_                = io.PtrOffsetMap()
+        self.groups_            = io.AssetList()
+        self.glyphs_            = io.AssetList()
+        self.textures_count_    = 0
+
+    def append_group(self, g):
+        self.groups_.append(g)
+
+    def append_glyph(self, g):
+        self.glyphs_.append(g)
+
+    def set_textures_count(self, c):
+        self.textures_count_ = c
+
+    def write_head(self, w):
+        assert(len(self.groups_))
+        assert(w.check_alignment())
+        w.u16(asset_tid.atid_font)
+        w.u16(len(self.groups_))
+        w.u16(len(self.glyphs_))
+        w.u16(self.textures_count_)
+        assert(w.check_alignment())
+        w.u32(self.om_.get(self.groups_))
+        w.u32(self.om_.get(self.glyphs_))
+        w.align()
+        assert(w.check_alignment())
+
+    def write_body(self, w, offset=0):
+        assert(w.check_alignment())
+        self.om_.set(self.groups_, w.relative_tell(offset))
+        self.groups_.write(w)
+        assert(w.check_alignment())
+        self.om_.set(self.glyphs_, w.relative_tell(offset))
+        self.glyphs_.write(w)
+        assert(w.check_alignment())
+
+    def write(self, w):
+        assert(w.check_alignment())
+        w_head_pos = w.tell()
+        self.write_head(w)
+        self.write_body(w, w_head_pos)
+        w_end_pos = w.tell()
+        w.goto(w_head_pos)
+        self.write_head(w)
+        w.goto(w_end_pos)
+        assert(w.check_alignment())
@@ -121,14 +121,18 @@ class AssetRect2DBoundingInfo:
 # {
 #     uint16_t              texture_index_ ;
 #     uint16_t              group_index_ ;
-#     uint16_t              pad1_ ;
+#     uint16_t              flags_ ;
 #     uint16_t              pad2_ ;
 #     rect_2d_bounding_info bounding_info_ ;
 # } rect_2d_info ;
+rect_2d_info_flag_opaque = 0x0001
+
+
 class AssetRect2DInfo:
     def __init__(self):
         self.texture_index_ = 0
         self.group_index_   = 0
+        self.flags_         = 0
         self.bounding_info_ = None
 
     def write(self, w):
@@ -136,7 +140,7 @@ class AssetRect2DInfo:
         assert(w.check_alignment())
         w.u16(self.texture_index_)
         w.u16(self.group_index_)
-        w.u16(0)
+        w.u16(self.flags_)
         w.u16(0)
         self.bounding_info_.write(w)
         assert(w.check_alignment())
@@ -145,8 +149,8 @@ class AssetRect2DInfo:
 # {
 #     uint16_t                frame_start_ ;
 #     uint16_t                frame_count_ ;
-#     uint16_t                pad1_ ;
-#     uint16_t                pad2_ ;
+#     uint16_t                playback_ ;
+#     uint16_t                blend_ms_ ;
 #     rect_2d_bounding_info   bounding_info_ ;
 # } sprite_2d_group ;
 class AssetSprite2DGroup:
@@ -176,13 +180,25 @@ class AssetSprite2DGroup:
 #     uint32_t            groups_offset_ ;
 #     uint32_t            vertices_offset_ ;
 #     uint32_t            infos_offset_ ;
+#     uint32_t            hulls_offset_ ;
+#     uint32_t            flags_ ;
+#     uint32_t            timings_offset_ ;
 # } sprite_2d ;
+
+
+sprite_2d_flag_premultiplied_alpha = 0x0001
+
+
 class AssetSprite2D:
     def __init__(self):
         self.om_        = io.PtrOffsetMap()
         self.groups_    = io.AssetList()
         self.vertices_  = io.AssetList()
         self.infos_     = io.AssetList()
+        self.flags_     = 0
+
+    def set_premultiplied_alpha(self):
+        self.flags_ |= sprite_2d_flag_premultiplied_alpha
 
     def append_group(self, g):
         self.groups_.append(g)
@@ -204,6 +220,11 @@ class AssetSprite2D:
         w.u32(self.om_.get(self.groups_))
         w.u32(self.om_.get(self.vertices_))
         w.u32(self.om_.get(self.infos_))
+        # no hulls, those come from bin/threed_atlas only.
+        w.u32(0)
+        w.u32(self.flags_)
+        # no timings either, the groups loop at the default frame duration.
+        w.u32(0)
         w.align()
         assert(w.check_alignment())
 
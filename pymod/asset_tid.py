@@ -4,8 +4,10 @@
 from pymod import io
 
 
-atid_null   = io.make_u16(0x00, 0x00)
-atid_sprite = io.make_u16(0x01, 0x00)
+atid_null    = io.make_u16(0x00, 0x00)
+atid_sprite  = io.make_u16(0x01, 0x00)
+atid_font    = io.make_u16(0x02, 0x00)
+atid_texture = io.make_u16(0x03, 0x00)
 
 
 
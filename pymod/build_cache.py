@@ -0,0 +1,154 @@
+
+import os
+import json
+import hashlib
+from concurrent.futures import ProcessPoolExecutor
+from concurrent.futures import ThreadPoolExecutor
+from concurrent.futures import as_completed
+
+
+# Bump when the manifest layout or the way hashes are made changes.
+manifest_version = 1
+
+
+def hash_file(h, fn):
+    assert(os.path.isfile(fn))
+    with open(fn, "rb") as f:
+        while True:
+            b = f.read(1 << 20)
+            if not b:
+                break
+            h.update(b)
+
+
+def get_files_in_dir(src_dir):
+    assert(os.path.isdir(src_dir))
+    files = list()
+    for root, dirs, names in os.walk(src_dir):
+        dirs.sort()
+        for n in sorted(names):
+            files.append(os.path.join(root, n))
+    return files
+
+
+def get_root_dir():
+    return os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+
+
+def hash_inputs(files, params):
+    # names are hashed too, so renaming or reordering frames is a change.
+    # they are relative to the repo, moving the checkout keeps the cache.
+    root_dir = get_root_dir()
+    h = hashlib.sha256()
+    h.update(("v%d" % manifest_version).encode())
+    h.update(repr(params).encode())
+    for fn in files:
+        h.update(b"\0")
+        h.update(os.path.relpath(os.path.abspath(fn), root_dir).encode())
+        h.update(b"\0")
+        hash_file(h, fn)
+    return h.hexdigest()
+
+
+def get_tool_files():
+    # the asset builders themselves are inputs, a packer fix rebuilds all.
+    pymod_dir = os.path.join(get_root_dir(), "pymod")
+    return [os.path.join(pymod_dir, f) for f in sorted(os.listdir(pymod_dir)) if f.endswith(".py")]
+
+
+class Job:
+    def __init__(self, key, func, args, inputs, params, outputs):
+        assert(key)
+        assert(func is not None)
+        assert(len(outputs) > 0)
+        self.key_       = key
+        self.func_      = func
+        self.args_      = args
+        self.inputs_    = inputs
+        self.params_    = params
+        self.outputs_   = outputs
+        self.hash_      = None
+
+    def calc_hash(self):
+        self.hash_ = hash_inputs(self.inputs_, self.params_)
+        return self.hash_
+
+    def has_outputs(self):
+        for o in self.outputs_:
+            if not os.path.exists(o):
+                return False
+        return True
+
+
+def run_job(func, args):
+    return func(*args)
+
+
+class BuildCache:
+    def __init__(self, manifest_file):
+        self.manifest_file_ = manifest_file
+        self.entries_       = dict()
+        self.load()
+
+    def load(self):
+        if not os.path.isfile(self.manifest_file_):
+            return
+        try:
+            with open(self.manifest_file_, "r") as f:
+                m = json.load(f)
+        except (OSError, ValueError):
+            print("ignoring broken manifest %s" % self.manifest_file_)
+            return
+        if m.get("version") != manifest_version:
+            return
+        self.entries_ = m.get("entries", dict())
+
+    def save(self):
+        d = os.path.dirname(self.manifest_file_)
+        if d and not os.path.isdir(d):
+            os.makedirs(d)
+        # written aside and renamed, so an interrupted build can't leave a
+        # half written manifest behind.
+        tmp = self.manifest_file_ + ".tmp"
+        with open(tmp, "w") as f:
+            json.dump({"version": manifest_version, "entries": self.entries_}, f, indent=1, sort_keys=True)
+        os.replace(tmp, self.manifest_file_)
+
+    def is_up_to_date(self, job):
+        return self.entries_.get(job.key_) == job.hash_ and job.has_outputs()
+
+    def run(self, jobs, use_processes=True, force=False):
+        assert(len(set(j.key_ for j in jobs)) == len(jobs))
+
+        with ThreadPoolExecutor() as ex:
+            list(ex.map(lambda j: j.calc_hash(), jobs))
+
+        todo = [j for j in jobs if force or not self.is_up_to_date(j)]
+        print("%d of %d jobs up to date" % (len(jobs) - len(todo), len(jobs)))
+        if not todo:
+            return True
+
+        # python bound work needs processes, tools like glslc only threads.
+        executor = ProcessPoolExecutor if use_processes else ThreadPoolExecutor
+        failed = 0
+        with executor() as ex:
+            futures = dict()
+            for j in todo:
+                print("building %s" % j.key_)
+                futures[ex.submit(run_job, j.func_, j.args_)] = j
+            for f in as_completed(futures):
+                j = futures[f]
+                try:
+                    ok = f.result() is not False
+                except Exception as e:
+                    print("%s failed: %s" % (j.key_, str(e)))
+                    ok = False
+                if ok and j.has_outputs():
+                    self.entries_[j.key_] = j.hash_
+                else:
+                    failed = failed + 1
+                    self.entries_.pop(j.key_, None)
+
+        self.save()
+        print("built %d jobs, %d failed" % (len(todo) - failed, failed))
+        return failed == 0
@@ -2,9 +2,11 @@ import os
 from collections import defaultdict
 
 from PIL import Image
+from pymod import io
 from pymod import font
 from pymod import packrect
 from pymod import binpack
+from pymod import asset_font
 
 
 def create_font(ubl, dst_font_file, font_size_name_list):
@@ -12,8 +14,11 @@ def create_font(ubl, dst_font_file, font_size_name_list):
     base_name = os.path.basename(dst_font_file)
     print("dst_dir=%s base_name=%s" % (dst_dir, base_name))
 
+    font_name = os.path.join(dst_dir, base_name + ".font")
+
     sizes = list()
     all_prs = dict()
+    metrics = list()
     for group_index, fi in enumerate(font_size_name_list):
         fs, fn = fi
         assert(fs > 0)
@@ -21,6 +26,7 @@ def create_font(ubl, dst_font_file, font_size_name_list):
 
         face, chars = font.make_font_images(fn, int(fs), ubl, True)
         assert(chars[0][0] is None)
+        metrics.append((int(fs), face.size.height / 64.0, face.size.ascender / 64.0, chars[0][1] / 64.0))
 
         for k, v in chars.items():
             g = v[0]
@@ -29,6 +35,7 @@ def create_font(ubl, dst_font_file, font_size_name_list):
             pr = packrect.PackRect()
             pr.init_from_image(g)
             pr.set_index(k, group_index)
+            pr.glyph_metrics_ = (v[1] / 64.0, v[2], v[3])
             pr.set_border(1, 1, 0, 0)
             if pr.get_crop_size() != pr.get_image_size():
                 pr.dump()
@@ -59,3 +66,40 @@ def create_font(ubl, dst_font_file, font_size_name_list):
         atlas_name = os.path.join(dst_dir, img_name)
         bin_img.save(atlas_name, "PNG")
 
+    # glyphs are sorted by codepoint inside a group, so the runtime can use
+    # a binary search.
+    afn = asset_font.AssetFont2D()
+    afn.set_textures_count(len(bins))
+    glyph_start = 0
+    for group_index, m in enumerate(metrics):
+        prs = sorted(groups[group_index], key=lambda x: x.get_local_index())
+        g = asset_font.AssetFont2DGroup()
+        g.font_size_        = m[0]
+        g.line_height_      = m[1]
+        g.ascender_         = m[2]
+        g.space_advance_    = m[3]
+        g.glyph_start_      = glyph_start
+        g.glyph_count_      = len(prs)
+        for pr in prs:
+            advance, left, top = pr.glyph_metrics_
+            x = asset_font.AssetFont2DGlyph()
+            x.codepoint_        = pr.get_local_index()
+            x.texture_index_    = pr.packed_bin_index_
+            x.group_index_      = group_index
+            x.advance_          = advance
+            x.offset_x_         = left + pr.crop_l_
+            x.offset_y_         = pr.crop_t_ - top
+            x.w_                = pr.crop_w_
+            x.h_                = pr.crop_h_
+            x.u0_               = pr.au_
+            x.v0_               = pr.av_
+            x.u1_               = pr.cu_
+            x.v1_               = pr.cv_
+            afn.append_glyph(x)
+        afn.append_group(g)
+        glyph_start = glyph_start + len(prs)
+
+    w = io.AssetWriter(8)
+    afn.write(w)
+    w.save_as(font_name)
+
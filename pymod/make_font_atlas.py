@@ -5,9 +5,25 @@ import os
 
 from pymod import font_atlas
 from pymod import misc
+from pymod import build_cache
+
+
+def make_job(ubl, dst_font_file, font_size_name_list):
+    inputs = build_cache.get_tool_files()
+    for fs, fn in font_size_name_list:
+        inputs.append(fn)
+    base_name = os.path.basename(dst_font_file)
+    return build_cache.Job(
+        "fonts/" + base_name
+    ,   font_atlas.create_font
+    ,   (ubl, dst_font_file, font_size_name_list)
+    ,   inputs
+    ,   ("font_atlas", ubl, [fs for fs, fn in font_size_name_list])
+    ,   [dst_font_file + ".font", dst_font_file + "_0.png"]
+    )
 
 
-def run(raw_input_dir, asset_output_dir):
+def make_jobs(raw_input_dir, asset_output_dir):
     print("raw_input_dir=%s, asset_output_dir=%s" % (raw_input_dir, asset_output_dir))
     assert(os.path.isdir(raw_input_dir))
     assert(os.path.isdir(asset_output_dir))
@@ -69,6 +85,21 @@ def run(raw_input_dir, asset_output_dir):
     # )
 
 
+    overlay_unicode_blocks = [
+        "Basic Latin"
+    ]
+
+    ubl_overlay = misc.get_unicode_block_ranges(overlay_unicode_blocks, False)
+
+    jobs = list()
+
+    font_file = "/usr/share/fonts/noto/NotoSansMono-Regular.ttf"
+    jobs.append(make_job(ubl_overlay, dst("overlay_font"), [
+            (16, font_file)
+        ]
+    ))
+
+
     cjk_unicode_blocks = [
         "Hiragana"
     ,   "Katakana"
@@ -85,7 +116,7 @@ def run(raw_input_dir, asset_output_dir):
     ubl_cjk = misc.get_unicode_block_ranges(cjk_unicode_blocks, False)
 
     font_file = "/usr/share/fonts/noto-cjk/NotoSansCJK-Regular.ttc"
-    font_atlas.create_font(ubl_cjk, dst("test_font_noto-cjk"), [
+    jobs.append(make_job(ubl_cjk, dst("test_font_noto-cjk"), [
             (32, font_file)
         #,   (12, font_file)
         #,   (16, font_file)
@@ -93,7 +124,6 @@ def run(raw_input_dir, asset_output_dir):
         #,   (32, font_file)
         #,   (44, font_file)
         ]
-    )
-
-
+    ))
 
+    return jobs
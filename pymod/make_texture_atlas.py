@@ -3,9 +3,26 @@ import os
 
 
 from pymod import texture_atlas
+from pymod import build_cache
+
+
+def make_job(dst_dir, src_dirs, create_animation, premultiplied_alpha=False):
+    inputs = build_cache.get_tool_files()
+    for src_dir in src_dirs:
+        inputs = inputs + build_cache.get_files_in_dir(src_dir)
+    base_name = os.path.basename(dst_dir)
+    func = texture_atlas.create_animation if create_animation else texture_atlas.create_image_collection
+    return build_cache.Job(
+        "sprites/" + base_name
+    ,   func
+    ,   (dst_dir, src_dirs, premultiplied_alpha)
+    ,   inputs
+    ,   ("texture_atlas", create_animation, premultiplied_alpha, len(src_dirs))
+    ,   [os.path.join(dst_dir, base_name + ".sprf"), os.path.join(dst_dir, base_name + "_0.png")]
+    )
 
 
-def run(raw_input_dir, asset_output_dir):
+def make_jobs(raw_input_dir, asset_output_dir):
     print("raw_input_dir=%s, asset_output_dir=%s" % (raw_input_dir, asset_output_dir))
     assert(os.path.isdir(raw_input_dir))
     assert(os.path.isdir(asset_output_dir))
@@ -24,30 +41,22 @@ def run(raw_input_dir, asset_output_dir):
         return os.path.join(dst_dir, d)
 
 
-    texture_atlas.create_animation(
-        dst("cube"), [
-            src("testing/cube/frames")
-        ]
-    )
-
-    texture_atlas.create_animation(
-        dst("suzanne"), [
-            src("testing/suzanne/frames")
-        ]
-    )
-
-    texture_atlas.create_image_collection(
-        dst("patset"), [
-            src("testing/patset/frames")
-        ]
-    )
-
-    texture_atlas.create_animation(
-        dst("test_cube_suzanne"), [
-            src("testing/cube/frames")
-        ,   src("testing/suzanne/frames")
-        ]
-    )
-
-
-
+    return [
+        make_job(dst("cube"), [
+                src("testing/cube/frames")
+            ], True
+        )
+    ,   make_job(dst("suzanne"), [
+                src("testing/suzanne/frames")
+            ], True
+        )
+    ,   make_job(dst("patset"), [
+                src("testing/patset/frames")
+            ], False
+        )
+    ,   make_job(dst("test_cube_suzanne"), [
+                src("testing/cube/frames")
+            ,   src("testing/suzanne/frames")
+            ], True, True
+        )
+    ]
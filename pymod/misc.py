@@ -50,6 +50,7 @@ def make_asset_rect_2d_info(r):
     a = asset_sprite.AssetRect2DInfo()
     a.texture_index_    = r.packed_bin_index_
     a.group_index_      = r.group_index_
+    a.flags_            = asset_sprite.rect_2d_info_flag_opaque if r.is_opaque() else 0
     a.bounding_info_    = make_asset_bounding_info(r)
     return a
 
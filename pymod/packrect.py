@@ -150,6 +150,15 @@ class PackRect:
         return self.image_ is not None
 
 
+    def is_opaque(self):
+        assert(self.is_valid())
+        for y in range(self.crop_t_, self.crop_t_ + self.crop_h_):
+            for x in range(self.crop_l_, self.crop_l_ + self.crop_w_):
+                if self.image_.getpixel((x, y))[3] != 255:
+                    return False
+        return True
+
+
     def init_from_file(self, file_name):
         img = Image.open(file_name)
         assert(img.mode == "RGBA")
@@ -363,3 +372,27 @@ def copy_pack_rect(img, pr):
 
             rgba = pr.image_.getpixel((src_x, src_y))
             img.putpixel((dst_x, dst_y), rgba)
+
+
+def srgb_to_linear(c):
+    return c / 12.92 if c <= 0.04045 else ((c + 0.055) / 1.055) ** 2.4
+
+
+def linear_to_srgb(l):
+    l = min(max(l, 0.0), 1.0)
+    return l * 12.92 if l <= 0.0031308 else 1.055 * (l ** (1.0 / 2.4)) - 0.055
+
+
+# Multiplies the colors by alpha in linear space and stores them as srgb
+# again, the same as bin/threed_atlas --premultiplied does.
+def premultiply_alpha(img):
+    assert(img.mode == "RGBA")
+    linear = [srgb_to_linear(i / 255.0) for i in range(0, 256)]
+    lut = dict()
+    pixels = list()
+    for r, g, b, a in img.getdata():
+        if a not in lut:
+            lut[a] = [int(linear_to_srgb(l * a / 255.0) * 255.0 + 0.5) for l in linear]
+        m = lut[a]
+        pixels.append((m[r], m[g], m[b], a))
+    img.putdata(pixels)
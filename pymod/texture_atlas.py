@@ -26,7 +26,7 @@ def fill_image(img, rgba):
 #             img.putpixel((x, y), rgba)
 
 
-def pack_sprite_rects(pack_rects, dst_dir, create_animation):
+def pack_sprite_rects(pack_rects, dst_dir, create_animation, premultiplied_alpha):
     base_name = os.path.basename(dst_dir)
     print("base_name=%s" % base_name)
 
@@ -71,6 +71,8 @@ def pack_sprite_rects(pack_rects, dst_dir, create_animation):
             pr.calc_pos_uv()
             packrect.copy_pack_rect(bin_img, pr)
             groups[pr.group_index_].append(pr)
+        if premultiplied_alpha:
+            packrect.premultiply_alpha(bin_img)
         img_name = base_name + "_%d.png" % bidx
         atlas_name = os.path.join(dst_dir, img_name)
         bin_img.save(atlas_name, "PNG")
@@ -81,6 +83,8 @@ def pack_sprite_rects(pack_rects, dst_dir, create_animation):
         sorted_groups[k] = sorted(v, key=lambda x: x.get_local_index())
 
     ass = asset_sprite.AssetSprite2D()
+    if premultiplied_alpha:
+        ass.set_premultiplied_alpha()
     frame_start = 0
     frame_count = 0
     for k, v in sorted_groups.items():
@@ -109,7 +113,7 @@ def create_sprite_pack_rect(file_name, local_index, group_index):
     return pr
 
 
-def create_sprite_pack_rects(dst_dir, src_dirs, create_animation):
+def create_sprite_pack_rects(dst_dir, src_dirs, create_animation, premultiplied_alpha):
     print("src_dirs=%s, dst_dir=%s" % (src_dirs, dst_dir))
     for src_dir in src_dirs:
         assert(os.path.isdir(src_dir))
@@ -126,15 +130,15 @@ def create_sprite_pack_rects(dst_dir, src_dirs, create_animation):
             prs.append(pr)
         pack_rects.append(prs)
 
-    pack_sprite_rects(pack_rects, dst_dir, create_animation)
+    pack_sprite_rects(pack_rects, dst_dir, create_animation, premultiplied_alpha)
 
 
-def create_animation(dst_dir, src_dirs):
-    create_sprite_pack_rects(dst_dir, src_dirs, True)
+def create_animation(dst_dir, src_dirs, premultiplied_alpha=False):
+    create_sprite_pack_rects(dst_dir, src_dirs, True, premultiplied_alpha)
 
 
-def create_image_collection(dst_dir, src_dirs):
-    create_sprite_pack_rects(dst_dir, src_dirs, False)
+def create_image_collection(dst_dir, src_dirs, premultiplied_alpha=False):
+    create_sprite_pack_rects(dst_dir, src_dirs, False, premultiplied_alpha)
 
 
 
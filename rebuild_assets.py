@@ -1,9 +1,11 @@
 #!tpl/python/bin/python
 
 import os
+import sys
 
 from pymod import make_texture_atlas
 from pymod import make_font_atlas
+from pymod import build_cache
 
 
 def main():
@@ -13,8 +15,14 @@ def main():
     if not os.path.isdir(dst_path):
         os.makedirs(dst_path)
 
-    #make_texture_atlas.run(src_path, dst_path)
-    make_font_atlas.run(src_path, dst_path)
+    # only inputs which changed since the last run are rebuilt, --force
+    # rebuilds everything.
+    cache = build_cache.BuildCache(os.path.join(dst_path, "build_cache.json"))
+    jobs = list()
+    #jobs += make_texture_atlas.make_jobs(src_path, dst_path)
+    jobs += make_font_atlas.make_jobs(src_path, dst_path)
+    if not cache.run(jobs, True, "--force" in sys.argv):
+        sys.exit(1)
 
 
 if __name__ == "__main__":
@@ -1,15 +1,41 @@
 #!/usr/bin/env python3
 
 import os
+import re
+import sys
 import shutil
 import subprocess
 
+from pymod import build_cache
+
 SCRIPT_PATH=os.path.dirname(os.path.realpath(__file__))
 
+INCLUDE_RE = re.compile(r'^\s*#\s*include\s*[<"]([^>"]+)[>"]', re.MULTILINE)
+
 
 def run_glslc(src, dst):
     print("Generate shader %s -> %s" % (src, dst))
-    subprocess.run(['glslc', src, '-o', dst])
+    return 0 == subprocess.run(['glslc', src, '-o', dst]).returncode
+
+
+def get_glslc_version():
+    try:
+        return subprocess.run(['glslc', '--version'], capture_output=True, text=True).stdout
+    except OSError:
+        return None
+
+
+def find_includes(src, found):
+    # includes are inputs as well, followed recursively.
+    with open(src, "r") as f:
+        text = f.read()
+    for inc in INCLUDE_RE.findall(text):
+        fn = os.path.normpath(os.path.join(os.path.dirname(src), inc))
+        if fn in found or not os.path.isfile(fn):
+            continue
+        found.append(fn)
+        find_includes(fn, found)
+    return found
 
 
 def main():
@@ -32,18 +58,38 @@ def main():
     def dst(d):
         return os.path.join(dst_dir, d)
 
+    glslc_version = get_glslc_version()
+    jobs = list()
+
     def run(s):
-        run_glslc(src(s), dst(s + ".spv"))
+        inputs = [src(s)] + find_includes(src(s), list())
+        jobs.append(build_cache.Job(
+            s
+        ,   run_glslc
+        ,   (src(s), dst(s + ".spv"))
+        ,   inputs
+        ,   ("glslc", glslc_version)
+        ,   [dst(s + ".spv")]
+        ))
 
 
     run("shader.vert")
     run("shader.frag")
-    run("shader_test.vert")
-    run("shader_test.frag")
     run("sprite_shader.vert")
     run("sprite_shader.frag")
     run("sprite_animation_shader.vert")
     run("sprite_animation_shader.frag")
+    run("text_shader.vert")
+    run("text_shader.frag")
+    run("sprite_batch_shader.vert")
+    run("sprite_batch_shader.frag")
+    run("post_shader.vert")
+    run("post_shader.frag")
+
+    # glslc does the work, threads are enough to keep all cores busy.
+    cache = build_cache.BuildCache(os.path.join(dst_dir, "build_cache.json"))
+    if not cache.run(jobs, False, "--force" in sys.argv):
+        sys.exit(1)
 
 
 
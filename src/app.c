@@ -4,6 +4,10 @@
 #include "log.h"
 #include "debug.h"
 #include "gfx.h"
+#include "job.h"
+#include "startup.h"
+#include "input_record.h"
+#include "bench.h"
 
 #include <SDL3/SDL_log.h>
 #include <SDL3/SDL_version.h>
@@ -13,6 +17,7 @@
 #include <SDL3/SDL_timer.h>
 #include <SDL3/SDL_filesystem.h>
 #include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_atomic.h>
 
 
 #include <cglm/mat4.h>
@@ -35,6 +40,14 @@ static char const   org_name_[] = "whatever" ;
 static char const   app_name_[] = "threed" ;
 
 
+// every allocation is prefixed with its size so the overlay can show how much
+// memory is in use. 16 bytes keeps the returned pointer 16 byte aligned.
+#define alloc_header_size   16
+
+// the render thread allocates as well, e.g. when the swapchain is recreated.
+static SDL_SpinLock alloc_lock_ = 0 ;
+
+
 
 ////////////////////////////////////////////////////////////////////////////////
 //                                                                            //
@@ -114,6 +127,52 @@ get_performance_frequency_inverse()
 }
 
 
+
+bool
+has_app_arg(
+    char const * const  arg
+)
+{
+    require(arg) ;
+
+    for(
+        int i = 1
+    ;   i < app_->argc_
+    ;   ++i
+    )
+    {
+        if(0 == SDL_strcmp(app_->argv_[i], arg))
+        {
+            return true ;
+        }
+    }
+
+    return false ;
+}
+
+
+char const *
+get_app_arg_value(
+    char const * const  arg
+)
+{
+    require(arg) ;
+
+    for(
+        int i = 1
+    ;   i + 1 < app_->argc_
+    ;   ++i
+    )
+    {
+        if(0 == SDL_strcmp(app_->argv_[i], arg))
+        {
+            return app_->argv_[i + 1] ;
+        }
+    }
+
+    return NULL ;
+}
+
 static void
 recalc_size()
 {
@@ -138,6 +197,7 @@ create_app()
     app_->performance_counter_0_ = SDL_GetPerformanceCounter() ;
     app_->performance_counter_0_ = SDL_GetPerformanceCounter() ;
     require(app_->performance_counter_0_) ;
+    begin_startup_phase(startup_phase_app) ;
 
     app_->base_path_ = SDL_GetBasePath() ;
     require(app_->base_path_) ;
@@ -157,13 +217,32 @@ create_app()
     app_->subsystems_ = SDL_INIT_VIDEO ;
     if(check_sdl(0 == SDL_Init(app_->subsystems_)))
     {
+        end_startup_phase(startup_phase_app) ;
         return  false ;
     }
 
+    if(check(create_jobs()))
+    {
+        end_startup_phase(startup_phase_app) ;
+        return false ;
+    }
+
     app_->window_width_     = 1280 ;
     app_->window_height_    = 768 ;
+    app_->show_overlay_     = true ;
     require(!app_->window_) ;
 
+    char const * const scene_name = get_app_arg_value("--scene") ;
+    app_->scene_name_               = scene_name ? scene_name : default_app_scene ;
+    app_->scene_sprite_count_       = default_app_sprite_count ;
+    app_->scene_instance_capacity_  = default_app_instance_capacity ;
+
+    char const * const background_fps = get_app_arg_value("--background-fps") ;
+    app_->background_hz_ = background_fps
+        ? (uint32_t) SDL_strtoul(background_fps, NULL, 10)
+        : default_app_background_hz
+        ;
+
     app_->window_ = SDL_CreateWindow(
         app_name_
     ,   app_->window_width_
@@ -173,12 +252,26 @@ create_app()
 
     if(check_sdl(0 != app_->window_))
     {
+        end_startup_phase(startup_phase_app) ;
         return false ;
     }
 
     recalc_size() ;
 
+    if(check(create_input_record()))
+    {
+        end_startup_phase(startup_phase_app) ;
+        return false ;
+    }
+
+    if(check(create_bench()))
+    {
+        end_startup_phase(startup_phase_app) ;
+        return false ;
+    }
+
     app_->created_ = true ;
+    end_startup_phase(startup_phase_app) ;
     return true ;
 }
 
@@ -186,12 +279,17 @@ create_app()
 void
 destroy_app()
 {
+    destroy_bench() ;
+    destroy_input_record() ;
+
     if(app_->window_)
     {
         SDL_DestroyWindow(app_->window_) ;
         app_->window_ = NULL ;
     }
 
+    destroy_jobs() ;
+
     if(app_->subsystems_)
     {
         SDL_QuitSubSystem(app_->subsystems_) ;
@@ -206,6 +304,110 @@ destroy_app()
 }
 
 
+void
+handle_keyboard_event(
+    SDL_Event * event
+) ;
+
+
+static bool
+simulate_app()
+{
+    begin_timed_block() ;
+
+    uint64_t const now = get_app_time() ;
+
+    if(!app_->simulation_step_)
+    {
+        app_->simulation_step_          = (uint64_t) SDL_GetPerformanceFrequency() / app_simulation_hz ;
+        app_->simulation_step_seconds_  = 1.0f / (float) app_simulation_hz ;
+        app_->simulation_last_time_     = now ;
+        require(app_->simulation_step_) ;
+    }
+
+    uint64_t delta = now - app_->simulation_last_time_ ;
+
+    // a replay brings its own clock and keyboard, the frame steps as it did
+    // when it was recorded.
+    if(is_input_replaying())
+    {
+        SDL_Event   events[max_input_record_frame_events] ;
+        uint32_t    events_count = 0 ;
+        if(!replay_input_frame(&delta, events, &events_count))
+        {
+            log_info("replay done.") ;
+            app_->running_ = false ;
+            end_timed_block() ;
+            return true ;
+        }
+
+        for(
+            uint32_t i = 0
+        ;   i < events_count
+        ;   ++i
+        )
+        {
+            handle_keyboard_event(&events[i]) ;
+        }
+    }
+    else if(is_benching())
+    {
+        // one step for every frame, two runs of a bench draw the same frames.
+        delta = app_->simulation_step_ ;
+    }
+    else
+    {
+        record_input_frame(delta) ;
+    }
+
+    // paused time isn't simulated, the scene stays as it is.
+    if(app_->paused_)
+    {
+        delta = 0 ;
+    }
+
+    app_->simulation_accumulator_  += delta ;
+    app_->simulation_last_time_     = now ;
+    app_->simulation_steps_         = 0 ;
+
+    for( ; app_->simulation_accumulator_ >= app_->simulation_step_ ; )
+    {
+        if(app_->simulation_steps_ == max_app_simulation_steps)
+        {
+            app_->simulation_accumulator_ %= app_->simulation_step_ ;
+            break ;
+        }
+
+        bool changed = false ;
+        if(check(simulate_gfx(app_->simulation_step_seconds_, &changed)))
+        {
+            end_timed_block() ;
+            return false ;
+        }
+
+        app_->simulation_changed_ = changed ;
+        if(changed)
+        {
+            app_->redraw_ = true ;
+        }
+
+        app_->simulation_accumulator_ -= app_->simulation_step_ ;
+        ++app_->simulation_steps_ ;
+    }
+
+    app_->simulation_alpha_ = (float) ((double) app_->simulation_accumulator_ / (double) app_->simulation_step_) ;
+
+    // a new alpha only shows when the last two states differ.
+    if(delta && app_->simulation_changed_)
+    {
+        app_->redraw_ = true ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
 bool
 update_app()
 {
@@ -213,10 +415,53 @@ update_app()
 
     if(app_->minimized_)
     {
+        // the time spent minimized is not simulated.
+        app_->simulation_last_time_ = get_app_time() ;
         return true ;
     }
 
-    if(check(draw_gfx()))
+    bool const live = is_input_replaying() || is_benching() ;
+
+    // in the background frames are drawn at background_hz_ at most, the time
+    // in between is simulated with the next one.
+    if(!app_->keyboard_focus_ && !live && app_->background_hz_)
+    {
+        uint64_t const now = get_app_time() ;
+        if(now < app_->next_background_frame_)
+        {
+            return true ;
+        }
+
+        app_->next_background_frame_ = now + (uint64_t) SDL_GetPerformanceFrequency() / app_->background_hz_ ;
+    }
+
+    if(check(simulate_app()))
+    {
+        return false ;
+    }
+
+    if(!app_->running_)
+    {
+        return true ;
+    }
+
+    // what was drawn last is still on screen.
+    if(!live && !app_->redraw_ && !is_gfx_animated())
+    {
+        return true ;
+    }
+
+    app_->redraw_ = false ;
+
+    // drawn on the render thread, meanwhile events and the next steps are
+    // handled here. A replay or a bench draws every frame, none may be
+    // dropped.
+    if(check(submit_gfx(live)))
+    {
+        return false ;
+    }
+
+    if(check(update_bench()))
     {
         return false ;
     }
@@ -245,6 +490,7 @@ resize_app(
 
     recalc_size() ;
     resize_gfx() ;
+    app_->redraw_ = true ;
 }
 
 
@@ -263,6 +509,7 @@ handle_window_event(
     case SDL_EVENT_WINDOW_HIDDEN:
         break ;
     case SDL_EVENT_WINDOW_EXPOSED:
+        app_->redraw_ = true ;
         break ;
     case SDL_EVENT_WINDOW_MOVED:
         break ;
@@ -397,6 +644,13 @@ handle_keyboard_event(
         case SDLK_RIGHT:
             ++app_->cnt_ ;
             break ;
+        case SDLK_F1:
+            app_->show_overlay_ = !app_->show_overlay_ ;
+            app_->redraw_ = true ;
+            break ;
+        case SDLK_SPACE:
+            app_->paused_ = !app_->paused_ ;
+            break ;
 
         default:
             break ;
@@ -426,6 +680,25 @@ handle_keyboard_event(
 
 
 
+// pushed by other threads to wake the main loop, e.g. after shaders were
+// reloaded, which changes what is drawn.
+static void
+handle_user_event(
+    SDL_Event * event
+)
+{
+    require(event) ;
+    switch(event->type)
+    {
+    case SDL_EVENT_USER:
+        app_->redraw_ = true ;
+        break ;
+    default:
+        break ;
+    }
+}
+
+
 void
 handle_event(
     SDL_Event * event
@@ -434,8 +707,49 @@ handle_event(
     require(event) ;
 
     handle_window_event(event) ;
-    handle_keyboard_event(event) ;
     handle_quit_event(event) ;
+    handle_user_event(event) ;
+
+    // while replaying the keyboard comes from the recording.
+    if(is_input_replaying())
+    {
+        return ;
+    }
+
+    record_input_event(event) ;
+    handle_keyboard_event(event) ;
+}
+
+
+// how long the main loop may sleep before the next frame is due.
+static uint32_t
+get_app_idle_ms(
+    bool const  background
+)
+{
+    if(background)
+    {
+        uint64_t const now = get_app_time() ;
+        if(now >= app_->next_background_frame_)
+        {
+            return 0 ;
+        }
+
+        // rounded up, waking up too early would only spin.
+        uint64_t const frequency = SDL_GetPerformanceFrequency() ;
+        return (uint32_t) (((app_->next_background_frame_ - now) * 1000 + frequency - 1) / frequency) ;
+    }
+
+    // paused nothing changes until an event arrives.
+    bool const idle =
+        app_->paused_
+    &&  !app_->redraw_
+    &&  !is_input_replaying()
+    &&  !is_benching()
+    &&  !is_gfx_animated()
+    ;
+
+    return idle ? app_idle_wait_ms : 0 ;
 }
 
 
@@ -447,10 +761,22 @@ run_app()
     app_->running_          = true ;
     app_->minimized_        = false ;
     app_->keyboard_focus_   = false ;
+    app_->redraw_           = true ;
 
     for( ; app_->running_ ; )
     {
-        bool const wait = app_->minimized_ || app_->keyboard_focus_ == false ;
+        // a replay or a bench doesn't wait for the focus. Without a
+        // background rate nothing happens until the next event.
+        bool const background =
+            !app_->keyboard_focus_
+        &&  !is_input_replaying()
+        &&  !is_benching()
+        ;
+
+        bool const wait =
+            app_->minimized_
+        ||  (background && 0 == app_->background_hz_)
+        ;
 
         if(wait)
         {
@@ -466,7 +792,16 @@ run_app()
         }
         else
         {
+            // sleeps until the next frame is due instead of spinning, an
+            // event wakes it up early.
+            uint32_t const idle_ms = get_app_idle_ms(background) ;
+
             SDL_Event event ;
+            if(idle_ms && SDL_WaitEventTimeout(&event, (Sint32) idle_ms))
+            {
+                handle_event(&event) ;
+            }
+
             for( ; SDL_PollEvent(&event) ; )
             {
                 handle_event(&event) ;
@@ -546,8 +881,9 @@ alloc_memory_impl(
 ,   int const       line
 )
 {
-    void * p = SDL_malloc(byte_count) ;
-    require(p) ;
+    uint8_t * h = SDL_malloc(byte_count + alloc_header_size) ;
+    require(h) ;
+    void * p = h ? h + alloc_header_size : NULL ;
     if(!p)
     {
         log_output_impl(
@@ -565,6 +901,12 @@ alloc_memory_impl(
         return NULL ;
     }
 
+    *(uint64_t *)h = byte_count ;
+    SDL_LockSpinlock(&alloc_lock_) ;
+    app_->allocated_bytes_ += byte_count ;
+    ++app_->allocations_count_ ;
+    SDL_UnlockSpinlock(&alloc_lock_) ;
+
     if(clear_memory)
     {
         SDL_memset(p, 0, byte_count) ;
@@ -600,8 +942,9 @@ alloc_array_impl(
     require(count) ;
     require(byte_size) ;
     size_t const total = count * byte_size ;
-    void * p = SDL_malloc(total) ;
-    require(p) ;
+    uint8_t * h = SDL_malloc(total + alloc_header_size) ;
+    require(h) ;
+    void * p = h + alloc_header_size ;
     // if(!p)
     // {
     //     log_output_impl(
@@ -619,6 +962,12 @@ alloc_array_impl(
     //     return NULL ;
     // }
 
+    *(uint64_t *)h = total ;
+    SDL_LockSpinlock(&alloc_lock_) ;
+    app_->allocated_bytes_ += total ;
+    ++app_->allocations_count_ ;
+    SDL_UnlockSpinlock(&alloc_lock_) ;
+
     if(clear_memory)
     {
         SDL_memset(p, 0, total) ;
@@ -665,11 +1014,34 @@ free_memory_impl(
 
     if(mem)
     {
-        SDL_free(mem) ;
+        uint8_t * h = (uint8_t *)mem - alloc_header_size ;
+        SDL_LockSpinlock(&alloc_lock_) ;
+        require(app_->allocations_count_) ;
+        require(app_->allocated_bytes_ >= *(uint64_t *)h) ;
+        app_->allocated_bytes_ -= *(uint64_t *)h ;
+        --app_->allocations_count_ ;
+        SDL_UnlockSpinlock(&alloc_lock_) ;
+        SDL_free(h) ;
     }
 }
 
 
+void
+get_app_allocations(
+    uint64_t *  out_bytes
+,   uint64_t *  out_count
+)
+{
+    require(out_bytes) ;
+    require(out_count) ;
+
+    SDL_LockSpinlock(&alloc_lock_) ;
+    *out_bytes = app_->allocated_bytes_ ;
+    *out_count = app_->allocations_count_ ;
+    SDL_UnlockSpinlock(&alloc_lock_) ;
+}
+
+
 bool
 load_file(
     void **             out_memory
@@ -682,10 +1054,12 @@ load_file(
     require(fullname) ;
     require(*fullname) ;
     begin_timed_block() ;
+    begin_startup_phase(startup_phase_assets) ;
     SDL_IOStream * ios = NULL ;
 
     if(check_sdl(ios = SDL_IOFromFile(fullname, "rb")))
     {
+        end_startup_phase(startup_phase_assets) ;
         end_timed_block() ;
         return false ;
     }
@@ -695,9 +1069,11 @@ load_file(
     {
         if(check_sdl(0 == SDL_CloseIO(ios)))
         {
+            end_startup_phase(startup_phase_assets) ;
             end_timed_block() ;
             return false ;
         }
+        end_startup_phase(startup_phase_assets) ;
         end_timed_block() ;
         return false ;
     }
@@ -712,9 +1088,11 @@ load_file(
         {
             if(check_sdl(0 == SDL_CloseIO(ios)))
             {
+                end_startup_phase(startup_phase_assets) ;
                 end_timed_block() ;
                 return false ;
             }
+            end_startup_phase(startup_phase_assets) ;
             end_timed_block() ;
             return false ;
         }
@@ -725,9 +1103,11 @@ load_file(
             free_memory(p) ;
             if(check_sdl(0 == SDL_CloseIO(ios)))
             {
+                end_startup_phase(startup_phase_assets) ;
                 end_timed_block() ;
                 return false ;
             }
+            end_startup_phase(startup_phase_assets) ;
             end_timed_block() ;
             return false ;
         }
@@ -737,6 +1117,7 @@ load_file(
     if(check_sdl(0 == SDL_CloseIO(ios)))
     {
         free_memory(p) ;
+        end_startup_phase(startup_phase_assets) ;
         end_timed_block() ;
         return false ;
     }
@@ -744,6 +1125,7 @@ load_file(
     *out_memory = p ;
     *out_size   = n ;
 
+    end_startup_phase(startup_phase_assets) ;
     end_timed_block() ;
     return true ;
 }
@@ -7,6 +7,26 @@
 typedef struct SDL_Window SDL_Window;
 
 
+// the simulation runs at a fixed rate, independent of how often frames are
+// drawn. A stall of more than max_app_simulation_steps steps is dropped
+// instead of caught up with.
+#define app_simulation_hz           120
+#define max_app_simulation_steps    8
+
+
+// without focus frames are drawn at this rate, 8 steps each, so no time is
+// dropped. Paused with nothing to draw the app checks again after
+// app_idle_wait_ms even without events.
+#define default_app_background_hz   15
+#define app_idle_wait_ms            100
+
+
+// what is drawn without --scene and --bench.
+#define default_app_scene               "sprites"
+#define default_app_sprite_count        32
+#define default_app_instance_capacity   16384
+
+
 typedef struct app
 {
     char ** argv_ ;
@@ -28,11 +48,44 @@ typedef struct app
     bool            running_ ;
     bool            minimized_ ;
     bool            keyboard_focus_ ;
+    bool            paused_ ;
+
+    // a frame is only drawn when redraw_ says what is shown changed since the
+    // last one, or the scene is animated. In the background the next one is
+    // drawn at next_background_frame_ and with background_hz_ 0 only when
+    // an event arrives.
+    bool            redraw_ ;
+    uint32_t        background_hz_ ;
+    uint64_t        next_background_frame_ ;
 
     uint64_t        performance_counter_0_ ;
     char const *    base_path_ ;
     char const *    pref_path_ ;
 
+    // ticks per simulation step, what is left over of the time drawn so far
+    // and how far the frame is between the last two simulation states, which
+    // only differ when simulation_changed_ is set.
+    uint64_t        simulation_step_ ;
+    uint64_t        simulation_accumulator_ ;
+    uint64_t        simulation_last_time_ ;
+    float           simulation_step_seconds_ ;
+    float           simulation_alpha_ ;
+    uint32_t        simulation_steps_ ;
+    bool            simulation_changed_ ;
+
+    // changed under the allocator's lock from any thread, see
+    // get_app_allocations.
+    uint64_t        allocated_bytes_ ;
+    uint64_t        allocations_count_ ;
+    bool            show_overlay_ ;
+
+    // the scene create_gfx makes, see gfx.c. The sprite count may change
+    // while running, the instances drawn never exceed the capacity the scene
+    // was made with.
+    char const *    scene_name_ ;
+    uint32_t        scene_sprite_count_ ;
+    uint32_t        scene_instance_capacity_ ;
+
 
 } app ;
 
@@ -52,6 +105,20 @@ double
 get_performance_frequency_inverse() ;
 
 
+// true when arg was passed on the command line, as it is.
+bool
+has_app_arg(
+    char const * const  arg
+) ;
+
+
+// what follows arg on the command line, NULL when arg isn't there.
+char const *
+get_app_arg_value(
+    char const * const  arg
+) ;
+
+
 void *
 alloc_memory_impl(
     size_t const    byte_count
@@ -85,6 +152,15 @@ free_memory_impl(
 ) ;
 
 
+// The bytes and the number of allocations in use, read under the same lock
+// the allocator takes.
+void
+get_app_allocations(
+    uint64_t *  out_bytes
+,   uint64_t *  out_count
+) ;
+
+
 bool
 load_file(
     void **             out_memory
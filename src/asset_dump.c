@@ -1,5 +1,7 @@
 #include "asset_dump.h"
 #include "asset_sprite.h"
+#include "asset_font.h"
+#include "asset_texture.h"
 #include "defines.h"
 #include "log.h"
 
@@ -55,7 +57,7 @@ dump_rect_2d_info(
     require(p) ;
     log_debug_u16(p->texture_index_) ;
     log_debug_u16(p->group_index_) ;
-    log_debug_u16(p->pad1_) ;
+    log_debug_u16(p->flags_) ;
     log_debug_u16(p->pad2_) ;
     dump_rect_2d_bounding_info(&p->bounding_info_) ;
 }
@@ -70,12 +72,43 @@ dump_rect_2d_group(
 
     log_debug_u16(p->frame_start_) ;
     log_debug_u16(p->frame_count_) ;
-    log_debug_u16(p->pad1_) ;
-    log_debug_u16(p->pad2_) ;
+    log_debug_u16(p->playback_) ;
+    log_debug_u16(p->blend_ms_) ;
     dump_rect_2d_bounding_info(&p->bounding_info_) ;
 }
 
 
+static void
+dump_rect_2d_hull(
+    rect_2d_hull const * p
+)
+{
+    require(p) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < max_rect_2d_hull_vertices
+    ;   ++i
+    )
+    {
+        log_debug_u16(p->st_[i][0]) ;
+        log_debug_u16(p->st_[i][1]) ;
+    }
+}
+
+
+static void
+dump_rect_2d_timing(
+    rect_2d_timing const * p
+)
+{
+    require(p) ;
+
+    log_debug_u16(p->duration_ms_) ;
+    log_debug_u16(p->event_) ;
+}
+
+
 void
 dump_sprite_2d(
     sprite_2d const * p
@@ -91,6 +124,9 @@ dump_sprite_2d(
     log_debug_u32(p->groups_offset_) ;
     log_debug_u32(p->vertices_offset_) ;
     log_debug_u32(p->infos_offset_) ;
+    log_debug_u32(p->hulls_offset_) ;
+    log_debug_u32(p->flags_) ;
+    log_debug_u32(p->timings_offset_) ;
 
     rect_2d_group *     rg = asset_ref(rect_2d_group,    p, p->groups_offset_) ;
     rect_2d_vertices *  rv = asset_ref(rect_2d_vertices, p, p->vertices_offset_) ;
@@ -126,5 +162,155 @@ dump_sprite_2d(
         dump_rect_2d_info(&ri[i]) ;
     }
 
+    if(p->hulls_offset_)
+    {
+        rect_2d_hull * rh = asset_ref(rect_2d_hull, p, p->hulls_offset_) ;
+
+        for(
+            uint16_t i = 0
+        ;   i < p->vertices_count_
+        ;   ++i
+        )
+        {
+            log_debug_u16(i) ;
+            dump_rect_2d_hull(&rh[i]) ;
+        }
+    }
+
+    if(p->timings_offset_)
+    {
+        rect_2d_timing * rt = asset_ref(rect_2d_timing, p, p->timings_offset_) ;
+
+        for(
+            uint16_t i = 0
+        ;   i < p->infos_count_
+        ;   ++i
+        )
+        {
+            log_debug_u16(i) ;
+            dump_rect_2d_timing(&rt[i]) ;
+        }
+    }
+
+}
+
+
+static void
+dump_font_2d_group(
+    font_2d_group const * p
+)
+{
+    require(p) ;
+
+    log_debug_u16(p->font_size_) ;
+    log_debug_u16(p->glyph_start_) ;
+    log_debug_u16(p->glyph_count_) ;
+    log_debug_f32(p->line_height_) ;
+    log_debug_f32(p->ascender_) ;
+    log_debug_f32(p->space_advance_) ;
+}
+
+
+static void
+dump_font_2d_glyph(
+    font_2d_glyph const * p
+)
+{
+    require(p) ;
+
+    log_debug_u32(p->codepoint_) ;
+    log_debug_u16(p->texture_index_) ;
+    log_debug_u16(p->group_index_) ;
+    log_debug_f32(p->advance_) ;
+    log_debug_f32(p->offset_x_) ;
+    log_debug_f32(p->offset_y_) ;
+    log_debug_f32(p->w_) ;
+    log_debug_f32(p->h_) ;
+    log_debug_f32(p->u0_) ;
+    log_debug_f32(p->v0_) ;
+    log_debug_f32(p->u1_) ;
+    log_debug_f32(p->v1_) ;
+}
+
+
+void
+dump_font_2d(
+    font_2d const * p
+)
+{
+    require(p) ;
+
+    log_debug_u16(p->tid_) ;
+    log_debug_u16(p->groups_count_) ;
+    log_debug_u16(p->glyphs_count_) ;
+    log_debug_u16(p->textures_count_) ;
+
+    log_debug_u32(p->groups_offset_) ;
+    log_debug_u32(p->glyphs_offset_) ;
+
+    font_2d_group * fg = asset_ref(font_2d_group, p, p->groups_offset_) ;
+    font_2d_glyph * fl = asset_ref(font_2d_glyph, p, p->glyphs_offset_) ;
+
+    for(
+        uint16_t i = 0
+    ;   i < p->groups_count_
+    ;   ++i
+    )
+    {
+        log_debug_u16(i) ;
+        dump_font_2d_group(&fg[i]) ;
+    }
+
+    for(
+        uint16_t i = 0
+    ;   i < p->glyphs_count_
+    ;   ++i
+    )
+    {
+        log_debug_u16(i) ;
+        dump_font_2d_glyph(&fl[i]) ;
+    }
+}
+
+
+static void
+dump_texture_2d_level(
+    texture_2d_level const * p
+)
+{
+    require(p) ;
+
+    log_debug_u32(p->offset_) ;
+    log_debug_u32(p->size_) ;
+    log_debug_u32(p->width_) ;
+    log_debug_u32(p->height_) ;
 }
 
+
+void
+dump_texture_2d(
+    texture_2d const * p
+)
+{
+    require(p) ;
+
+    log_debug_u16(p->tid_) ;
+    log_debug_u16(p->format_) ;
+    log_debug_u16(p->levels_count_) ;
+
+    log_debug_u32(p->width_) ;
+    log_debug_u32(p->height_) ;
+    log_debug_u32(p->levels_offset_) ;
+
+    texture_2d_level * tl = asset_ref(texture_2d_level, p, p->levels_offset_) ;
+
+    for(
+        uint16_t i = 0
+    ;   i < p->levels_count_
+    ;   ++i
+    )
+    {
+        log_debug_u16(i) ;
+        dump_texture_2d_level(&tl[i]) ;
+    }
+}
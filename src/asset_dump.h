@@ -2,6 +2,8 @@
 
 
 typedef struct sprite_2d sprite_2d ;
+typedef struct font_2d font_2d ;
+typedef struct texture_2d texture_2d ;
 
 
 void
@@ -9,3 +11,16 @@ dump_sprite_2d(
     sprite_2d const * p
 ) ;
 
+
+
+void
+dump_font_2d(
+    font_2d const * p
+) ;
+
+
+
+void
+dump_texture_2d(
+    texture_2d const * p
+) ;
@@ -0,0 +1,75 @@
+#include "asset_dump.h"
+#include "asset_font.h"
+#include "defines.h"
+#include "log.h"
+#include "app.h"
+#include "check.h"
+
+
+font_2d_ptr
+load_asset_font(
+    char const * const  fullname
+)
+{
+    require(fullname) ;
+    require(*fullname) ;
+
+    font_2d_ptr ptr = { 0 } ;
+
+    if(check(load_file((void **)&ptr.this_, &ptr.size_, fullname)))
+    {
+        require(0) ;
+        return ptr ;
+    }
+    require(ptr.size_) ;
+    require(ptr.this_) ;
+
+    font_2d * p = ptr.this_ ;
+
+    ptr.groups_ = asset_ref(font_2d_group, p, p->groups_offset_) ;
+    ptr.glyphs_ = asset_ref(font_2d_glyph, p, p->glyphs_offset_) ;
+
+    dump_font_2d(p) ;
+
+    return ptr ;
+}
+
+
+font_2d_glyph const *
+find_font_glyph(
+    font_2d_ptr const * p
+,   uint16_t const      group_index
+,   uint32_t const      codepoint
+)
+{
+    require(p) ;
+    require(p->this_) ;
+    require(group_index < p->this_->groups_count_) ;
+
+    font_2d_group const * g = &p->groups_[group_index] ;
+    font_2d_glyph const * glyphs = &p->glyphs_[g->glyph_start_] ;
+
+    // glyphs are sorted by codepoint within a group.
+    uint32_t lo = 0 ;
+    uint32_t hi = g->glyph_count_ ;
+
+    for( ; lo < hi ; )
+    {
+        uint32_t const mid = lo + (hi - lo) / 2 ;
+        if(glyphs[mid].codepoint_ < codepoint)
+        {
+            lo = mid + 1 ;
+        }
+        else
+        {
+            hi = mid ;
+        }
+    }
+
+    if(lo < g->glyph_count_ && glyphs[lo].codepoint_ == codepoint)
+    {
+        return &glyphs[lo] ;
+    }
+
+    return NULL ;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+
+#include "types.h"
+
+
+typedef struct font_2d_glyph
+{
+    uint32_t    codepoint_ ;
+    uint16_t    texture_index_ ;
+    uint16_t    group_index_ ;
+    float       advance_ ;
+    float       offset_x_ ;
+    float       offset_y_ ;
+    float       w_ ;
+    float       h_ ;
+    float       u0_ ;
+    float       v0_ ;
+    float       u1_ ;
+    float       v1_ ;
+    uint32_t    pad_ ;
+} font_2d_glyph ;
+
+
+typedef struct font_2d_group
+{
+    uint16_t    font_size_ ;
+    uint16_t    glyph_start_ ;
+    uint16_t    glyph_count_ ;
+    uint16_t    pad_ ;
+    float       line_height_ ;
+    float       ascender_ ;
+    float       space_advance_ ;
+    float       pad2_ ;
+} font_2d_group ;
+
+
+typedef struct font_2d
+{
+    uint16_t            tid_ ;
+    uint16_t            groups_count_ ;
+    uint16_t            glyphs_count_ ;
+    uint16_t            textures_count_ ;
+
+    uint32_t            groups_offset_ ;
+    uint32_t            glyphs_offset_ ;
+
+    //font_2d_group     groups_[] ;
+    //font_2d_glyph     glyphs_[] ;
+} font_2d ;
+
+
+typedef struct font_2d_ptr
+{
+    uint64_t            size_ ;
+    font_2d *           this_ ;
+    font_2d_group *     groups_ ;
+    font_2d_glyph *     glyphs_ ;
+} font_2d_ptr ;
+
+
+
+font_2d_ptr
+load_asset_font(
+    char const * const  fullname
+) ;
+
+
+font_2d_glyph const *
+find_font_glyph(
+    font_2d_ptr const * p
+,   uint16_t const      group_index
+,   uint32_t const      codepoint
+) ;
@@ -29,6 +29,8 @@ load_asset_sprite(
     ptr.groups_   = asset_ref(rect_2d_group,    p, p->groups_offset_) ;
     ptr.vertices_ = asset_ref(rect_2d_vertices, p, p->vertices_offset_) ;
     ptr.infos_    = asset_ref(rect_2d_info,     p, p->infos_offset_) ;
+    ptr.hulls_    = p->hulls_offset_ ? asset_ref(rect_2d_hull, p, p->hulls_offset_) : NULL ;
+    ptr.timings_  = p->timings_offset_ ? asset_ref(rect_2d_timing, p, p->timings_offset_) : NULL ;
 
     dump_sprite_2d(p) ;
 
@@ -63,26 +63,61 @@ typedef struct rect_2d_bounding_info
 } rect_2d_bounding_info ;
 
 
+// every texel of the frame has full alpha, nothing behind it shows through.
+#define rect_2d_info_flag_opaque    0x0001
+
+
 typedef struct rect_2d_info
 {
     uint16_t                texture_index_ ;
     uint16_t                group_index_ ;
-    uint16_t                pad1_ ;
+    uint16_t                flags_ ;
     uint16_t                pad2_ ;
     rect_2d_bounding_info   bounding_info_ ;
 } rect_2d_info ;
 
 
+// how a group's frames are played, see sprite_animation.h.
+#define rect_2d_playback_loop       0
+#define rect_2d_playback_ping_pong  1
+#define rect_2d_playback_once       2
+
+
 typedef struct rect_2d_group
 {
     uint16_t                frame_start_ ;
     uint16_t                frame_count_ ;
-    uint16_t                pad1_ ;
-    uint16_t                pad2_ ;
+    uint16_t                playback_ ;
+    // how long playing this group blends out of the previous one.
+    uint16_t                blend_ms_ ;
     rect_2d_bounding_info   bounding_info_ ;
 } rect_2d_group ;
 
 
+// How long a frame is shown and the event raised when it starts, 0 for none.
+typedef struct rect_2d_timing
+{
+    uint16_t    duration_ms_ ;
+    uint16_t    event_ ;
+} rect_2d_timing ;
+
+
+#define max_rect_2d_hull_vertices   8
+
+
+// A convex polygon around the visible texels of a frame, drawn instead of
+// the quad. s runs from p0 to p1 and t from p0 to p3 of rect_2d_vertices,
+// both in [0, 65535]. Unused vertices repeat the last one.
+typedef struct rect_2d_hull
+{
+    uint16_t    st_[max_rect_2d_hull_vertices][2] ;
+} rect_2d_hull ;
+
+
+// the pngs and .tex files next to the .sprf hold premultiplied alpha.
+#define sprite_2d_flag_premultiplied_alpha  0x0001
+
+
 typedef struct sprite_2d
 {
     uint16_t            tid_ ;
@@ -93,10 +128,17 @@ typedef struct sprite_2d
     uint32_t            groups_offset_ ;
     uint32_t            vertices_offset_ ;
     uint32_t            infos_offset_ ;
+    // 0 when there are no hulls, one per vertices otherwise.
+    uint32_t            hulls_offset_ ;
+    uint32_t            flags_ ;
+    // 0 when there are no timings, one per infos otherwise.
+    uint32_t            timings_offset_ ;
 
     //sprite_2d_groups  groups_[] ;
     //rect_2d_vertices  vertices_[] ;
     //sprite_2d_info    infos_[] ;
+    //rect_2d_hull      hulls_[] ;
+    //rect_2d_timing    timings_[] ;
 } sprite_2d ;
 
 
@@ -107,6 +149,8 @@ typedef struct sprite_2d_ptr
     rect_2d_group *     groups_ ;
     rect_2d_vertices *  vertices_ ;
     rect_2d_info *      infos_ ;
+    rect_2d_hull *      hulls_ ;
+    rect_2d_timing *    timings_ ;
 } sprite_2d_ptr ;
 
 
@@ -0,0 +1,232 @@
+#include "asset_dump.h"
+#include "asset_texture.h"
+#include "defines.h"
+#include "log.h"
+#include "app.h"
+#include "check.h"
+#include "debug.h"
+
+
+// pymod/asset_tid.py atid_texture.
+#define texture_2d_tid  0x0300
+
+
+static uint64_t
+calc_texture_2d_level_size(
+    uint16_t const  format
+,   uint32_t const  w
+,   uint32_t const  h
+)
+{
+    if(texture_2d_format_bc3 == format)
+    {
+        return (((uint64_t) w + 3) / 4) * (((uint64_t) h + 3) / 4) * 16 ;
+    }
+    return (uint64_t) w * h * 4 ;
+}
+
+
+// every level has to be the next one of the chain, in the file and as big
+// as its format and size say, nothing reads past it then.
+static bool
+are_texture_2d_levels_valid(
+    texture_2d const *          p
+,   texture_2d_level const *    levels
+,   uint64_t const              file_size
+)
+{
+    require(p) ;
+    require(levels) ;
+
+    uint32_t lw = p->width_ ;
+    uint32_t lh = p->height_ ;
+
+    for(
+        uint32_t i = 0
+    ;   i < p->levels_count_
+    ;   ++i
+    )
+    {
+        texture_2d_level const * l = &levels[i] ;
+        if(
+            l->width_ != lw
+        ||  l->height_ != lh
+        ||  l->size_ != calc_texture_2d_level_size(p->format_, lw, lh)
+        ||  (uint64_t) l->offset_ + l->size_ > file_size
+        )
+        {
+            log_error("texture level %u is broken.", i) ;
+            return false ;
+        }
+
+        lw = lw > 1 ? lw / 2 : 1 ;
+        lh = lh > 1 ? lh / 2 : 1 ;
+    }
+
+    return true ;
+}
+
+
+texture_2d_ptr
+load_asset_texture(
+    char const * const  fullname
+)
+{
+    require(fullname) ;
+    require(*fullname) ;
+
+    texture_2d_ptr ptr = { 0 } ;
+
+    if(check(load_file((void **)&ptr.this_, &ptr.size_, fullname)))
+    {
+        require(0) ;
+        return ptr ;
+    }
+    require(ptr.size_) ;
+    require(ptr.this_) ;
+
+    texture_2d * p = ptr.this_ ;
+
+    if(check(
+            ptr.size_ >= sizeof(texture_2d)
+        &&  texture_2d_tid == p->tid_
+        &&  (texture_2d_format_rgba8 == p->format_ || texture_2d_format_bc3 == p->format_)
+        &&  p->width_ > 0
+        &&  p->height_ > 0
+        &&  p->levels_count_ > 0
+        &&  p->levels_count_ <= max_texture_2d_levels
+        &&  p->levels_offset_ + sizeof(texture_2d_level) * p->levels_count_ <= ptr.size_
+        &&  are_texture_2d_levels_valid(p, asset_ref(texture_2d_level, p, p->levels_offset_), ptr.size_)
+        )
+    )
+    {
+        free_memory(ptr.this_) ;
+        ptr = (texture_2d_ptr) { 0 } ;
+        return ptr ;
+    }
+
+    ptr.levels_ = asset_ref(texture_2d_level, p, p->levels_offset_) ;
+
+    dump_texture_2d(p) ;
+
+    return ptr ;
+}
+
+
+static void
+decode_bc3_block(
+    uint8_t *       out_pixels
+,   uint32_t const  stride
+,   uint32_t const  w
+,   uint32_t const  h
+,   uint8_t const * block
+)
+{
+    uint8_t alpha[8] = { 0 } ;
+    alpha[0] = block[0] ;
+    alpha[1] = block[1] ;
+    if(alpha[0] > alpha[1])
+    {
+        for(uint32_t i = 1 ; i < 7 ; ++i)
+        {
+            alpha[i + 1] = (uint8_t) (((7 - i) * alpha[0] + i * alpha[1]) / 7) ;
+        }
+    }
+    else
+    {
+        for(uint32_t i = 1 ; i < 5 ; ++i)
+        {
+            alpha[i + 1] = (uint8_t) (((5 - i) * alpha[0] + i * alpha[1]) / 5) ;
+        }
+        alpha[6] = 0 ;
+        alpha[7] = 255 ;
+    }
+
+    uint64_t alpha_bits = 0 ;
+    for(uint32_t i = 0 ; i < 6 ; ++i)
+    {
+        alpha_bits |= (uint64_t) block[2 + i] << (8 * i) ;
+    }
+
+    uint8_t color[4][3] = { 0 } ;
+    for(uint32_t i = 0 ; i < 2 ; ++i)
+    {
+        uint32_t const c = block[8 + i * 2] | (block[9 + i * 2] << 8) ;
+        color[i][0] = (uint8_t) ((((c >> 11) & 0x1f) * 255 + 15) / 31) ;
+        color[i][1] = (uint8_t) ((((c >>  5) & 0x3f) * 255 + 31) / 63) ;
+        color[i][2] = (uint8_t) ((((c >>  0) & 0x1f) * 255 + 15) / 31) ;
+    }
+    // bc3 colors always use the four color mode.
+    for(uint32_t k = 0 ; k < 3 ; ++k)
+    {
+        color[2][k] = (uint8_t) ((2 * color[0][k] + color[1][k]) / 3) ;
+        color[3][k] = (uint8_t) ((color[0][k] + 2 * color[1][k]) / 3) ;
+    }
+
+    uint32_t const color_bits =
+        block[12]
+    |   (block[13] << 8)
+    |   (block[14] << 16)
+    |   ((uint32_t) block[15] << 24) ;
+
+    for(
+        uint32_t y = 0
+    ;   y < h
+    ;   ++y
+    )
+    {
+        for(uint32_t x = 0 ; x < w ; ++x)
+        {
+            uint32_t const  i   = y * 4 + x ;
+            uint8_t const * c   = color[(color_bits >> (2 * i)) & 3] ;
+            uint8_t *       d   = out_pixels + y * stride + x * 4 ;
+            d[0] = c[0] ;
+            d[1] = c[1] ;
+            d[2] = c[2] ;
+            d[3] = alpha[(alpha_bits >> (3 * i)) & 7] ;
+        }
+    }
+}
+
+
+void
+decode_texture_2d_bc3(
+    uint8_t *                   out_pixels
+,   texture_2d const *          p
+,   texture_2d_level const *    level
+)
+{
+    require(out_pixels) ;
+    require(p) ;
+    require(level) ;
+    require(texture_2d_format_bc3 == p->format_) ;
+    begin_timed_block() ;
+
+    uint32_t const  blocks_x    = (level->width_ + 3) / 4 ;
+    uint32_t const  blocks_y    = (level->height_ + 3) / 4 ;
+    uint32_t const  stride      = level->width_ * 4 ;
+    uint8_t const * blocks      = asset_ref(uint8_t const, p, level->offset_) ;
+    require(blocks_x * blocks_y * 16 == level->size_) ;
+
+    for(
+        uint32_t by = 0
+    ;   by < blocks_y
+    ;   ++by
+    )
+    {
+        for(uint32_t bx = 0 ; bx < blocks_x ; ++bx)
+        {
+            uint32_t const w = level->width_  - bx * 4 < 4 ? level->width_  - bx * 4 : 4 ;
+            uint32_t const h = level->height_ - by * 4 < 4 ? level->height_ - by * 4 : 4 ;
+            decode_bc3_block(
+                out_pixels + by * 4 * stride + bx * 4 * 4
+            ,   stride
+            ,   w
+            ,   h
+            ,   &blocks[(by * blocks_x + bx) * 16]
+            ) ;
+        }
+    }
+
+    end_timed_block() ;
+}
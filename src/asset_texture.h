@@ -0,0 +1,63 @@
+#pragma once
+
+
+#include "types.h"
+
+
+// texture_2d_level data is 16 byte aligned and tightly packed, bc3 levels
+// hold whole 4x4 blocks, rows of blocks top to bottom.
+#define texture_2d_format_rgba8     1
+#define texture_2d_format_bc3       2
+
+#define max_texture_2d_levels       16
+
+
+typedef struct texture_2d_level
+{
+    uint32_t    offset_ ;
+    uint32_t    size_ ;
+    uint32_t    width_ ;
+    uint32_t    height_ ;
+} texture_2d_level ;
+
+
+// Written by threed_atlas, the complete mip chain computed offline. Levels
+// are ordered from the largest to the smallest.
+typedef struct texture_2d
+{
+    uint16_t            tid_ ;
+    uint16_t            format_ ;
+    uint16_t            levels_count_ ;
+    uint16_t            pad1_ ;
+
+    uint32_t            width_ ;
+    uint32_t            height_ ;
+    uint32_t            levels_offset_ ;
+
+    //texture_2d_level  levels_[] ;
+} texture_2d ;
+
+
+typedef struct texture_2d_ptr
+{
+    uint64_t            size_ ;
+    texture_2d *        this_ ;
+    texture_2d_level *  levels_ ;
+} texture_2d_ptr ;
+
+
+
+texture_2d_ptr
+load_asset_texture(
+    char const * const  fullname
+) ;
+
+
+// For devices without bc3 support, out_pixels holds width_ * height_ * 4
+// bytes of rgba8.
+void
+decode_texture_2d_bc3(
+    uint8_t *                   out_pixels
+,   texture_2d const *          p
+,   texture_2d_level const *    level
+) ;
@@ -0,0 +1,2628 @@
+#include "types.h"
+#include "defines.h"
+#include "asset_sprite.h"
+#include "asset_texture.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_bits.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_timer.h>
+#include <SDL3/SDL_intrin.h>
+
+#include <stb/stb_image.h>
+#include <stb/stb_image_write.h>
+#include <stb/stb_dxt.h>
+
+
+// Native replacement for pymod/texture_atlas.py. Same inputs, same packing
+// decisions and the same .sprf bytes, apart from the hulls which only this
+// tool writes; the pngs hold the same pixels.
+//
+//  threed_atlas animation  <dst_dir> <src_dir> [<src_dir> ...]
+//  threed_atlas collection <dst_dir> <src_dir> [<src_dir> ...]
+//  threed_atlas texture    <dst_file> <src_file> [rgba8|bc3]
+//
+// Every src_dir is one group, its files sorted by name are the frames.
+// Next to every png an atlas gets a .tex with the bc3 compressed mip chain,
+// the texture mode does the same for a single image.
+
+
+// pymod/asset_tid.py atid_sprite and atid_texture.
+#define atlas_sprite_tid        0x0100
+#define atlas_texture_tid       0x0300
+
+#define max_atlas_path          1024
+#define atlas_border_left       1
+#define atlas_border_top        1
+#define atlas_border_right      0
+#define atlas_border_bottom     0
+#define atlas_frame_ms          33
+
+
+typedef struct atlas_rect
+{
+    int32_t x_ ;
+    int32_t y_ ;
+    int32_t w_ ;
+    int32_t h_ ;
+
+} atlas_rect ;
+
+
+typedef struct atlas_frame
+{
+    char        file_name_[max_atlas_path] ;
+    uint8_t *   pixels_ ;
+    int32_t     image_w_ ;
+    int32_t     image_h_ ;
+
+    int32_t     crop_l_ ;
+    int32_t     crop_t_ ;
+    int32_t     crop_r_ ;
+    int32_t     crop_b_ ;
+    int32_t     crop_w_ ;
+    int32_t     crop_h_ ;
+
+    int32_t     pack_w_ ;
+    int32_t     pack_h_ ;
+
+    uint32_t    local_index_ ;
+    uint32_t    group_index_ ;
+
+    // the animation's crop rect, all frames of a group share one origin.
+    bool        has_group_crop_ ;
+    int32_t     group_crop_l_ ;
+    int32_t     group_crop_t_ ;
+
+    atlas_rect  packed_ ;
+    uint32_t    packed_bin_ ;
+    bool        rotated_ ;
+
+    float       pos_[4][2] ;
+    float       uv_[4][2] ;
+
+    rect_2d_hull    hull_ ;
+    uint32_t        hull_count_ ;
+    double          hull_area_ ;
+    bool            opaque_ ;
+
+    uint16_t        duration_ms_ ;
+    uint16_t        event_ ;
+
+} atlas_frame ;
+
+
+// what <src_dir>.anim says about the whole group.
+typedef struct atlas_group
+{
+    uint16_t    playback_ ;
+    uint16_t    blend_ms_ ;
+
+} atlas_group ;
+
+
+typedef struct atlas_placement
+{
+    uint32_t    frame_ ;
+    uint32_t    bin_ ;
+    atlas_rect  rect_ ;
+
+} atlas_placement ;
+
+
+// rectpack's offline packer with PackingBin.Global and MaxRectsBl, which is
+// what pymod/binpack.py uses. One bin is open at a time, it takes the first
+// remaining rect which fits anywhere until none does.
+typedef struct atlas_packer
+{
+    atlas_rect *        free_ ;
+    uint32_t            free_count_ ;
+    uint32_t            free_capacity_ ;
+    atlas_rect *        scratch_ ;
+    uint32_t            scratch_capacity_ ;
+    uint8_t *           contained_ ;
+    uint32_t            contained_capacity_ ;
+
+    bool *              packed_ ;
+    atlas_placement *   placements_ ;
+    atlas_placement *   best_placements_ ;
+    uint32_t            placements_count_ ;
+    uint32_t            bins_count_ ;
+
+} atlas_packer ;
+
+
+typedef struct atlas
+{
+    atlas_frame *   frames_ ;
+    uint32_t        frames_count_ ;
+    atlas_group *   groups_ ;
+    uint32_t        groups_count_ ;
+    uint32_t        groups_capacity_ ;
+    bool            create_animation_ ;
+    bool            premultiplied_alpha_ ;
+
+    atlas_packer    packer_ ;
+    int32_t         bin_w_ ;
+    int32_t         bin_h_ ;
+
+} atlas ;
+
+
+typedef struct atlas_writer
+{
+    uint8_t *   data_ ;
+    size_t      size_ ;
+    size_t      capacity_ ;
+
+} atlas_writer ;
+
+
+static bool
+write_texture(
+    char const *    file_name
+,   uint8_t const * pixels
+,   uint32_t const  width
+,   uint32_t const  height
+,   uint16_t const  format
+,   bool const      premultiplied_alpha
+) ;
+
+
+static void
+premultiply_alpha(
+    uint8_t *       pixels
+,   uint32_t const  count
+) ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static bool
+grow_array(
+    void **         array
+,   uint32_t *      capacity
+,   uint32_t const  needed
+,   size_t const    element_size
+)
+{
+    if(needed <= *capacity)
+    {
+        return true ;
+    }
+
+    uint32_t c = *capacity ? *capacity : 16 ;
+    while(c < needed)
+    {
+        c *= 2 ;
+    }
+
+    void * p = SDL_realloc(*array, c * element_size) ;
+    if(!p)
+    {
+        SDL_Log("out of memory growing to %u elements.", c) ;
+        return false ;
+    }
+
+    *array      = p ;
+    *capacity   = c ;
+    return true ;
+}
+
+
+static int
+compare_names(
+    void const *    a
+,   void const *    b
+)
+{
+    return SDL_strcmp(*(char const * const *) a, *(char const * const *) b) ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+// Scans one row for the first and the last pixel with alpha != 0, four
+// pixels at a time. Returns false for a fully transparent row.
+static bool
+find_row_alpha_span(
+    uint32_t const *    row
+,   int32_t const       w
+,   int32_t *           out_first
+,   int32_t *           out_last
+)
+{
+    int32_t first   = -1 ;
+    int32_t x       = 0 ;
+
+#ifdef SDL_SSE2_INTRINSICS
+    __m128i const alpha_mask    = _mm_set1_epi32((int) 0xFF000000) ;
+    __m128i const zero          = _mm_setzero_si128() ;
+
+    for( ; x + 4 <= w ; x += 4)
+    {
+        __m128i const p = _mm_and_si128(_mm_loadu_si128((__m128i const *) &row[x]), alpha_mask) ;
+        int const m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(p, zero))) ^ 0xF ;
+        if(m)
+        {
+            first = x + SDL_MostSignificantBitIndex32((uint32_t) (m & -m)) ;
+            break ;
+        }
+    }
+#endif
+
+    if(first < 0)
+    {
+        for( ; x < w ; ++x)
+        {
+            if(row[x] & 0xFF000000)
+            {
+                first = x ;
+                break ;
+            }
+        }
+    }
+
+    if(first < 0)
+    {
+        return false ;
+    }
+
+    // a visible pixel exists, so walking back from the end stops at first.
+    int32_t last = w - 1 ;
+
+#ifdef SDL_SSE2_INTRINSICS
+    for( ; last - 3 > first ; last -= 4)
+    {
+        __m128i const p = _mm_and_si128(_mm_loadu_si128((__m128i const *) &row[last - 3]), alpha_mask) ;
+        int const m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(p, zero))) ^ 0xF ;
+        if(m)
+        {
+            last = last - 3 + SDL_MostSignificantBitIndex32((uint32_t) m) ;
+            *out_first  = first ;
+            *out_last   = last ;
+            return true ;
+        }
+    }
+#endif
+
+    while(!(row[last] & 0xFF000000))
+    {
+        --last ;
+    }
+
+    *out_first  = first ;
+    *out_last   = last ;
+    return true ;
+}
+
+
+static bool
+find_crop_rect(
+    atlas_frame *   f
+)
+{
+    require(f) ;
+    require(f->pixels_) ;
+
+    int32_t min_x = f->image_w_ + 1 ;
+    int32_t min_y = f->image_h_ + 1 ;
+    int32_t max_x = -1 ;
+    int32_t max_y = -1 ;
+
+    for(
+        int32_t y = 0
+    ;   y < f->image_h_
+    ;   ++y
+    )
+    {
+        uint32_t const * row = (uint32_t const *) (f->pixels_ + (size_t) y * f->image_w_ * 4) ;
+
+        int32_t first   = 0 ;
+        int32_t last    = 0 ;
+        if(!find_row_alpha_span(row, f->image_w_, &first, &last))
+        {
+            continue ;
+        }
+
+        min_x = first < min_x ? first : min_x ;
+        max_x = last > max_x ? last : max_x ;
+        min_y = y < min_y ? y : min_y ;
+        max_y = y ;
+    }
+
+    if(max_x < 0)
+    {
+        SDL_Log("%s has no visible pixels.", f->file_name_) ;
+        return false ;
+    }
+
+    f->crop_l_  = min_x ;
+    f->crop_t_  = min_y ;
+    f->crop_r_  = max_x ;
+    f->crop_b_  = max_y ;
+    f->crop_w_  = 1 + max_x - min_x ;
+    f->crop_h_  = 1 + max_y - min_y ;
+    f->pack_w_  = f->crop_w_ + atlas_border_left + atlas_border_right ;
+    f->pack_h_  = f->crop_h_ + atlas_border_top + atlas_border_bottom ;
+
+    return true ;
+}
+
+
+static bool
+load_frame(
+    atlas_frame *   f
+)
+{
+    require(f) ;
+
+    int w = 0 ;
+    int h = 0 ;
+    int c = 0 ;
+    f->pixels_ = stbi_load(f->file_name_, &w, &h, &c, 4) ;
+    if(!f->pixels_)
+    {
+        SDL_Log("loading %s failed: %s", f->file_name_, stbi_failure_reason()) ;
+        return false ;
+    }
+
+    // the python pipeline only takes RGBA images as well.
+    if(4 != c)
+    {
+        SDL_Log("%s has %d channels, RGBA is required.", f->file_name_, c) ;
+        return false ;
+    }
+
+    f->image_w_ = w ;
+    f->image_h_ = h ;
+
+    return find_crop_rect(f) ;
+}
+
+
+static bool
+parse_anim_line(
+    atlas_group *   g
+,   atlas_frame *   frames
+,   uint32_t const  frames_count
+,   char const *    line
+)
+{
+    char        word[16]    = { 0 } ;
+    uint32_t    a           = 0 ;
+    uint32_t    b           = 0 ;
+
+    if(1 == SDL_sscanf(line, "playback %15s", word))
+    {
+        if(0 == SDL_strcmp(word, "loop"))
+        {
+            g->playback_ = rect_2d_playback_loop ;
+        }
+        else if(0 == SDL_strcmp(word, "ping_pong"))
+        {
+            g->playback_ = rect_2d_playback_ping_pong ;
+        }
+        else if(0 == SDL_strcmp(word, "once"))
+        {
+            g->playback_ = rect_2d_playback_once ;
+        }
+        else
+        {
+            return false ;
+        }
+        return true ;
+    }
+
+    if(1 == SDL_sscanf(line, "blend %u", &a))
+    {
+        g->blend_ms_ = (uint16_t) SDL_min(a, UINT16_MAX) ;
+        return true ;
+    }
+
+    if(1 == SDL_sscanf(line, "duration %u", &a) && a > 0)
+    {
+        for(uint32_t i = 0 ; i < frames_count ; ++i)
+        {
+            frames[i].duration_ms_ = (uint16_t) SDL_min(a, UINT16_MAX) ;
+        }
+        return true ;
+    }
+
+    if(2 == SDL_sscanf(line, "frame %u %u", &a, &b) && a < frames_count && b > 0)
+    {
+        frames[a].duration_ms_ = (uint16_t) SDL_min(b, UINT16_MAX) ;
+        return true ;
+    }
+
+    if(2 == SDL_sscanf(line, "event %u %u", &a, &b) && a < frames_count)
+    {
+        frames[a].event_ = (uint16_t) SDL_min(b, UINT16_MAX) ;
+        return true ;
+    }
+
+    return false ;
+}
+
+
+// The optional <src_dir>.anim next to the frames, one setting per line and
+// later lines win. Frames are counted from 0 in file name order:
+//   playback loop|ping_pong|once
+//   blend <ms>             blending out of the group played before
+//   duration <ms>          every frame
+//   frame <index> <ms>     one frame
+//   event <index> <id>     raised when the frame starts
+// Without it a group loops, every frame shown for atlas_frame_ms.
+static bool
+load_group_animation(
+    atlas_group *   g
+,   atlas_frame *   frames
+,   uint32_t const  frames_count
+,   char const *    src_dir
+)
+{
+    char name[max_atlas_path] = { 0 } ;
+    SDL_snprintf(name, sizeof(name), "%s.anim", src_dir) ;
+
+    SDL_PathInfo info = { 0 } ;
+    if(!SDL_GetPathInfo(name, &info))
+    {
+        return true ;
+    }
+
+    size_t  size = 0 ;
+    char *  text = SDL_LoadFile(name, &size) ;
+    if(!text)
+    {
+        SDL_Log("loading %s failed: %s", name, SDL_GetError()) ;
+        return false ;
+    }
+
+    bool        result  = true ;
+    uint32_t    line_no = 0 ;
+    char *      next    = text ;
+
+    while(*next && result)
+    {
+        char * line = next ;
+        char * end  = SDL_strchr(line, '\n') ;
+        next = end ? end + 1 : line + SDL_strlen(line) ;
+        if(end)
+        {
+            *end = 0 ;
+        }
+        ++line_no ;
+
+        char * comment = SDL_strchr(line, '#') ;
+        if(comment)
+        {
+            *comment = 0 ;
+        }
+
+        while(' ' == *line || '\t' == *line)
+        {
+            ++line ;
+        }
+
+        if(0 == *line || '\r' == *line)
+        {
+            continue ;
+        }
+
+        if(!parse_anim_line(g, frames, frames_count, line))
+        {
+            SDL_Log("%s:%u: can't use '%s'.", name, line_no, line) ;
+            result = false ;
+        }
+    }
+
+    SDL_free(text) ;
+    return result ;
+}
+
+
+static bool
+add_group(
+    atlas *         at
+,   uint32_t *      frames_capacity
+,   char const *    src_dir
+)
+{
+    require(at) ;
+    require(src_dir) ;
+
+    SDL_PathInfo info = { 0 } ;
+    if(!SDL_GetPathInfo(src_dir, &info) || SDL_PATHTYPE_DIRECTORY != info.type)
+    {
+        SDL_Log("%s is not a directory.", src_dir) ;
+        return false ;
+    }
+
+    int names_count = 0 ;
+    char ** names = SDL_GlobDirectory(src_dir, NULL, 0, &names_count) ;
+    if(!names)
+    {
+        SDL_Log("listing %s failed: %s", src_dir, SDL_GetError()) ;
+        return false ;
+    }
+
+    SDL_qsort(names, (size_t) names_count, sizeof(char *), compare_names) ;
+
+    if(!grow_array((void **) &at->groups_, &at->groups_capacity_, at->groups_count_ + 1, sizeof(atlas_group)))
+    {
+        SDL_free(names) ;
+        return false ;
+    }
+
+    uint32_t const  group_index = at->groups_count_++ ;
+    uint32_t const  first_frame = at->frames_count_ ;
+    uint32_t        local_index = 0 ;
+    bool            result      = true ;
+
+    SDL_memset(&at->groups_[group_index], 0, sizeof(atlas_group)) ;
+
+    for(
+        int i = 0
+    ;   i < names_count && result
+    ;   ++i
+    )
+    {
+        if(!grow_array((void **) &at->frames_, frames_capacity, at->frames_count_ + 1, sizeof(atlas_frame)))
+        {
+            result = false ;
+            break ;
+        }
+
+        atlas_frame * f = &at->frames_[at->frames_count_] ;
+        SDL_memset(f, 0, sizeof(atlas_frame)) ;
+        SDL_snprintf(f->file_name_, sizeof(f->file_name_), "%s/%s", src_dir, names[i]) ;
+
+        if(!SDL_GetPathInfo(f->file_name_, &info) || SDL_PATHTYPE_FILE != info.type)
+        {
+            continue ;
+        }
+
+        f->local_index_ = local_index++ ;
+        f->group_index_ = group_index ;
+        f->duration_ms_ = atlas_frame_ms ;
+        ++at->frames_count_ ;
+
+        result = load_frame(f) ;
+    }
+
+    SDL_free(names) ;
+
+    if(result && 0 == local_index)
+    {
+        SDL_Log("%s has no frames.", src_dir) ;
+        return false ;
+    }
+
+    return result && load_group_animation(&at->groups_[group_index], &at->frames_[first_frame], local_index, src_dir) ;
+}
+
+
+static void
+set_group_crop_rects(
+    atlas * at
+)
+{
+    require(at) ;
+
+    for(
+        uint32_t g = 0
+    ;   g < at->groups_count_
+    ;   ++g
+    )
+    {
+        int32_t l = INT32_MAX ;
+        int32_t t = INT32_MAX ;
+
+        for(uint32_t i = 0 ; i < at->frames_count_ ; ++i)
+        {
+            atlas_frame const * f = &at->frames_[i] ;
+            if(f->group_index_ == g)
+            {
+                l = f->crop_l_ < l ? f->crop_l_ : l ;
+                t = f->crop_t_ < t ? f->crop_t_ : t ;
+            }
+        }
+
+        for(uint32_t i = 0 ; i < at->frames_count_ ; ++i)
+        {
+            atlas_frame * f = &at->frames_[i] ;
+            if(f->group_index_ == g)
+            {
+                f->has_group_crop_  = at->create_animation_ ;
+                f->group_crop_l_    = l ;
+                f->group_crop_t_    = t ;
+            }
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static bool
+is_rect_overlap(
+    atlas_rect const *  a
+,   atlas_rect const *  b
+)
+{
+    return
+        a->x_ < b->x_ + b->w_
+    &&  a->x_ + a->w_ > b->x_
+    &&  a->y_ < b->y_ + b->h_
+    &&  a->y_ + a->h_ > b->y_
+    ;
+}
+
+
+static bool
+is_rect_contained(
+    atlas_rect const *  outer
+,   atlas_rect const *  inner
+)
+{
+    return
+        inner->y_ >= outer->y_
+    &&  inner->x_ >= outer->x_
+    &&  inner->y_ + inner->h_ <= outer->y_ + outer->h_
+    &&  inner->x_ + inner->w_ <= outer->x_ + outer->w_
+    ;
+}
+
+
+static bool
+is_rect_equal(
+    atlas_rect const *  a
+,   atlas_rect const *  b
+)
+{
+    return a->x_ == b->x_ && a->y_ == b->y_ && a->w_ == b->w_ && a->h_ == b->h_ ;
+}
+
+
+static bool
+fits_size(
+    int32_t const   w
+,   int32_t const   h
+,   int32_t const   bin_w
+,   int32_t const   bin_h
+)
+{
+    return (w <= bin_w && h <= bin_h) || (h <= bin_w && w <= bin_h) ;
+}
+
+
+// MaxRectsBl: the lowest top edge wins, ties go to the first free rect and
+// the unrotated orientation.
+static bool
+select_position(
+    atlas_packer const *    ap
+,   int32_t const           w
+,   int32_t const           h
+,   atlas_rect *            out_rect
+)
+{
+    int64_t best = INT64_MAX ;
+
+    for(
+        uint32_t i = 0
+    ;   i < ap->free_count_
+    ;   ++i
+    )
+    {
+        atlas_rect const * m = &ap->free_[i] ;
+        if(w <= m->w_ && h <= m->h_ && (int64_t) m->y_ + h < best)
+        {
+            best = (int64_t) m->y_ + h ;
+            *out_rect = (atlas_rect) { m->x_, m->y_, w, h } ;
+        }
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < ap->free_count_
+    ;   ++i
+    )
+    {
+        atlas_rect const * m = &ap->free_[i] ;
+        if(h <= m->w_ && w <= m->h_ && (int64_t) m->y_ + w < best)
+        {
+            best = (int64_t) m->y_ + w ;
+            *out_rect = (atlas_rect) { m->x_, m->y_, h, w } ;
+        }
+    }
+
+    return best != INT64_MAX ;
+}
+
+
+static bool
+split_free_rects(
+    atlas_packer *      ap
+,   atlas_rect const *  r
+)
+{
+    // every free rect splits into at most four.
+    if(!grow_array((void **) &ap->scratch_, &ap->scratch_capacity_, ap->free_count_ * 4, sizeof(atlas_rect)))
+    {
+        return false ;
+    }
+
+    uint32_t count = 0 ;
+
+    for(
+        uint32_t i = 0
+    ;   i < ap->free_count_
+    ;   ++i
+    )
+    {
+        atlas_rect const m = ap->free_[i] ;
+        if(!is_rect_overlap(&m, r))
+        {
+            ap->scratch_[count++] = m ;
+            continue ;
+        }
+
+        if(r->x_ > m.x_)
+        {
+            ap->scratch_[count++] = (atlas_rect) { m.x_, m.y_, r->x_ - m.x_, m.h_ } ;
+        }
+        if(r->x_ + r->w_ < m.x_ + m.w_)
+        {
+            ap->scratch_[count++] = (atlas_rect) { r->x_ + r->w_, m.y_, m.x_ + m.w_ - (r->x_ + r->w_), m.h_ } ;
+        }
+        if(r->y_ + r->h_ < m.y_ + m.h_)
+        {
+            ap->scratch_[count++] = (atlas_rect) { m.x_, r->y_ + r->h_, m.w_, m.y_ + m.h_ - (r->y_ + r->h_) } ;
+        }
+        if(r->y_ > m.y_)
+        {
+            ap->scratch_[count++] = (atlas_rect) { m.x_, m.y_, m.w_, r->y_ - m.y_ } ;
+        }
+    }
+
+    atlas_rect * const  t   = ap->free_ ;
+    uint32_t const      tc  = ap->free_capacity_ ;
+    ap->free_               = ap->scratch_ ;
+    ap->free_capacity_      = ap->scratch_capacity_ ;
+    ap->free_count_         = count ;
+    ap->scratch_            = t ;
+    ap->scratch_capacity_   = tc ;
+
+    return true ;
+}
+
+
+// rectpack collects contained rects in a set, so a rect equal to a contained
+// one goes as well, duplicates remove each other.
+static bool
+remove_contained_free_rects(
+    atlas_packer *  ap
+)
+{
+    if(!grow_array((void **) &ap->contained_, &ap->contained_capacity_, ap->free_count_, sizeof(uint8_t)))
+    {
+        return false ;
+    }
+
+    uint8_t * c = ap->contained_ ;
+    SDL_memset(c, 0, ap->free_count_) ;
+
+    for(uint32_t i = 0 ; i < ap->free_count_ ; ++i)
+    {
+        for(uint32_t j = i + 1 ; j < ap->free_count_ ; ++j)
+        {
+            if(is_rect_contained(&ap->free_[i], &ap->free_[j]))
+            {
+                c[j] = 1 ;
+            }
+            else if(is_rect_contained(&ap->free_[j], &ap->free_[i]))
+            {
+                c[i] = 1 ;
+            }
+        }
+    }
+
+    for(uint32_t i = 0 ; i < ap->free_count_ ; ++i)
+    {
+        if(1 != c[i])
+        {
+            continue ;
+        }
+        for(uint32_t j = 0 ; j < ap->free_count_ ; ++j)
+        {
+            if(!c[j] && is_rect_equal(&ap->free_[i], &ap->free_[j]))
+            {
+                c[j] = 2 ;
+            }
+        }
+    }
+
+    uint32_t count = 0 ;
+    for(uint32_t i = 0 ; i < ap->free_count_ ; ++i)
+    {
+        if(!c[i])
+        {
+            ap->free_[count++] = ap->free_[i] ;
+        }
+    }
+    ap->free_count_ = count ;
+
+    return true ;
+}
+
+
+static bool
+pack_max_rects(
+    atlas *         at
+,   int32_t const   bin_w
+,   int32_t const   bin_h
+)
+{
+    require(at) ;
+    atlas_packer * ap = &at->packer_ ;
+
+    SDL_memset(ap->packed_, 0, sizeof(bool) * at->frames_count_) ;
+    ap->placements_count_   = 0 ;
+    ap->bins_count_         = 0 ;
+
+    uint32_t remaining = at->frames_count_ ;
+
+    while(remaining)
+    {
+        // a new bin only opens when at least one remaining rect fits it.
+        bool any_fits = false ;
+        for(uint32_t i = 0 ; i < at->frames_count_ && !any_fits ; ++i)
+        {
+            any_fits = !ap->packed_[i] && fits_size(at->frames_[i].pack_w_, at->frames_[i].pack_h_, bin_w, bin_h) ;
+        }
+        if(!any_fits)
+        {
+            return false ;
+        }
+
+        uint32_t const bin = ap->bins_count_++ ;
+        ap->free_count_ = 1 ;
+        ap->free_[0]    = (atlas_rect) { 0, 0, bin_w, bin_h } ;
+
+        for(;;)
+        {
+            uint32_t    found   = UINT32_MAX ;
+            atlas_rect  r       = { 0 } ;
+
+            for(uint32_t i = 0 ; i < at->frames_count_ ; ++i)
+            {
+                if(!ap->packed_[i] && select_position(ap, at->frames_[i].pack_w_, at->frames_[i].pack_h_, &r))
+                {
+                    found = i ;
+                    break ;
+                }
+            }
+
+            if(UINT32_MAX == found)
+            {
+                break ;
+            }
+
+            ap->packed_[found] = true ;
+            --remaining ;
+
+            atlas_placement * p = &ap->placements_[ap->placements_count_++] ;
+            p->frame_   = found ;
+            p->bin_     = bin ;
+            p->rect_    = r ;
+
+            if(!split_free_rects(ap, &r) || !remove_contained_free_rects(ap))
+            {
+                return false ;
+            }
+        }
+    }
+
+    return true ;
+}
+
+
+// pymod/binpack.py calc_potential_bin_sizes with power_of_two.
+static uint32_t
+calc_potential_bin_sizes(
+    int32_t const   max_w
+,   int32_t const   max_h
+,   int32_t         out_sizes[][2]
+,   uint32_t const  max_sizes
+)
+{
+    int32_t mw = 1 ;
+    int32_t mh = 1 ;
+    while(mw < max_w)
+    {
+        mw <<= 1 ;
+    }
+    while(mh < max_h)
+    {
+        mh <<= 1 ;
+    }
+
+    int32_t nw = mw > mh ? mw : mh ;
+    int32_t nh = nw ;
+    uint32_t count = 0 ;
+
+    while(nw > 1)
+    {
+        require(count + 3 < max_sizes) ;
+        out_sizes[count][0] = nw ;
+        out_sizes[count][1] = nh ;
+        ++count ;
+        if(nh > 1)
+        {
+            nh >>= 1 ;
+        }
+        out_sizes[count][0] = nh ;
+        out_sizes[count][1] = nw ;
+        ++count ;
+        out_sizes[count][0] = nw ;
+        out_sizes[count][1] = nh ;
+        ++count ;
+        nw >>= 1 ;
+    }
+
+    require(count < max_sizes) ;
+    out_sizes[count][0] = 1 ;
+    out_sizes[count][1] = 1 ;
+    return count + 1 ;
+}
+
+
+// pymod/binpack.py do_pack with auto_bin_size and allow_shrinking. The bin
+// starts at the sum of all sizes and shrinks as long as everything goes into
+// one bin, one more size is tried after the first that needs more bins.
+// Sizes whose area is below the rects' total area need more bins for sure,
+// those are not packed at all.
+static bool
+pack_atlas(
+    atlas * at
+)
+{
+    require(at) ;
+    require(at->frames_count_) ;
+    atlas_packer * ap = &at->packer_ ;
+
+    if(
+        !grow_array((void **) &ap->free_, &ap->free_capacity_, 64, sizeof(atlas_rect))
+    ||  !(ap->packed_ = SDL_malloc(sizeof(bool) * at->frames_count_))
+    ||  !(ap->placements_ = SDL_malloc(sizeof(atlas_placement) * at->frames_count_))
+    ||  !(ap->best_placements_ = SDL_malloc(sizeof(atlas_placement) * at->frames_count_))
+    )
+    {
+        SDL_Log("out of memory.") ;
+        return false ;
+    }
+
+    int32_t total_w = 0 ;
+    int32_t total_h = 0 ;
+    int64_t total_a = 0 ;
+
+    for(
+        uint32_t i = 0
+    ;   i < at->frames_count_
+    ;   ++i
+    )
+    {
+        total_w += at->frames_[i].pack_w_ ;
+        total_h += at->frames_[i].pack_h_ ;
+        total_a += (int64_t) at->frames_[i].pack_w_ * at->frames_[i].pack_h_ ;
+    }
+
+    int32_t         sizes[96][2] = { { 0 } } ;
+    uint32_t const  sizes_count = calc_potential_bin_sizes(total_w, total_h, sizes, array_count(sizes)) ;
+
+    bool        have_best   = false ;
+    uint32_t    best_bins   = 0 ;
+    uint32_t    best_count  = 0 ;
+    bool        one_more    = true ;
+
+    at->bin_w_ = total_w ;
+    at->bin_h_ = total_h ;
+
+    for(
+        uint32_t s = 0
+    ;   s < sizes_count
+    ;   ++s
+    )
+    {
+        int32_t const bw = sizes[s][0] ;
+        int32_t const bh = sizes[s][1] ;
+
+        bool all_fit = true ;
+        for(uint32_t i = 0 ; i < at->frames_count_ && all_fit ; ++i)
+        {
+            all_fit = fits_size(at->frames_[i].pack_w_, at->frames_[i].pack_h_, bw, bh) ;
+        }
+        if(!all_fit)
+        {
+            break ;
+        }
+
+        bool const is_max = bw == total_w && bh == total_h ;
+
+        uint32_t bins_count = 2 ;
+        if(is_max || (int64_t) bw * bh >= total_a)
+        {
+            if(!pack_max_rects(at, bw, bh))
+            {
+                SDL_Log("packing into %d x %d failed.", bw, bh) ;
+                return false ;
+            }
+            bins_count = ap->bins_count_ ;
+        }
+
+        if(bins_count > 1 && is_max)
+        {
+            SDL_memcpy(ap->best_placements_, ap->placements_, sizeof(atlas_placement) * ap->placements_count_) ;
+            best_count  = ap->placements_count_ ;
+            best_bins   = bins_count ;
+            have_best   = true ;
+            at->bin_w_  = bw ;
+            at->bin_h_  = bh ;
+            break ;
+        }
+
+        if(1 == bins_count)
+        {
+            SDL_memcpy(ap->best_placements_, ap->placements_, sizeof(atlas_placement) * ap->placements_count_) ;
+            best_count  = ap->placements_count_ ;
+            best_bins   = bins_count ;
+            have_best   = true ;
+            at->bin_w_  = bw ;
+            at->bin_h_  = bh ;
+            continue ;
+        }
+
+        if(one_more)
+        {
+            one_more = false ;
+            continue ;
+        }
+        break ;
+    }
+
+    if(!have_best)
+    {
+        SDL_Log("nothing could be packed.") ;
+        return false ;
+    }
+
+    require(best_count == at->frames_count_) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < best_count
+    ;   ++i
+    )
+    {
+        atlas_placement const * p = &ap->best_placements_[i] ;
+        atlas_frame * f = &at->frames_[p->frame_] ;
+        f->packed_      = p->rect_ ;
+        f->packed_bin_  = p->bin_ ;
+        f->rotated_     =
+            f->pack_w_ != f->pack_h_
+        &&  f->pack_w_ == p->rect_.h_
+        &&  f->pack_h_ == p->rect_.w_
+        ;
+    }
+
+    ap->placements_count_   = best_count ;
+    ap->bins_count_         = best_bins ;
+
+    SDL_Log("packed %u rects in %u bins of [%d %d]", best_count, best_bins, at->bin_w_, at->bin_h_) ;
+    return true ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+// pymod/packrect.py calc_pos_uv.
+static void
+calc_pos_uv(
+    atlas const *   at
+,   atlas_frame *   f
+)
+{
+    int32_t px = 0 ;
+    int32_t py = 0 ;
+    int32_t pw = f->crop_w_ ;
+    int32_t ph = f->crop_h_ ;
+
+    if(f->has_group_crop_)
+    {
+        px = f->crop_l_ - f->group_crop_l_ ;
+        py = f->crop_t_ - f->group_crop_t_ ;
+    }
+
+    int32_t const pos[4][2] =
+    {
+        { px,       py      }
+    ,   { px + pw,  py      }
+    ,   { px + pw,  py + ph }
+    ,   { px,       py + ph }
+    } ;
+
+    int32_t tu = f->packed_.x_ + atlas_border_left ;
+    int32_t tv = f->packed_.y_ + atlas_border_top ;
+    int32_t tex[4][2] =
+    {
+        { tu,       tv      }
+    ,   { tu + pw,  tv      }
+    ,   { tu + pw,  tv + ph }
+    ,   { tu,       tv + ph }
+    } ;
+
+    if(f->rotated_)
+    {
+        tu = f->packed_.x_ + atlas_border_top ;
+        tv = f->packed_.y_ + atlas_border_left ;
+        int32_t const tw = ph ;
+        int32_t const th = pw ;
+        int32_t const rot[4][2] =
+        {
+            { tu + tw,  tv      }
+        ,   { tu + tw,  tv + th }
+        ,   { tu,       tv + th }
+        ,   { tu,       tv      }
+        } ;
+        SDL_memcpy(tex, rot, sizeof(tex)) ;
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < 4
+    ;   ++i
+    )
+    {
+        f->pos_[i][0]   = (float) pos[i][0] ;
+        f->pos_[i][1]   = (float) pos[i][1] ;
+        // python divides doubles and only rounds when packing the f32.
+        f->uv_[i][0]    = (float) ((double) tex[i][0] / (double) at->bin_w_) ;
+        f->uv_[i][1]    = (float) ((double) tex[i][1] / (double) at->bin_h_) ;
+    }
+}
+
+
+static void
+copy_frame(
+    atlas const *       at
+,   atlas_frame const * f
+,   uint8_t *           bin_pixels
+)
+{
+    size_t const    dst_pitch   = (size_t) at->bin_w_ * 4 ;
+    size_t const    src_pitch   = (size_t) f->image_w_ * 4 ;
+    uint8_t const * src         = f->pixels_ + (size_t) f->crop_t_ * src_pitch + (size_t) f->crop_l_ * 4 ;
+
+    if(!f->rotated_)
+    {
+        uint8_t * dst = bin_pixels
+            + (size_t) (f->packed_.y_ + atlas_border_top) * dst_pitch
+            + (size_t) (f->packed_.x_ + atlas_border_left) * 4 ;
+
+        for(
+            int32_t y = 0
+        ;   y < f->crop_h_
+        ;   ++y
+        )
+        {
+            SDL_memcpy(dst, src, (size_t) f->crop_w_ * 4) ;
+            dst += dst_pitch ;
+            src += src_pitch ;
+        }
+        return ;
+    }
+
+    // source row y becomes destination column crop_h_ - 1 - y.
+    uint32_t * dst = (uint32_t *) bin_pixels ;
+    int32_t const dx0 = f->packed_.x_ + atlas_border_top + f->crop_h_ - 1 ;
+    int32_t const dy0 = f->packed_.y_ + atlas_border_left ;
+
+    for(
+        int32_t y = 0
+    ;   y < f->crop_h_
+    ;   ++y
+    )
+    {
+        uint32_t const *    s = (uint32_t const *) src ;
+        uint32_t *          d = dst + (size_t) dy0 * at->bin_w_ + (dx0 - y) ;
+        for(int32_t x = 0 ; x < f->crop_w_ ; ++x)
+        {
+            *d = s[x] ;
+            d += at->bin_w_ ;
+        }
+        src += src_pitch ;
+    }
+}
+
+
+static bool
+write_bins(
+    atlas const *   at
+,   char const *    dst_dir
+,   char const *    base_name
+)
+{
+    size_t const    bin_size    = (size_t) at->bin_w_ * at->bin_h_ * 4 ;
+    uint8_t *       pixels      = SDL_malloc(bin_size) ;
+    if(!pixels)
+    {
+        SDL_Log("out of memory.") ;
+        return false ;
+    }
+
+    bool result = true ;
+
+    for(
+        uint32_t b = 0
+    ;   b < at->packer_.bins_count_ && result
+    ;   ++b
+    )
+    {
+        SDL_memset(pixels, 0, bin_size) ;
+
+        for(uint32_t i = 0 ; i < at->frames_count_ ; ++i)
+        {
+            if(at->frames_[i].packed_bin_ == b)
+            {
+                copy_frame(at, &at->frames_[i], pixels) ;
+            }
+        }
+
+        if(at->premultiplied_alpha_)
+        {
+            premultiply_alpha(pixels, (uint32_t) (at->bin_w_ * at->bin_h_)) ;
+        }
+
+        char name[max_atlas_path] = { 0 } ;
+        SDL_snprintf(name, sizeof(name), "%s/%s_%u.png", dst_dir, base_name, b) ;
+
+        if(!stbi_write_png(name, at->bin_w_, at->bin_h_, 4, pixels, at->bin_w_ * 4))
+        {
+            SDL_Log("writing %s failed.", name) ;
+            result = false ;
+        }
+
+        SDL_snprintf(name, sizeof(name), "%s/%s_%u.tex", dst_dir, base_name, b) ;
+
+        if(result && !write_texture(name, pixels, at->bin_w_, at->bin_h_, texture_2d_format_bc3, at->premultiplied_alpha_))
+        {
+            result = false ;
+        }
+    }
+
+    SDL_free(pixels) ;
+    return result ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+typedef struct atlas_point
+{
+    double  x_ ;
+    double  y_ ;
+
+} atlas_point ;
+
+
+typedef struct atlas_circle
+{
+    double  x_ ;
+    double  y_ ;
+    double  r2_ ;
+
+} atlas_circle ;
+
+
+static int
+compare_points(
+    void const *    a
+,   void const *    b
+)
+{
+    atlas_point const * p = (atlas_point const *) a ;
+    atlas_point const * q = (atlas_point const *) b ;
+    if(p->x_ != q->x_)
+    {
+        return p->x_ < q->x_ ? -1 : 1 ;
+    }
+    if(p->y_ != q->y_)
+    {
+        return p->y_ < q->y_ ? -1 : 1 ;
+    }
+    return 0 ;
+}
+
+
+static bool
+is_in_circle(
+    atlas_circle const *    c
+,   atlas_point const *     p
+)
+{
+    double const dx = p->x_ - c->x_ ;
+    double const dy = p->y_ - c->y_ ;
+    return dx * dx + dy * dy <= c->r2_ * (1.0 + 1e-12) ;
+}
+
+
+static atlas_circle
+make_circle_2(
+    atlas_point const * a
+,   atlas_point const * b
+)
+{
+    atlas_circle c = { 0 } ;
+    c.x_    = (a->x_ + b->x_) * 0.5 ;
+    c.y_    = (a->y_ + b->y_) * 0.5 ;
+    double const dx = a->x_ - b->x_ ;
+    double const dy = a->y_ - b->y_ ;
+    c.r2_   = (dx * dx + dy * dy) * 0.25 ;
+    return c ;
+}
+
+
+static atlas_circle
+make_circle_3(
+    atlas_point const * a
+,   atlas_point const * b
+,   atlas_point const * c
+)
+{
+    double const bx = b->x_ - a->x_ ;
+    double const by = b->y_ - a->y_ ;
+    double const cx = c->x_ - a->x_ ;
+    double const cy = c->y_ - a->y_ ;
+    double const d  = 2.0 * (bx * cy - by * cx) ;
+
+    if(0.0 == d)
+    {
+        // collinear, the two points furthest apart span the circle.
+        atlas_circle const ab = make_circle_2(a, b) ;
+        atlas_circle const ac = make_circle_2(a, c) ;
+        atlas_circle const bc = make_circle_2(b, c) ;
+        atlas_circle r = ab.r2_ > ac.r2_ ? ab : ac ;
+        return r.r2_ > bc.r2_ ? r : bc ;
+    }
+
+    double const b2 = bx * bx + by * by ;
+    double const c2 = cx * cx + cy * cy ;
+    double const ux = (cy * b2 - by * c2) / d ;
+    double const uy = (bx * c2 - cx * b2) / d ;
+
+    atlas_circle r = { 0 } ;
+    r.x_    = a->x_ + ux ;
+    r.y_    = a->y_ + uy ;
+    r.r2_   = ux * ux + uy * uy ;
+    return r ;
+}
+
+
+// Smallest enclosing circle, what miniball computes for pymod's
+// bounding_circle.py. Points are made unique first, like numpy.unique does.
+static atlas_circle
+calc_bounding_circle(
+    atlas_point *   points
+,   uint32_t        count
+)
+{
+    require(count) ;
+
+    SDL_qsort(points, count, sizeof(atlas_point), compare_points) ;
+
+    uint32_t n = 1 ;
+    for(uint32_t i = 1 ; i < count ; ++i)
+    {
+        if(compare_points(&points[n - 1], &points[i]))
+        {
+            points[n++] = points[i] ;
+        }
+    }
+
+    atlas_circle c = { points[0].x_, points[0].y_, 0.0 } ;
+
+    for(uint32_t i = 1 ; i < n ; ++i)
+    {
+        if(is_in_circle(&c, &points[i]))
+        {
+            continue ;
+        }
+        c = (atlas_circle) { points[i].x_, points[i].y_, 0.0 } ;
+
+        for(uint32_t j = 0 ; j < i ; ++j)
+        {
+            if(is_in_circle(&c, &points[j]))
+            {
+                continue ;
+            }
+            c = make_circle_2(&points[i], &points[j]) ;
+
+            for(uint32_t k = 0 ; k < j ; ++k)
+            {
+                if(!is_in_circle(&c, &points[k]))
+                {
+                    c = make_circle_3(&points[i], &points[j], &points[k]) ;
+                }
+            }
+        }
+    }
+
+    return c ;
+}
+
+
+static void
+set_bounding_circle(
+    rect_2d_bounding_info * bi
+,   atlas_circle const *    c
+)
+{
+    // python's int() truncates.
+    bi->circle_offset_x_        = (uint32_t) c->x_ ;
+    bi->circle_offset_y_        = (uint32_t) c->y_ ;
+    bi->circle_radius_          = (uint32_t) SDL_sqrt(c->r2_) ;
+    bi->circle_radius_squared_  = (uint32_t) c->r2_ ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static double
+cross_points(
+    atlas_point const * o
+,   atlas_point const * a
+,   atlas_point const * b
+)
+{
+    return (a->x_ - o->x_) * (b->y_ - o->y_) - (a->y_ - o->y_) * (b->x_ - o->x_) ;
+}
+
+
+static double
+calc_polygon_area(
+    atlas_point const * p
+,   uint32_t const      n
+)
+{
+    double a = 0.0 ;
+    for(
+        uint32_t i = 0
+    ;   i < n
+    ;   ++i
+    )
+    {
+        atlas_point const * q = &p[(i + 1) % n] ;
+        a += p[i].x_ * q->y_ - q->x_ * p[i].y_ ;
+    }
+    return a * 0.5 ;
+}
+
+
+// Andrew's monotone chain, points must be sorted by x and y. Collinear
+// points are dropped, the hull winds like the quad p0, p1, p2.
+static uint32_t
+calc_convex_hull(
+    atlas_point *       out_hull
+,   atlas_point const * points
+,   uint32_t const      count
+)
+{
+    uint32_t n = 0 ;
+
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        while(n >= 2 && cross_points(&out_hull[n - 2], &out_hull[n - 1], &points[i]) <= 0.0)
+        {
+            --n ;
+        }
+        out_hull[n++] = points[i] ;
+    }
+
+    uint32_t const lower = n + 1 ;
+    for(
+        uint32_t i = count - 1
+    ;   i-- > 0
+    ;
+    )
+    {
+        while(n >= lower && cross_points(&out_hull[n - 2], &out_hull[n - 1], &points[i]) <= 0.0)
+        {
+            --n ;
+        }
+        out_hull[n++] = points[i] ;
+    }
+
+    return n > 1 ? n - 1 : n ;
+}
+
+
+// Drops the edge whose removal adds the least area: its neighbours are
+// extended until they meet. The meeting point has to stay inside the quad,
+// outside of it the uvs would reach into the next frame of the atlas.
+static bool
+remove_hull_edge(
+    atlas_point *   hull
+,   uint32_t *      count
+,   double const    w
+,   double const    h
+)
+{
+    uint32_t const  n           = *count ;
+    uint32_t        best        = UINT32_MAX ;
+    double          best_area   = 0.0 ;
+    atlas_point     best_point  = { 0 } ;
+
+    for(
+        uint32_t i = 0
+    ;   i < n
+    ;   ++i
+    )
+    {
+        atlas_point const * a = &hull[(i + n - 1) % n] ;
+        atlas_point const * b = &hull[i] ;
+        atlas_point const * c = &hull[(i + 1) % n] ;
+        atlas_point const * d = &hull[(i + 2) % n] ;
+
+        double const    abx = b->x_ - a->x_ ;
+        double const    aby = b->y_ - a->y_ ;
+        double const    dcx = c->x_ - d->x_ ;
+        double const    dcy = c->y_ - d->y_ ;
+        double const    den = abx * dcy - aby * dcx ;
+        if(SDL_fabs(den) < 1e-12)
+        {
+            continue ;
+        }
+
+        // the lines only meet beyond the edge when they turn towards it.
+        double const t = ((d->x_ - a->x_) * dcy - (d->y_ - a->y_) * dcx) / den ;
+        double const u = ((d->x_ - a->x_) * aby - (d->y_ - a->y_) * abx) / den ;
+        if(t < 1.0 || u < 1.0)
+        {
+            continue ;
+        }
+
+        atlas_point const x = { a->x_ + abx * t, a->y_ + aby * t } ;
+        if(x.x_ < -1e-9 || x.y_ < -1e-9 || x.x_ > w + 1e-9 || x.y_ > h + 1e-9)
+        {
+            continue ;
+        }
+
+        double const area = SDL_fabs(cross_points(b, &x, c)) * 0.5 ;
+        if(UINT32_MAX == best || area < best_area)
+        {
+            best        = i ;
+            best_area   = area ;
+            best_point  = x ;
+        }
+    }
+
+    if(UINT32_MAX == best)
+    {
+        return false ;
+    }
+
+    hull[best] = best_point ;
+    uint32_t const r = (best + 1) % n ;
+    SDL_memmove(&hull[r], &hull[r + 1], sizeof(atlas_point) * (n - r - 1)) ;
+    *count = n - 1 ;
+    return true ;
+}
+
+
+// The polygon covers every texel with alpha != 0 plus one texel around it,
+// which is what bilinear filtering reads. Frames for which no polygon with
+// few enough vertices exists keep their quad.
+static bool
+calc_frame_hull(
+    atlas_frame *   f
+)
+{
+    double const    w       = (double) f->crop_w_ ;
+    double const    h       = (double) f->crop_h_ ;
+    atlas_point *   points  = SDL_malloc(sizeof(atlas_point) * 4 * (size_t) f->crop_h_) ;
+    atlas_point *   hull    = SDL_malloc(sizeof(atlas_point) * 8 * (size_t) f->crop_h_) ;
+
+    if(!points || !hull)
+    {
+        SDL_Log("out of memory.") ;
+        SDL_free(hull) ;
+        SDL_free(points) ;
+        return false ;
+    }
+
+    // per row the span's dilated corners, sorted by x then y for the hull.
+    uint32_t count = 0 ;
+    for(
+        int32_t y = 0
+    ;   y < f->crop_h_
+    ;   ++y
+    )
+    {
+        uint32_t const * row = (uint32_t const *) (f->pixels_ + ((size_t) (f->crop_t_ + y) * f->image_w_ + f->crop_l_) * 4) ;
+
+        int32_t first   = 0 ;
+        int32_t last    = 0 ;
+        if(!find_row_alpha_span(row, f->crop_w_, &first, &last))
+        {
+            continue ;
+        }
+
+        double const x0 = SDL_max(first - 1, 0) ;
+        double const x1 = SDL_min(last + 2, f->crop_w_) ;
+        double const y0 = SDL_max(y - 1, 0) ;
+        double const y1 = SDL_min(y + 2, f->crop_h_) ;
+
+        points[count++] = (atlas_point) { x0, y0 } ;
+        points[count++] = (atlas_point) { x0, y1 } ;
+        points[count++] = (atlas_point) { x1, y0 } ;
+        points[count++] = (atlas_point) { x1, y1 } ;
+    }
+    require(count) ;
+
+    SDL_qsort(points, count, sizeof(atlas_point), compare_points) ;
+
+    uint32_t n = calc_convex_hull(hull, points, count) ;
+
+    while(n > max_rect_2d_hull_vertices && remove_hull_edge(hull, &n, w, h))
+    {
+    }
+
+    static atlas_point const quad[4] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } } ;
+
+    f->hull_count_ = n ;
+    if(n < 3 || n > max_rect_2d_hull_vertices)
+    {
+        f->hull_count_ = 4 ;
+        for(uint32_t i = 0 ; i < 4 ; ++i)
+        {
+            hull[i] = (atlas_point) { quad[i].x_ * w, quad[i].y_ * h } ;
+        }
+    }
+
+    f->hull_area_ = calc_polygon_area(hull, f->hull_count_) ;
+    require(f->hull_area_ > 0.0) ;
+
+    // unused vertices repeat the last one, their triangles have no area.
+    for(
+        uint32_t i = 0
+    ;   i < max_rect_2d_hull_vertices
+    ;   ++i
+    )
+    {
+        atlas_point const * p = &hull[i < f->hull_count_ ? i : f->hull_count_ - 1] ;
+        double const s = SDL_clamp(p->x_ / w, 0.0, 1.0) ;
+        double const t = SDL_clamp(p->y_ / h, 0.0, 1.0) ;
+        f->hull_.st_[i][0] = (uint16_t) (s * 65535.0 + 0.5) ;
+        f->hull_.st_[i][1] = (uint16_t) (t * 65535.0 + 0.5) ;
+    }
+
+    SDL_free(hull) ;
+    SDL_free(points) ;
+    return true ;
+}
+
+
+// Opaque frames are drawn without blending and write depth, which needs
+// every texel of the crop rect at full alpha. Their polygon is the quad.
+static bool
+is_frame_opaque(
+    atlas_frame const * f
+)
+{
+    for(
+        int32_t y = 0
+    ;   y < f->crop_h_
+    ;   ++y
+    )
+    {
+        uint32_t const * row = (uint32_t const *) (f->pixels_ + ((size_t) (f->crop_t_ + y) * f->image_w_ + f->crop_l_) * 4) ;
+        for(int32_t x = 0 ; x < f->crop_w_ ; ++x)
+        {
+            if(0xFF000000 != (row[x] & 0xFF000000))
+            {
+                return false ;
+            }
+        }
+    }
+
+    return true ;
+}
+
+
+// Reports the fragments the polygons save, assuming every frame is drawn
+// once at its size.
+static bool
+calc_hulls(
+    atlas * at
+)
+{
+    double quads_area   = 0.0 ;
+    double hulls_area   = 0.0 ;
+    uint32_t quads      = 0 ;
+    uint32_t opaques    = 0 ;
+
+    for(
+        uint32_t i = 0
+    ;   i < at->frames_count_
+    ;   ++i
+    )
+    {
+        atlas_frame * f = &at->frames_[i] ;
+        if(!calc_frame_hull(f))
+        {
+            return false ;
+        }
+
+        quads_area += (double) f->crop_w_ * f->crop_h_ ;
+        hulls_area += f->hull_area_ ;
+        quads += f->hull_count_ == 4 ? 1 : 0 ;
+
+        f->opaque_ = is_frame_opaque(f) ;
+        opaques += f->opaque_ ? 1 : 0 ;
+    }
+
+    SDL_Log(
+        "hulls cover %.1f%% of the quads, %.1f%% fragments saved, %u of %u frames are quads."
+    ,   100.0 * hulls_area / quads_area
+    ,   100.0 - 100.0 * hulls_area / quads_area
+    ,   quads
+    ,   at->frames_count_
+    ) ;
+
+    SDL_Log("%u of %u frames are opaque.", opaques, at->frames_count_) ;
+
+    return true ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static bool
+write_bytes(
+    atlas_writer *  w
+,   void const *    p
+,   size_t const    n
+)
+{
+    if(w->size_ + n > w->capacity_)
+    {
+        size_t c = w->capacity_ ? w->capacity_ : 4096 ;
+        while(c < w->size_ + n)
+        {
+            c *= 2 ;
+        }
+        uint8_t * d = SDL_realloc(w->data_, c) ;
+        if(!d)
+        {
+            SDL_Log("out of memory.") ;
+            return false ;
+        }
+        w->data_        = d ;
+        w->capacity_    = c ;
+    }
+
+    SDL_memcpy(w->data_ + w->size_, p, n) ;
+    w->size_ += n ;
+    return true ;
+}
+
+
+// pymod/io.py align_fill, the padding bytes hold the padding length.
+static bool
+write_align(
+    atlas_writer *  w
+,   size_t const    a
+)
+{
+    size_t const n = ((w->size_ + a - 1) / a) * a - w->size_ ;
+    uint8_t const v = (uint8_t) n ;
+    for(size_t i = 0 ; i < n ; ++i)
+    {
+        if(!write_bytes(w, &v, 1))
+        {
+            return false ;
+        }
+    }
+    return true ;
+}
+
+
+static int
+compare_group_frames(
+    void const *    a
+,   void const *    b
+)
+{
+    atlas_frame const * p = *(atlas_frame const * const *) a ;
+    atlas_frame const * q = *(atlas_frame const * const *) b ;
+    return p->local_index_ < q->local_index_ ? -1 : (p->local_index_ > q->local_index_ ? 1 : 0) ;
+}
+
+
+// pymod/texture_atlas.py pack_sprite_rects and asset_sprite.py. Groups are
+// written in the order they first show up in the packed bins, frames of a
+// group by their index in the source directory.
+static bool
+write_sprf(
+    atlas const *   at
+,   char const *    file_name
+)
+{
+    atlas_frame const **    order       = SDL_malloc(sizeof(atlas_frame *) * at->frames_count_) ;
+    uint32_t *              group_order = SDL_malloc(sizeof(uint32_t) * at->groups_count_) ;
+    uint32_t *              group_start = SDL_malloc(sizeof(uint32_t) * (at->groups_count_ + 1)) ;
+    atlas_point *           points      = SDL_malloc(sizeof(atlas_point) * 4 * at->frames_count_) ;
+    atlas_writer            w           = { 0 } ;
+    bool                    result      = false ;
+
+    if(!order || !group_order || !group_start || !points)
+    {
+        SDL_Log("out of memory.") ;
+        goto done ;
+    }
+
+    uint32_t groups_count = 0 ;
+    for(
+        uint32_t i = 0
+    ;   i < at->packer_.placements_count_
+    ;   ++i
+    )
+    {
+        uint32_t const g = at->frames_[at->packer_.best_placements_[i].frame_].group_index_ ;
+        bool seen = false ;
+        for(uint32_t k = 0 ; k < groups_count && !seen ; ++k)
+        {
+            seen = group_order[k] == g ;
+        }
+        if(!seen)
+        {
+            group_order[groups_count++] = g ;
+        }
+    }
+    require(groups_count == at->groups_count_) ;
+
+    uint32_t n = 0 ;
+    for(
+        uint32_t k = 0
+    ;   k < groups_count
+    ;   ++k
+    )
+    {
+        group_start[k] = n ;
+        for(uint32_t i = 0 ; i < at->frames_count_ ; ++i)
+        {
+            if(at->frames_[i].group_index_ == group_order[k])
+            {
+                order[n++] = &at->frames_[i] ;
+            }
+        }
+        SDL_qsort(&order[group_start[k]], n - group_start[k], sizeof(atlas_frame *), compare_group_frames) ;
+    }
+    group_start[groups_count] = n ;
+
+    sprite_2d head = { 0 } ;
+    head.tid_               = atlas_sprite_tid ;
+    head.groups_count_      = (uint16_t) groups_count ;
+    head.vertices_count_    = (uint16_t) n ;
+    head.infos_count_       = (uint16_t) n ;
+    head.flags_             = at->premultiplied_alpha_ ? sprite_2d_flag_premultiplied_alpha : 0 ;
+
+    if(!write_bytes(&w, &head, sizeof(head)) || !write_align(&w, 8))
+    {
+        goto done ;
+    }
+
+    head.groups_offset_ = (uint32_t) w.size_ ;
+
+    for(
+        uint32_t k = 0
+    ;   k < groups_count
+    ;   ++k
+    )
+    {
+        rect_2d_group   g       = { 0 } ;
+        uint32_t        pc      = 0 ;
+        int32_t         min_l   = INT32_MAX ;
+        int32_t         min_t   = INT32_MAX ;
+        int32_t         max_r   = 0 ;
+        int32_t         max_b   = 0 ;
+
+        for(uint32_t i = group_start[k] ; i < group_start[k + 1] ; ++i)
+        {
+            atlas_frame const * f = order[i] ;
+            for(uint32_t c = 0 ; c < 4 ; ++c)
+            {
+                points[pc++] = (atlas_point) { f->pos_[c][0], f->pos_[c][1] } ;
+            }
+            min_l = f->crop_l_ < min_l ? f->crop_l_ : min_l ;
+            min_t = f->crop_t_ < min_t ? f->crop_t_ : min_t ;
+            max_r = f->crop_r_ > max_r ? f->crop_r_ : max_r ;
+            max_b = f->crop_b_ > max_b ? f->crop_b_ : max_b ;
+        }
+
+        atlas_circle const c = calc_bounding_circle(points, pc) ;
+
+        g.frame_start_  = (uint16_t) group_start[k] ;
+        g.frame_count_  = (uint16_t) (group_start[k + 1] - group_start[k]) ;
+        g.playback_     = at->groups_[group_order[k]].playback_ ;
+        g.blend_ms_     = at->groups_[group_order[k]].blend_ms_ ;
+        set_bounding_circle(&g.bounding_info_, &c) ;
+        g.bounding_info_.crop_w_    = (uint32_t) (1 + max_r - min_l) ;
+        g.bounding_info_.crop_h_    = (uint32_t) (1 + max_b - min_t) ;
+        // sic, the python writes the crop rect's right and bottom here.
+        g.bounding_info_.w_         = (uint32_t) max_r ;
+        g.bounding_info_.h_         = (uint32_t) max_b ;
+
+        if(!write_bytes(&w, &g, sizeof(g)))
+        {
+            goto done ;
+        }
+    }
+
+    if(!write_align(&w, 16))
+    {
+        goto done ;
+    }
+    head.vertices_offset_ = (uint32_t) w.size_ ;
+
+    for(
+        uint32_t i = 0
+    ;   i < n
+    ;   ++i
+    )
+    {
+        atlas_frame const * f = order[i] ;
+        rect_2d_vertices v = { 0 } ;
+        for(uint32_t c = 0 ; c < 4 ; ++c)
+        {
+            v.pxpytutv_4_4_[c][0] = f->pos_[c][0] ;
+            v.pxpytutv_4_4_[c][1] = f->pos_[c][1] ;
+            v.pxpytutv_4_4_[c][2] = f->uv_[c][0] ;
+            v.pxpytutv_4_4_[c][3] = f->uv_[c][1] ;
+        }
+        if(!write_bytes(&w, &v, sizeof(v)))
+        {
+            goto done ;
+        }
+    }
+
+    head.infos_offset_ = (uint32_t) w.size_ ;
+
+    for(
+        uint32_t i = 0
+    ;   i < n
+    ;   ++i
+    )
+    {
+        atlas_frame const * f = order[i] ;
+        for(uint32_t c = 0 ; c < 4 ; ++c)
+        {
+            points[c] = (atlas_point) { f->pos_[c][0], f->pos_[c][1] } ;
+        }
+        atlas_circle const c = calc_bounding_circle(points, 4) ;
+
+        rect_2d_info info = { 0 } ;
+        info.texture_index_ = (uint16_t) f->packed_bin_ ;
+        info.group_index_   = (uint16_t) f->group_index_ ;
+        info.flags_         = f->opaque_ ? rect_2d_info_flag_opaque : 0 ;
+        set_bounding_circle(&info.bounding_info_, &c) ;
+        info.bounding_info_.crop_w_ = (uint32_t) f->crop_w_ ;
+        info.bounding_info_.crop_h_ = (uint32_t) f->crop_h_ ;
+        info.bounding_info_.w_      = (uint32_t) f->image_w_ ;
+        info.bounding_info_.h_      = (uint32_t) f->image_h_ ;
+
+        if(!write_bytes(&w, &info, sizeof(info)))
+        {
+            goto done ;
+        }
+    }
+
+    if(!write_align(&w, 16))
+    {
+        goto done ;
+    }
+    head.hulls_offset_ = (uint32_t) w.size_ ;
+
+    for(
+        uint32_t i = 0
+    ;   i < n
+    ;   ++i
+    )
+    {
+        if(!write_bytes(&w, &order[i]->hull_, sizeof(rect_2d_hull)))
+        {
+            goto done ;
+        }
+    }
+
+    head.timings_offset_ = (uint32_t) w.size_ ;
+
+    for(
+        uint32_t i = 0
+    ;   i < n
+    ;   ++i
+    )
+    {
+        rect_2d_timing t = { 0 } ;
+        t.duration_ms_  = order[i]->duration_ms_ ;
+        t.event_        = order[i]->event_ ;
+
+        if(!write_bytes(&w, &t, sizeof(t)))
+        {
+            goto done ;
+        }
+    }
+
+    SDL_memcpy(w.data_, &head, sizeof(head)) ;
+
+    if(!SDL_SaveFile(file_name, w.data_, w.size_))
+    {
+        SDL_Log("writing %s failed: %s", file_name, SDL_GetError()) ;
+        goto done ;
+    }
+
+    result = true ;
+
+done:
+    SDL_free(w.data_) ;
+    SDL_free(points) ;
+    SDL_free(group_start) ;
+    SDL_free(group_order) ;
+    SDL_free(order) ;
+    return result ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+// Mips are filtered in linear space with premultiplied alpha, so transparent
+// texels don't bleed their color into the visible ones, and each level is
+// made from the float level above it, rounding only once per level.
+static float srgb_to_linear_[256] = { 0 } ;
+
+
+static void
+init_srgb_to_linear(void)
+{
+    for(
+        uint32_t i = 0
+    ;   i < 256
+    ;   ++i
+    )
+    {
+        double const c = (double) i / 255.0 ;
+        srgb_to_linear_[i] = (float) (c <= 0.04045 ? c / 12.92 : SDL_pow((c + 0.055) / 1.055, 2.4)) ;
+    }
+}
+
+
+static uint8_t
+linear_to_srgb(
+    float const l
+)
+{
+    double const c = l <= 0.0f ? 0.0 : (l >= 1.0f ? 1.0 : (double) l) ;
+    double const s = c <= 0.0031308 ? c * 12.92 : 1.055 * SDL_pow(c, 1.0 / 2.4) - 0.055 ;
+    return (uint8_t) (s * 255.0 + 0.5) ;
+}
+
+
+// Colors are multiplied by alpha in linear space and stored as srgb again,
+// the texture samplers decode them back to the linear premultiplied value.
+static void
+premultiply_alpha(
+    uint8_t *       pixels
+,   uint32_t const  count
+)
+{
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        float const a = (float) pixels[i * 4 + 3] / 255.0f ;
+        pixels[i * 4 + 0] = linear_to_srgb(srgb_to_linear_[pixels[i * 4 + 0]] * a) ;
+        pixels[i * 4 + 1] = linear_to_srgb(srgb_to_linear_[pixels[i * 4 + 1]] * a) ;
+        pixels[i * 4 + 2] = linear_to_srgb(srgb_to_linear_[pixels[i * 4 + 2]] * a) ;
+    }
+}
+
+
+// premultiplied pixels are taken as they are, straight ones are multiplied.
+static void
+load_linear_level(
+    float *         out_texels
+,   uint8_t const * pixels
+,   uint32_t const  count
+,   bool const      premultiplied_alpha
+)
+{
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        float const a = (float) pixels[i * 4 + 3] / 255.0f ;
+        float const m = premultiplied_alpha ? 1.0f : a ;
+        out_texels[i * 4 + 0] = srgb_to_linear_[pixels[i * 4 + 0]] * m ;
+        out_texels[i * 4 + 1] = srgb_to_linear_[pixels[i * 4 + 1]] * m ;
+        out_texels[i * 4 + 2] = srgb_to_linear_[pixels[i * 4 + 2]] * m ;
+        out_texels[i * 4 + 3] = a ;
+    }
+}
+
+
+static void
+store_linear_level(
+    uint8_t *       out_pixels
+,   float const *   texels
+,   uint32_t const  count
+,   bool const      premultiplied_alpha
+)
+{
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        float const a = texels[i * 4 + 3] ;
+        float const r = premultiplied_alpha ? 1.0f : (a > 0.0f ? 1.0f / a : 0.0f) ;
+        out_pixels[i * 4 + 0] = linear_to_srgb(texels[i * 4 + 0] * r) ;
+        out_pixels[i * 4 + 1] = linear_to_srgb(texels[i * 4 + 1] * r) ;
+        out_pixels[i * 4 + 2] = linear_to_srgb(texels[i * 4 + 2] * r) ;
+        out_pixels[i * 4 + 3] = (uint8_t) (a * 255.0f + 0.5f) ;
+    }
+}
+
+
+// Box filter over the 2x2 texels under each destination texel. The sizes
+// are halved and rounded down the way vulkan counts levels, so an odd last
+// row or column goes into the last destination row or column, which then
+// averages 3 texels across instead of 2.
+static void
+downsample_level(
+    float *         out_texels
+,   uint32_t const  dst_w
+,   uint32_t const  dst_h
+,   float const *   texels
+,   uint32_t const  src_w
+,   uint32_t const  src_h
+)
+{
+    for(
+        uint32_t y = 0
+    ;   y < dst_h
+    ;   ++y
+    )
+    {
+        uint32_t const y0 = SDL_min(y * 2, src_h - 1) ;
+        uint32_t const y1 = y + 1 == dst_h ? src_h - 1 : y * 2 + 1 ;
+
+        for(uint32_t x = 0 ; x < dst_w ; ++x)
+        {
+            uint32_t const x0 = SDL_min(x * 2, src_w - 1) ;
+            uint32_t const x1 = x + 1 == dst_w ? src_w - 1 : x * 2 + 1 ;
+
+            float sum[4] = { 0.0f } ;
+            for(uint32_t sy = y0 ; sy <= y1 ; ++sy)
+            {
+                for(uint32_t sx = x0 ; sx <= x1 ; ++sx)
+                {
+                    float const * t = &texels[(sy * src_w + sx) * 4] ;
+                    for(uint32_t c = 0 ; c < 4 ; ++c)
+                    {
+                        sum[c] += t[c] ;
+                    }
+                }
+            }
+
+            float const r   = 1.0f / (float) ((y1 - y0 + 1) * (x1 - x0 + 1)) ;
+            float *     d   = &out_texels[(y * dst_w + x) * 4] ;
+
+            for(uint32_t c = 0 ; c < 4 ; ++c)
+            {
+                d[c] = sum[c] * r ;
+            }
+        }
+    }
+}
+
+
+// Edge blocks repeat the last row and column, that keeps the endpoints
+// within the colors which are really there.
+static void
+compress_bc3_level(
+    uint8_t *       out_blocks
+,   uint8_t const * pixels
+,   uint32_t const  w
+,   uint32_t const  h
+)
+{
+    uint32_t const blocks_x = (w + 3) / 4 ;
+    uint32_t const blocks_y = (h + 3) / 4 ;
+
+    for(
+        uint32_t by = 0
+    ;   by < blocks_y
+    ;   ++by
+    )
+    {
+        for(uint32_t bx = 0 ; bx < blocks_x ; ++bx)
+        {
+            uint8_t block[16 * 4] = { 0 } ;
+            for(uint32_t y = 0 ; y < 4 ; ++y)
+            {
+                uint32_t const sy = SDL_min(by * 4 + y, h - 1) ;
+                for(uint32_t x = 0 ; x < 4 ; ++x)
+                {
+                    uint32_t const sx = SDL_min(bx * 4 + x, w - 1) ;
+                    SDL_memcpy(&block[(y * 4 + x) * 4], &pixels[(sy * w + sx) * 4], 4) ;
+                }
+            }
+            stb_compress_dxt_block(&out_blocks[(by * blocks_x + bx) * 16], block, 1, STB_DXT_HIGHQUAL) ;
+        }
+    }
+}
+
+
+static uint32_t
+calc_texture_level_size(
+    uint16_t const  format
+,   uint32_t const  w
+,   uint32_t const  h
+)
+{
+    if(texture_2d_format_bc3 == format)
+    {
+        return ((w + 3) / 4) * ((h + 3) / 4) * 16 ;
+    }
+    return w * h * 4 ;
+}
+
+
+// The whole mip chain down to 1x1, see asset_texture.h for the layout. The
+// levels keep the alpha of the pixels, premultiplied or straight.
+static bool
+write_texture(
+    char const *    file_name
+,   uint8_t const * pixels
+,   uint32_t const  width
+,   uint32_t const  height
+,   uint16_t const  format
+,   bool const      premultiplied_alpha
+)
+{
+    require(file_name) ;
+    require(pixels) ;
+    require(width) ;
+    require(height) ;
+
+    uint32_t levels_count = 1 ;
+    while((width >> levels_count) || (height >> levels_count))
+    {
+        ++levels_count ;
+    }
+    require(levels_count <= max_texture_2d_levels) ;
+
+    size_t const        count           = (size_t) width * height ;
+    float *             texels          = SDL_malloc(sizeof(float) * 4 * count) ;
+    float *             next_texels     = SDL_malloc(sizeof(float) * 4 * count) ;
+    uint8_t *           level_pixels    = SDL_malloc(4 * count) ;
+    uint8_t *           blocks          = SDL_malloc(calc_texture_level_size(texture_2d_format_bc3, width, height)) ;
+    atlas_writer        w               = { 0 } ;
+    texture_2d_level    levels[max_texture_2d_levels] = { 0 } ;
+    bool                result          = false ;
+
+    if(!texels || !next_texels || !level_pixels || !blocks)
+    {
+        SDL_Log("out of memory.") ;
+        goto done ;
+    }
+
+    texture_2d head = { 0 } ;
+    head.tid_           = atlas_texture_tid ;
+    head.format_        = format ;
+    head.levels_count_  = (uint16_t) levels_count ;
+    head.width_         = width ;
+    head.height_        = height ;
+
+    if(!write_bytes(&w, &head, sizeof(head)) || !write_align(&w, 16))
+    {
+        goto done ;
+    }
+    head.levels_offset_ = (uint32_t) w.size_ ;
+
+    if(!write_bytes(&w, levels, sizeof(texture_2d_level) * levels_count))
+    {
+        goto done ;
+    }
+
+    load_linear_level(texels, pixels, (uint32_t) count, premultiplied_alpha) ;
+
+    uint32_t lw = width ;
+    uint32_t lh = height ;
+
+    for(
+        uint32_t i = 0
+    ;   i < levels_count
+    ;   ++i
+    )
+    {
+        uint8_t const * level_data = pixels ;
+        if(i > 0)
+        {
+            store_linear_level(level_pixels, texels, lw * lh, premultiplied_alpha) ;
+            level_data = level_pixels ;
+        }
+
+        if(texture_2d_format_bc3 == format)
+        {
+            compress_bc3_level(blocks, level_data, lw, lh) ;
+            level_data = blocks ;
+        }
+
+        if(!write_align(&w, 16))
+        {
+            goto done ;
+        }
+
+        levels[i].offset_   = (uint32_t) w.size_ ;
+        levels[i].size_     = calc_texture_level_size(format, lw, lh) ;
+        levels[i].width_    = lw ;
+        levels[i].height_   = lh ;
+
+        if(!write_bytes(&w, level_data, levels[i].size_))
+        {
+            goto done ;
+        }
+
+        // rounded down like vulkan does, the odd edge goes into the last texel.
+        uint32_t const nw = lw > 1 ? lw / 2 : 1 ;
+        uint32_t const nh = lh > 1 ? lh / 2 : 1 ;
+        downsample_level(next_texels, nw, nh, texels, lw, lh) ;
+
+        float * t   = texels ;
+        texels      = next_texels ;
+        next_texels = t ;
+        lw          = nw ;
+        lh          = nh ;
+    }
+
+    SDL_memcpy(w.data_, &head, sizeof(head)) ;
+    SDL_memcpy(w.data_ + head.levels_offset_, levels, sizeof(texture_2d_level) * levels_count) ;
+
+    if(!SDL_SaveFile(file_name, w.data_, w.size_))
+    {
+        SDL_Log("writing %s failed: %s", file_name, SDL_GetError()) ;
+        goto done ;
+    }
+
+    result = true ;
+
+done:
+    SDL_free(w.data_) ;
+    SDL_free(blocks) ;
+    SDL_free(level_pixels) ;
+    SDL_free(next_texels) ;
+    SDL_free(texels) ;
+    return result ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static void
+destroy_atlas(
+    atlas * at
+)
+{
+    for(
+        uint32_t i = 0
+    ;   i < at->frames_count_
+    ;   ++i
+    )
+    {
+        if(at->frames_[i].pixels_)
+        {
+            stbi_image_free(at->frames_[i].pixels_) ;
+        }
+    }
+
+    SDL_free(at->frames_) ;
+    SDL_free(at->groups_) ;
+    SDL_free(at->packer_.free_) ;
+    SDL_free(at->packer_.scratch_) ;
+    SDL_free(at->packer_.contained_) ;
+    SDL_free(at->packer_.packed_) ;
+    SDL_free(at->packer_.placements_) ;
+    SDL_free(at->packer_.best_placements_) ;
+    SDL_memset(at, 0, sizeof(atlas)) ;
+}
+
+
+static bool
+build_atlas(
+    char const *            dst_dir
+,   char const * const *    src_dirs
+,   uint32_t const          src_dirs_count
+,   bool const              create_animation
+,   bool const              premultiplied_alpha
+)
+{
+    require(dst_dir) ;
+    require(src_dirs) ;
+    require(src_dirs_count) ;
+
+    if(!SDL_CreateDirectory(dst_dir))
+    {
+        SDL_Log("creating %s failed: %s", dst_dir, SDL_GetError()) ;
+        return false ;
+    }
+
+    char const * base_name = SDL_strrchr(dst_dir, '/') ;
+    base_name = base_name ? base_name + 1 : dst_dir ;
+
+    atlas       at              = { 0 } ;
+    uint32_t    frames_capacity = 0 ;
+    bool        result          = true ;
+
+    at.create_animation_    = create_animation ;
+    at.premultiplied_alpha_ = premultiplied_alpha ;
+
+    for(
+        uint32_t i = 0
+    ;   i < src_dirs_count && result
+    ;   ++i
+    )
+    {
+        result = add_group(&at, &frames_capacity, src_dirs[i]) ;
+    }
+
+    if(result)
+    {
+        set_group_crop_rects(&at) ;
+        result = pack_atlas(&at) ;
+    }
+
+    if(result)
+    {
+        for(uint32_t i = 0 ; i < at.frames_count_ ; ++i)
+        {
+            calc_pos_uv(&at, &at.frames_[i]) ;
+        }
+
+        result = calc_hulls(&at) ;
+    }
+
+    if(result)
+    {
+        char sprf_name[max_atlas_path] = { 0 } ;
+        SDL_snprintf(sprf_name, sizeof(sprf_name), "%s/%s.sprf", dst_dir, base_name) ;
+
+        result = write_bins(&at, dst_dir, base_name) && write_sprf(&at, sprf_name) ;
+    }
+
+    destroy_atlas(&at) ;
+    return result ;
+}
+
+
+static bool
+build_texture(
+    char const *    dst_file
+,   char const *    src_file
+,   uint16_t const  format
+)
+{
+    require(dst_file) ;
+    require(src_file) ;
+
+    int w = 0 ;
+    int h = 0 ;
+    int n = 0 ;
+    uint8_t * pixels = stbi_load(src_file, &w, &h, &n, 4) ;
+    if(!pixels)
+    {
+        SDL_Log("loading %s failed: %s", src_file, stbi_failure_reason()) ;
+        return false ;
+    }
+
+    bool const result = write_texture(dst_file, pixels, (uint32_t) w, (uint32_t) h, format, false) ;
+
+    stbi_image_free(pixels) ;
+    return result ;
+}
+
+
+int
+main(
+    int     argc
+,   char *  argv[]
+)
+{
+    // --premultiplied goes before the mode, the source dirs take the rest.
+    bool const premultiplied_alpha = argc > 1 && 0 == SDL_strcmp(argv[1], "--premultiplied") ;
+    if(premultiplied_alpha)
+    {
+        argv[1] = argv[0] ;
+        ++argv ;
+        --argc ;
+    }
+
+    if(argc < 4)
+    {
+        SDL_Log("usage: %s [--premultiplied] animation|collection <dst_dir> <src_dir> [<src_dir> ...]", argv[0]) ;
+        SDL_Log("usage: %s texture <dst_file> <src_file> [rgba8|bc3]", argv[0]) ;
+        return 1 ;
+    }
+
+    init_srgb_to_linear() ;
+
+    uint64_t const t0 = SDL_GetPerformanceCounter() ;
+
+    if(0 == SDL_strcmp(argv[1], "texture"))
+    {
+        uint16_t format = texture_2d_format_bc3 ;
+        if(argc > 4 && 0 == SDL_strcmp(argv[4], "rgba8"))
+        {
+            format = texture_2d_format_rgba8 ;
+        }
+        else if(argc > 4 && SDL_strcmp(argv[4], "bc3"))
+        {
+            SDL_Log("unknown format %s, expected rgba8 or bc3.", argv[4]) ;
+            return 1 ;
+        }
+
+        if(!build_texture(argv[2], argv[3], format))
+        {
+            return 1 ;
+        }
+    }
+    else
+    {
+        bool const create_animation = 0 == SDL_strcmp(argv[1], "animation") ;
+        if(!create_animation && SDL_strcmp(argv[1], "collection"))
+        {
+            SDL_Log("unknown mode %s, expected animation, collection or texture.", argv[1]) ;
+            return 1 ;
+        }
+
+        if(!build_atlas(argv[2], (char const * const *) &argv[3], (uint32_t) (argc - 3), create_animation, premultiplied_alpha))
+        {
+            return 1 ;
+        }
+    }
+
+    uint64_t const t1 = SDL_GetPerformanceCounter() ;
+    SDL_Log("%s done in %.3f ms", argv[2], (double) (t1 - t0) * 1000.0 / (double) SDL_GetPerformanceFrequency()) ;
+
+    return 0 ;
+}
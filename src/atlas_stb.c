@@ -0,0 +1,6 @@
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+#define STB_DXT_IMPLEMENTATION
+#include <stb/stb_dxt.h>
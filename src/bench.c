@@ -0,0 +1,674 @@
+#include "bench.h"
+#include "app.h"
+#include "gfx.h"
+#include "vulkan.h"
+#include "render_thread.h"
+#include "input_record.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "log.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+#include <SDL3/SDL_iostream.h>
+
+
+#define default_bench_frames        600
+#define default_bench_warmup_frames 60
+#define default_bench_out           "bench.json"
+#define max_bench_line              512
+
+
+// a million sprites took about 300 MB of frame packets, vertex buffers and
+// batch, twice that while every sprite blends.
+static uint32_t const bench_sprite_counts[] = { 1000, 10000, 100000, 250000 } ;
+
+
+// an animated sprite which blends between groups submits two instances.
+#define bench_instances_per_sprite  2
+
+
+#define max_bench_steps array_count(bench_sprite_counts)
+
+
+// one sample of each for every measured frame. main is the main thread's
+// time without waiting for the render thread, render the time it took to
+// draw the packet and gpu what the timestamps measured.
+typedef enum bench_sample
+{
+    bench_sample_frame
+,   bench_sample_main
+,   bench_sample_render
+,   bench_sample_gpu
+,   bench_samples_count
+
+} bench_sample ;
+
+
+static char const * const bench_sample_names[bench_samples_count] =
+{
+    "frame"
+,   "main"
+,   "render"
+,   "gpu"
+} ;
+
+
+typedef struct bench_times
+{
+    float   avg_ ;
+    float   p50_ ;
+    float   p90_ ;
+    float   p99_ ;
+    float   max_ ;
+
+} bench_times ;
+
+
+// the counts, the render scale and the aa mode are the last frame's, the memory the most in use while measuring.
+typedef struct bench_result
+{
+    uint32_t        sprite_count_ ;
+    bench_times     times_[bench_samples_count] ;
+    uint32_t        draw_count_ ;
+    uint32_t        instance_count_ ;
+    uint32_t        visible_count_ ;
+    uint32_t        culled_count_ ;
+    float           render_scale_ ;
+    uint32_t        aa_mode_ ;
+    uint64_t        host_bytes_ ;
+    uint64_t        device_bytes_ ;
+
+} bench_result ;
+
+
+typedef struct bench
+{
+    char const *    scene_ ;
+    char const *    out_name_ ;
+    char const *    device_name_ ;
+    bool            has_sprite_count_ ;
+    bool            gpu_timed_ ;
+    uint32_t        frames_ ;
+    uint32_t        warmup_frames_ ;
+
+    uint32_t        sprite_counts_[max_bench_steps] ;
+    uint32_t        steps_count_ ;
+    uint32_t        step_ ;
+    uint32_t        frame_ ;
+    uint64_t        last_time_ ;
+    uint64_t        host_bytes_ ;
+    uint64_t        device_bytes_ ;
+
+    float *         samples_ ;
+    bench_result    results_[max_bench_steps] ;
+
+} bench ;
+
+
+static bench bn_ = { 0 } ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static uint32_t
+get_bench_arg(
+    char const * const  arg
+,   uint32_t const      default_value
+)
+{
+    require(arg) ;
+
+    char const * const v = get_app_arg_value(arg) ;
+    if(!v)
+    {
+        return default_value ;
+    }
+
+    return (uint32_t) SDL_strtoul(v, NULL, 10) ;
+}
+
+
+static int SDLCALL
+compare_bench_samples(
+    void const *    a
+,   void const *    b
+)
+{
+    float const fa = *(float const *) a ;
+    float const fb = *(float const *) b ;
+    return (fa > fb) - (fa < fb) ;
+}
+
+
+// sorts the samples in place, they aren't needed in order afterwards.
+static void
+get_bench_times(
+    bench_times *   out_times
+,   float *         samples
+,   uint32_t const  count
+)
+{
+    require(out_times) ;
+    require(samples) ;
+    require(count) ;
+
+    SDL_qsort(samples, count, sizeof(float), compare_bench_samples) ;
+
+    double sum = 0.0 ;
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        sum += samples[i] ;
+    }
+
+    uint32_t const last = count - 1 ;
+    out_times->avg_ = (float) (sum / count) ;
+    out_times->p50_ = samples[(uint32_t) (last * 0.50f + 0.5f)] ;
+    out_times->p90_ = samples[(uint32_t) (last * 0.90f + 0.5f)] ;
+    out_times->p99_ = samples[(uint32_t) (last * 0.99f + 0.5f)] ;
+    out_times->max_ = samples[last] ;
+}
+
+
+static bool
+write_bench_line(
+    SDL_IOStream *  ios
+,   char const *    fmt
+,   ...
+)
+{
+    require(ios) ;
+    require(fmt) ;
+
+    char line[max_bench_line] ;
+    va_list args ;
+    va_start(args, fmt) ;
+    int const n = SDL_vsnprintf(line, sizeof(line), fmt, args) ;
+    va_end(args) ;
+
+    if(check(n >= 0 && n < (int) sizeof(line)))
+    {
+        return false ;
+    }
+
+    return (size_t) n == SDL_WriteIO(ios, line, (size_t) n) ;
+}
+
+
+// s in double quotes, csv doubles the quotes in it, json escapes them, the
+// backslashes and the control characters.
+static bool
+write_bench_string(
+    SDL_IOStream *  ios
+,   char const *    s
+,   bool const      csv
+)
+{
+    require(ios) ;
+    require(s) ;
+
+    bool ok = write_bench_line(ios, "\"") ;
+
+    for( ; ok && *s ; ++s)
+    {
+        unsigned char const c = (unsigned char) *s ;
+
+        if('"' == c)
+        {
+            ok = write_bench_line(ios, csv ? "\"\"" : "\\\"") ;
+        }
+        else if(csv)
+        {
+            ok = write_bench_line(ios, "%c", c) ;
+        }
+        else if('\\' == c)
+        {
+            ok = write_bench_line(ios, "\\\\") ;
+        }
+        else if(c < 0x20)
+        {
+            ok = write_bench_line(ios, "\\u%04x", c) ;
+        }
+        else
+        {
+            ok = write_bench_line(ios, "%c", c) ;
+        }
+    }
+
+    return ok && write_bench_line(ios, "\"") ;
+}
+
+
+static bool
+write_bench_csv(
+    SDL_IOStream *  ios
+)
+{
+    require(ios) ;
+
+    bool ok = write_bench_line(ios, "scene,device,sprites,frames,warmup_frames") ;
+
+    for(
+        uint32_t i = 0
+    ;   i < bench_samples_count
+    ;   ++i
+    )
+    {
+        char const * n = bench_sample_names[i] ;
+        ok = ok && write_bench_line(ios, ",%s_avg_ms,%s_p50_ms,%s_p90_ms,%s_p99_ms,%s_max_ms", n, n, n, n, n) ;
+    }
+
+    ok = ok && write_bench_line(ios, ",draws,instances,visible,culled,render_scale,aa,host_bytes,device_bytes\n") ;
+
+    for(
+        uint32_t i = 0
+    ;   i < bn_.steps_count_
+    ;   ++i
+    )
+    {
+        bench_result const * br = &bn_.results_[i] ;
+
+        // device names may have commas, e.g. llvmpipe's.
+        ok = ok && write_bench_string(ios, bn_.scene_, true) ;
+        ok = ok && write_bench_line(ios, ",") ;
+        ok = ok && write_bench_string(ios, bn_.device_name_, true) ;
+        ok = ok && write_bench_line(
+            ios
+        ,   ",%u,%u,%u"
+        ,   br->sprite_count_
+        ,   bn_.frames_
+        ,   bn_.warmup_frames_
+        ) ;
+
+        for(
+            uint32_t j = 0
+        ;   j < bench_samples_count
+        ;   ++j
+        )
+        {
+            bench_times const * bt = &br->times_[j] ;
+            ok = ok && write_bench_line(ios, ",%.3f,%.3f,%.3f,%.3f,%.3f", bt->avg_, bt->p50_, bt->p90_, bt->p99_, bt->max_) ;
+        }
+
+        ok = ok && write_bench_line(
+            ios
+        ,   ",%u,%u,%u,%u,%.3f,%s,%" SDL_PRIu64 ",%" SDL_PRIu64 "\n"
+        ,   br->draw_count_
+        ,   br->instance_count_
+        ,   br->visible_count_
+        ,   br->culled_count_
+        ,   br->render_scale_
+        ,   get_vulkan_aa_mode_name(br->aa_mode_)
+        ,   br->host_bytes_
+        ,   br->device_bytes_
+        ) ;
+    }
+
+    return ok ;
+}
+
+
+static bool
+write_bench_json(
+    SDL_IOStream *  ios
+)
+{
+    require(ios) ;
+
+    bool ok = write_bench_line(ios, "{\n  \"scene\": ") ;
+    ok = ok && write_bench_string(ios, bn_.scene_, false) ;
+    ok = ok && write_bench_line(ios, ",\n  \"device\": ") ;
+    ok = ok && write_bench_string(ios, bn_.device_name_, false) ;
+    ok = ok && write_bench_line(
+        ios
+    ,   ",\n"
+        "  \"frames\": %u,\n"
+        "  \"warmup_frames\": %u,\n"
+        "  \"gpu_timed\": %s,\n"
+        "  \"runs\": [\n"
+    ,   bn_.frames_
+    ,   bn_.warmup_frames_
+    ,   bn_.gpu_timed_ ? "true" : "false"
+    ) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < bn_.steps_count_
+    ;   ++i
+    )
+    {
+        bench_result const * br = &bn_.results_[i] ;
+
+        ok = ok && write_bench_line(ios, "    {\n      \"sprites\": %u,\n", br->sprite_count_) ;
+
+        for(
+            uint32_t j = 0
+        ;   j < bench_samples_count
+        ;   ++j
+        )
+        {
+            bench_times const * bt = &br->times_[j] ;
+            ok = ok && write_bench_line(
+                ios
+            ,   "      \"%s_ms\": { \"avg\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n"
+            ,   bench_sample_names[j]
+            ,   bt->avg_
+            ,   bt->p50_
+            ,   bt->p90_
+            ,   bt->p99_
+            ,   bt->max_
+            ) ;
+        }
+
+        ok = ok && write_bench_line(
+            ios
+        ,   "      \"draws\": %u,\n"
+            "      \"instances\": %u,\n"
+            "      \"visible\": %u,\n"
+            "      \"culled\": %u,\n"
+            "      \"render_scale\": %.3f,\n"
+            "      \"aa\": \"%s\",\n"
+            "      \"host_bytes\": %" SDL_PRIu64 ",\n"
+            "      \"device_bytes\": %" SDL_PRIu64 "\n"
+            "    }%s\n"
+        ,   br->draw_count_
+        ,   br->instance_count_
+        ,   br->visible_count_
+        ,   br->culled_count_
+        ,   br->render_scale_
+        ,   get_vulkan_aa_mode_name(br->aa_mode_)
+        ,   br->host_bytes_
+        ,   br->device_bytes_
+        ,   i + 1 < bn_.steps_count_ ? "," : ""
+        ) ;
+    }
+
+    ok = ok && write_bench_line(ios, "  ]\n}\n") ;
+    return ok ;
+}
+
+
+static bool
+write_bench_results()
+{
+    begin_timed_block() ;
+
+    SDL_IOStream * ios = SDL_IOFromFile(bn_.out_name_, "wb") ;
+    if(check_sdl(ios))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    size_t const    len = SDL_strlen(bn_.out_name_) ;
+    bool const      csv = len >= 4 && 0 == SDL_strcasecmp(bn_.out_name_ + len - 4, ".csv") ;
+
+    bool written = csv ? write_bench_csv(ios) : write_bench_json(ios) ;
+    written &= SDL_CloseIO(ios) ;
+
+    if(check_sdl(written))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    log_info("bench results written to %s.", bn_.out_name_) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static void
+finish_bench_step(
+    vulkan_frame_stats const *  fs
+)
+{
+    require(fs) ;
+    require(bn_.step_ < bn_.steps_count_) ;
+
+    bench_result * br = &bn_.results_[bn_.step_] ;
+    br->sprite_count_ = bn_.has_sprite_count_ ? bn_.sprite_counts_[bn_.step_] : 0 ;
+
+    for(
+        uint32_t i = 0
+    ;   i < bench_samples_count
+    ;   ++i
+    )
+    {
+        get_bench_times(&br->times_[i], &bn_.samples_[i * bn_.frames_], bn_.frames_) ;
+    }
+
+    br->draw_count_     = fs->draw_count_ ;
+    br->instance_count_ = fs->instance_count_ ;
+    br->visible_count_  = fs->visible_count_ ;
+    br->culled_count_   = fs->culled_count_ ;
+    br->render_scale_   = fs->render_scale_ ;
+    br->aa_mode_        = fs->aa_mode_ ;
+    br->host_bytes_     = bn_.host_bytes_ ;
+    br->device_bytes_   = bn_.device_bytes_ ;
+
+    bench_times const * ft = &br->times_[bench_sample_frame] ;
+    bench_times const * gt = &br->times_[bench_sample_gpu] ;
+    log_info(
+        "bench %s, %u sprites, frame p50 %.2f ms p99 %.2f ms, gpu p50 %.2f ms at scale %.2f, aa %s."
+    ,   bn_.scene_
+    ,   br->sprite_count_
+    ,   ft->p50_
+    ,   ft->p99_
+    ,   gt->p50_
+    ,   br->render_scale_
+    ,   get_vulkan_aa_mode_name(br->aa_mode_)
+    ) ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_bench()
+{
+    require(!bn_.scene_) ;
+    begin_timed_block() ;
+
+    char const * const scene = get_app_arg_value("--bench") ;
+    if(!scene)
+    {
+        end_timed_block() ;
+        return true ;
+    }
+
+    // a bench brings its own clock.
+    if(check(!is_input_recording() && !is_input_replaying()))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    bool has_sprite_count = false ;
+    if(!find_gfx_scene(scene, &has_sprite_count))
+    {
+        log_error("there is no scene %s to bench.", scene) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    bn_.has_sprite_count_   = has_sprite_count ;
+    bn_.frames_             = get_bench_arg("--bench-frames", default_bench_frames) ;
+    bn_.warmup_frames_      = get_bench_arg("--bench-warmup", default_bench_warmup_frames) ;
+    bn_.out_name_           = get_app_arg_value("--bench-out") ;
+    if(!bn_.out_name_)
+    {
+        bn_.out_name_ = default_bench_out ;
+    }
+
+    // the first frame has no frame before it to measure from.
+    if(!bn_.warmup_frames_)
+    {
+        bn_.warmup_frames_ = 1 ;
+    }
+
+    if(check(bn_.frames_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    // a scene without a sprite count is measured once.
+    uint32_t const max_sprites = has_sprite_count
+        ? get_bench_arg("--bench-max-sprites", UINT32_MAX)
+        : app_->scene_sprite_count_
+        ;
+
+    for(
+        uint32_t i = 0
+    ;   has_sprite_count && i < max_bench_steps
+    ;   ++i
+    )
+    {
+        if(bench_sprite_counts[i] <= max_sprites)
+        {
+            bn_.sprite_counts_[bn_.steps_count_++] = bench_sprite_counts[i] ;
+        }
+    }
+
+    if(0 == bn_.steps_count_)
+    {
+        bn_.sprite_counts_[bn_.steps_count_++] = max_sprites ;
+    }
+
+    if(check(bn_.sprite_counts_[0]))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    bn_.samples_ = alloc_array(float, bench_samples_count * bn_.frames_) ;
+    if(check(bn_.samples_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    uint32_t const most_sprites = bn_.sprite_counts_[bn_.steps_count_ - 1] ;
+
+    bn_.scene_                      = scene ;
+    app_->scene_name_               = scene ;
+    app_->scene_sprite_count_       = bn_.sprite_counts_[0] ;
+    app_->scene_instance_capacity_  = SDL_max(app_->scene_instance_capacity_, most_sprites * bench_instances_per_sprite) ;
+
+    log_info(
+        "benching %s, %u sprite counts up to %u, %u frames each after %u to warm up."
+    ,   scene
+    ,   bn_.steps_count_
+    ,   most_sprites
+    ,   bn_.frames_
+    ,   bn_.warmup_frames_
+    ) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+void
+destroy_bench()
+{
+    begin_timed_block() ;
+
+    if(bn_.samples_)
+    {
+        free_memory(bn_.samples_) ;
+    }
+
+    SDL_memset(&bn_, 0, sizeof(bench)) ;
+
+    end_timed_block() ;
+}
+
+
+bool
+is_benching()
+{
+    return NULL != bn_.scene_ ;
+}
+
+
+bool
+update_bench()
+{
+    if(!bn_.scene_ || bn_.step_ == bn_.steps_count_)
+    {
+        return true ;
+    }
+
+    uint64_t const now  = SDL_GetPerformanceCounter() ;
+    uint64_t const last = bn_.last_time_ ;
+    bn_.last_time_ = now ;
+
+    // the stats the render thread published with the last frame it drew.
+    vulkan_frame_stats  fs ;
+    char const *        device_name = NULL ;
+    bn_.gpu_timed_      = get_vulkan_frame_stats(&fs, &device_name) ;
+    bn_.device_name_    = device_name ;
+
+    // --aa auto, the warmup starts once a mode was picked.
+    if(fs.aa_tuning_)
+    {
+        return true ;
+    }
+
+    if(bn_.frame_ < bn_.warmup_frames_)
+    {
+        ++bn_.frame_ ;
+        return true ;
+    }
+
+    uint64_t wait_ticks = 0 ;
+    uint64_t draw_ticks = 0 ;
+    get_render_thread_ticks(&wait_ticks, &draw_ticks) ;
+
+    double const    ms          = 1000.0 * get_performance_frequency_inverse() ;
+    uint64_t const  frame_ticks = now - last ;
+    uint32_t const  i           = bn_.frame_ - bn_.warmup_frames_ ;
+
+    bn_.samples_[bench_sample_frame  * bn_.frames_ + i] = (float) (frame_ticks * ms) ;
+    bn_.samples_[bench_sample_main   * bn_.frames_ + i] = (float) ((frame_ticks - SDL_min(wait_ticks, frame_ticks)) * ms) ;
+    bn_.samples_[bench_sample_render * bn_.frames_ + i] = (float) (draw_ticks * ms) ;
+    bn_.samples_[bench_sample_gpu    * bn_.frames_ + i] = (float) fs.gpu_time_ms_ ;
+
+    uint64_t host_bytes         = 0 ;
+    uint64_t host_allocations   = 0 ;
+    get_app_allocations(&host_bytes, &host_allocations) ;
+
+    bn_.host_bytes_     = SDL_max(bn_.host_bytes_, host_bytes) ;
+    bn_.device_bytes_   = SDL_max(bn_.device_bytes_, (uint64_t) fs.device_memory_size_) ;
+
+    if(++bn_.frame_ < bn_.warmup_frames_ + bn_.frames_)
+    {
+        return true ;
+    }
+
+    finish_bench_step(&fs) ;
+
+    bn_.frame_          = 0 ;
+    bn_.host_bytes_     = 0 ;
+    bn_.device_bytes_   = 0 ;
+
+    // the sprite batch makes its scene again for the next count.
+    if(++bn_.step_ < bn_.steps_count_)
+    {
+        app_->scene_sprite_count_ = bn_.sprite_counts_[bn_.step_] ;
+        return true ;
+    }
+
+    app_->running_ = false ;
+    return write_bench_results() ;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+
+#include "types.h"
+
+
+// With --bench <scene> the scene is drawn for a fixed number of frames at
+// every sprite count of the ramp, 1k, 10k, 100k and 250k, and the results are
+// written to a file. --bench-frames <n> frames are measured after
+// --bench-warmup <n> frames at every count, --bench-max-sprites <n> stops the
+// ramp early and --bench-out <file> names the file, .csv for comma separated
+// values, json otherwise. The simulation takes one step for every frame and
+// every frame is drawn, the keyboard stays live.
+bool
+create_bench() ;
+
+
+void
+destroy_bench() ;
+
+
+bool
+is_benching() ;
+
+
+// After every frame was handed to the render thread. Moves on to the next
+// sprite count once enough frames were measured, writes the results and
+// stops the app after the last one. False when they can't be written.
+bool
+update_bench() ;
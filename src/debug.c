@@ -2,6 +2,7 @@
 #include "debug.h"
 #include "log.h"
 #include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -104,8 +105,27 @@ typedef struct counter_keeper_storage
 ////////////////////////////////////////////////////////////////////////////////
 //                                                                            //
 //
-static counter_keeper_storage   the_cks_ = { 0 } ;
-static counter_keeper_storage * cks_ = &the_cks_ ;
+static counter_keeper_storage   the_cks_[max_timed_block_storages] = { 0 } ;
+static SDL_TLSID                cks_tls_ = { 0 } ;
+
+
+static counter_keeper_storage *
+get_cks()
+{
+    // a thread which didn't pick a storage shares the main thread's.
+    counter_keeper_storage * cks = SDL_GetTLS(&cks_tls_) ;
+    return cks ? cks : &the_cks_[timed_block_storage_main] ;
+}
+
+
+void
+use_timed_block_storage(
+    uint32_t const  storage
+)
+{
+    require(storage < max_timed_block_storages) ;
+    SDL_SetTLS(&cks_tls_, &the_cks_[storage], NULL) ;
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -156,22 +176,23 @@ dump_counter_keeper(
 void
 dump_all_debug_counter_keepers()
 {
-    require(cks_) ;
+    counter_keeper_storage * cks = get_cks() ;
+    require(cks) ;
 
-    log_debug_u32(cks_->counter_keeper_count_) ;
+    log_debug_u32(cks->counter_keeper_count_) ;
 
     for(
         uint32_t i = 0
-    ;   i < cks_->counter_keeper_count_
+    ;   i < cks->counter_keeper_count_
     ;   ++i
     )
     {
         log_debug_u32(i) ;
-        dump_counter_keeper(&cks_->counter_keeper_[i]) ;
+        dump_counter_keeper(&cks->counter_keeper_[i]) ;
     }
 
-    log_debug_u64(cks_->begin_count_) ;
-    log_debug_u64(cks_->end_count_) ;
+    log_debug_u64(cks->begin_count_) ;
+    log_debug_u64(cks->end_count_) ;
 }
 
 
@@ -268,7 +289,7 @@ find_end_counter_keeper(
         if(
             p->begin_.file_ == ffli->file_
         &&  p->begin_.func_ == ffli->func_
-        &&  p               == cks->counter_keeper_stack_[cks_->stack_index_]
+        &&  p               == cks->counter_keeper_stack_[cks->stack_index_]
         )
         {
             return p ;
@@ -324,30 +345,32 @@ begin_timed_block_impl(
 {
     require(file) ;
     require(func) ;
-    require(cks_) ;
+
+    counter_keeper_storage * cks = get_cks() ;
+    require(cks) ;
 
     log_output_impl(file, func, line, LOG_PRI_DEBUG, "enter %s", func) ;
 
-    ++cks_->begin_count_ ;
+    ++cks->begin_count_ ;
 
     file_func_line_info ffli = { 0 } ;
     ffli.file_ = file ;
     ffli.func_ = func ;
     ffli.line_ = line ;
 
-    counter_keeper * ck = find_begin_counter_keeper(cks_, &ffli) ;
+    counter_keeper * ck = find_begin_counter_keeper(cks, &ffli) ;
     if(!ck)
     {
-        ck = make_counter_keeper(cks_, &ffli) ;
+        ck = make_counter_keeper(cks, &ffli) ;
         require(ck) ;
-        insert_counter_keeper(cks_, ck) ;
-        require(find_begin_counter_keeper(cks_, &ffli)) ;
+        insert_counter_keeper(cks, ck) ;
+        require(find_begin_counter_keeper(cks, &ffli)) ;
     }
 
-    require(cks_->stack_index_ < max_counter_keeper) ;
-    ck->indent_ = cks_->stack_index_ ;
-    ck->parent_ = cks_->counter_keeper_stack_[cks_->stack_index_++] ;
-    cks_->counter_keeper_stack_[cks_->stack_index_] = ck ;
+    require(cks->stack_index_ < max_counter_keeper) ;
+    ck->indent_ = cks->stack_index_ ;
+    ck->parent_ = cks->counter_keeper_stack_[cks->stack_index_++] ;
+    cks->counter_keeper_stack_[cks->stack_index_] = ck ;
 
     ck->hit_count_++ ;
     ck->start_count_ = get_app_time() ;
@@ -363,22 +386,23 @@ end_timed_block_impl(
 {
     require(file) ;
     require(func) ;
-    require(cks_) ;
 
+    counter_keeper_storage * cks = get_cks() ;
+    require(cks) ;
 
     log_output_impl(file, func, line, LOG_PRI_DEBUG, "leave %s", func) ;
 
-    ++cks_->end_count_ ;
+    ++cks->end_count_ ;
 
     file_func_line_info ffli = { 0 } ;
     ffli.file_ = file ;
     ffli.func_ = func ;
     ffli.line_ = line ;
 
-    counter_keeper * ck = find_end_counter_keeper(cks_, &ffli) ;
+    counter_keeper * ck = find_end_counter_keeper(cks, &ffli) ;
     require(ck) ;
-    require(cks_->stack_index_ < max_counter_keeper) ;
-    --cks_->stack_index_ ;
+    require(cks->stack_index_ < max_counter_keeper) ;
+    --cks->stack_index_ ;
 
     require(ck->begin_.file_ == ck->end_.file_) ;
     require(ck->begin_.func_ == ck->end_.func_) ;
@@ -399,9 +423,124 @@ end_timed_block_impl(
 int
 check_begin_end_timed_block_mismatch()
 {
-    log_debug_u64(cks_->begin_count_) ;
-    log_debug_u64(cks_->end_count_) ;
-    return cks_->begin_count_ == cks_->end_count_ ;
+    counter_keeper_storage * cks = get_cks() ;
+    log_debug_u64(cks->begin_count_) ;
+    log_debug_u64(cks->end_count_) ;
+    return cks->begin_count_ == cks->end_count_ ;
 }
 
 
+
+
+static int
+compare_delta_count(
+    void const *    a
+,   void const *    b
+)
+{
+    uint64_t const x = *(uint64_t const *) a ;
+    uint64_t const y = *(uint64_t const *) b ;
+    return (x > y) - (x < y) ;
+}
+
+
+bool
+get_timed_block_stats(
+    timed_block_stats * out_stats
+,   char const *        func
+)
+{
+    require(out_stats) ;
+    require(func) ;
+
+    counter_keeper_storage const * cks = get_cks() ;
+    require(cks) ;
+
+    SDL_memset(out_stats, 0, sizeof(timed_block_stats)) ;
+
+    counter_keeper const * ck = NULL ;
+
+    for(
+        uint32_t i = 0
+    ;   i < cks->counter_keeper_count_
+    ;   ++i
+    )
+    {
+        if(0 == SDL_strcmp(cks->counter_keeper_[i].begin_.func_, func))
+        {
+            ck = &cks->counter_keeper_[i] ;
+            break ;
+        }
+    }
+
+    if(!ck || !ck->hit_count_)
+    {
+        return false ;
+    }
+
+    // a block which is still open, e.g. the caller itself, has not written
+    // its sample yet. the delta ring only holds the last max_delta_count.
+    uint64_t completed = ck->hit_count_ ;
+    for(
+        uint32_t i = 1
+    ;   i <= cks->stack_index_
+    ;   ++i
+    )
+    {
+        if(cks->counter_keeper_stack_[i] == ck)
+        {
+            --completed ;
+        }
+    }
+
+    uint32_t const n = completed < max_delta_count ? (uint32_t) completed : max_delta_count ;
+
+    if(!n)
+    {
+        return false ;
+    }
+
+    uint64_t sorted[max_delta_count] ;
+    SDL_memcpy(sorted, ck->delta_count_, n * sizeof(uint64_t)) ;
+    SDL_qsort(sorted, n, sizeof(uint64_t), compare_delta_count) ;
+
+    double const to_ms = 1000.0 * get_performance_frequency_inverse() ;
+
+    uint64_t sum = 0 ;
+    for(
+        uint32_t i = 0
+    ;   i < n
+    ;   ++i
+    )
+    {
+        sum += sorted[i] ;
+    }
+
+    uint32_t const last = (ck->delta_count_index_ + max_delta_count - 1) & max_delta_count_mask ;
+    uint32_t const p50  = (n - 1) / 2 ;
+    uint32_t const p99  = ((n - 1) * 99) / 100 ;
+
+    out_stats->hit_count_       = ck->hit_count_ ;
+    out_stats->sample_count_    = n ;
+    out_stats->last_ms_         = (double) ck->delta_count_[last] * to_ms ;
+    out_stats->min_ms_          = (double) sorted[0] * to_ms ;
+    out_stats->max_ms_          = (double) sorted[n - 1] * to_ms ;
+    out_stats->avg_ms_          = (double) sum * to_ms / (double) n ;
+    out_stats->p50_ms_          = (double) sorted[p50] * to_ms ;
+    out_stats->p99_ms_          = (double) sorted[p99] * to_ms ;
+
+    uint64_t const bin_size = sorted[n - 1] / max_timed_block_histogram_bins + 1 ;
+    out_stats->histogram_bin_ms_ = (double) bin_size * to_ms ;
+
+    for(
+        uint32_t i = 0
+    ;   i < n
+    ;   ++i
+    )
+    {
+        uint64_t const b = sorted[i] / bin_size ;
+        ++out_stats->histogram_[b < max_timed_block_histogram_bins ? b : max_timed_block_histogram_bins - 1] ;
+    }
+
+    return true ;
+}
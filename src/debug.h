@@ -1,6 +1,33 @@
 #pragma once
 
 
+#include "types.h"
+
+
+#define max_timed_block_histogram_bins  16
+
+// see use_timed_block_storage.
+#define timed_block_storage_main        0
+#define timed_block_storage_render      1
+#define max_timed_block_storages        2
+
+
+typedef struct timed_block_stats
+{
+    uint64_t    hit_count_ ;
+    uint32_t    sample_count_ ;
+    double      last_ms_ ;
+    double      min_ms_ ;
+    double      max_ms_ ;
+    double      avg_ms_ ;
+    double      p50_ms_ ;
+    double      p99_ms_ ;
+    double      histogram_bin_ms_ ;
+    uint32_t    histogram_[max_timed_block_histogram_bins] ;
+
+} timed_block_stats ;
+
+
 void
 begin_timed_block_impl(
     char const *    file
@@ -17,6 +44,15 @@ end_timed_block_impl(
 ) ;
 
 
+// Timed blocks are kept per thread. The main thread uses storage 0, any
+// other thread with timed blocks picks one of its own before the first.
+// get_timed_block_stats only sees the blocks of the calling thread.
+void
+use_timed_block_storage(
+    uint32_t const  storage
+) ;
+
+
 int
 test_debug_file_func() ;
 
@@ -29,6 +65,13 @@ int
 check_begin_end_timed_block_mismatch() ;
 
 
+bool
+get_timed_block_stats(
+    timed_block_stats * out_stats
+,   char const *        func
+) ;
+
+
 #ifdef  ENABLE_TIMED_BLOCK
 #define begin_timed_block() begin_timed_block_impl(__FILE__, __func__, __LINE__)
 #define end_timed_block()   end_timed_block_impl(__FILE__, __func__, __LINE__)
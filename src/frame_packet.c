@@ -0,0 +1,151 @@
+#include "frame_packet.h"
+#include "app.h"
+#include "defines.h"
+#include "check.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_atomic.h>
+
+
+// ready_ holds the index of the packet in between and whether it was handed
+// over after the render thread took the last one.
+#define frame_packet_index_mask     0x3
+#define frame_packet_fresh          0x4
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static size_t
+align_16(
+    size_t const    s
+)
+{
+    return (s + 15) & ~((size_t)15) ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_frame_mailbox(
+    frame_mailbox * out_mailbox
+,   uint32_t const  instances_capacity
+)
+{
+    require(out_mailbox) ;
+    require(!out_mailbox->memory_) ;
+    require(instances_capacity) ;
+    static_require(frame_mailbox_packets <= frame_packet_index_mask + 1, "fix me!") ;
+
+    size_t const submissions_size   = align_16(sizeof(sprite_submission) * instances_capacity) ;
+    size_t const draws_size         = align_16(sizeof(sprite_batch_draw) * instances_capacity) ;
+    size_t const total_size         = frame_mailbox_packets * (submissions_size + draws_size) ;
+
+    uint8_t * m = alloc_memory(uint8_t, total_size) ;
+    if(check(m))
+    {
+        return false ;
+    }
+
+    SDL_memset(out_mailbox, 0, sizeof(frame_mailbox)) ;
+
+    out_mailbox->memory_ = m ;
+
+    for(
+        uint32_t i = 0
+    ;   i < frame_mailbox_packets
+    ;   ++i
+    )
+    {
+        frame_packet * fp = &out_mailbox->packets_[i] ;
+        fp->submissions_            = (sprite_submission *) m ;
+        m += submissions_size ;
+        fp->draws_                  = (sprite_batch_draw *) m ;
+        m += draws_size ;
+        fp->submissions_capacity_   = instances_capacity ;
+    }
+
+    out_mailbox->back_  = 0 ;
+    out_mailbox->front_ = 1 ;
+    SDL_SetAtomicInt(&out_mailbox->ready_, 2) ;
+
+    return true ;
+}
+
+
+void
+destroy_frame_mailbox(
+    frame_mailbox * fm
+)
+{
+    require(fm) ;
+
+    if(fm->memory_)
+    {
+        free_memory(fm->memory_) ;
+    }
+
+    SDL_memset(fm, 0, sizeof(frame_mailbox)) ;
+}
+
+
+frame_packet *
+get_back_frame_packet(
+    frame_mailbox * fm
+)
+{
+    require(fm) ;
+    require(fm->memory_) ;
+    require(fm->back_ < frame_mailbox_packets) ;
+
+    frame_packet * fp = &fm->packets_[fm->back_] ;
+    fp->frame_              = ++fm->frames_count_ ;
+    fp->show_overlay_       = false ;
+    fp->submissions_count_  = 0 ;
+    fp->draws_count_        = 0 ;
+    fp->visible_count_      = 0 ;
+    fp->culled_count_       = 0 ;
+    SDL_memset(&fp->camera_, 0, sizeof(frame_packet_camera)) ;
+
+    return fp ;
+}
+
+
+void
+put_frame_packet(
+    frame_mailbox * fm
+)
+{
+    require(fm) ;
+
+    // the packet is written before anyone can see its index.
+    SDL_MemoryBarrierRelease() ;
+
+    int const ready = SDL_SetAtomicInt(&fm->ready_, (int) (fm->back_ | frame_packet_fresh)) ;
+    fm->back_ = (uint32_t) ready & frame_packet_index_mask ;
+}
+
+
+frame_packet const *
+take_frame_packet(
+    frame_mailbox * fm
+)
+{
+    require(fm) ;
+
+    // only this side clears the flag, it can't go away before the swap.
+    if(!(SDL_GetAtomicInt(&fm->ready_) & frame_packet_fresh))
+    {
+        return NULL ;
+    }
+
+    int const ready = SDL_SetAtomicInt(&fm->ready_, (int) fm->front_) ;
+    fm->front_ = (uint32_t) ready & frame_packet_index_mask ;
+
+    SDL_MemoryBarrierAcquire() ;
+
+    require(fm->front_ < frame_mailbox_packets) ;
+    return &fm->packets_[fm->front_] ;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+
+#include "types.h"
+#include "sprite_batch.h"
+
+#include <SDL3/SDL_atomic.h>
+
+
+#define frame_mailbox_packets           3
+
+
+// The window a packet was made for, the 2d render objects' ubo is made of it.
+typedef struct frame_packet_camera
+{
+    float   offset_x_ ;
+    float   offset_y_ ;
+    float   scale_x_ ;
+    float   scale_y_ ;
+
+} frame_packet_camera ;
+
+
+// Everything the render thread needs to draw a frame, made by the main
+// thread after simulating. Once handed over it isn't written any more, the
+// render thread makes the instances of the sorted submissions right in the
+// frame's vertex buffer and draws them as draws_ says.
+typedef struct frame_packet
+{
+    uint64_t                frame_ ;
+    frame_packet_camera     camera_ ;
+    bool                    show_overlay_ ;
+
+    sprite_submission *     submissions_ ;
+    uint32_t                submissions_count_ ;
+    uint32_t                submissions_capacity_ ;
+    sprite_batch_draw *     draws_ ;
+    uint32_t                draws_count_ ;
+    uint32_t                visible_count_ ;
+    uint32_t                culled_count_ ;
+
+} frame_packet ;
+
+
+// Three packets, one written by the main thread, one read by the render
+// thread and the one handed over last in between. Handing over swaps the
+// back packet with the one in between, taking swaps the front one with it,
+// both are a single atomic exchange and neither side ever waits. A packet
+// which wasn't taken before the next was handed over is dropped, the render
+// thread always draws the newest one.
+typedef struct frame_mailbox
+{
+    frame_packet    packets_[frame_mailbox_packets] ;
+    SDL_AtomicInt   ready_ ;
+    uint32_t        back_ ;
+    uint32_t        front_ ;
+    uint64_t        frames_count_ ;
+    void *          memory_ ;
+
+} frame_mailbox ;
+
+
+// Every packet holds up to instances_capacity submissions and draws.
+bool
+create_frame_mailbox(
+    frame_mailbox * out_mailbox
+,   uint32_t const  instances_capacity
+) ;
+
+
+void
+destroy_frame_mailbox(
+    frame_mailbox * fm
+) ;
+
+
+// The packet the main thread fills next, cleared apart from its arrays.
+frame_packet *
+get_back_frame_packet(
+    frame_mailbox * fm
+) ;
+
+
+// Hands the back packet over, from the main thread.
+void
+put_frame_packet(
+    frame_mailbox * fm
+) ;
+
+
+// The newest packet handed over since the last call, NULL when there is
+// none. From the render thread, the packet stays valid until the next call.
+frame_packet const *
+take_frame_packet(
+    frame_mailbox * fm
+) ;
@@ -1,14 +1,75 @@
 #include "types.h"
+#include "app.h"
 #include "defines.h"
 #include "debug.h"
 #include "check.h"
+#include "log.h"
 #include "vulkan.h"
+#include "shader_watch.h"
+#include "render_thread.h"
 
 #include "vulkan_rob.h"
 #include "vulkan_rob_test.h"
 #include "vulkan_rob_sprite.h"
 #include "vulkan_rob_sprite_animation.h"
+#include "vulkan_rob_sprite_batch.h"
+#include "vulkan_rob_text.h"
 
+#include <SDL3/SDL_stdinc.h>
+
+
+
+typedef void (fn_make_rob)(vulkan_render_object * out_rob) ;
+
+
+#define max_gfx_scene_robs  2
+
+
+// the text render object for the overlay comes after the scene's. Only the
+// sprite batch draws app_->scene_sprite_count_ sprites, the others have as
+// many as they were written with. sprite and sprite_animation are the one
+// off render objects the batch replaced, kept as they were so the batch can
+// be measured against them.
+typedef struct gfx_scene
+{
+    char const *    name_ ;
+    bool            has_sprite_count_ ;
+    fn_make_rob *   make_robs_[max_gfx_scene_robs] ;
+
+} gfx_scene ;
+
+
+static gfx_scene const gfx_scenes[] =
+{
+    {   "sprites",          true,   { make_rob_sprite_batch } }
+,   {   "sprite_animation", false,  { make_rob_sprite_animation } }
+,   {   "sprite",           false,  { make_rob_sprite } }
+,   {   "quad",             false,  { make_rob } }
+,   {   "test",             false,  { make_rob_test } }
+} ;
+
+
+static gfx_scene const *
+get_gfx_scene(
+    char const * const  name
+)
+{
+    require(name) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < array_count(gfx_scenes)
+    ;   ++i
+    )
+    {
+        if(0 == SDL_strcmp(gfx_scenes[i].name_, name))
+        {
+            return &gfx_scenes[i] ;
+        }
+    }
+
+    return NULL ;
+}
 
 
 static bool
@@ -16,28 +77,38 @@ create_render_objects()
 {
     begin_timed_block() ;
 
-    // {
-    //     vulkan_render_object vr ;
-    //     make_rob_test(&vr) ;
-    //     create_vulkan_render_object(&vr) ;
-    // }
-
-    // {
-    //      vulkan_render_object vr ;
-    //      make_rob(&vr) ;
-    //      create_vulkan_render_object(&vr) ;
-    // }
+    gfx_scene const * gs = get_gfx_scene(app_->scene_name_) ;
+    if(check(gs))
+    {
+        log_error("there is no scene %s.", app_->scene_name_) ;
+        end_timed_block() ;
+        return false ;
+    }
 
-    // {
-    //     vulkan_render_object vr ;
-    //     make_rob_sprite(&vr) ;
-    //     create_vulkan_render_object(&vr) ;
-    // }
+    for(
+        uint32_t i = 0
+    ;   i < max_gfx_scene_robs && gs->make_robs_[i]
+    ;   ++i
+    )
+    {
+        vulkan_render_object vr ;
+        gs->make_robs_[i](&vr) ;
+        if(check(create_vulkan_render_object(&vr)))
+        {
+            end_timed_block() ;
+            return false ;
+        }
+    }
 
+    // drawn last, the overlay goes on top of everything else.
     {
         vulkan_render_object vr ;
-        make_rob_sprite_animation(&vr) ;
-        create_vulkan_render_object(&vr) ;
+        make_rob_text(&vr) ;
+        if(check(create_vulkan_render_object(&vr)))
+        {
+            end_timed_block() ;
+            return false ;
+        }
     }
 
     end_timed_block() ;
@@ -54,6 +125,21 @@ destroy_render_objects()
 }
 
 
+bool
+find_gfx_scene(
+    char const * const  name
+,   bool *              out_has_sprite_count
+)
+{
+    require(name) ;
+    require(out_has_sprite_count) ;
+
+    gfx_scene const * gs = get_gfx_scene(name) ;
+    *out_has_sprite_count = gs && gs->has_sprite_count_ ;
+    return NULL != gs ;
+}
+
+
 int
 create_gfx()
 {
@@ -77,6 +163,22 @@ create_gfx()
         return false ;
     }
 
+#ifdef  ENABLE_SHADER_RELOAD
+    // started last, only what has changed after startup is compiled.
+    if(check(create_shader_watch("src/shaders", "ass/shaders")))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+#endif
+
+    // every render object is in place before the first packet is drawn.
+    if(check(create_render_thread(app_->scene_instance_capacity_)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
     end_timed_block() ;
     return true ;
 }
@@ -87,6 +189,12 @@ destroy_gfx()
 {
     begin_timed_block() ;
 
+    destroy_render_thread() ;
+
+#ifdef  ENABLE_SHADER_RELOAD
+    destroy_shader_watch() ;
+#endif
+
     destroy_render_objects() ;
 
     destroy_vulkan() ;
@@ -96,11 +204,13 @@ destroy_gfx()
 
 
 int
-draw_gfx()
+draw_gfx(
+    frame_packet const *    fp
+)
 {
     begin_timed_block() ;
 
-    if(check(draw_vulkan()))
+    if(check(draw_vulkan(fp)))
     {
         end_timed_block() ;
         return false ;
@@ -111,6 +221,56 @@ draw_gfx()
 }
 
 
+int
+submit_gfx(
+    bool const  every_frame
+)
+{
+    begin_timed_block() ;
+
+    if(check(pack_vulkan(get_render_thread_packet())))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(put_render_thread_packet(every_frame)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+int
+simulate_gfx(
+    float const step_seconds
+,   bool *      out_changed
+)
+{
+    begin_timed_block() ;
+
+    if(check(simulate_vulkan(step_seconds, out_changed)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+bool
+is_gfx_animated()
+{
+    return is_vulkan_animated() ;
+}
+
+
 void
 resize_gfx()
 {
@@ -1,6 +1,22 @@
 #pragma once
 
 
+#include "types.h"
+
+
+typedef struct frame_packet frame_packet ;
+
+
+// Whether there is a scene of that name for --scene and --bench, and if it
+// draws as many sprites as app_->scene_sprite_count_ says.
+bool
+find_gfx_scene(
+    char const * const  name
+,   bool *              out_has_sprite_count
+) ;
+
+
+// Makes the scene app_->scene_name_ names.
 int
 create_gfx() ;
 
@@ -8,8 +24,33 @@ create_gfx() ;
 void
 destroy_gfx() ;
 
+// From the render thread, see render_thread.h.
+int
+draw_gfx(
+    frame_packet const *    fp
+) ;
+
+
+// Fills a frame packet after the simulation and hands it to the render
+// thread, from the main thread. With every_frame set it waits until the
+// packet was drawn, so none is dropped.
 int
-draw_gfx() ;
+submit_gfx(
+    bool const  every_frame
+) ;
+
+
+// out_changed is set when the step changed what is drawn.
+int
+simulate_gfx(
+    float const step_seconds
+,   bool *      out_changed
+) ;
+
+
+// Whether the scene changes every frame, even without simulating.
+bool
+is_gfx_animated() ;
 
 
 void
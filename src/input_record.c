@@ -0,0 +1,385 @@
+#include "input_record.h"
+#include "app.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "log.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_timer.h>
+#include <SDL3/SDL_error.h>
+
+
+#define input_record_magic      0x43455254
+#define input_record_version    1
+
+
+// frames_count_ is written last, a recording that wasn't finished has 0.
+typedef struct input_record_header
+{
+    uint32_t    magic_ ;
+    uint32_t    version_ ;
+    uint64_t    frequency_ ;
+    uint32_t    simulation_hz_ ;
+    int32_t     window_width_ ;
+    int32_t     window_height_ ;
+    uint32_t    frames_count_ ;
+
+} input_record_header ;
+
+
+typedef struct input_record_event
+{
+    uint32_t    type_ ;
+    uint32_t    key_ ;
+    uint16_t    mod_ ;
+    uint16_t    unused_ ;
+
+} input_record_event ;
+
+
+// on disk a frame is its delta, the events count in one byte and the events.
+#define input_record_frame_head_size    (sizeof(uint64_t) + sizeof(uint8_t))
+
+
+typedef struct input_record
+{
+    SDL_IOStream *          ios_ ;
+    input_record_header     header_ ;
+    input_record_event      events_[max_input_record_frame_events] ;
+    uint32_t                events_count_ ;
+    uint32_t                dropped_events_count_ ;
+
+    uint8_t const *         replay_ ;
+    uint64_t                replay_size_ ;
+    uint64_t                replay_offset_ ;
+    uint32_t                replay_frame_ ;
+    double                  replay_ticks_scale_ ;
+
+} input_record ;
+
+
+static input_record ir_ = { 0 } ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static bool
+create_recording(
+    char const * const  name
+)
+{
+    require(name) ;
+    begin_timed_block() ;
+
+    ir_.ios_ = SDL_IOFromFile(name, "wb") ;
+    if(check_sdl(ir_.ios_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    ir_.header_.magic_          = input_record_magic ;
+    ir_.header_.version_        = input_record_version ;
+    ir_.header_.frequency_      = SDL_GetPerformanceFrequency() ;
+    ir_.header_.simulation_hz_  = app_simulation_hz ;
+    ir_.header_.window_width_   = app_->window_width_ ;
+    ir_.header_.window_height_  = app_->window_height_ ;
+    ir_.header_.frames_count_   = 0 ;
+
+    if(check_sdl(sizeof(input_record_header) == SDL_WriteIO(ir_.ios_, &ir_.header_, sizeof(input_record_header))))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    log_info("recording input to %s.", name) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+create_replay(
+    char const * const  name
+)
+{
+    require(name) ;
+    begin_timed_block() ;
+
+    void *      p = NULL ;
+    uint64_t    s = 0 ;
+    if(check(load_file(&p, &s, name)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    ir_.replay_         = p ;
+    ir_.replay_size_    = s ;
+
+    if(check(s >= sizeof(input_record_header)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    SDL_memcpy(&ir_.header_, p, sizeof(input_record_header)) ;
+    ir_.replay_offset_ = sizeof(input_record_header) ;
+
+    if(check(
+            input_record_magic      == ir_.header_.magic_
+        &&  input_record_version    == ir_.header_.version_
+        &&  app_simulation_hz       == ir_.header_.simulation_hz_
+        &&  ir_.header_.frequency_
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    // the same on one machine, so two replays there step the same.
+    ir_.replay_ticks_scale_ = (double) SDL_GetPerformanceFrequency() / (double) ir_.header_.frequency_ ;
+
+    if(
+        ir_.header_.window_width_   != app_->window_width_
+    ||  ir_.header_.window_height_  != app_->window_height_
+    )
+    {
+        log_info(
+            "%s was recorded at %dx%d, the window is %dx%d, the frames won't be the same."
+        ,   name
+        ,   ir_.header_.window_width_
+        ,   ir_.header_.window_height_
+        ,   app_->window_width_
+        ,   app_->window_height_
+        ) ;
+    }
+
+    log_info("replaying %u frames of input from %s.", ir_.header_.frames_count_, name) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_input_record()
+{
+    require(!ir_.ios_) ;
+    require(!ir_.replay_) ;
+    begin_timed_block() ;
+
+    char const * const record_name = get_app_arg_value("--record") ;
+    char const * const replay_name = get_app_arg_value("--replay") ;
+
+    if(check(!record_name || !replay_name))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(record_name && check(create_recording(record_name)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(replay_name && check(create_replay(replay_name)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+void
+destroy_input_record()
+{
+    begin_timed_block() ;
+
+    if(ir_.ios_)
+    {
+        // the header again, now with the frames count.
+        bool written =
+            0 == SDL_SeekIO(ir_.ios_, 0, SDL_IO_SEEK_SET)
+        &&  sizeof(input_record_header) == SDL_WriteIO(ir_.ios_, &ir_.header_, sizeof(input_record_header))
+        ;
+        written &= SDL_CloseIO(ir_.ios_) ;
+        ir_.ios_ = NULL ;
+
+        if(!written)
+        {
+            log_info("can't finish the input recording: %s", SDL_GetError()) ;
+        }
+        else
+        {
+            log_info("recorded %u frames of input.", ir_.header_.frames_count_) ;
+        }
+
+        if(ir_.dropped_events_count_)
+        {
+            log_info("%u events were not recorded.", ir_.dropped_events_count_) ;
+        }
+    }
+
+    if(ir_.replay_)
+    {
+        free_memory((void *) ir_.replay_) ;
+    }
+
+    SDL_memset(&ir_, 0, sizeof(input_record)) ;
+
+    end_timed_block() ;
+}
+
+
+bool
+is_input_recording()
+{
+    return NULL != ir_.ios_ ;
+}
+
+
+bool
+is_input_replaying()
+{
+    return NULL != ir_.replay_ ;
+}
+
+
+void
+record_input_event(
+    SDL_Event const *   event
+)
+{
+    require(event) ;
+
+    if(!ir_.ios_)
+    {
+        return ;
+    }
+
+    if(
+        SDL_EVENT_KEY_DOWN  != event->type
+    &&  SDL_EVENT_KEY_UP    != event->type
+    )
+    {
+        return ;
+    }
+
+    if(ir_.events_count_ == max_input_record_frame_events)
+    {
+        ++ir_.dropped_events_count_ ;
+        return ;
+    }
+
+    input_record_event * e = &ir_.events_[ir_.events_count_++] ;
+    e->type_    = event->type ;
+    e->key_     = (uint32_t) event->key.keysym.sym ;
+    e->mod_     = (uint16_t) event->key.keysym.mod ;
+    e->unused_  = 0 ;
+}
+
+
+void
+record_input_frame(
+    uint64_t const  delta
+)
+{
+    if(!ir_.ios_)
+    {
+        return ;
+    }
+
+    uint8_t frame[input_record_frame_head_size + sizeof(ir_.events_)] ;
+    uint8_t const count = (uint8_t) ir_.events_count_ ;
+
+    SDL_memcpy(frame, &delta, sizeof(uint64_t)) ;
+    frame[sizeof(uint64_t)] = count ;
+    SDL_memcpy(frame + input_record_frame_head_size, ir_.events_, sizeof(input_record_event) * count) ;
+
+    size_t const size = input_record_frame_head_size + sizeof(input_record_event) * count ;
+    if(size == SDL_WriteIO(ir_.ios_, frame, size))
+    {
+        ++ir_.header_.frames_count_ ;
+    }
+
+    ir_.events_count_ = 0 ;
+}
+
+
+bool
+replay_input_frame(
+    uint64_t *  out_delta
+,   SDL_Event * out_events
+,   uint32_t *  out_events_count
+)
+{
+    require(out_delta) ;
+    require(out_events) ;
+    require(out_events_count) ;
+    require(ir_.replay_) ;
+
+    *out_events_count = 0 ;
+
+    if(ir_.replay_frame_ == ir_.header_.frames_count_)
+    {
+        return false ;
+    }
+
+    uint8_t const * p = ir_.replay_ + ir_.replay_offset_ ;
+    uint64_t const  left = ir_.replay_size_ - ir_.replay_offset_ ;
+    if(check(left >= input_record_frame_head_size))
+    {
+        return false ;
+    }
+
+    uint64_t delta = 0 ;
+    SDL_memcpy(&delta, p, sizeof(uint64_t)) ;
+    uint32_t const count = p[sizeof(uint64_t)] ;
+
+    size_t const size = input_record_frame_head_size + sizeof(input_record_event) * count ;
+    if(check(count <= max_input_record_frame_events && left >= size))
+    {
+        return false ;
+    }
+
+    input_record_event events[max_input_record_frame_events] ;
+    SDL_memcpy(events, p + input_record_frame_head_size, sizeof(input_record_event) * count) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        SDL_Event * e = &out_events[i] ;
+        SDL_memset(e, 0, sizeof(SDL_Event)) ;
+        e->type             = events[i].type_ ;
+        e->key.type         = events[i].type_ ;
+        e->key.keysym.sym   = (SDL_Keycode) events[i].key_ ;
+        e->key.keysym.mod   = (SDL_Keymod) events[i].mod_ ;
+    }
+
+    *out_delta = 1.0 == ir_.replay_ticks_scale_
+        ? delta
+        : (uint64_t) ((double) delta * ir_.replay_ticks_scale_)
+        ;
+    *out_events_count   = count ;
+    ir_.replay_offset_ += size ;
+    ++ir_.replay_frame_ ;
+
+    return true ;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+
+#include "types.h"
+
+
+#define max_input_record_frame_events   16
+
+
+typedef union SDL_Event SDL_Event ;
+
+
+// With --record <file> the keyboard events and the time between two
+// simulated frames are written to file, with --replay <file> they are read
+// back and replace the clock and the keyboard. The file is a header followed
+// by one record per simulated frame, its delta in performance counter ticks
+// and the events handled before it. Window events stay live in both modes,
+// the window should have the size it had while recording.
+bool
+create_input_record() ;
+
+
+// Finishes the file when recording.
+void
+destroy_input_record() ;
+
+
+bool
+is_input_recording() ;
+
+
+bool
+is_input_replaying() ;
+
+
+// Keeps a live event for the next frame, only keyboard events are kept.
+void
+record_input_event(
+    SDL_Event const *   event
+) ;
+
+
+// Writes the frame with the events kept since the last one.
+void
+record_input_frame(
+    uint64_t const  delta
+) ;
+
+
+// The next recorded frame, its delta in this machine's ticks and its events.
+// False when the recording is over.
+bool
+replay_input_frame(
+    uint64_t *  out_delta
+,   SDL_Event * out_events
+,   uint32_t *  out_events_count
+) ;
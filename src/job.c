@@ -0,0 +1,231 @@
+#include "job.h"
+#include "defines.h"
+#include "check.h"
+#include "log.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_cpuinfo.h>
+
+
+// A fixed set of worker threads, started once. run_parallel_for hands out
+// ranges through an atomic counter, workers sleep on a semaphore in between.
+typedef struct job_system
+{
+    SDL_Thread *        workers_[max_job_workers] ;
+    uint32_t            workers_count_ ;
+    SDL_Semaphore *     work_semaphore_ ;
+    SDL_Semaphore *     done_semaphore_ ;
+    SDL_AtomicInt       next_range_ ;
+    SDL_AtomicInt       quit_ ;
+
+    fn_job_range_func * func_ ;
+    void *              param_ ;
+    uint32_t            count_ ;
+    uint32_t            range_size_ ;
+    uint32_t            ranges_count_ ;
+
+} job_system ;
+
+
+static job_system   js_ = { 0 } ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static void
+process_ranges()
+{
+    for(;;)
+    {
+        uint32_t const r = (uint32_t) SDL_AddAtomicInt(&js_.next_range_, 1) ;
+        if(r >= js_.ranges_count_)
+        {
+            return ;
+        }
+
+        uint32_t const b = r * js_.range_size_ ;
+        uint32_t const e = b + js_.range_size_ < js_.count_ ? b + js_.range_size_ : js_.count_ ;
+        js_.func_(js_.param_, b, e) ;
+    }
+}
+
+
+static int
+run_worker(
+    void *  data
+)
+{
+    (void) data ;
+
+    for(;;)
+    {
+        SDL_WaitSemaphore(js_.work_semaphore_) ;
+
+        if(SDL_GetAtomicInt(&js_.quit_))
+        {
+            return 0 ;
+        }
+
+        process_ranges() ;
+
+        SDL_SignalSemaphore(js_.done_semaphore_) ;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_jobs()
+{
+    require(!js_.work_semaphore_) ;
+
+    js_.work_semaphore_ = SDL_CreateSemaphore(0) ;
+    if(check_sdl(js_.work_semaphore_))
+    {
+        return false ;
+    }
+
+    js_.done_semaphore_ = SDL_CreateSemaphore(0) ;
+    if(check_sdl(js_.done_semaphore_))
+    {
+        return false ;
+    }
+
+    SDL_SetAtomicInt(&js_.quit_, 0) ;
+
+    // the calling thread takes part as well.
+    int const cores = SDL_GetNumLogicalCPUCores() ;
+    uint32_t const n = cores > 1 ? (uint32_t) cores - 1 : 0 ;
+    uint32_t const workers_count = n < max_job_workers ? n : max_job_workers ;
+
+    for(
+        uint32_t i = 0
+    ;   i < workers_count
+    ;   ++i
+    )
+    {
+        js_.workers_[i] = SDL_CreateThread(run_worker, "job_worker", NULL) ;
+        if(check_sdl(js_.workers_[i]))
+        {
+            return false ;
+        }
+        ++js_.workers_count_ ;
+    }
+
+    log_debug_u32(js_.workers_count_) ;
+    return true ;
+}
+
+
+void
+destroy_jobs()
+{
+    SDL_SetAtomicInt(&js_.quit_, 1) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < js_.workers_count_
+    ;   ++i
+    )
+    {
+        SDL_SignalSemaphore(js_.work_semaphore_) ;
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < js_.workers_count_
+    ;   ++i
+    )
+    {
+        SDL_WaitThread(js_.workers_[i], NULL) ;
+        js_.workers_[i] = NULL ;
+    }
+    js_.workers_count_ = 0 ;
+
+    if(js_.done_semaphore_)
+    {
+        SDL_DestroySemaphore(js_.done_semaphore_) ;
+        js_.done_semaphore_ = NULL ;
+    }
+
+    if(js_.work_semaphore_)
+    {
+        SDL_DestroySemaphore(js_.work_semaphore_) ;
+        js_.work_semaphore_ = NULL ;
+    }
+}
+
+
+uint32_t
+get_job_worker_count()
+{
+    return js_.workers_count_ ;
+}
+
+
+void
+run_parallel_for(
+    fn_job_range_func * func
+,   void *              param
+,   uint32_t const      count
+,   uint32_t const      min_range
+)
+{
+    require(func) ;
+    require(min_range) ;
+
+    if(!count)
+    {
+        return ;
+    }
+
+    if(
+        !js_.workers_count_
+    ||  count <= min_range
+    )
+    {
+        func(param, 0, count) ;
+        return ;
+    }
+
+    // a few ranges per thread so uneven ranges even out.
+    uint32_t const max_ranges   = (js_.workers_count_ + 1) * 4 ;
+    uint32_t const wanted       = (count + min_range - 1) / min_range ;
+    uint32_t const ranges       = wanted < max_ranges ? wanted : max_ranges ;
+    uint32_t const range_size   = (count + ranges - 1) / ranges ;
+
+    js_.func_           = func ;
+    js_.param_          = param ;
+    js_.count_          = count ;
+    js_.range_size_     = range_size ;
+    js_.ranges_count_   = (count + range_size - 1) / range_size ;
+    SDL_SetAtomicInt(&js_.next_range_, 0) ;
+
+    uint32_t const wake = js_.ranges_count_ - 1 < js_.workers_count_ ? js_.ranges_count_ - 1 : js_.workers_count_ ;
+
+    for(
+        uint32_t i = 0
+    ;   i < wake
+    ;   ++i
+    )
+    {
+        SDL_SignalSemaphore(js_.work_semaphore_) ;
+    }
+
+    process_ranges() ;
+
+    for(
+        uint32_t i = 0
+    ;   i < wake
+    ;   ++i
+    )
+    {
+        SDL_WaitSemaphore(js_.done_semaphore_) ;
+    }
+}
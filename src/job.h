@@ -0,0 +1,37 @@
+#pragma once
+
+
+#include "types.h"
+
+
+#define max_job_workers 8
+
+
+// Called with a sub range [begin, end) of the whole range, from the worker
+// threads and from the calling thread. The workers have no timed block
+// storage of their own, range functions must not use timed blocks, logging
+// or the allocator.
+typedef void (fn_job_range_func)(void * param, uint32_t const begin, uint32_t const end) ;
+
+
+bool
+create_jobs() ;
+
+
+void
+destroy_jobs() ;
+
+
+uint32_t
+get_job_worker_count() ;
+
+
+// Splits [0, count) into ranges of at least min_range elements and runs them
+// on the workers and the calling thread. Returns when all ranges are done.
+void
+run_parallel_for(
+    fn_job_range_func * func
+,   void *              param
+,   uint32_t const      count
+,   uint32_t const      min_range
+) ;
@@ -0,0 +1,198 @@
+#include "overlay.h"
+#include "text.h"
+#include "vulkan.h"
+#include "app.h"
+#include "debug.h"
+#include "defines.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+
+#define max_overlay_line    128
+
+
+static float const      overlay_left_           = 8.0f ;
+static float const      overlay_top_            = 8.0f ;
+static float const      overlay_width_          = 440.0f ;
+static float const      overlay_histogram_h_    = 48.0f ;
+static char const       overlay_frame_block_[]  = "draw_gfx" ;
+
+
+static double
+to_mib(
+    uint64_t const  bytes
+)
+{
+    return (double) bytes / (1024.0 * 1024.0) ;
+}
+
+
+static void
+build_histogram(
+    text_batch *                tb
+,   timed_block_stats const *   tbs
+,   float const                 x
+,   float const                 y
+,   float const                 w
+,   float const                 h
+)
+{
+    require(tb) ;
+    require(tbs) ;
+
+    uint32_t const bar_color    = make_text_color(0x40, 0xC0, 0x40, 0xFF) ;
+    uint32_t const p99_color    = make_text_color(0xFF, 0x40, 0x40, 0xFF) ;
+    uint32_t const back_color   = make_text_color(0x20, 0x20, 0x20, 0xC0) ;
+
+    add_text_rect(tb, x, y, w, h, back_color) ;
+
+    uint32_t max_count = 1 ;
+    for(
+        uint32_t i = 0
+    ;   i < max_timed_block_histogram_bins
+    ;   ++i
+    )
+    {
+        if(tbs->histogram_[i] > max_count)
+        {
+            max_count = tbs->histogram_[i] ;
+        }
+    }
+
+    float const bw = w / (float) max_timed_block_histogram_bins ;
+
+    for(
+        uint32_t i = 0
+    ;   i < max_timed_block_histogram_bins
+    ;   ++i
+    )
+    {
+        if(!tbs->histogram_[i])
+        {
+            continue ;
+        }
+
+        float const bh = h * (float) tbs->histogram_[i] / (float) max_count ;
+        add_text_rect(tb, x + (float) i * bw + 1.0f, y + h - bh, bw - 2.0f, bh, bar_color) ;
+    }
+
+    // p99 marker, the histogram spans [0, max].
+    if(tbs->histogram_bin_ms_ > 0.0)
+    {
+        double const range  = tbs->histogram_bin_ms_ * max_timed_block_histogram_bins ;
+        float const px      = x + w * (float) (tbs->p99_ms_ / range) ;
+        add_text_rect(tb, px, y, 2.0f, h, p99_color) ;
+    }
+}
+
+
+void
+build_overlay(
+    text_batch *            tb
+,   vulkan_context const *  vc
+)
+{
+    require(tb) ;
+    require(vc) ;
+
+    clear_text_batch(tb) ;
+
+    // drawn on the render thread, the main thread's toggle comes with the
+    // packet.
+    if(!vc->frame_packet_ || !vc->frame_packet_->show_overlay_)
+    {
+        return ;
+    }
+
+    uint32_t const text_color = make_text_color(0xFF, 0xFF, 0xFF, 0xFF) ;
+    uint32_t const back_color = make_text_color(0x00, 0x00, 0x00, 0xA0) ;
+
+    float const lh  = get_text_line_height(tb) ;
+    float const x   = overlay_left_ ;
+    float       y   = overlay_top_ ;
+
+    // background first, its size is known up front: 4 lines and a histogram.
+    add_text_rect(tb, x - 4.0f, y - 4.0f, overlay_width_, 4.0f * lh + overlay_histogram_h_ + 12.0f, back_color) ;
+
+    char line[max_overlay_line] ;
+
+    timed_block_stats tbs = { 0 } ;
+    if(get_timed_block_stats(&tbs, overlay_frame_block_))
+    {
+        SDL_snprintf(
+            line
+        ,   sizeof(line)
+        ,   "frame %6.2f ms avg %6.2f p99 %6.2f max %6.2f (%5.1f fps)"
+        ,   tbs.last_ms_
+        ,   tbs.avg_ms_
+        ,   tbs.p99_ms_
+        ,   tbs.max_ms_
+        ,   tbs.avg_ms_ > 0.0 ? 1000.0 / tbs.avg_ms_ : 0.0
+        ) ;
+    }
+    else
+    {
+        SDL_snprintf(line, sizeof(line), "frame n/a (timed blocks disabled)") ;
+    }
+    add_text(tb, x, y, text_color, line) ;
+    y += lh ;
+
+    if(vc->enable_timestamps_)
+    {
+        SDL_snprintf(
+            line
+        ,   sizeof(line)
+        ,   "gpu   %6.2f ms scale %.2f (%ux%u) aa %s%s"
+        ,   vc->frame_stats_.gpu_time_ms_
+        ,   vc->frame_stats_.render_scale_
+        ,   vc->render_extent_.width
+        ,   vc->render_extent_.height
+        ,   get_vulkan_aa_mode_name(vc->frame_stats_.aa_mode_)
+        ,   vc->frame_stats_.aa_tuning_ ? " (tuning)" : ""
+        ) ;
+    }
+    else
+    {
+        SDL_snprintf(
+            line
+        ,   sizeof(line)
+        ,   "gpu   n/a scale %.2f (%ux%u) aa %s"
+        ,   vc->frame_stats_.render_scale_
+        ,   vc->render_extent_.width
+        ,   vc->render_extent_.height
+        ,   get_vulkan_aa_mode_name(vc->frame_stats_.aa_mode_)
+        ) ;
+    }
+    add_text(tb, x, y, text_color, line) ;
+    y += lh ;
+
+    SDL_snprintf(
+        line
+    ,   sizeof(line)
+    ,   "draws %u instances %u visible %u culled %u"
+    ,   vc->frame_stats_.draw_count_
+    ,   vc->frame_stats_.instance_count_
+    ,   vc->frame_stats_.visible_count_
+    ,   vc->frame_stats_.culled_count_
+    ) ;
+    add_text(tb, x, y, text_color, line) ;
+    y += lh ;
+
+    uint64_t host_bytes         = 0 ;
+    uint64_t host_allocations   = 0 ;
+    get_app_allocations(&host_bytes, &host_allocations) ;
+
+    SDL_snprintf(
+        line
+    ,   sizeof(line)
+    ,   "host %.2f MiB (%u) device %.2f MiB (%u)"
+    ,   to_mib(host_bytes)
+    ,   (uint32_t) host_allocations
+    ,   to_mib(vc->frame_stats_.device_memory_size_)
+    ,   vc->frame_stats_.device_memory_count_
+    ) ;
+    add_text(tb, x, y, text_color, line) ;
+    y += lh + 4.0f ;
+
+    build_histogram(tb, &tbs, x, y, overlay_width_ - 8.0f, overlay_histogram_h_) ;
+}
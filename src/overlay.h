@@ -0,0 +1,12 @@
+#pragma once
+
+
+typedef struct text_batch text_batch ;
+typedef struct vulkan_context vulkan_context ;
+
+
+void
+build_overlay(
+    text_batch *            tb
+,   vulkan_context const *  vc
+) ;
@@ -0,0 +1,301 @@
+#include "pool.h"
+#include "app.h"
+#include "defines.h"
+#include "check.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static uint32_t
+next_generation(
+    uint32_t const  generation
+)
+{
+    // skip 0 on wrap around, it marks the invalid handle.
+    uint32_t const g = generation + 1 ;
+    return g ? g : 1 ;
+}
+
+
+// where the element of the dense index lives, its slot in a stable pool.
+static uint8_t *
+get_element_address(
+    pool const *    p
+,   uint32_t const  dense_index
+)
+{
+    require(p) ;
+
+    uint32_t const i = p->stable_ ? p->dense_to_slot_[dense_index] : dense_index ;
+    return p->elements_ + (size_t)i * p->element_size_ ;
+}
+
+
+static void
+reset_pool_slots(
+    pool *  p
+)
+{
+    require(p) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < p->capacity_
+    ;   ++i
+    )
+    {
+        p->slot_to_dense_[i]    = invalid_pool_index ;
+        p->dense_to_slot_[i]    = invalid_pool_index ;
+        p->next_free_slot_[i]   = i + 1 ;
+    }
+
+    p->next_free_slot_[p->capacity_ - 1] = invalid_pool_index ;
+    p->free_slot_   = 0 ;
+    p->count_       = 0 ;
+}
+
+
+bool
+create_pool(
+    pool *          out_pool
+,   uint32_t const  element_size
+,   uint32_t const  capacity
+)
+{
+    require(out_pool) ;
+    require(!out_pool->memory_) ;
+    require(element_size) ;
+    require(capacity) ;
+    require(capacity < invalid_pool_index) ;
+
+    size_t const elements_size  = (((size_t)element_size * capacity) + 15) & ~((size_t)15) ;
+    size_t const indices_size   = sizeof(uint32_t) * capacity ;
+    size_t const total_size     = elements_size + 4 * indices_size ;
+
+    uint8_t * m = alloc_memory(uint8_t, total_size) ;
+    if(check(m))
+    {
+        return false ;
+    }
+
+    out_pool->memory_           = m ;
+    out_pool->elements_         = m ;
+    out_pool->dense_to_slot_    = (uint32_t *)(m + elements_size) ;
+    out_pool->slot_to_dense_    = (uint32_t *)(m + elements_size + 1 * indices_size) ;
+    out_pool->generations_      = (uint32_t *)(m + elements_size + 2 * indices_size) ;
+    out_pool->next_free_slot_   = (uint32_t *)(m + elements_size + 3 * indices_size) ;
+    out_pool->element_size_     = element_size ;
+    out_pool->capacity_         = capacity ;
+
+    SDL_memset(out_pool->elements_, 0, elements_size) ;
+
+    // generation 0 is never handed out, so a zeroed handle is always invalid.
+    for(
+        uint32_t i = 0
+    ;   i < capacity
+    ;   ++i
+    )
+    {
+        out_pool->generations_[i] = 1 ;
+    }
+
+    reset_pool_slots(out_pool) ;
+
+    return true ;
+}
+
+
+bool
+create_stable_pool(
+    pool *          out_pool
+,   uint32_t const  element_size
+,   uint32_t const  capacity
+)
+{
+    require(out_pool) ;
+
+    if(check(create_pool(out_pool, element_size, capacity)))
+    {
+        return false ;
+    }
+
+    out_pool->stable_ = true ;
+    return true ;
+}
+
+
+void
+destroy_pool(
+    pool *  p
+)
+{
+    require(p) ;
+
+    if(p->memory_)
+    {
+        free_memory(p->memory_) ;
+    }
+
+    SDL_memset(p, 0, sizeof(pool)) ;
+}
+
+
+void
+clear_pool(
+    pool *  p
+)
+{
+    require(p) ;
+    require(p->memory_) ;
+
+    // every live handle goes stale.
+    for(
+        uint32_t i = 0
+    ;   i < p->count_
+    ;   ++i
+    )
+    {
+        uint32_t const s = p->dense_to_slot_[i] ;
+        p->generations_[s] = next_generation(p->generations_[s]) ;
+    }
+
+    reset_pool_slots(p) ;
+}
+
+
+pool_handle
+alloc_pool_element(
+    pool *  p
+)
+{
+    require(p) ;
+    require(p->memory_) ;
+
+    pool_handle h = { invalid_pool_index, 0 } ;
+
+    if(p->free_slot_ == invalid_pool_index)
+    {
+        return h ;
+    }
+
+    uint32_t const s = p->free_slot_ ;
+    uint32_t const d = p->count_++ ;
+    require(d < p->capacity_) ;
+
+    p->free_slot_           = p->next_free_slot_[s] ;
+    p->next_free_slot_[s]   = invalid_pool_index ;
+    p->slot_to_dense_[s]    = d ;
+    p->dense_to_slot_[d]    = s ;
+
+    SDL_memset(get_element_address(p, d), 0, p->element_size_) ;
+
+    h.index_        = s ;
+    h.generation_   = p->generations_[s] ;
+    return h ;
+}
+
+
+bool
+free_pool_element(
+    pool *              p
+,   pool_handle const   h
+)
+{
+    require(p) ;
+
+    if(!is_pool_handle_valid(p, h))
+    {
+        return false ;
+    }
+
+    uint32_t const s    = h.index_ ;
+    uint32_t const d    = p->slot_to_dense_[s] ;
+    uint32_t const last = --p->count_ ;
+
+    if(d != last)
+    {
+        uint32_t const ls = p->dense_to_slot_[last] ;
+        if(!p->stable_)
+        {
+            SDL_memcpy(
+                p->elements_ + (size_t)d * p->element_size_
+            ,   p->elements_ + (size_t)last * p->element_size_
+            ,   p->element_size_
+            ) ;
+        }
+        p->dense_to_slot_[d]    = ls ;
+        p->slot_to_dense_[ls]   = d ;
+    }
+
+    p->dense_to_slot_[last] = invalid_pool_index ;
+    p->slot_to_dense_[s]    = invalid_pool_index ;
+    p->generations_[s]      = next_generation(p->generations_[s]) ;
+    p->next_free_slot_[s]   = p->free_slot_ ;
+    p->free_slot_           = s ;
+
+    return true ;
+}
+
+
+bool
+is_pool_handle_valid(
+    pool const *        p
+,   pool_handle const   h
+)
+{
+    require(p) ;
+
+    return
+        h.index_ < p->capacity_
+    &&  h.generation_ == p->generations_[h.index_]
+    &&  p->slot_to_dense_[h.index_] != invalid_pool_index
+    ;
+}
+
+
+void *
+get_pool_element(
+    pool const *        p
+,   pool_handle const   h
+)
+{
+    require(p) ;
+
+    if(!is_pool_handle_valid(p, h))
+    {
+        return NULL ;
+    }
+
+    return get_element_address(p, p->slot_to_dense_[h.index_]) ;
+}
+
+
+void *
+get_pool_element_at(
+    pool const *    p
+,   uint32_t const  dense_index
+)
+{
+    require(p) ;
+    require(dense_index < p->count_) ;
+
+    return get_element_address(p, dense_index) ;
+}
+
+
+pool_handle
+get_pool_handle_at(
+    pool const *    p
+,   uint32_t const  dense_index
+)
+{
+    require(p) ;
+    require(dense_index < p->count_) ;
+
+    uint32_t const s = p->dense_to_slot_[dense_index] ;
+    pool_handle const h = { s, p->generations_[s] } ;
+    return h ;
+}
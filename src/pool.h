@@ -0,0 +1,119 @@
+#pragma once
+
+
+#include "types.h"
+
+
+// A fixed capacity pool of equally sized elements.
+// Elements are kept densely packed in [0, count_), freeing swaps the last
+// element into the hole. Handles stay valid across those moves, they index a
+// slot table which maps to the dense index and carry a generation counter so
+// stale handles are detected. All memory is allocated once in create_pool.
+// A stable pool, made with create_stable_pool, keeps every element where it
+// was allocated instead, only the dense index tables are swapped. Pointers
+// into it stay valid until the element is freed, but the elements aren't
+// packed, pool_data can't be used on it.
+typedef struct pool_handle
+{
+    uint32_t    index_ ;
+    uint32_t    generation_ ;
+
+} pool_handle ;
+
+
+typedef struct pool
+{
+    uint8_t *   elements_ ;
+    uint32_t *  dense_to_slot_ ;
+    uint32_t *  slot_to_dense_ ;
+    uint32_t *  generations_ ;
+    uint32_t *  next_free_slot_ ;
+    void *      memory_ ;
+    uint32_t    element_size_ ;
+    uint32_t    capacity_ ;
+    uint32_t    count_ ;
+    uint32_t    free_slot_ ;
+    bool        stable_ ;
+
+} pool ;
+
+
+#define invalid_pool_index  UINT32_MAX
+
+
+bool
+create_pool(
+    pool *          out_pool
+,   uint32_t const  element_size
+,   uint32_t const  capacity
+) ;
+
+
+bool
+create_stable_pool(
+    pool *          out_pool
+,   uint32_t const  element_size
+,   uint32_t const  capacity
+) ;
+
+
+void
+destroy_pool(
+    pool *  p
+) ;
+
+
+void
+clear_pool(
+    pool *  p
+) ;
+
+
+pool_handle
+alloc_pool_element(
+    pool *  p
+) ;
+
+
+bool
+free_pool_element(
+    pool *              p
+,   pool_handle const   h
+) ;
+
+
+bool
+is_pool_handle_valid(
+    pool const *        p
+,   pool_handle const   h
+) ;
+
+
+void *
+get_pool_element(
+    pool const *        p
+,   pool_handle const   h
+) ;
+
+
+void *
+get_pool_element_at(
+    pool const *    p
+,   uint32_t const  dense_index
+) ;
+
+
+pool_handle
+get_pool_handle_at(
+    pool const *    p
+,   uint32_t const  dense_index
+) ;
+
+
+#define create_typed_pool(p, t, n)  create_pool(p, sizeof(t), n)
+#define create_typed_stable_pool(p, t, n)   create_stable_pool(p, sizeof(t), n)
+#define pool_get(t, p, h)           ((t *) get_pool_element(p, h))
+#define pool_at(t, p, i)            ((t *) get_pool_element_at(p, i))
+#define pool_data(t, p)             ((t *) (p)->elements_)
+#define pool_count(p)               ((p)->count_)
+#define pool_is_full(p)             ((p)->count_ == (p)->capacity_)
@@ -0,0 +1,241 @@
+#include "render_thread.h"
+#include "app.h"
+#include "gfx.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "log.h"
+#include "startup.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_timer.h>
+
+
+// the main thread goes on after this long even when no frame was drawn.
+#define render_thread_wait_ms   (1000 / app_simulation_hz)
+
+
+// The mailbox is the only thing both threads touch, besides the semaphores
+// and the flags. packet_semaphore_ is signaled for every packet handed over
+// and on quit, drawn_semaphore_ for every frame drawn. draw_ticks_ is
+// written before drawn_semaphore_ is signaled and only read after waiting
+// for it.
+typedef struct render_thread
+{
+    SDL_Thread *        thread_ ;
+    SDL_Semaphore *     packet_semaphore_ ;
+    SDL_Semaphore *     drawn_semaphore_ ;
+    SDL_AtomicInt       quit_ ;
+    SDL_AtomicInt       failed_ ;
+    frame_mailbox       mailbox_ ;
+    uint64_t            wait_ticks_ ;
+    uint64_t            draw_ticks_ ;
+
+} render_thread ;
+
+
+static render_thread rt_ = { 0 } ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static int
+run_render_thread(
+    void *  data
+)
+{
+    (void) data ;
+
+    use_timed_block_storage(timed_block_storage_render) ;
+
+    bool first_frame = true ;
+
+    for(;;)
+    {
+        SDL_WaitSemaphore(rt_.packet_semaphore_) ;
+
+        if(SDL_GetAtomicInt(&rt_.quit_))
+        {
+            return 0 ;
+        }
+
+        // the packet signaled was already taken with one before it.
+        frame_packet const * fp = take_frame_packet(&rt_.mailbox_) ;
+        if(!fp)
+        {
+            continue ;
+        }
+
+        uint64_t const draw_begin = SDL_GetPerformanceCounter() ;
+
+        if(check(draw_gfx(fp)))
+        {
+            SDL_SetAtomicInt(&rt_.failed_, 1) ;
+            SDL_SignalSemaphore(rt_.drawn_semaphore_) ;
+
+            // the main thread may be waiting for events.
+            SDL_Event e = { 0 } ;
+            e.type = SDL_EVENT_USER ;
+            SDL_PushEvent(&e) ;
+            return 1 ;
+        }
+
+        // startup ends with the first frame drawn.
+        if(first_frame)
+        {
+            first_frame = false ;
+            end_startup_timeline() ;
+        }
+
+        rt_.draw_ticks_ = SDL_GetPerformanceCounter() - draw_begin ;
+        SDL_SignalSemaphore(rt_.drawn_semaphore_) ;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_render_thread(
+    uint32_t const  instances_capacity
+)
+{
+    require(!rt_.thread_) ;
+    begin_timed_block() ;
+
+    SDL_SetAtomicInt(&rt_.quit_, 0) ;
+    SDL_SetAtomicInt(&rt_.failed_, 0) ;
+
+    if(check(create_frame_mailbox(&rt_.mailbox_, instances_capacity)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    rt_.packet_semaphore_ = SDL_CreateSemaphore(0) ;
+    if(check_sdl(rt_.packet_semaphore_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    rt_.drawn_semaphore_ = SDL_CreateSemaphore(0) ;
+    if(check_sdl(rt_.drawn_semaphore_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    rt_.thread_ = SDL_CreateThread(run_render_thread, "render", NULL) ;
+    if(check_sdl(rt_.thread_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+void
+destroy_render_thread()
+{
+    begin_timed_block() ;
+
+    if(rt_.thread_)
+    {
+        SDL_SetAtomicInt(&rt_.quit_, 1) ;
+        SDL_SignalSemaphore(rt_.packet_semaphore_) ;
+        SDL_WaitThread(rt_.thread_, NULL) ;
+        rt_.thread_ = NULL ;
+    }
+
+    if(rt_.drawn_semaphore_)
+    {
+        SDL_DestroySemaphore(rt_.drawn_semaphore_) ;
+        rt_.drawn_semaphore_ = NULL ;
+    }
+
+    if(rt_.packet_semaphore_)
+    {
+        SDL_DestroySemaphore(rt_.packet_semaphore_) ;
+        rt_.packet_semaphore_ = NULL ;
+    }
+
+    destroy_frame_mailbox(&rt_.mailbox_) ;
+
+    end_timed_block() ;
+}
+
+
+frame_packet *
+get_render_thread_packet()
+{
+    require(rt_.thread_) ;
+    return get_back_frame_packet(&rt_.mailbox_) ;
+}
+
+
+bool
+put_render_thread_packet(
+    bool const  every_frame
+)
+{
+    require(rt_.thread_) ;
+    begin_timed_block() ;
+
+    // the render thread is gone, nothing would signal the wait below.
+    if(SDL_GetAtomicInt(&rt_.failed_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    uint64_t const wait_begin = SDL_GetPerformanceCounter() ;
+
+    // a frame which was drawn after the last wait timed out is still
+    // counted, without taking it the wait below would return right away.
+    for( ; SDL_TryWaitSemaphore(rt_.drawn_semaphore_) ; )
+    {
+    }
+
+    put_frame_packet(&rt_.mailbox_) ;
+    SDL_SignalSemaphore(rt_.packet_semaphore_) ;
+
+    // one frame drawn for every packet, the one before this was taken and
+    // this one can't be replaced before it is.
+    if(every_frame)
+    {
+        SDL_WaitSemaphore(rt_.drawn_semaphore_) ;
+    }
+    else
+    {
+        SDL_WaitSemaphoreTimeout(rt_.drawn_semaphore_, render_thread_wait_ms) ;
+    }
+
+    rt_.wait_ticks_ = SDL_GetPerformanceCounter() - wait_begin ;
+
+    end_timed_block() ;
+    return !SDL_GetAtomicInt(&rt_.failed_) ;
+}
+
+
+void
+get_render_thread_ticks(
+    uint64_t *  out_wait_ticks
+,   uint64_t *  out_draw_ticks
+)
+{
+    require(out_wait_ticks) ;
+    require(out_draw_ticks) ;
+
+    *out_wait_ticks = rt_.wait_ticks_ ;
+    *out_draw_ticks = rt_.draw_ticks_ ;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+
+#include "types.h"
+#include "frame_packet.h"
+
+
+// Draws on a thread of its own. The main thread pumps events, simulates and
+// hands a frame packet over once per frame, the render thread waits for the
+// fences, records, submits and presents the newest packet it got. A fence
+// wait or a blocking present only holds up the render thread.
+// The render thread has timed block storage of its own, its blocks, e.g.
+// draw_gfx, are only seen by get_timed_block_stats called on it.
+// A packet holds up to instances_capacity sprite instances.
+bool
+create_render_thread(
+    uint32_t const  instances_capacity
+) ;
+
+
+void
+destroy_render_thread() ;
+
+
+// The packet to fill for the next frame, from the main thread.
+frame_packet *
+get_render_thread_packet() ;
+
+
+// Hands the packet over and waits until a frame was drawn, for one
+// simulation step at most, so the main thread neither spins nor waits for
+// the gpu. With every_frame set it waits as long as it takes, then every
+// packet is drawn and the frames are the same from run to run. False when
+// drawing failed on the render thread.
+bool
+put_render_thread_packet(
+    bool const  every_frame
+) ;
+
+
+// How long the last put_render_thread_packet waited and how long drawing the
+// packet took, in performance counter ticks. The draw time is only the one of
+// that packet after a put with every_frame set.
+void
+get_render_thread_ticks(
+    uint64_t *  out_wait_ticks
+,   uint64_t *  out_draw_ticks
+) ;
@@ -0,0 +1,358 @@
+#include "shader_watch.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "log.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_process.h>
+#include <SDL3/SDL_events.h>
+
+
+#define shader_watch_interval_ms    250
+
+
+typedef struct shader_watch_file
+{
+    char        src_[max_shader_watch_name] ;
+    char        dst_[max_shader_watch_name] ;
+    SDL_Time    modify_time_ ;
+
+} shader_watch_file ;
+
+
+// The thread owns files_, compiled_ is handed over under the mutex. Like the
+// job workers the thread must not log or use the app allocator.
+typedef struct shader_watch
+{
+    SDL_Thread *        thread_ ;
+    SDL_Semaphore *     quit_semaphore_ ;
+    SDL_AtomicInt       quit_ ;
+    SDL_Mutex *         mutex_ ;
+
+    char                src_dir_[max_shader_watch_name] ;
+    char                dst_dir_[max_shader_watch_name] ;
+
+    shader_watch_file   files_[max_shader_watch_files] ;
+    uint32_t            files_count_ ;
+
+    char                compiled_[max_shader_watch_files][max_shader_watch_name] ;
+    bool                compiled_okay_[max_shader_watch_files] ;
+    uint32_t            compiled_count_ ;
+
+} shader_watch ;
+
+
+static shader_watch sw_ = { 0 } ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static bool
+is_shader_source(
+    char const * const  name
+)
+{
+    require(name) ;
+
+    size_t const n = SDL_strlen(name) ;
+    if(n < 5)
+    {
+        return false ;
+    }
+
+    return
+        0 == SDL_strcmp(name + n - 5, ".vert")
+    ||  0 == SDL_strcmp(name + n - 5, ".frag")
+    ;
+}
+
+
+static bool
+compile_shader(
+    shader_watch_file const *   f
+)
+{
+    require(f) ;
+
+    // no shell involved, the names don't need quoting.
+    char const * args[] =
+    {
+        "glslc"
+    ,   f->src_
+    ,   "-o"
+    ,   f->dst_
+    ,   NULL
+    } ;
+
+    SDL_Process * p = SDL_CreateProcess(args, false) ;
+    if(!p)
+    {
+        return false ;
+    }
+
+    int exit_code = -1 ;
+    bool const waited = SDL_WaitProcess(p, true, &exit_code) ;
+    SDL_DestroyProcess(p) ;
+
+    return waited && 0 == exit_code ;
+}
+
+
+static void
+push_compiled_shader(
+    shader_watch_file const *   f
+,   bool const                  okay
+)
+{
+    require(f) ;
+
+    SDL_LockMutex(sw_.mutex_) ;
+
+    // saved twice before the frame picked it up, once is enough.
+    uint32_t i = 0 ;
+    for( ; i < sw_.compiled_count_ ; ++i)
+    {
+        if(0 == SDL_strcmp(sw_.compiled_[i], f->dst_))
+        {
+            break ;
+        }
+    }
+
+    // every file is queued once at most, there is always room.
+    require(i < max_shader_watch_files) ;
+    if(i == sw_.compiled_count_)
+    {
+        SDL_strlcpy(sw_.compiled_[i], f->dst_, max_shader_watch_name) ;
+        ++sw_.compiled_count_ ;
+    }
+    sw_.compiled_okay_[i] = okay ;
+
+    SDL_UnlockMutex(sw_.mutex_) ;
+
+    // without focus the app waits for events, this one gets a frame drawn.
+    SDL_Event e = { 0 } ;
+    e.type = SDL_EVENT_USER ;
+    SDL_PushEvent(&e) ;
+}
+
+
+static void
+scan_shader_sources(
+    bool const  compile_changed
+)
+{
+    int names_count = 0 ;
+    char ** names = SDL_GlobDirectory(sw_.src_dir_, NULL, 0, &names_count) ;
+    if(!names)
+    {
+        return ;
+    }
+
+    for(
+        int i = 0
+    ;   i < names_count
+    ;   ++i
+    )
+    {
+        if(!is_shader_source(names[i]))
+        {
+            continue ;
+        }
+
+        char src[max_shader_watch_name] ;
+        SDL_snprintf(src, sizeof(src), "%s/%s", sw_.src_dir_, names[i]) ;
+
+        SDL_PathInfo info = { 0 } ;
+        if(!SDL_GetPathInfo(src, &info) || SDL_PATHTYPE_FILE != info.type)
+        {
+            continue ;
+        }
+
+        shader_watch_file * f = NULL ;
+        for(
+            uint32_t j = 0
+        ;   j < sw_.files_count_
+        ;   ++j
+        )
+        {
+            if(0 == SDL_strcmp(sw_.files_[j].src_, src))
+            {
+                f = &sw_.files_[j] ;
+                break ;
+            }
+        }
+
+        // a new file isn't used by anything yet, it is only remembered.
+        if(!f)
+        {
+            if(sw_.files_count_ < max_shader_watch_files)
+            {
+                f = &sw_.files_[sw_.files_count_++] ;
+                SDL_strlcpy(f->src_, src, max_shader_watch_name) ;
+                SDL_snprintf(f->dst_, sizeof(f->dst_), "%s/%s.spv", sw_.dst_dir_, names[i]) ;
+                f->modify_time_ = info.modify_time ;
+            }
+            continue ;
+        }
+
+        if(f->modify_time_ == info.modify_time)
+        {
+            continue ;
+        }
+        f->modify_time_ = info.modify_time ;
+
+        if(compile_changed)
+        {
+            push_compiled_shader(f, compile_shader(f)) ;
+        }
+    }
+
+    SDL_free(names) ;
+}
+
+
+static int
+run_shader_watch(
+    void *  data
+)
+{
+    (void) data ;
+
+    // the first scan only takes the times, what is there is already built.
+    scan_shader_sources(false) ;
+
+    for(;;)
+    {
+        SDL_WaitSemaphoreTimeout(sw_.quit_semaphore_, shader_watch_interval_ms) ;
+
+        if(SDL_GetAtomicInt(&sw_.quit_))
+        {
+            return 0 ;
+        }
+
+        scan_shader_sources(true) ;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_shader_watch(
+    char const * const  src_dir
+,   char const * const  dst_dir
+)
+{
+    require(src_dir) ;
+    require(dst_dir) ;
+    require(!sw_.thread_) ;
+    begin_timed_block() ;
+
+    SDL_PathInfo info = { 0 } ;
+    if(!SDL_GetPathInfo(src_dir, &info) || SDL_PATHTYPE_DIRECTORY != info.type)
+    {
+        log_info("%s not found, shaders are not reloaded.", src_dir) ;
+        end_timed_block() ;
+        return true ;
+    }
+
+    SDL_strlcpy(sw_.src_dir_, src_dir, max_shader_watch_name) ;
+    SDL_strlcpy(sw_.dst_dir_, dst_dir, max_shader_watch_name) ;
+    SDL_SetAtomicInt(&sw_.quit_, 0) ;
+
+    sw_.mutex_ = SDL_CreateMutex() ;
+    if(check_sdl(sw_.mutex_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    sw_.quit_semaphore_ = SDL_CreateSemaphore(0) ;
+    if(check_sdl(sw_.quit_semaphore_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    sw_.thread_ = SDL_CreateThread(run_shader_watch, "shader_watch", NULL) ;
+    if(check_sdl(sw_.thread_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    log_debug("watching %s for shader changes.", src_dir) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+void
+destroy_shader_watch()
+{
+    if(sw_.thread_)
+    {
+        SDL_SetAtomicInt(&sw_.quit_, 1) ;
+        SDL_SignalSemaphore(sw_.quit_semaphore_) ;
+        SDL_WaitThread(sw_.thread_, NULL) ;
+        sw_.thread_ = NULL ;
+    }
+
+    if(sw_.quit_semaphore_)
+    {
+        SDL_DestroySemaphore(sw_.quit_semaphore_) ;
+        sw_.quit_semaphore_ = NULL ;
+    }
+
+    if(sw_.mutex_)
+    {
+        SDL_DestroyMutex(sw_.mutex_) ;
+        sw_.mutex_ = NULL ;
+    }
+
+    sw_.files_count_    = 0 ;
+    sw_.compiled_count_ = 0 ;
+}
+
+
+bool
+take_compiled_shader(
+    char *          out_name
+,   uint32_t const  out_name_size
+,   bool *          out_okay
+)
+{
+    require(out_name) ;
+    require(out_name_size) ;
+    require(out_okay) ;
+
+    if(!sw_.thread_)
+    {
+        return false ;
+    }
+
+    SDL_LockMutex(sw_.mutex_) ;
+
+    bool const taken = sw_.compiled_count_ > 0 ;
+    if(taken)
+    {
+        // the order doesn't matter, the last one fills the gap.
+        --sw_.compiled_count_ ;
+        SDL_strlcpy(out_name, sw_.compiled_[0], out_name_size) ;
+        *out_okay = sw_.compiled_okay_[0] ;
+        SDL_memcpy(sw_.compiled_[0], sw_.compiled_[sw_.compiled_count_], max_shader_watch_name) ;
+        sw_.compiled_okay_[0] = sw_.compiled_okay_[sw_.compiled_count_] ;
+    }
+
+    SDL_UnlockMutex(sw_.mutex_) ;
+
+    return taken ;
+}
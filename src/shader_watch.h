@@ -0,0 +1,34 @@
+#pragma once
+
+
+#include "types.h"
+
+
+#define max_shader_watch_files  32
+#define max_shader_watch_name   128
+
+
+// Polls the glsl sources in src_dir on a thread of its own and compiles the
+// ones that changed with glslc into dst_dir, where rebuild_shaders.py puts
+// them as well. Only the spir-v files are written, loading them is up to
+// the caller of take_compiled_shader.
+bool
+create_shader_watch(
+    char const * const  src_dir
+,   char const * const  dst_dir
+) ;
+
+
+void
+destroy_shader_watch() ;
+
+
+// Takes the next shader the watch has compiled, false when there is none.
+// out_name is the spir-v file, named like the shaders are loaded, and
+// out_okay is false when glslc failed, glslc reports why on stderr.
+bool
+take_compiled_shader(
+    char *          out_name
+,   uint32_t const  out_name_size
+,   bool *          out_okay
+) ;
@@ -0,0 +1,64 @@
+#version 450
+
+
+layout(push_constant) uniform PushConstants {
+    vec2 uv_scale_ ;
+    vec2 texel_ ;
+} pc;
+
+layout(location = 0) in vec2 fragUv;
+layout(location = 0) out vec4 outColor;
+
+layout(binding = 0) uniform sampler2D sceneSampler;
+
+
+float luma(vec3 c) {
+    return dot(c, vec3(0.299f, 0.587f, 0.114f)) ;
+}
+
+// only the drawn part of the scene image, uv_scale_ of it.
+vec3 fetch(vec2 uv) {
+    vec2 h = 0.5f * pc.texel_ ;
+    return texture(sceneSampler, clamp(uv, h, pc.uv_scale_ - h)).xyz ;
+}
+
+// a cut down fxaa. An edge is found by the luma of the diagonal neighbours,
+// the pixel is blurred along it, and not at all where the contrast is low.
+void main() {
+    vec2 t = pc.texel_ ;
+
+    vec3  m     = fetch(fragUv) ;
+    float lm    = luma(m) ;
+    float lnw   = luma(fetch(fragUv + vec2(-t.x, -t.y))) ;
+    float lne   = luma(fetch(fragUv + vec2( t.x, -t.y))) ;
+    float lsw   = luma(fetch(fragUv + vec2(-t.x,  t.y))) ;
+    float lse   = luma(fetch(fragUv + vec2( t.x,  t.y))) ;
+
+    float lmin  = min(lm, min(min(lnw, lne), min(lsw, lse))) ;
+    float lmax  = max(lm, max(max(lnw, lne), max(lsw, lse))) ;
+
+    if(lmax - lmin < max(0.0625f, 0.125f * lmax)) {
+        outColor = vec4(m, 1.0f) ;
+        return ;
+    }
+
+    vec2 dir = vec2(
+        (lsw + lse) - (lnw + lne)
+    ,   (lnw + lsw) - (lne + lse)
+    ) ;
+    float reduce    = max(0.03125f * (lnw + lne + lsw + lse), 1.0f / 128.0f) ;
+    float rcp       = 1.0f / (min(abs(dir.x), abs(dir.y)) + reduce) ;
+    dir = clamp(dir * rcp, vec2(-8.0f), vec2(8.0f)) * t ;
+
+    vec3 a = 0.5f * (
+        fetch(fragUv + dir * (1.0f / 3.0f - 0.5f))
+    +   fetch(fragUv + dir * (2.0f / 3.0f - 0.5f))
+    ) ;
+    vec3 b = 0.5f * a + 0.25f * (
+        fetch(fragUv - 0.5f * dir)
+    +   fetch(fragUv + 0.5f * dir)
+    ) ;
+
+    float lb = luma(b) ;
+    outColor = vec4((lb < lmin || lb > lmax) ? a : b, 1.0f) ;
+}
@@ -0,0 +1,17 @@
+#version 450
+
+
+layout(push_constant) uniform PushConstants {
+    vec2 uv_scale_ ;
+    vec2 texel_ ;
+} pc;
+
+layout(location = 0) out vec2 fragUv;
+
+
+// one triangle covering the window, corners come from gl_VertexIndex.
+void main() {
+    vec2 corner = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2) ;
+    gl_Position = vec4(corner * 2.0f - 1.0f, 0.0f, 1.0f) ;
+    fragUv      = corner * pc.uv_scale_ ;
+}
@@ -1,9 +1,13 @@
 #version 450
 
+// vulkan_rob_test turns it on, it uploads proj * view * model as all.
+layout(constant_id = 0) const bool use_all = false ;
+
 layout(binding = 0) uniform UniformBufferObject {
     mat4 model;
     mat4 view;
     mat4 proj;
+    mat4 all;
 } ubo;
 
 layout(location = 0) in vec3 inPosition;
@@ -15,7 +19,11 @@ layout(location = 1) out vec2 fragTex;
 
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0) ;
+    if(use_all) {
+        gl_Position = ubo.all * vec4(inPosition, 1.0) ;
+    } else {
+        gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0) ;
+    }
     fragColor = inColor ;
     fragTex = inTex ;
 }
@@ -1,23 +0,0 @@
-#version 450
-
-layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
-    mat4 view;
-    mat4 proj;
-    mat4 all;
-} ubo;
-
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec2 inTex;
-
-layout(location = 0) out vec3 fragColor;
-layout(location = 1) out vec2 fragTex;
-
-
-void main() {
-    //gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0) ;
-    gl_Position = ubo.all * vec4(inPosition, 1.0) ;
-    fragColor = inColor ;
-    fragTex = inTex ;
-}
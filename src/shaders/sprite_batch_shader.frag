@@ -0,0 +1,28 @@
+#version 450
+
+layout(location = 0) in vec2 fragTex;
+layout(location = 1) in vec4 fragColor;
+layout(location = 0) out vec4 outColor;
+
+layout(binding = 1) uniform sampler2D texSampler;
+
+layout(constant_id = 0) const float alpha_cutoff = 0.1 ;
+// the atlases hold premultiplied alpha, blended without any discard.
+layout(constant_id = 1) const bool premultiplied_alpha = false ;
+
+void main() {
+    vec4 texel = texture(texSampler, fragTex) ;
+    if(premultiplied_alpha)
+    {
+        // the tint stays straight alpha, weight its color like the texels.
+        outColor = texel * vec4(fragColor.rgb * fragColor.a, fragColor.a) ;
+    }
+    else
+    {
+        outColor = texel * fragColor ;
+        if(outColor.w < alpha_cutoff)
+        {
+           discard ;
+        }
+    }
+}
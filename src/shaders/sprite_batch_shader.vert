@@ -0,0 +1,35 @@
+#version 450
+
+
+layout(binding = 0) uniform UniformBufferObject {
+    vec2 offset_ ;
+    vec2 scale_ ;
+} ubo;
+
+// one instance per sprite, the four corners are transformed on the cpu.
+// the hull vertex is placed inside of them, s | t << 16 in 16 bit units.
+layout(location = 0) in vec4 inPos01;
+layout(location = 1) in vec4 inPos23;
+layout(location = 2) in vec4 inTex01;
+layout(location = 3) in vec4 inTex23;
+layout(location = 4) in uvec4 inSt0123;
+layout(location = 5) in uvec4 inSt4567;
+layout(location = 6) in vec4 inColor;
+// layer and depth, opaque sprites write it, translucent ones test against it.
+layout(location = 7) in float inZ;
+
+layout(location = 0) out vec2 fragTex;
+layout(location = 1) out vec4 fragColor;
+
+
+void main() {
+    uint st     = gl_VertexIndex < 4 ? inSt0123[gl_VertexIndex & 3] : inSt4567[gl_VertexIndex & 3] ;
+    float s     = float(st & 0xffffu) / 65535.0f ;
+    float t     = float(st >> 16) / 65535.0f ;
+    vec2 pos    = mix(mix(inPos01.xy, inPos01.zw, s), mix(inPos23.zw, inPos23.xy, s), t) ;
+    vec2 tex    = mix(mix(inTex01.xy, inTex01.zw, s), mix(inTex23.zw, inTex23.xy, s), t) ;
+    vec2 p      = (pos - ubo.offset_) * ubo.scale_ ;
+    gl_Position = vec4(p, inZ, 1.0f) ;
+    fragTex     = tex ;
+    fragColor   = inColor ;
+}
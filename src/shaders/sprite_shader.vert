@@ -1,7 +1,8 @@
 #version 450
 
 
-const int max_instance = 32 ;
+// set to max_ubo_instance_count by vulkan_rob_sprite.
+layout(constant_id = 0) const int max_instance = 32 ;
 
 layout(binding = 0) uniform UniformBufferObject {
     vec2 offset_ ;
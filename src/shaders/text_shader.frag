@@ -0,0 +1,13 @@
+#version 450
+
+layout(location = 0) in vec2 fragTex;
+layout(location = 1) in vec4 fragColor;
+layout(location = 2) in float fragSolid;
+layout(location = 0) out vec4 outColor;
+
+layout(binding = 1) uniform sampler2D texSampler;
+
+void main() {
+    float coverage = fragSolid > 0.5f ? 1.0f : texture(texSampler, fragTex).w ;
+    outColor = vec4(fragColor.xyz, fragColor.w * coverage) ;
+}
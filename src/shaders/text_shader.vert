@@ -0,0 +1,30 @@
+#version 450
+
+
+layout(binding = 0) uniform UniformBufferObject {
+    vec2 offset_ ;
+    vec2 scale_ ;
+} ubo;
+
+// one instance per glyph or solid rect, corners come from gl_VertexIndex.
+layout(location = 0) in vec4 inRect;
+layout(location = 1) in vec4 inTex;
+layout(location = 2) in vec4 inColor;
+
+layout(location = 0) out vec2 fragTex;
+layout(location = 1) out vec4 fragColor;
+layout(location = 2) out float fragSolid;
+
+
+void main() {
+    vec2 corner = vec2(
+        (gl_VertexIndex == 1 || gl_VertexIndex == 2) ? 1.0f : 0.0f
+    ,   (gl_VertexIndex == 2 || gl_VertexIndex == 3) ? 1.0f : 0.0f
+    ) ;
+    vec2 pos    = inRect.xy + corner * inRect.zw ;
+    vec2 p      = (pos - ubo.offset_) * ubo.scale_ ;
+    gl_Position = vec4(p, 0.0f, 1.0f) ;
+    fragTex     = mix(inTex.xy, inTex.zw, corner) ;
+    fragColor   = inColor ;
+    fragSolid   = inTex.x < 0.0f ? 1.0f : 0.0f ;
+}
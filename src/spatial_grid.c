@@ -0,0 +1,819 @@
+#include "spatial_grid.h"
+#include "app.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "job.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+
+// below this many items a single thread is faster than waking the workers.
+#define spatial_grid_min_range  1024
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static size_t
+align_16(
+    size_t const    s
+)
+{
+    return (s + 15) & ~((size_t)15) ;
+}
+
+
+static uint32_t
+hash_cell(
+    spatial_grid const *    sg
+,   int32_t const           cx
+,   int32_t const           cy
+)
+{
+    uint32_t const h = ((uint32_t) cx * 73856093u) ^ ((uint32_t) cy * 19349663u) ;
+    return h & (sg->buckets_count_ - 1) ;
+}
+
+
+static int32_t
+to_cell(
+    spatial_grid const *    sg
+,   float const             v
+)
+{
+    return (int32_t) SDL_floorf(v * sg->inverse_cell_size_) ;
+}
+
+
+static bool
+is_circle_in_rect(
+    float const x
+,   float const y
+,   float const r
+,   float const left
+,   float const top
+,   float const right
+,   float const bottom
+)
+{
+    return
+        x + r >= left
+    &&  x - r <= right
+    &&  y + r >= top
+    &&  y - r <= bottom
+    ;
+}
+
+
+static bool
+is_circle_overlap(
+    spatial_grid const *    sg
+,   uint32_t const          a
+,   uint32_t const          b
+)
+{
+    float const dx = sg->item_x_[a] - sg->item_x_[b] ;
+    float const dy = sg->item_y_[a] - sg->item_y_[b] ;
+    float const rr = sg->item_r_[a] + sg->item_r_[b] ;
+    return dx * dx + dy * dy <= rr * rr ;
+}
+
+
+static uint32_t
+next_stamp(
+    spatial_grid *  sg
+)
+{
+    if(!++sg->stamp_)
+    {
+        SDL_memset(sg->item_stamps_, 0, sizeof(uint32_t) * sg->capacity_) ;
+        sg->stamp_ = 1 ;
+    }
+    return sg->stamp_ ;
+}
+
+
+static bool
+is_oversize(
+    spatial_grid_cells const *  c
+)
+{
+    int64_t const w = (int64_t) c->x1_ - c->x0_ + 1 ;
+    int64_t const h = (int64_t) c->y1_ - c->y0_ + 1 ;
+    return w * h > max_spatial_grid_item_cells ;
+}
+
+
+// a spilled item looks oversize from then on, like the others on that list.
+static void
+mark_oversize(
+    spatial_grid_cells *    c
+)
+{
+    c->x0_ = 0 ;
+    c->y0_ = 0 ;
+    c->x1_ = max_spatial_grid_item_cells ;
+    c->y1_ = 0 ;
+}
+
+
+static void
+count_chunks_range(
+    void *          param
+,   uint32_t const  begin
+,   uint32_t const  end
+)
+{
+    spatial_grid * sg = (spatial_grid *) param ;
+
+    for(
+        uint32_t j = begin
+    ;   j < end
+    ;   ++j
+    )
+    {
+        spatial_grid_chunk *    ch      = &sg->chunks_[j] ;
+        uint32_t *              counts  = &sg->chunk_counts_[j * sg->buckets_count_] ;
+
+        SDL_memset(counts, 0, sizeof(uint32_t) * sg->buckets_count_) ;
+        ch->entries_count_  = 0 ;
+        ch->oversize_count_ = 0 ;
+        ch->spilled_        = false ;
+        ch->left_           = sg->item_x_[ch->begin_] - sg->item_r_[ch->begin_] ;
+        ch->top_            = sg->item_y_[ch->begin_] - sg->item_r_[ch->begin_] ;
+        ch->right_          = sg->item_x_[ch->begin_] + sg->item_r_[ch->begin_] ;
+        ch->bottom_         = sg->item_y_[ch->begin_] + sg->item_r_[ch->begin_] ;
+
+        for(
+            uint32_t i = ch->begin_
+        ;   i < ch->end_
+        ;   ++i
+        )
+        {
+            float const x = sg->item_x_[i] ;
+            float const y = sg->item_y_[i] ;
+            float const r = sg->item_r_[i] ;
+
+            spatial_grid_cells * c = &sg->item_cells_[i] ;
+            c->x0_ = to_cell(sg, x - r) ;
+            c->y0_ = to_cell(sg, y - r) ;
+            c->x1_ = to_cell(sg, x + r) ;
+            c->y1_ = to_cell(sg, y + r) ;
+
+            ch->left_   = x - r < ch->left_ ? x - r : ch->left_ ;
+            ch->top_    = y - r < ch->top_ ? y - r : ch->top_ ;
+            ch->right_  = x + r > ch->right_ ? x + r : ch->right_ ;
+            ch->bottom_ = y + r > ch->bottom_ ? y + r : ch->bottom_ ;
+
+            if(is_oversize(c))
+            {
+                ++ch->oversize_count_ ;
+                continue ;
+            }
+
+            for(int32_t cy = c->y0_ ; cy <= c->y1_ ; ++cy)
+            {
+                for(int32_t cx = c->x0_ ; cx <= c->x1_ ; ++cx)
+                {
+                    ++counts[hash_cell(sg, cx, cy)] ;
+                }
+            }
+            ch->entries_count_ += (uint32_t) ((c->x1_ - c->x0_ + 1) * (c->y1_ - c->y0_ + 1)) ;
+        }
+    }
+}
+
+
+static void
+scatter_chunks_range(
+    void *          param
+,   uint32_t const  begin
+,   uint32_t const  end
+)
+{
+    spatial_grid * sg = (spatial_grid *) param ;
+
+    for(
+        uint32_t j = begin
+    ;   j < end
+    ;   ++j
+    )
+    {
+        spatial_grid_chunk const *  ch          = &sg->chunks_[j] ;
+        uint32_t *                  cursors     = &sg->chunk_counts_[j * sg->buckets_count_] ;
+        uint32_t                    oversize    = ch->oversize_start_ ;
+
+        for(
+            uint32_t i = ch->begin_
+        ;   i < ch->end_
+        ;   ++i
+        )
+        {
+            spatial_grid_cells * c = &sg->item_cells_[i] ;
+            if(ch->spilled_)
+            {
+                mark_oversize(c) ;
+            }
+
+            if(is_oversize(c))
+            {
+                sg->oversize_items_[oversize++] = i ;
+                continue ;
+            }
+
+            for(int32_t cy = c->y0_ ; cy <= c->y1_ ; ++cy)
+            {
+                for(int32_t cx = c->x0_ ; cx <= c->x1_ ; ++cx)
+                {
+                    spatial_grid_entry * e = &sg->entries_[cursors[hash_cell(sg, cx, cy)]++] ;
+                    e->item_    = i ;
+                    e->cell_x_  = cx ;
+                    e->cell_y_  = cy ;
+                }
+            }
+        }
+    }
+}
+
+
+static uint32_t
+push_item(
+    spatial_grid *  sg
+,   uint32_t const  item
+,   uint32_t const  stamp
+,   uint32_t *      out_items
+,   uint32_t const  max_items
+,   uint32_t const  count
+)
+{
+    if(sg->item_stamps_[item] == stamp)
+    {
+        return count ;
+    }
+    sg->item_stamps_[item] = stamp ;
+
+    if(count < max_items)
+    {
+        out_items[count] = item ;
+    }
+    return count + 1 ;
+}
+
+
+// with test_circles false every item of a cell the rect touches is taken,
+// the caller tests the circles.
+static uint32_t
+collect_rect_items(
+    spatial_grid *  sg
+,   float const     left
+,   float const     top
+,   float const     right
+,   float const     bottom
+,   bool const      test_circles
+,   uint32_t *      out_items
+,   uint32_t const  max_items
+)
+{
+    require(sg) ;
+    require(out_items || !max_items) ;
+
+    if(!sg->items_count_)
+    {
+        return 0 ;
+    }
+
+    // e.g. the window around a scene which is all on screen.
+    if(
+        left <= sg->items_left_
+    &&  top <= sg->items_top_
+    &&  right >= sg->items_right_
+    &&  bottom >= sg->items_bottom_
+    )
+    {
+        uint32_t const count = sg->items_count_ < max_items ? sg->items_count_ : max_items ;
+        for(
+            uint32_t i = 0
+        ;   i < count
+        ;   ++i
+        )
+        {
+            out_items[i] = i ;
+        }
+        return count ;
+    }
+
+    uint32_t const  stamp   = next_stamp(sg) ;
+    uint32_t        count   = 0 ;
+
+    // cells outside of the items' rect are empty, they aren't looked at.
+    int32_t const rx0 = to_cell(sg, left) ;
+    int32_t const ry0 = to_cell(sg, top) ;
+    int32_t const rx1 = to_cell(sg, right) ;
+    int32_t const ry1 = to_cell(sg, bottom) ;
+    int32_t const ix0 = to_cell(sg, sg->items_left_) ;
+    int32_t const iy0 = to_cell(sg, sg->items_top_) ;
+    int32_t const ix1 = to_cell(sg, sg->items_right_) ;
+    int32_t const iy1 = to_cell(sg, sg->items_bottom_) ;
+
+    int32_t const x0 = rx0 > ix0 ? rx0 : ix0 ;
+    int32_t const y0 = ry0 > iy0 ? ry0 : iy0 ;
+    int32_t const x1 = rx1 < ix1 ? rx1 : ix1 ;
+    int32_t const y1 = ry1 < iy1 ? ry1 : iy1 ;
+
+    int64_t const cells = x0 > x1 || y0 > y1 ? 0 : ((int64_t) x1 - x0 + 1) * ((int64_t) y1 - y0 + 1) ;
+
+    if(cells > sg->buckets_count_)
+    {
+        // more cells than buckets, walking the entries once is cheaper.
+        for(
+            uint32_t i = 0
+        ;   i < sg->entries_count_
+        ;   ++i
+        )
+        {
+            spatial_grid_entry const * e = &sg->entries_[i] ;
+            if(
+                e->cell_x_ < x0 || e->cell_x_ > x1
+            ||  e->cell_y_ < y0 || e->cell_y_ > y1
+            ||  (test_circles && !is_circle_in_rect(sg->item_x_[e->item_], sg->item_y_[e->item_], sg->item_r_[e->item_], left, top, right, bottom))
+            )
+            {
+                continue ;
+            }
+            count = push_item(sg, e->item_, stamp, out_items, max_items, count) ;
+        }
+    }
+    else
+    {
+        for(int32_t cy = y0 ; cy <= y1 ; ++cy)
+        {
+            for(int32_t cx = x0 ; cx <= x1 ; ++cx)
+            {
+                uint32_t const b = hash_cell(sg, cx, cy) ;
+                for(
+                    uint32_t i = sg->bucket_starts_[b]
+                ;   i < sg->bucket_starts_[b + 1]
+                ;   ++i
+                )
+                {
+                    spatial_grid_entry const * e = &sg->entries_[i] ;
+                    if(
+                        e->cell_x_ != cx
+                    ||  e->cell_y_ != cy
+                    ||  (test_circles && !is_circle_in_rect(sg->item_x_[e->item_], sg->item_y_[e->item_], sg->item_r_[e->item_], left, top, right, bottom))
+                    )
+                    {
+                        continue ;
+                    }
+                    count = push_item(sg, e->item_, stamp, out_items, max_items, count) ;
+                }
+            }
+        }
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < sg->oversize_items_count_
+    ;   ++i
+    )
+    {
+        uint32_t const it = sg->oversize_items_[i] ;
+        if(!test_circles || is_circle_in_rect(sg->item_x_[it], sg->item_y_[it], sg->item_r_[it], left, top, right, bottom))
+        {
+            count = push_item(sg, it, stamp, out_items, max_items, count) ;
+        }
+    }
+
+    return count < max_items ? count : max_items ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+uint32_t
+calc_spatial_grid_item_entries(
+    float const cell_size
+,   float const radius
+)
+{
+    require(cell_size > 0.0f) ;
+    require(radius >= 0.0f) ;
+
+    // a span touches one cell more than it fully covers, two when it
+    // straddles both ends.
+    uint32_t const  n       = (uint32_t) SDL_floorf(2.0f * radius / cell_size) + 2 ;
+    uint64_t const  cells   = (uint64_t) n * n ;
+    return cells < max_spatial_grid_item_cells ? (uint32_t) cells : max_spatial_grid_item_cells ;
+}
+
+
+bool
+create_spatial_grid(
+    spatial_grid *  out_grid
+,   float const     cell_size
+,   uint32_t const  buckets_count
+,   uint32_t const  capacity
+,   uint32_t const  entries_capacity
+)
+{
+    require(out_grid) ;
+    require(!out_grid->memory_) ;
+    require(cell_size > 0.0f) ;
+    require(buckets_count) ;
+    require(0 == (buckets_count & (buckets_count - 1))) ;
+    require(capacity) ;
+
+    size_t const buckets_size   = align_16(sizeof(uint32_t) * (buckets_count + 1)) ;
+    size_t const counts_size    = align_16(sizeof(uint32_t) * buckets_count * max_spatial_grid_chunks) ;
+    size_t const entries_size   = align_16(sizeof(spatial_grid_entry) * entries_capacity) ;
+    size_t const floats_size    = align_16(sizeof(float) * capacity) ;
+    size_t const cells_size     = align_16(sizeof(spatial_grid_cells) * capacity) ;
+    size_t const indices_size   = align_16(sizeof(uint32_t) * capacity) ;
+    size_t const total_size     = buckets_size + counts_size + entries_size + 3 * floats_size + cells_size + 2 * indices_size ;
+
+    uint8_t * m = alloc_memory(uint8_t, total_size) ;
+    if(check(m))
+    {
+        return false ;
+    }
+
+    SDL_memset(out_grid, 0, sizeof(spatial_grid)) ;
+    SDL_memset(m, 0, total_size) ;
+
+    out_grid->memory_           = m ;
+    out_grid->bucket_starts_    = (uint32_t *) m ;
+    m += buckets_size ;
+    out_grid->chunk_counts_     = (uint32_t *) m ;
+    m += counts_size ;
+    out_grid->entries_          = (spatial_grid_entry *) m ;
+    m += entries_size ;
+    out_grid->item_x_           = (float *) m ;
+    m += floats_size ;
+    out_grid->item_y_           = (float *) m ;
+    m += floats_size ;
+    out_grid->item_r_           = (float *) m ;
+    m += floats_size ;
+    out_grid->item_cells_       = (spatial_grid_cells *) m ;
+    m += cells_size ;
+    out_grid->item_stamps_      = (uint32_t *) m ;
+    m += indices_size ;
+    out_grid->oversize_items_   = (uint32_t *) m ;
+
+    out_grid->cell_size_            = cell_size ;
+    out_grid->inverse_cell_size_    = 1.0f / cell_size ;
+    out_grid->buckets_count_        = buckets_count ;
+    out_grid->capacity_             = capacity ;
+    out_grid->entries_capacity_     = entries_capacity ;
+
+    return true ;
+}
+
+
+void
+destroy_spatial_grid(
+    spatial_grid *  sg
+)
+{
+    require(sg) ;
+
+    if(sg->memory_)
+    {
+        free_memory(sg->memory_) ;
+    }
+
+    SDL_memset(sg, 0, sizeof(spatial_grid)) ;
+}
+
+
+void
+clear_spatial_grid(
+    spatial_grid *  sg
+)
+{
+    require(sg) ;
+    sg->items_count_            = 0 ;
+    sg->entries_count_          = 0 ;
+    sg->oversize_items_count_   = 0 ;
+}
+
+
+uint32_t
+add_spatial_grid_item(
+    spatial_grid *  sg
+,   float const     x
+,   float const     y
+,   float const     radius
+)
+{
+    require(sg) ;
+    require(radius >= 0.0f) ;
+
+    if(sg->items_count_ >= sg->capacity_)
+    {
+        return UINT32_MAX ;
+    }
+
+    uint32_t const i = sg->items_count_++ ;
+    sg->item_x_[i] = x ;
+    sg->item_y_[i] = y ;
+    sg->item_r_[i] = radius ;
+    return i ;
+}
+
+
+void
+build_spatial_grid(
+    spatial_grid *  sg
+)
+{
+    require(sg) ;
+    begin_timed_block() ;
+
+    uint32_t const n        = sg->items_count_ ;
+    uint32_t const wanted   = (n + spatial_grid_min_range - 1) / spatial_grid_min_range ;
+    sg->chunks_count_       = wanted < max_spatial_grid_chunks ? wanted : max_spatial_grid_chunks ;
+
+    for(
+        uint32_t j = 0
+    ;   j < sg->chunks_count_
+    ;   ++j
+    )
+    {
+        sg->chunks_[j].begin_   = (uint32_t) ((uint64_t) n * j / sg->chunks_count_) ;
+        sg->chunks_[j].end_     = (uint32_t) ((uint64_t) n * (j + 1) / sg->chunks_count_) ;
+    }
+
+    run_parallel_for(count_chunks_range, sg, sg->chunks_count_, 1) ;
+
+    // chunks which don't fit the reserved entries any more go to the
+    // oversize items as a whole.
+    uint32_t entries    = 0 ;
+    uint32_t oversize   = 0 ;
+    sg->spilled_items_count_ = 0 ;
+    for(
+        uint32_t j = 0
+    ;   j < sg->chunks_count_
+    ;   ++j
+    )
+    {
+        spatial_grid_chunk * ch = &sg->chunks_[j] ;
+        if(entries + (uint64_t) ch->entries_count_ > sg->entries_capacity_)
+        {
+            SDL_memset(&sg->chunk_counts_[j * sg->buckets_count_], 0, sizeof(uint32_t) * sg->buckets_count_) ;
+            ch->spilled_                = true ;
+            ch->entries_count_          = 0 ;
+            ch->oversize_count_         = ch->end_ - ch->begin_ ;
+            sg->spilled_items_count_   += ch->end_ - ch->begin_ ;
+        }
+        entries            += ch->entries_count_ ;
+        ch->oversize_start_ = oversize ;
+        oversize           += ch->oversize_count_ ;
+
+        if(0 == j)
+        {
+            sg->items_left_     = ch->left_ ;
+            sg->items_top_      = ch->top_ ;
+            sg->items_right_    = ch->right_ ;
+            sg->items_bottom_   = ch->bottom_ ;
+        }
+        else
+        {
+            sg->items_left_     = ch->left_ < sg->items_left_ ? ch->left_ : sg->items_left_ ;
+            sg->items_top_      = ch->top_ < sg->items_top_ ? ch->top_ : sg->items_top_ ;
+            sg->items_right_    = ch->right_ > sg->items_right_ ? ch->right_ : sg->items_right_ ;
+            sg->items_bottom_   = ch->bottom_ > sg->items_bottom_ ? ch->bottom_ : sg->items_bottom_ ;
+        }
+    }
+    sg->oversize_items_count_ = oversize ;
+
+    // bucket by bucket and chunk by chunk within, the counts turn into where
+    // every chunk starts writing in every bucket. Entries stay in item order.
+    uint32_t sum = 0 ;
+    for(
+        uint32_t b = 0
+    ;   b < sg->buckets_count_
+    ;   ++b
+    )
+    {
+        sg->bucket_starts_[b] = sum ;
+        for(
+            uint32_t j = 0
+        ;   j < sg->chunks_count_
+        ;   ++j
+        )
+        {
+            uint32_t * c = &sg->chunk_counts_[j * sg->buckets_count_ + b] ;
+            uint32_t const count = *c ;
+            *c   = sum ;
+            sum += count ;
+        }
+    }
+    sg->bucket_starts_[sg->buckets_count_] = sum ;
+    sg->entries_count_ = sum ;
+    require(sum == entries) ;
+    require(sum <= sg->entries_capacity_) ;
+
+    run_parallel_for(scatter_chunks_range, sg, sg->chunks_count_, 1) ;
+
+    end_timed_block() ;
+}
+
+
+uint32_t
+query_spatial_grid_rect(
+    spatial_grid *  sg
+,   float const     left
+,   float const     top
+,   float const     right
+,   float const     bottom
+,   uint32_t *      out_items
+,   uint32_t const  max_items
+)
+{
+    begin_timed_block() ;
+    uint32_t const count = collect_rect_items(sg, left, top, right, bottom, true, out_items, max_items) ;
+    end_timed_block() ;
+    return count ;
+}
+
+
+uint32_t
+gather_spatial_grid_rect(
+    spatial_grid *  sg
+,   float const     left
+,   float const     top
+,   float const     right
+,   float const     bottom
+,   uint32_t *      out_items
+,   uint32_t const  max_items
+)
+{
+    begin_timed_block() ;
+    uint32_t const count = collect_rect_items(sg, left, top, right, bottom, false, out_items, max_items) ;
+    end_timed_block() ;
+    return count ;
+}
+
+
+uint32_t
+pick_spatial_grid_point(
+    spatial_grid *  sg
+,   float const     x
+,   float const     y
+,   uint32_t *      out_items
+,   uint32_t const  max_items
+)
+{
+    require(sg) ;
+    require(out_items || !max_items) ;
+
+    uint32_t const  stamp   = next_stamp(sg) ;
+    uint32_t        count   = 0 ;
+
+    int32_t const   cx  = to_cell(sg, x) ;
+    int32_t const   cy  = to_cell(sg, y) ;
+    uint32_t const  b   = hash_cell(sg, cx, cy) ;
+
+    for(
+        uint32_t i = sg->bucket_starts_[b]
+    ;   i < sg->bucket_starts_[b + 1]
+    ;   ++i
+    )
+    {
+        spatial_grid_entry const * e = &sg->entries_[i] ;
+        if(e->cell_x_ != cx || e->cell_y_ != cy)
+        {
+            continue ;
+        }
+
+        float const dx = sg->item_x_[e->item_] - x ;
+        float const dy = sg->item_y_[e->item_] - y ;
+        float const r  = sg->item_r_[e->item_] ;
+        if(dx * dx + dy * dy <= r * r)
+        {
+            count = push_item(sg, e->item_, stamp, out_items, max_items, count) ;
+        }
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < sg->oversize_items_count_
+    ;   ++i
+    )
+    {
+        uint32_t const it = sg->oversize_items_[i] ;
+        float const dx = sg->item_x_[it] - x ;
+        float const dy = sg->item_y_[it] - y ;
+        float const r  = sg->item_r_[it] ;
+        if(dx * dx + dy * dy <= r * r)
+        {
+            count = push_item(sg, it, stamp, out_items, max_items, count) ;
+        }
+    }
+
+    return count < max_items ? count : max_items ;
+}
+
+
+uint32_t
+find_spatial_grid_pairs(
+    spatial_grid const *    sg
+,   uint32_t *              out_pairs
+,   uint32_t const          max_pairs
+)
+{
+    require(sg) ;
+    require(out_pairs || !max_pairs) ;
+    begin_timed_block() ;
+
+    uint32_t count = 0 ;
+
+    for(
+        uint32_t b = 0
+    ;   b < sg->buckets_count_
+    ;   ++b
+    )
+    {
+        uint32_t const s = sg->bucket_starts_[b] ;
+        uint32_t const e = sg->bucket_starts_[b + 1] ;
+
+        for(uint32_t i = s ; i < e ; ++i)
+        {
+            spatial_grid_entry const * ei = &sg->entries_[i] ;
+
+            for(uint32_t j = i + 1 ; j < e ; ++j)
+            {
+                spatial_grid_entry const * ej = &sg->entries_[j] ;
+                if(
+                    ei->cell_x_ != ej->cell_x_
+                ||  ei->cell_y_ != ej->cell_y_
+                )
+                {
+                    continue ;
+                }
+
+                // two items share every cell of the overlap of their cell
+                // rects, only its first cell reports the pair.
+                spatial_grid_cells const * ci = &sg->item_cells_[ei->item_] ;
+                spatial_grid_cells const * cj = &sg->item_cells_[ej->item_] ;
+                int32_t const fx = ci->x0_ > cj->x0_ ? ci->x0_ : cj->x0_ ;
+                int32_t const fy = ci->y0_ > cj->y0_ ? ci->y0_ : cj->y0_ ;
+                if(
+                    ei->cell_x_ != fx
+                ||  ei->cell_y_ != fy
+                ||  !is_circle_overlap(sg, ei->item_, ej->item_)
+                )
+                {
+                    continue ;
+                }
+
+                if(count < max_pairs)
+                {
+                    uint32_t const a = ei->item_ < ej->item_ ? ei->item_ : ej->item_ ;
+                    uint32_t const c = ei->item_ < ej->item_ ? ej->item_ : ei->item_ ;
+                    out_pairs[2 * count + 0] = a ;
+                    out_pairs[2 * count + 1] = c ;
+                }
+                ++count ;
+            }
+        }
+    }
+
+    // oversize items against everything else, each oversize pair once.
+    for(
+        uint32_t i = 0
+    ;   i < sg->oversize_items_count_
+    ;   ++i
+    )
+    {
+        uint32_t const o = sg->oversize_items_[i] ;
+
+        for(
+            uint32_t j = 0
+        ;   j < sg->items_count_
+        ;   ++j
+        )
+        {
+            if(
+                j == o
+            ||  (is_oversize(&sg->item_cells_[j]) && j < o)
+            ||  !is_circle_overlap(sg, o, j)
+            )
+            {
+                continue ;
+            }
+
+            if(count < max_pairs)
+            {
+                out_pairs[2 * count + 0] = o < j ? o : j ;
+                out_pairs[2 * count + 1] = o < j ? j : o ;
+            }
+            ++count ;
+        }
+    }
+
+    end_timed_block() ;
+    return count < max_pairs ? count : max_pairs ;
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+
+#include "types.h"
+
+
+// items which cover more cells than this go to a short list which every
+// query checks, so a few huge items don't blow up the cell entries.
+#define max_spatial_grid_item_cells 16
+
+// the build splits the items into at most this many chunks, every chunk
+// counts its cells into its own row of buckets.
+#define max_spatial_grid_chunks     32
+
+
+typedef struct spatial_grid_entry
+{
+    uint32_t    item_ ;
+    int32_t     cell_x_ ;
+    int32_t     cell_y_ ;
+
+} spatial_grid_entry ;
+
+
+typedef struct spatial_grid_cells
+{
+    int32_t     x0_ ;
+    int32_t     y0_ ;
+    int32_t     x1_ ;
+    int32_t     y1_ ;
+
+} spatial_grid_cells ;
+
+
+// A run of items built by one job. Its row of counts turns into the cursors
+// it scatters its entries with, oversize items go to their own range.
+typedef struct spatial_grid_chunk
+{
+    uint32_t    begin_ ;
+    uint32_t    end_ ;
+    uint32_t    entries_count_ ;
+    uint32_t    oversize_count_ ;
+    uint32_t    oversize_start_ ;
+    bool        spilled_ ;
+    float       left_ ;
+    float       top_ ;
+    float       right_ ;
+    float       bottom_ ;
+
+} spatial_grid_chunk ;
+
+
+// A uniform grid over the plane, cells are hashed into a fixed number of
+// buckets so the grid has no bounds. Items are circles, added between
+// clear_spatial_grid and build_spatial_grid. The build is a counting sort
+// run by the job workers, one chunk of items each: entries of one bucket are
+// contiguous in entries_, in item order, bucket_starts_ has one more element
+// than there are buckets. The entries are reserved up front, a build never
+// allocates. When the items cover more cells than that, whole chunks are
+// spilled to the oversize items, which stays correct but makes every query
+// check them.
+typedef struct spatial_grid
+{
+    float                   cell_size_ ;
+    float                   inverse_cell_size_ ;
+
+    uint32_t                buckets_count_ ;
+    uint32_t *              bucket_starts_ ;
+    uint32_t *              chunk_counts_ ;
+
+    spatial_grid_chunk      chunks_[max_spatial_grid_chunks] ;
+    uint32_t                chunks_count_ ;
+
+    spatial_grid_entry *    entries_ ;
+    uint32_t                entries_count_ ;
+    uint32_t                entries_capacity_ ;
+    uint32_t                spilled_items_count_ ;
+
+    float *                 item_x_ ;
+    float *                 item_y_ ;
+    float *                 item_r_ ;
+    spatial_grid_cells *    item_cells_ ;
+    uint32_t *              item_stamps_ ;
+    uint32_t                items_count_ ;
+    uint32_t                capacity_ ;
+
+    // the rect around all circles, queries don't look at cells outside of it.
+    float                   items_left_ ;
+    float                   items_top_ ;
+    float                   items_right_ ;
+    float                   items_bottom_ ;
+
+    uint32_t *              oversize_items_ ;
+    uint32_t                oversize_items_count_ ;
+
+    uint32_t                stamp_ ;
+    void *                  memory_ ;
+
+} spatial_grid ;
+
+
+// Entries an item of the radius takes at most, times the items gives the
+// entries_capacity of create_spatial_grid.
+uint32_t
+calc_spatial_grid_item_entries(
+    float const cell_size
+,   float const radius
+) ;
+
+
+bool
+create_spatial_grid(
+    spatial_grid *  out_grid
+,   float const     cell_size
+,   uint32_t const  buckets_count
+,   uint32_t const  capacity
+,   uint32_t const  entries_capacity
+) ;
+
+
+void
+destroy_spatial_grid(
+    spatial_grid *  sg
+) ;
+
+
+void
+clear_spatial_grid(
+    spatial_grid *  sg
+) ;
+
+
+// Returns the item index, or UINT32_MAX when the grid is full.
+uint32_t
+add_spatial_grid_item(
+    spatial_grid *  sg
+,   float const     x
+,   float const     y
+,   float const     radius
+) ;
+
+
+void
+build_spatial_grid(
+    spatial_grid *  sg
+) ;
+
+
+// Every item whose circle touches the rect, each item once. A rect around
+// all circles returns every item without testing any of them.
+uint32_t
+query_spatial_grid_rect(
+    spatial_grid *  sg
+,   float const     left
+,   float const     top
+,   float const     right
+,   float const     bottom
+,   uint32_t *      out_items
+,   uint32_t const  max_items
+) ;
+
+
+// Every item in a cell the rect touches, each item once, without testing
+// the circles. For callers which test them in bulk, e.g. cull_sprite_batch.
+uint32_t
+gather_spatial_grid_rect(
+    spatial_grid *  sg
+,   float const     left
+,   float const     top
+,   float const     right
+,   float const     bottom
+,   uint32_t *      out_items
+,   uint32_t const  max_items
+) ;
+
+
+// Every item whose circle contains the point.
+uint32_t
+pick_spatial_grid_point(
+    spatial_grid *  sg
+,   float const     x
+,   float const     y
+,   uint32_t *      out_items
+,   uint32_t const  max_items
+) ;
+
+
+// Every pair of overlapping circles, each pair once. out_pairs holds two
+// item indices per pair, the smaller one first.
+uint32_t
+find_spatial_grid_pairs(
+    spatial_grid const *    sg
+,   uint32_t *              out_pairs
+,   uint32_t const          max_pairs
+) ;
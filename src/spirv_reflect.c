@@ -0,0 +1,938 @@
+#include "spirv_reflect.h"
+#include "app.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "log.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+
+// The few parts of the spir-v spec which are needed to find the interface of
+// a shader, spirv.h isn't required for this.
+#define spirv_magic                         0x07230203
+#define spirv_header_word_count             5
+
+#define spirv_op_entry_point                15
+#define spirv_op_type_int                   21
+#define spirv_op_type_float                 22
+#define spirv_op_type_vector                23
+#define spirv_op_type_matrix                24
+#define spirv_op_type_image                 25
+#define spirv_op_type_sampler               26
+#define spirv_op_type_sampled_image         27
+#define spirv_op_type_array                 28
+#define spirv_op_type_runtime_array         29
+#define spirv_op_type_struct                30
+#define spirv_op_type_pointer               32
+#define spirv_op_constant                   43
+#define spirv_op_spec_constant_true         48
+#define spirv_op_spec_constant_false        49
+#define spirv_op_spec_constant              50
+#define spirv_op_variable                   59
+#define spirv_op_decorate                   71
+#define spirv_op_member_decorate            72
+
+#define spirv_decoration_spec_id            1
+#define spirv_decoration_block              2
+#define spirv_decoration_buffer_block       3
+#define spirv_decoration_array_stride       6
+#define spirv_decoration_matrix_stride      7
+#define spirv_decoration_builtin            11
+#define spirv_decoration_location           30
+#define spirv_decoration_binding            33
+#define spirv_decoration_descriptor_set     34
+#define spirv_decoration_offset             35
+
+#define spirv_storage_uniform_constant      0
+#define spirv_storage_input                 1
+#define spirv_storage_uniform               2
+#define spirv_storage_push_constant         9
+#define spirv_storage_storage_buffer        12
+
+#define spirv_dim_buffer                    5
+#define spirv_dim_subpass_data              6
+
+#define spirv_id_has_location               0x01
+#define spirv_id_has_binding                0x02
+#define spirv_id_is_builtin                 0x04
+#define spirv_id_is_block                   0x08
+#define spirv_id_is_buffer_block            0x10
+#define spirv_id_has_spec_id                0x20
+
+
+typedef struct spirv_id
+{
+    uint32_t    op_ ;
+    uint32_t    word_ ;
+    uint32_t    flags_ ;
+    uint32_t    location_ ;
+    uint32_t    binding_ ;
+    uint32_t    set_ ;
+    uint32_t    array_stride_ ;
+    uint32_t    spec_id_ ;
+
+} spirv_id ;
+
+
+typedef struct spirv_module
+{
+    uint32_t const *    code_ ;
+    uint32_t            code_count_ ;
+    spirv_id *          ids_ ;
+    uint32_t            ids_count_ ;
+
+} spirv_module ;
+
+
+static spirv_reflection reflections_[max_spirv_reflections] = { 0 } ;
+static uint32_t         reflections_count_ = 0 ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static uint32_t const *
+get_id_words(
+    spirv_module const *    sm
+,   uint32_t const          id
+)
+{
+    require(sm) ;
+    require(id < sm->ids_count_) ;
+    require(sm->ids_[id].op_) ;
+    return &sm->code_[sm->ids_[id].word_] ;
+}
+
+
+static uint32_t
+get_id_op(
+    spirv_module const *    sm
+,   uint32_t const          id
+)
+{
+    require(sm) ;
+    if(id >= sm->ids_count_)
+    {
+        return 0 ;
+    }
+    return sm->ids_[id].op_ ;
+}
+
+
+static uint32_t
+get_constant_value(
+    spirv_module const *    sm
+,   uint32_t const          id
+)
+{
+    // OpConstant and OpSpecConstant are result_type result value, arrays only
+    // use 32 bit lengths.
+    uint32_t const op = get_id_op(sm, id) ;
+    if(spirv_op_constant != op && spirv_op_spec_constant != op)
+    {
+        return 0 ;
+    }
+    return get_id_words(sm, id)[3] ;
+}
+
+
+static uint32_t
+find_member_decoration(
+    spirv_module const *    sm
+,   uint32_t const          struct_id
+,   uint32_t const          member
+,   uint32_t const          decoration
+)
+{
+    require(sm) ;
+
+    // only asked for when a block size is calculated, scanning is cheaper than
+    // keeping every member decoration around.
+    uint32_t w = spirv_header_word_count ;
+    while(w < sm->code_count_)
+    {
+        uint32_t const n    = sm->code_[w] >> 16 ;
+        uint32_t const op   = sm->code_[w] & 0xffff ;
+
+        if(
+            spirv_op_member_decorate == op
+        &&  n >= 5
+        &&  struct_id == sm->code_[w + 1]
+        &&  member == sm->code_[w + 2]
+        &&  decoration == sm->code_[w + 3]
+        )
+        {
+            return sm->code_[w + 4] ;
+        }
+
+        w += n ;
+    }
+
+    return 0 ;
+}
+
+
+static uint32_t
+get_type_size(
+    spirv_module const *    sm
+,   uint32_t const          type_id
+,   uint32_t const          matrix_stride
+) ;
+
+
+static uint32_t
+get_struct_size(
+    spirv_module const *    sm
+,   uint32_t const          struct_id
+)
+{
+    require(spirv_op_type_struct == get_id_op(sm, struct_id)) ;
+
+    uint32_t const *    words           = get_id_words(sm, struct_id) ;
+    uint32_t const      members_count   = (words[0] >> 16) - 2 ;
+    uint32_t            size            = 0 ;
+
+    for(
+        uint32_t i = 0
+    ;   i < members_count
+    ;   ++i
+    )
+    {
+        uint32_t const offset   = find_member_decoration(sm, struct_id, i, spirv_decoration_offset) ;
+        uint32_t const stride   = find_member_decoration(sm, struct_id, i, spirv_decoration_matrix_stride) ;
+        uint32_t const end      = offset + get_type_size(sm, words[2 + i], stride) ;
+        if(end > size)
+        {
+            size = end ;
+        }
+    }
+
+    return size ;
+}
+
+
+static uint32_t
+get_type_size(
+    spirv_module const *    sm
+,   uint32_t const          type_id
+,   uint32_t const          matrix_stride
+)
+{
+    uint32_t const op = get_id_op(sm, type_id) ;
+    if(0 == op)
+    {
+        return 0 ;
+    }
+
+    uint32_t const * words = get_id_words(sm, type_id) ;
+
+    switch(op)
+    {
+        case spirv_op_type_int:
+        case spirv_op_type_float:
+            return words[2] / 8 ;
+
+        case spirv_op_type_vector:
+            return words[3] * get_type_size(sm, words[2], 0) ;
+
+        case spirv_op_type_matrix:
+            // column major, the stride comes from the member decoration.
+            return words[3] * (matrix_stride ? matrix_stride : get_type_size(sm, words[2], 0)) ;
+
+        case spirv_op_type_array:
+        {
+            uint32_t const stride = sm->ids_[type_id].array_stride_ ;
+            return get_constant_value(sm, words[3]) * (stride ? stride : get_type_size(sm, words[2], matrix_stride)) ;
+        }
+
+        case spirv_op_type_struct:
+            return get_struct_size(sm, type_id) ;
+
+        default:
+            // runtime arrays, opaque types
+            return 0 ;
+    }
+}
+
+
+static VkFormat
+get_vertex_input_format(
+    spirv_module const *    sm
+,   uint32_t const          type_id
+,   uint32_t *              out_size
+)
+{
+    require(out_size) ;
+
+    static VkFormat const float_formats[] =
+    {
+        VK_FORMAT_R32_SFLOAT
+    ,   VK_FORMAT_R32G32_SFLOAT
+    ,   VK_FORMAT_R32G32B32_SFLOAT
+    ,   VK_FORMAT_R32G32B32A32_SFLOAT
+    } ;
+
+    static VkFormat const sint_formats[] =
+    {
+        VK_FORMAT_R32_SINT
+    ,   VK_FORMAT_R32G32_SINT
+    ,   VK_FORMAT_R32G32B32_SINT
+    ,   VK_FORMAT_R32G32B32A32_SINT
+    } ;
+
+    static VkFormat const uint_formats[] =
+    {
+        VK_FORMAT_R32_UINT
+    ,   VK_FORMAT_R32G32_UINT
+    ,   VK_FORMAT_R32G32B32_UINT
+    ,   VK_FORMAT_R32G32B32A32_UINT
+    } ;
+
+    *out_size = 0 ;
+
+    uint32_t scalar_id          = type_id ;
+    uint32_t components_count   = 1 ;
+
+    if(spirv_op_type_vector == get_id_op(sm, type_id))
+    {
+        uint32_t const * words = get_id_words(sm, type_id) ;
+        scalar_id           = words[2] ;
+        components_count    = words[3] ;
+    }
+
+    uint32_t const op = get_id_op(sm, scalar_id) ;
+    if(
+        (spirv_op_type_float != op && spirv_op_type_int != op)
+    ||  components_count < 1
+    ||  components_count > 4
+    )
+    {
+        // matrices and arrays take more than one location, none are used.
+        return VK_FORMAT_UNDEFINED ;
+    }
+
+    uint32_t const * words = get_id_words(sm, scalar_id) ;
+    if(32 != words[2])
+    {
+        return VK_FORMAT_UNDEFINED ;
+    }
+
+    *out_size = 4 * components_count ;
+
+    if(spirv_op_type_float == op)
+    {
+        return float_formats[components_count - 1] ;
+    }
+
+    return words[3] ? sint_formats[components_count - 1] : uint_formats[components_count - 1] ;
+}
+
+
+static VkDescriptorType
+get_descriptor_type(
+    spirv_module const *    sm
+,   uint32_t const          storage_class
+,   uint32_t const          type_id
+)
+{
+    uint32_t const op = get_id_op(sm, type_id) ;
+
+    if(spirv_storage_storage_buffer == storage_class)
+    {
+        return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ;
+    }
+
+    if(spirv_storage_uniform == storage_class && spirv_op_type_struct == op)
+    {
+        if(sm->ids_[type_id].flags_ & spirv_id_is_buffer_block)
+        {
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ;
+        }
+        return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ;
+    }
+
+    if(spirv_storage_uniform_constant != storage_class)
+    {
+        return VK_DESCRIPTOR_TYPE_MAX_ENUM ;
+    }
+
+    switch(op)
+    {
+        case spirv_op_type_sampled_image:
+            return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ;
+
+        case spirv_op_type_sampler:
+            return VK_DESCRIPTOR_TYPE_SAMPLER ;
+
+        case spirv_op_type_image:
+        {
+            // OpTypeImage result sampled_type dim depth arrayed ms sampled format
+            uint32_t const * words  = get_id_words(sm, type_id) ;
+            uint32_t const dim      = words[3] ;
+            uint32_t const sampled  = words[7] ;
+
+            if(spirv_dim_subpass_data == dim)
+            {
+                return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT ;
+            }
+            if(spirv_dim_buffer == dim)
+            {
+                return 2 == sampled ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ;
+            }
+            return 2 == sampled ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ;
+        }
+
+        default:
+            return VK_DESCRIPTOR_TYPE_MAX_ENUM ;
+    }
+}
+
+
+static VkShaderStageFlagBits
+get_shader_stage(
+    uint32_t const  execution_model
+)
+{
+    switch(execution_model)
+    {
+        case 0: return VK_SHADER_STAGE_VERTEX_BIT ;
+        case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT ;
+        case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT ;
+        case 3: return VK_SHADER_STAGE_GEOMETRY_BIT ;
+        case 4: return VK_SHADER_STAGE_FRAGMENT_BIT ;
+        case 5: return VK_SHADER_STAGE_COMPUTE_BIT ;
+        default: return 0 ;
+    }
+}
+
+
+static bool
+scan_spirv_module(
+    spirv_module *      sm
+,   spirv_reflection *  sr
+)
+{
+    require(sm) ;
+    require(sr) ;
+
+    uint32_t w = spirv_header_word_count ;
+    while(w < sm->code_count_)
+    {
+        uint32_t const n    = sm->code_[w] >> 16 ;
+        uint32_t const op   = sm->code_[w] & 0xffff ;
+
+        if(check(n > 0 && w + n <= sm->code_count_))
+        {
+            return false ;
+        }
+
+        uint32_t const * words      = &sm->code_[w] ;
+        uint32_t         result_id  = 0 ;
+
+        switch(op)
+        {
+            case spirv_op_entry_point:
+                if(n >= 2 && 0 == sr->stage_)
+                {
+                    sr->stage_ = get_shader_stage(words[1]) ;
+                }
+                break ;
+
+            case spirv_op_decorate:
+                if(n >= 3 && words[1] < sm->ids_count_)
+                {
+                    spirv_id *      si          = &sm->ids_[words[1]] ;
+                    uint32_t const  literal     = n >= 4 ? words[3] : 0 ;
+
+                    switch(words[2])
+                    {
+                        case spirv_decoration_block:            si->flags_ |= spirv_id_is_block ; break ;
+                        case spirv_decoration_buffer_block:     si->flags_ |= spirv_id_is_buffer_block ; break ;
+                        case spirv_decoration_builtin:          si->flags_ |= spirv_id_is_builtin ; break ;
+                        case spirv_decoration_array_stride:     si->array_stride_ = literal ; break ;
+                        case spirv_decoration_descriptor_set:   si->set_ = literal ; break ;
+
+                        case spirv_decoration_location:
+                            si->flags_      |= spirv_id_has_location ;
+                            si->location_    = literal ;
+                            break ;
+
+                        case spirv_decoration_binding:
+                            si->flags_      |= spirv_id_has_binding ;
+                            si->binding_     = literal ;
+                            break ;
+
+                        case spirv_decoration_spec_id:
+                            si->flags_      |= spirv_id_has_spec_id ;
+                            si->spec_id_     = literal ;
+                            break ;
+
+                        default:
+                            break ;
+                    }
+                }
+                break ;
+
+            case spirv_op_type_int:
+            case spirv_op_type_float:
+            case spirv_op_type_vector:
+            case spirv_op_type_matrix:
+            case spirv_op_type_image:
+            case spirv_op_type_sampler:
+            case spirv_op_type_sampled_image:
+            case spirv_op_type_array:
+            case spirv_op_type_runtime_array:
+            case spirv_op_type_struct:
+            case spirv_op_type_pointer:
+                result_id = n >= 2 ? words[1] : 0 ;
+                break ;
+
+            case spirv_op_constant:
+            case spirv_op_spec_constant:
+            case spirv_op_variable:
+                result_id = n >= 4 ? words[2] : 0 ;
+                break ;
+
+            case spirv_op_spec_constant_true:
+            case spirv_op_spec_constant_false:
+                result_id = n >= 3 ? words[2] : 0 ;
+                break ;
+
+            default:
+                break ;
+        }
+
+        if(result_id)
+        {
+            if(check(result_id < sm->ids_count_))
+            {
+                return false ;
+            }
+            sm->ids_[result_id].op_     = op ;
+            sm->ids_[result_id].word_   = w ;
+        }
+
+        w += n ;
+    }
+
+    return true ;
+}
+
+
+static bool
+add_descriptor_binding(
+    spirv_module const *    sm
+,   spirv_reflection *      sr
+,   spirv_id const *        variable
+,   uint32_t const          storage_class
+,   uint32_t const          pointee_id
+)
+{
+    require(sr) ;
+    require(variable) ;
+
+    uint32_t type_id    = pointee_id ;
+    uint32_t count      = 1 ;
+
+    // arrays of descriptors, runtime arrays are unbounded and counted as 0.
+    for(
+        uint32_t op = get_id_op(sm, type_id)
+    ;   spirv_op_type_array == op || spirv_op_type_runtime_array == op
+    ;   op = get_id_op(sm, type_id)
+    )
+    {
+        uint32_t const * words = get_id_words(sm, type_id) ;
+        count      *= spirv_op_type_array == op ? get_constant_value(sm, words[3]) : 0 ;
+        type_id     = words[2] ;
+    }
+
+    VkDescriptorType const type = get_descriptor_type(sm, storage_class, type_id) ;
+    if(check(VK_DESCRIPTOR_TYPE_MAX_ENUM != type))
+    {
+        return false ;
+    }
+
+    if(check(sr->descriptor_bindings_count_ < max_spirv_descriptor_bindings))
+    {
+        return false ;
+    }
+
+    spirv_descriptor_binding * sdb = &sr->descriptor_bindings_[sr->descriptor_bindings_count_] ;
+    sdb->set_           = variable->set_ ;
+    sdb->binding_       = variable->binding_ ;
+    sdb->type_          = type ;
+    sdb->count_         = count ;
+    sdb->block_size_    = spirv_op_type_struct == get_id_op(sm, type_id) ? get_struct_size(sm, type_id) : 0 ;
+
+    ++sr->descriptor_bindings_count_ ;
+    return true ;
+}
+
+
+static bool
+add_vertex_input(
+    spirv_module const *    sm
+,   spirv_reflection *      sr
+,   spirv_id const *        variable
+,   uint32_t const          pointee_id
+)
+{
+    require(sr) ;
+    require(variable) ;
+
+    if(check(sr->vertex_inputs_count_ < max_spirv_vertex_inputs))
+    {
+        return false ;
+    }
+
+    spirv_vertex_input vi = { 0 } ;
+    vi.location_    = variable->location_ ;
+    vi.format_      = get_vertex_input_format(sm, pointee_id, &vi.size_) ;
+
+    if(check(VK_FORMAT_UNDEFINED != vi.format_))
+    {
+        log_error("unsupported vertex input at location %u.", vi.location_) ;
+        return false ;
+    }
+
+    // sorted by location, there are only a handful.
+    uint32_t i = sr->vertex_inputs_count_ ;
+    while(i > 0 && sr->vertex_inputs_[i - 1].location_ > vi.location_)
+    {
+        sr->vertex_inputs_[i] = sr->vertex_inputs_[i - 1] ;
+        --i ;
+    }
+    sr->vertex_inputs_[i] = vi ;
+
+    ++sr->vertex_inputs_count_ ;
+    return true ;
+}
+
+
+static bool
+reflect_specialization_constants(
+    spirv_module const *    sm
+,   spirv_reflection *      sr
+)
+{
+    require(sm) ;
+    require(sr) ;
+
+    for(
+        uint32_t id = 1
+    ;   id < sm->ids_count_
+    ;   ++id
+    )
+    {
+        spirv_id const *    si  = &sm->ids_[id] ;
+        uint32_t const      op  = si->op_ ;
+
+        if(
+            !(si->flags_ & spirv_id_has_spec_id)
+        ||  (spirv_op_spec_constant != op && spirv_op_spec_constant_true != op && spirv_op_spec_constant_false != op)
+        )
+        {
+            // OpSpecConstantComposite and OpSpecConstantOp have no id of their own.
+            continue ;
+        }
+
+        if(check(sr->specialization_constants_count_ < max_spirv_specialization_constants))
+        {
+            return false ;
+        }
+
+        spirv_specialization_constant * ssc = &sr->specialization_constants_[sr->specialization_constants_count_] ;
+        ssc->constant_id_   = si->spec_id_ ;
+        ssc->default_value_ =
+            spirv_op_spec_constant == op    ? get_id_words(sm, id)[3]
+        :   spirv_op_spec_constant_true == op
+        ;
+
+        ++sr->specialization_constants_count_ ;
+    }
+
+    return true ;
+}
+
+
+static bool
+reflect_variables(
+    spirv_module const *    sm
+,   spirv_reflection *      sr
+)
+{
+    require(sm) ;
+    require(sr) ;
+
+    for(
+        uint32_t id = 1
+    ;   id < sm->ids_count_
+    ;   ++id
+    )
+    {
+        spirv_id const * si = &sm->ids_[id] ;
+        if(spirv_op_variable != si->op_ || (si->flags_ & spirv_id_is_builtin))
+        {
+            continue ;
+        }
+
+        // OpVariable result_type result storage_class, the type is a pointer.
+        uint32_t const *    words           = get_id_words(sm, id) ;
+        uint32_t const      storage_class   = words[3] ;
+
+        if(check(spirv_op_type_pointer == get_id_op(sm, words[1])))
+        {
+            return false ;
+        }
+        uint32_t const pointee_id = get_id_words(sm, words[1])[3] ;
+
+        switch(storage_class)
+        {
+            case spirv_storage_input:
+                if(VK_SHADER_STAGE_VERTEX_BIT == sr->stage_ && (si->flags_ & spirv_id_has_location))
+                {
+                    if(check(add_vertex_input(sm, sr, si, pointee_id)))
+                    {
+                        return false ;
+                    }
+                }
+                break ;
+
+            case spirv_storage_uniform_constant:
+            case spirv_storage_uniform:
+            case spirv_storage_storage_buffer:
+                if(si->flags_ & spirv_id_has_binding)
+                {
+                    if(check(add_descriptor_binding(sm, sr, si, storage_class, pointee_id)))
+                    {
+                        return false ;
+                    }
+                }
+                break ;
+
+            case spirv_storage_push_constant:
+                sr->push_constant_size_ = get_type_size(sm, pointee_id, 0) ;
+                break ;
+
+            default:
+                break ;
+        }
+    }
+
+    return true ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+reflect_spirv(
+    spirv_reflection *  out_reflection
+,   void const *        code
+,   uint64_t const      code_size
+)
+{
+    require(out_reflection) ;
+    require(code) ;
+    begin_timed_block() ;
+
+    SDL_memset(out_reflection, 0, sizeof(spirv_reflection)) ;
+
+    uint32_t const * words = code ;
+
+    // OpSource strings aside, everything is little endian words.
+    if(check(
+            0 == (code_size % 4)
+        &&  code_size >= spirv_header_word_count * 4
+        &&  spirv_magic == words[0]
+        &&  words[3] > 0
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    spirv_module sm = { 0 } ;
+    sm.code_        = words ;
+    sm.code_count_  = (uint32_t) (code_size / 4) ;
+    sm.ids_count_   = words[3] ;
+    sm.ids_         = alloc_array(spirv_id, sm.ids_count_) ;
+    if(check(sm.ids_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    SDL_memset(sm.ids_, 0, sizeof(spirv_id) * sm.ids_count_) ;
+
+    bool const ok =
+        scan_spirv_module(&sm, out_reflection)
+    &&  reflect_variables(&sm, out_reflection)
+    &&  reflect_specialization_constants(&sm, out_reflection)
+    ;
+
+    free_memory(sm.ids_) ;
+
+    if(check(ok && out_reflection->stage_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+spirv_reflection const *
+get_spirv_reflection(
+    char const * const  shader_full_name
+,   void const *        code
+,   uint64_t const      code_size
+)
+{
+    require(shader_full_name) ;
+    require(*shader_full_name) ;
+    require(SDL_strlen(shader_full_name) < max_spirv_reflection_name) ;
+    begin_timed_block() ;
+
+    for(
+        uint32_t i = 0
+    ;   i < reflections_count_
+    ;   ++i
+    )
+    {
+        if(0 == SDL_strcmp(reflections_[i].name_, shader_full_name))
+        {
+            end_timed_block() ;
+            return &reflections_[i] ;
+        }
+    }
+
+    if(check(reflections_count_ < max_spirv_reflections))
+    {
+        end_timed_block() ;
+        return NULL ;
+    }
+
+    spirv_reflection * sr = &reflections_[reflections_count_] ;
+    if(check(reflect_spirv(sr, code, code_size)))
+    {
+        log_error("failed to reflect %s.", shader_full_name) ;
+        end_timed_block() ;
+        return NULL ;
+    }
+    SDL_strlcpy(sr->name_, shader_full_name, max_spirv_reflection_name) ;
+    ++reflections_count_ ;
+
+    log_debug(
+        "%s: stage=%x descriptor_bindings=%u vertex_inputs=%u specialization_constants=%u push_constant_size=%u"
+    ,   shader_full_name
+    ,   (unsigned) sr->stage_
+    ,   sr->descriptor_bindings_count_
+    ,   sr->vertex_inputs_count_
+    ,   sr->specialization_constants_count_
+    ,   sr->push_constant_size_
+    ) ;
+
+    end_timed_block() ;
+    return sr ;
+}
+
+
+spirv_descriptor_binding const *
+find_spirv_descriptor_binding(
+    spirv_reflection const *    sr
+,   uint32_t const              set
+,   uint32_t const              binding
+)
+{
+    require(sr) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < sr->descriptor_bindings_count_
+    ;   ++i
+    )
+    {
+        spirv_descriptor_binding const * sdb = &sr->descriptor_bindings_[i] ;
+        if(set == sdb->set_ && binding == sdb->binding_)
+        {
+            return sdb ;
+        }
+    }
+
+    return NULL ;
+}
+
+
+spirv_specialization_constant const *
+find_spirv_specialization_constant(
+    spirv_reflection const *    sr
+,   uint32_t const              constant_id
+)
+{
+    require(sr) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < sr->specialization_constants_count_
+    ;   ++i
+    )
+    {
+        if(constant_id == sr->specialization_constants_[i].constant_id_)
+        {
+            return &sr->specialization_constants_[i] ;
+        }
+    }
+
+    return NULL ;
+}
+
+
+bool
+is_spirv_reflection_compatible(
+    spirv_reflection const *    sr
+,   spirv_reflection const *    other
+)
+{
+    require(sr) ;
+    require(other) ;
+
+    if(
+        sr->stage_                          != other->stage_
+    ||  sr->descriptor_bindings_count_      != other->descriptor_bindings_count_
+    ||  sr->vertex_inputs_count_            != other->vertex_inputs_count_
+    ||  sr->specialization_constants_count_ != other->specialization_constants_count_
+    ||  sr->push_constant_size_             != other->push_constant_size_
+    )
+    {
+        return false ;
+    }
+
+    // both are zeroed before they are filled, the padding compares equal.
+    if(
+        0 != SDL_memcmp(sr->descriptor_bindings_, other->descriptor_bindings_, sr->descriptor_bindings_count_ * sizeof(spirv_descriptor_binding))
+    ||  0 != SDL_memcmp(sr->vertex_inputs_, other->vertex_inputs_, sr->vertex_inputs_count_ * sizeof(spirv_vertex_input))
+    )
+    {
+        return false ;
+    }
+
+    // the defaults may change, the values set by the render objects win.
+    for(
+        uint32_t i = 0
+    ;   i < sr->specialization_constants_count_
+    ;   ++i
+    )
+    {
+        if(sr->specialization_constants_[i].constant_id_ != other->specialization_constants_[i].constant_id_)
+        {
+            return false ;
+        }
+    }
+
+    return true ;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+
+#include <vulkan/vulkan.h>
+#include "types.h"
+
+
+#define max_spirv_reflections               32
+#define max_spirv_reflection_name           128
+#define max_spirv_descriptor_bindings       8
+#define max_spirv_vertex_inputs             16
+#define max_spirv_specialization_constants  8
+
+
+typedef struct spirv_descriptor_binding
+{
+    uint32_t            set_ ;
+    uint32_t            binding_ ;
+    VkDescriptorType    type_ ;
+    uint32_t            count_ ;
+
+    // the std140/std430 size of uniform and storage blocks, 0 otherwise.
+    uint32_t            block_size_ ;
+
+} spirv_descriptor_binding ;
+
+
+typedef struct spirv_vertex_input
+{
+    uint32_t    location_ ;
+    VkFormat    format_ ;
+    uint32_t    size_ ;
+
+} spirv_vertex_input ;
+
+
+// bool, int, uint and float constants, the default is kept as its bits.
+typedef struct spirv_specialization_constant
+{
+    uint32_t    constant_id_ ;
+    uint32_t    default_value_ ;
+
+} spirv_specialization_constant ;
+
+
+// What a render object needs to know about one shader stage, taken from the
+// spir-v itself instead of being repeated by hand next to the glsl. Builtins
+// are skipped, vertex inputs are sorted by location and only filled for
+// vertex shaders. Array sizes given by specialization constants use their
+// default value.
+typedef struct spirv_reflection
+{
+    char                            name_[max_spirv_reflection_name] ;
+    VkShaderStageFlagBits           stage_ ;
+
+    spirv_descriptor_binding        descriptor_bindings_[max_spirv_descriptor_bindings] ;
+    uint32_t                        descriptor_bindings_count_ ;
+
+    spirv_vertex_input              vertex_inputs_[max_spirv_vertex_inputs] ;
+    uint32_t                        vertex_inputs_count_ ;
+
+    spirv_specialization_constant   specialization_constants_[max_spirv_specialization_constants] ;
+    uint32_t                        specialization_constants_count_ ;
+
+    uint32_t                        push_constant_size_ ;
+
+} spirv_reflection ;
+
+
+bool
+reflect_spirv(
+    spirv_reflection *  out_reflection
+,   void const *        code
+,   uint64_t const      code_size
+) ;
+
+
+// Reflections are cached by shader name for the lifetime of the app, so
+// creating another render object with the same shaders doesn't parse again.
+// The code is only looked at when the name isn't cached yet.
+spirv_reflection const *
+get_spirv_reflection(
+    char const * const  shader_full_name
+,   void const *        code
+,   uint64_t const      code_size
+) ;
+
+
+spirv_descriptor_binding const *
+find_spirv_descriptor_binding(
+    spirv_reflection const *    sr
+,   uint32_t const              set
+,   uint32_t const              binding
+) ;
+
+
+spirv_specialization_constant const *
+find_spirv_specialization_constant(
+    spirv_reflection const *    sr
+,   uint32_t const              constant_id
+) ;
+
+
+// True when other can take the place of sr without changing the descriptor
+// set layout, the vertex input state or the specialization map of a pipeline
+// made for sr. Names and specialization defaults are not compared.
+bool
+is_spirv_reflection_compatible(
+    spirv_reflection const *    sr
+,   spirv_reflection const *    other
+) ;
@@ -0,0 +1,493 @@
+#include "sprite_animation.h"
+#include "asset_sprite.h"
+#include "app.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static size_t
+align_16(
+    size_t const    s
+)
+{
+    return (s + 15) & ~((size_t)15) ;
+}
+
+
+static uint32_t
+count_track_steps(
+    rect_2d_group const *   g
+)
+{
+    require(g) ;
+    require(g->frame_count_) ;
+
+    if(rect_2d_playback_ping_pong == g->playback_ && g->frame_count_ > 2)
+    {
+        return 2u * g->frame_count_ - 2u ;
+    }
+
+    return g->frame_count_ ;
+}
+
+
+static void
+fill_track(
+    sprite_animation_atlas *    a
+,   sprite_animation_track *    t
+,   rect_2d_group const *       g
+,   uint32_t const              first_step
+)
+{
+    require(a) ;
+    require(t) ;
+    require(g) ;
+
+    rect_2d_timing const * timings = a->sprite_->timings_ ;
+
+    t->first_step_  = first_step ;
+    t->steps_count_ = count_track_steps(g) ;
+    t->playback_    = g->playback_ ;
+    t->blend_ms_    = g->blend_ms_ ;
+
+    float end_ms = 0.0f ;
+    for(
+        uint32_t i = 0
+    ;   i < t->steps_count_
+    ;   ++i
+    )
+    {
+        // past the last frame ping pong comes back down.
+        uint32_t const  local   = i < g->frame_count_ ? i : 2u * g->frame_count_ - 2u - i ;
+        uint16_t const  frame   = (uint16_t) (g->frame_start_ + local) ;
+        uint32_t const  ms      = timings && timings[frame].duration_ms_ ? timings[frame].duration_ms_ : sprite_animation_default_frame_ms ;
+
+        end_ms += (float) ms ;
+        a->step_end_ms_[first_step + i] = end_ms ;
+        a->step_frame_[first_step + i]  = frame ;
+        a->step_event_[first_step + i]  = timings ? timings[frame].event_ : 0 ;
+    }
+
+    t->duration_ms_ = end_ms ;
+}
+
+
+static void
+raise_sprite_animation_event(
+    sprite_animator *   sa
+,   uint32_t const      animation
+,   uint16_t const      frame
+,   uint16_t const      event
+)
+{
+    if(sa->events_count_ == sa->capacity_)
+    {
+        ++sa->dropped_events_count_ ;
+        return ;
+    }
+
+    sprite_animation_event * e = &sa->events_[sa->events_count_++] ;
+    e->animation_   = animation ;
+    e->frame_       = frame ;
+    e->event_       = event ;
+}
+
+
+// Moves time_ms by delta_ms through the track and returns the new time, step
+// is where it ends up. Events are raised for every step entered when
+// animation isn't UINT32_MAX.
+static float
+advance_track(
+    sprite_animator *               sa
+,   sprite_animation_atlas const *  a
+,   sprite_animation_track const *  t
+,   uint32_t const                  animation
+,   uint16_t *                      step
+,   float const                     time_ms
+,   float const                     delta_ms
+,   bool *                          out_finished
+)
+{
+    float const *       ends    = &a->step_end_ms_[t->first_step_] ;
+    uint32_t const      last    = t->steps_count_ - 1 ;
+    uint32_t            s       = *step ;
+    float               time    = time_ms + delta_ms ;
+
+    *out_finished = false ;
+
+    if(rect_2d_playback_once == t->playback_)
+    {
+        if(time >= t->duration_ms_)
+        {
+            time = t->duration_ms_ ;
+            *out_finished = true ;
+        }
+    }
+    else if(time >= 2.0f * t->duration_ms_)
+    {
+        // a long hitch skips whole laps, their events are raised once.
+        time = t->duration_ms_ + SDL_fmodf(time, t->duration_ms_) ;
+    }
+
+    for(;;)
+    {
+        if(time < ends[s])
+        {
+            break ;
+        }
+
+        if(s == last)
+        {
+            if(rect_2d_playback_once == t->playback_)
+            {
+                break ;
+            }
+            time -= t->duration_ms_ ;
+            s = 0 ;
+        }
+        else
+        {
+            ++s ;
+        }
+
+        uint32_t const k = t->first_step_ + s ;
+        if(UINT32_MAX != animation && a->step_event_[k])
+        {
+            raise_sprite_animation_event(sa, animation, a->step_frame_[k], a->step_event_[k]) ;
+        }
+    }
+
+    *step = (uint16_t) s ;
+    return time ;
+}
+
+
+static uint32_t
+find_track_step(
+    sprite_animation_atlas const *  a
+,   sprite_animation_track const *  t
+,   float const                     time_ms
+)
+{
+    for(
+        uint32_t s = 0
+    ;   s < t->steps_count_
+    ;   ++s
+    )
+    {
+        if(time_ms < a->step_end_ms_[t->first_step_ + s])
+        {
+            return s ;
+        }
+    }
+
+    return t->steps_count_ - 1 ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_sprite_animator(
+    sprite_animator *   out_animator
+,   uint32_t const      capacity
+)
+{
+    require(out_animator) ;
+    require(!out_animator->memory_) ;
+    require(capacity) ;
+
+    size_t const u16_size       = align_16(sizeof(uint16_t) * capacity) ;
+    size_t const f32_size       = align_16(sizeof(float) * capacity) ;
+    size_t const u8_size        = align_16(sizeof(uint8_t) * capacity) ;
+    size_t const events_size    = align_16(sizeof(sprite_animation_event) * capacity) ;
+    size_t const total_size     = 7 * u16_size + 6 * f32_size + u8_size + events_size ;
+
+    uint8_t * m = alloc_memory(uint8_t, total_size) ;
+    if(check(m))
+    {
+        return false ;
+    }
+
+    SDL_memset(out_animator, 0, sizeof(sprite_animator)) ;
+
+    out_animator->memory_           = m ;
+    out_animator->events_           = (sprite_animation_event *) m ;
+    m += events_size ;
+    out_animator->time_ms_          = (float *) m ;
+    m += f32_size ;
+    out_animator->speed_            = (float *) m ;
+    m += f32_size ;
+    out_animator->blend_time_ms_    = (float *) m ;
+    m += f32_size ;
+    out_animator->blend_elapsed_ms_ = (float *) m ;
+    m += f32_size ;
+    out_animator->blend_ms_         = (float *) m ;
+    m += f32_size ;
+    out_animator->blend_weight_     = (float *) m ;
+    m += f32_size ;
+    out_animator->atlas_            = (uint16_t *) m ;
+    m += u16_size ;
+    out_animator->group_            = (uint16_t *) m ;
+    m += u16_size ;
+    out_animator->step_             = (uint16_t *) m ;
+    m += u16_size ;
+    out_animator->blend_group_      = (uint16_t *) m ;
+    m += u16_size ;
+    out_animator->blend_step_       = (uint16_t *) m ;
+    m += u16_size ;
+    out_animator->frame_            = (uint16_t *) m ;
+    m += u16_size ;
+    out_animator->blend_frame_      = (uint16_t *) m ;
+    m += u16_size ;
+    out_animator->finished_         = m ;
+    out_animator->capacity_         = capacity ;
+
+    return true ;
+}
+
+
+void
+destroy_sprite_animator(
+    sprite_animator *   sa
+)
+{
+    require(sa) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < sa->atlases_count_
+    ;   ++i
+    )
+    {
+        if(sa->atlases_[i].memory_)
+        {
+            free_memory(sa->atlases_[i].memory_) ;
+        }
+    }
+
+    if(sa->memory_)
+    {
+        free_memory(sa->memory_) ;
+    }
+
+    SDL_memset(sa, 0, sizeof(sprite_animator)) ;
+}
+
+
+bool
+add_sprite_animator_atlas(
+    sprite_animator *       sa
+,   sprite_2d_ptr const *   atlas
+,   uint16_t *              out_atlas
+)
+{
+    require(sa) ;
+    require(atlas) ;
+    require(atlas->this_) ;
+    require(out_atlas) ;
+    require(0 == sa->count_) ;
+    require(sa->atlases_count_ < max_sprite_animation_atlases) ;
+
+    uint32_t const groups_count = atlas->this_->groups_count_ ;
+
+    uint32_t steps_count = 0 ;
+    for(
+        uint32_t i = 0
+    ;   i < groups_count
+    ;   ++i
+    )
+    {
+        steps_count += count_track_steps(&atlas->groups_[i]) ;
+    }
+
+    // the steps are indexed with 16 bits.
+    require(steps_count <= UINT16_MAX) ;
+
+    size_t const tracks_size    = align_16(sizeof(sprite_animation_track) * groups_count) ;
+    size_t const ends_size      = align_16(sizeof(float) * steps_count) ;
+    size_t const steps_size     = align_16(sizeof(uint16_t) * steps_count) ;
+    size_t const total_size     = tracks_size + ends_size + 2 * steps_size ;
+
+    uint8_t * m = alloc_memory(uint8_t, total_size) ;
+    if(check(m))
+    {
+        return false ;
+    }
+
+    sprite_animation_atlas * a = &sa->atlases_[sa->atlases_count_] ;
+    SDL_memset(a, 0, sizeof(sprite_animation_atlas)) ;
+
+    a->memory_      = m ;
+    a->sprite_      = atlas ;
+    a->tracks_      = (sprite_animation_track *) m ;
+    m += tracks_size ;
+    a->step_end_ms_ = (float *) m ;
+    m += ends_size ;
+    a->step_frame_  = (uint16_t *) m ;
+    m += steps_size ;
+    a->step_event_  = (uint16_t *) m ;
+    a->steps_count_ = steps_count ;
+
+    uint32_t first_step = 0 ;
+    for(
+        uint32_t i = 0
+    ;   i < groups_count
+    ;   ++i
+    )
+    {
+        fill_track(a, &a->tracks_[i], &atlas->groups_[i], first_step) ;
+        first_step += a->tracks_[i].steps_count_ ;
+    }
+
+    *out_atlas = (uint16_t) sa->atlases_count_++ ;
+    return true ;
+}
+
+
+uint32_t
+add_sprite_animation(
+    sprite_animator *   sa
+,   uint16_t const      atlas
+,   uint16_t const      group
+,   float const         start_ms
+)
+{
+    require(sa) ;
+    require(sa->count_ < sa->capacity_) ;
+    require(atlas < sa->atlases_count_) ;
+
+    sprite_animation_atlas const *  a = &sa->atlases_[atlas] ;
+    require(group < a->sprite_->this_->groups_count_) ;
+    sprite_animation_track const *  t = &a->tracks_[group] ;
+
+    float time_ms = start_ms < 0.0f ? 0.0f : start_ms ;
+    if(rect_2d_playback_once == t->playback_)
+    {
+        time_ms = SDL_min(time_ms, t->duration_ms_) ;
+    }
+    else
+    {
+        time_ms = SDL_fmodf(time_ms, t->duration_ms_) ;
+    }
+
+    uint32_t const  i = sa->count_++ ;
+    uint16_t const  s = (uint16_t) find_track_step(a, t, time_ms) ;
+
+    sa->atlas_[i]               = atlas ;
+    sa->group_[i]               = group ;
+    sa->step_[i]                = s ;
+    sa->time_ms_[i]             = time_ms ;
+    sa->speed_[i]               = 1.0f ;
+    sa->blend_group_[i]         = group ;
+    sa->blend_step_[i]          = s ;
+    sa->blend_time_ms_[i]       = 0.0f ;
+    sa->blend_elapsed_ms_[i]    = 0.0f ;
+    sa->blend_ms_[i]            = 0.0f ;
+    sa->frame_[i]               = a->step_frame_[t->first_step_ + s] ;
+    sa->blend_frame_[i]         = sa->frame_[i] ;
+    sa->blend_weight_[i]        = 0.0f ;
+    sa->finished_[i]            = rect_2d_playback_once == t->playback_ && time_ms >= t->duration_ms_ ;
+
+    return i ;
+}
+
+
+void
+play_sprite_animation(
+    sprite_animator *   sa
+,   uint32_t const      animation
+,   uint16_t const      group
+,   bool const          blend
+)
+{
+    require(sa) ;
+    require(animation < sa->count_) ;
+
+    uint32_t const                  i = animation ;
+    sprite_animation_atlas const *  a = &sa->atlases_[sa->atlas_[i]] ;
+    require(group < a->sprite_->this_->groups_count_) ;
+    sprite_animation_track const *  t = &a->tracks_[group] ;
+
+    if(blend && t->blend_ms_)
+    {
+        sa->blend_group_[i]         = sa->group_[i] ;
+        sa->blend_step_[i]          = sa->step_[i] ;
+        sa->blend_time_ms_[i]       = sa->time_ms_[i] ;
+        sa->blend_elapsed_ms_[i]    = 0.0f ;
+        sa->blend_ms_[i]            = (float) t->blend_ms_ ;
+        sa->blend_frame_[i]         = sa->frame_[i] ;
+        sa->blend_weight_[i]        = 1.0f ;
+    }
+    else
+    {
+        sa->blend_ms_[i]            = 0.0f ;
+        sa->blend_weight_[i]        = 0.0f ;
+    }
+
+    sa->group_[i]       = group ;
+    sa->step_[i]        = 0 ;
+    sa->time_ms_[i]     = 0.0f ;
+    sa->frame_[i]       = a->step_frame_[t->first_step_] ;
+    sa->finished_[i]    = 0 ;
+}
+
+
+void
+update_sprite_animations(
+    sprite_animator *   sa
+,   float const         delta_seconds
+)
+{
+    require(sa) ;
+    begin_timed_block() ;
+
+    sa->events_count_           = 0 ;
+    sa->dropped_events_count_   = 0 ;
+
+    float const delta_ms = delta_seconds > 0.0f ? delta_seconds * 1000.0f : 0.0f ;
+
+    for(
+        uint32_t i = 0
+    ;   i < sa->count_
+    ;   ++i
+    )
+    {
+        sprite_animation_atlas const *  a   = &sa->atlases_[sa->atlas_[i]] ;
+        sprite_animation_track const *  t   = &a->tracks_[sa->group_[i]] ;
+        float const                     d   = delta_ms * sa->speed_[i] ;
+        bool                            finished = false ;
+
+        sa->time_ms_[i]     = advance_track(sa, a, t, i, &sa->step_[i], sa->time_ms_[i], d, &finished) ;
+        sa->frame_[i]       = a->step_frame_[t->first_step_ + sa->step_[i]] ;
+        sa->finished_[i]    = finished ;
+
+        if(0.0f == sa->blend_ms_[i])
+        {
+            continue ;
+        }
+
+        sa->blend_elapsed_ms_[i] += d ;
+        if(sa->blend_elapsed_ms_[i] >= sa->blend_ms_[i])
+        {
+            sa->blend_ms_[i]        = 0.0f ;
+            sa->blend_weight_[i]    = 0.0f ;
+            continue ;
+        }
+
+        // the group blended out of runs on, its events are not raised.
+        sprite_animation_track const * bt = &a->tracks_[sa->blend_group_[i]] ;
+        sa->blend_time_ms_[i]   = advance_track(sa, a, bt, UINT32_MAX, &sa->blend_step_[i], sa->blend_time_ms_[i], d, &finished) ;
+        sa->blend_frame_[i]     = a->step_frame_[bt->first_step_ + sa->blend_step_[i]] ;
+        sa->blend_weight_[i]    = 1.0f - sa->blend_elapsed_ms_[i] / sa->blend_ms_[i] ;
+    }
+
+    end_timed_block() ;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+
+#include "types.h"
+#include "asset_sprite.h"
+
+
+#define max_sprite_animation_atlases    16
+
+// frames of atlases without timings are shown this long.
+#define sprite_animation_default_frame_ms   33
+
+
+// A group's frames unrolled into steps, ping pong plays 0..n-1 and then
+// n-2..1. step_end_ms_ is where a step ends, counted from the start of the
+// group, the last one is duration_ms_.
+typedef struct sprite_animation_track
+{
+    uint32_t    first_step_ ;
+    uint32_t    steps_count_ ;
+    float       duration_ms_ ;
+    uint16_t    playback_ ;
+    uint16_t    blend_ms_ ;
+
+} sprite_animation_track ;
+
+
+typedef struct sprite_animation_atlas
+{
+    sprite_2d_ptr const *       sprite_ ;
+    sprite_animation_track *    tracks_ ;
+    float *                     step_end_ms_ ;
+    uint16_t *                  step_frame_ ;
+    uint16_t *                  step_event_ ;
+    uint32_t                    steps_count_ ;
+    void *                      memory_ ;
+
+} sprite_animation_atlas ;
+
+
+// Raised when an animation enters a step whose frame has an event, frame_ is
+// the vertices index like sprite_animator.frame_.
+typedef struct sprite_animation_event
+{
+    uint32_t    animation_ ;
+    uint16_t    frame_ ;
+    uint16_t    event_ ;
+
+} sprite_animation_event ;
+
+
+// Every animation is a column in a set of arrays and update_sprite_animations
+// walks all of them in one go, only the elapsed time goes in so the result
+// doesn't depend on how often it runs. While an animation blends out of the
+// group it played before, that group keeps running in the blend_ columns and
+// blend_weight_ goes from 1 down to 0. frame_, blend_frame_, blend_weight_
+// and finished_ are what the caller reads after an update, the events
+// raised during the last update are in events_.
+typedef struct sprite_animator
+{
+    sprite_animation_atlas  atlases_[max_sprite_animation_atlases] ;
+    uint32_t                atlases_count_ ;
+
+    uint16_t *              atlas_ ;
+    uint16_t *              group_ ;
+    uint16_t *              step_ ;
+    float *                 time_ms_ ;
+    float *                 speed_ ;
+
+    uint16_t *              blend_group_ ;
+    uint16_t *              blend_step_ ;
+    float *                 blend_time_ms_ ;
+    float *                 blend_elapsed_ms_ ;
+    float *                 blend_ms_ ;
+
+    uint16_t *              frame_ ;
+    uint16_t *              blend_frame_ ;
+    float *                 blend_weight_ ;
+    uint8_t *               finished_ ;
+
+    uint32_t                count_ ;
+    uint32_t                capacity_ ;
+
+    sprite_animation_event *    events_ ;
+    uint32_t                    events_count_ ;
+    uint32_t                    dropped_events_count_ ;
+
+    void *                  memory_ ;
+
+} sprite_animator ;
+
+
+bool
+create_sprite_animator(
+    sprite_animator *   out_animator
+,   uint32_t const      capacity
+) ;
+
+
+void
+destroy_sprite_animator(
+    sprite_animator *   sa
+) ;
+
+
+// Unrolls the groups of the atlas into tracks, the index is what
+// add_sprite_animation takes. Not after animations were added.
+bool
+add_sprite_animator_atlas(
+    sprite_animator *       sa
+,   sprite_2d_ptr const *   atlas
+,   uint16_t *              out_atlas
+) ;
+
+
+// Starts group at start_ms into it, speed_ is 1 and must not go negative.
+uint32_t
+add_sprite_animation(
+    sprite_animator *   sa
+,   uint16_t const      atlas
+,   uint16_t const      group
+,   float const         start_ms
+) ;
+
+
+// Switches to group from its start. With blend set and a blend time on the
+// group the one played so far fades out, otherwise it stops at once. Like
+// add_sprite_animation the first frame's event isn't raised.
+void
+play_sprite_animation(
+    sprite_animator *   sa
+,   uint32_t const      animation
+,   uint16_t const      group
+,   bool const          blend
+) ;
+
+
+void
+update_sprite_animations(
+    sprite_animator *   sa
+,   float const         delta_seconds
+) ;
@@ -0,0 +1,670 @@
+#include "sprite_batch.h"
+#include "asset_sprite.h"
+#include "app.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "job.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_intrin.h>
+
+
+// key layout, from the most significant bits down:
+//   63..56  pipeline, opaque before translucent
+//   55..48  layer, 0 when opaque, the depth test orders those
+// opaque, grouped by texture since the depth test keeps them in order:
+//   47..32  texture
+//   31..8   depth, front to back
+// translucent, where only the depth gives the right order:
+//   47..24  depth, back to front
+//   23..8   texture
+//    7..0   unused, the radix sort skips constant digits
+#define sprite_key_pipeline_shift            56
+#define sprite_key_layer_shift               48
+#define sprite_key_opaque_texture_shift      32
+#define sprite_key_opaque_depth_shift        8
+#define sprite_key_translucent_depth_shift   24
+#define sprite_key_translucent_texture_shift 8
+#define sprite_key_depth_max                 0xFFFFFF
+
+#define sprite_key_radix_bits                8
+#define sprite_key_radix_size                (1 << sprite_key_radix_bits)
+#define sprite_key_radix_passes              (64 / sprite_key_radix_bits)
+
+// below this many circles a single thread is faster than waking the workers.
+#define sprite_cull_min_range                1024
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static size_t
+align_16(
+    size_t const    s
+)
+{
+    return (s + 15) & ~((size_t)15) ;
+}
+
+
+static uint16_t
+get_sprite_key_pipeline(
+    uint64_t const  key
+)
+{
+    return (uint16_t) ((key >> sprite_key_pipeline_shift) & 0xFF) ;
+}
+
+
+static uint16_t
+get_sprite_key_texture(
+    uint64_t const  key
+)
+{
+    uint32_t const shift = sprite_batch_pipeline_opaque == get_sprite_key_pipeline(key)
+        ? sprite_key_opaque_texture_shift
+        : sprite_key_translucent_texture_shift
+        ;
+    return (uint16_t) ((key >> shift) & 0xFFFF) ;
+}
+
+
+static void
+radix_sort_keys(
+    uint64_t *      keys
+,   uint32_t *      indices
+,   uint64_t *      scratch_keys
+,   uint32_t *      scratch_indices
+,   uint32_t const  count
+)
+{
+    require(keys) ;
+    require(indices) ;
+    require(scratch_keys) ;
+    require(scratch_indices) ;
+
+    static uint32_t histograms[sprite_key_radix_passes][sprite_key_radix_size] = { 0 } ;
+    SDL_memset(histograms, 0, sizeof(histograms)) ;
+
+    // one read of the keys builds the histograms of all passes.
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        uint64_t const k = keys[i] ;
+        for(
+            uint32_t p = 0
+        ;   p < sprite_key_radix_passes
+        ;   ++p
+        )
+        {
+            ++histograms[p][(k >> (p * sprite_key_radix_bits)) & (sprite_key_radix_size - 1)] ;
+        }
+    }
+
+    uint64_t *  src_keys    = keys ;
+    uint32_t *  src_indices = indices ;
+    uint64_t *  dst_keys    = scratch_keys ;
+    uint32_t *  dst_indices = scratch_indices ;
+
+    for(
+        uint32_t p = 0
+    ;   p < sprite_key_radix_passes
+    ;   ++p
+    )
+    {
+        uint32_t *      h       = histograms[p] ;
+        uint32_t const  shift   = p * sprite_key_radix_bits ;
+
+        // all keys share this digit, the pass would not move anything.
+        uint32_t const first_digit = (src_keys[0] >> shift) & (sprite_key_radix_size - 1) ;
+        if(h[first_digit] == count)
+        {
+            continue ;
+        }
+
+        uint32_t sum = 0 ;
+        for(
+            uint32_t d = 0
+        ;   d < sprite_key_radix_size
+        ;   ++d
+        )
+        {
+            uint32_t const c = h[d] ;
+            h[d] = sum ;
+            sum += c ;
+        }
+
+        for(
+            uint32_t i = 0
+        ;   i < count
+        ;   ++i
+        )
+        {
+            uint64_t const  k = src_keys[i] ;
+            uint32_t const  o = h[(k >> shift) & (sprite_key_radix_size - 1)]++ ;
+            dst_keys[o]     = k ;
+            dst_indices[o]  = src_indices[i] ;
+        }
+
+        uint64_t *  tk = src_keys ;
+        uint32_t *  ti = src_indices ;
+        src_keys    = dst_keys ;
+        src_indices = dst_indices ;
+        dst_keys    = tk ;
+        dst_indices = ti ;
+    }
+
+    if(src_keys != keys)
+    {
+        SDL_memcpy(keys, src_keys, sizeof(uint64_t) * count) ;
+        SDL_memcpy(indices, src_indices, sizeof(uint32_t) * count) ;
+    }
+}
+
+
+// Frames without a hull are drawn as their quad, the four corners padded
+// with the last one.
+static uint32_t const quad_st[max_rect_2d_hull_vertices] =
+{
+    0x00000000
+,   0x0000ffff
+,   0xffffffff
+,   0xffff0000
+,   0xffff0000
+,   0xffff0000
+,   0xffff0000
+,   0xffff0000
+} ;
+
+
+static void
+write_sprite_instance(
+    sprite_instance *           si
+,   rect_2d_vertices const *    rv
+,   rect_2d_hull const *        rh
+,   sprite_transform const *    t
+,   uint32_t const              tint
+,   float const                 z
+)
+{
+    require(si) ;
+    require(rv) ;
+    require(t) ;
+
+    float const c = SDL_cosf(t->rotation_) ;
+    float const s = SDL_sinf(t->rotation_) ;
+
+    float * dst[4] = { &si->p01_[0], &si->p01_[2], &si->p23_[0], &si->p23_[2] } ;
+    float * uv[4]  = { &si->t01_[0], &si->t01_[2], &si->t23_[0], &si->t23_[2] } ;
+
+    for(
+        uint32_t i = 0
+    ;   i < 4
+    ;   ++i
+    )
+    {
+        float const x = rv->pxpytutv_4_4_[i][0] * t->sx_ ;
+        float const y = rv->pxpytutv_4_4_[i][1] * t->sy_ ;
+        dst[i][0] = t->px_ + c * x - s * y ;
+        dst[i][1] = t->py_ + s * x + c * y ;
+        uv[i][0]  = rv->pxpytutv_4_4_[i][2] ;
+        uv[i][1]  = rv->pxpytutv_4_4_[i][3] ;
+    }
+
+    if(rh)
+    {
+        for(uint32_t i = 0 ; i < max_rect_2d_hull_vertices ; ++i)
+        {
+            si->st_[i] = (uint32_t) rh->st_[i][0] | ((uint32_t) rh->st_[i][1] << 16) ;
+        }
+    }
+    else
+    {
+        SDL_memcpy(si->st_, quad_st, sizeof(quad_st)) ;
+    }
+
+    si->color_  = tint ;
+    si->z_      = z ;
+}
+
+
+// Layers are stacked in the depth buffer, every layer is in front of all
+// lower ones. The buffer is cleared to 1, which no sprite may reach.
+static float
+calc_sprite_z(
+    uint8_t const   layer
+,   float const     depth
+)
+{
+    float const d = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth) ;
+    return ((float) (UINT8_MAX - layer) + d) / (float) (UINT8_MAX + 2) ;
+}
+
+
+typedef struct cull_range_param
+{
+    sprite_batch *  sb_ ;
+    float           left_ ;
+    float           top_ ;
+    float           right_ ;
+    float           bottom_ ;
+
+} cull_range_param ;
+
+
+static void
+cull_range(
+    void *          param
+,   uint32_t const  begin
+,   uint32_t const  end
+)
+{
+    cull_range_param const *    cp = (cull_range_param const *) param ;
+    sprite_batch *              sb = cp->sb_ ;
+
+    float const *   cx  = sb->circle_x_ ;
+    float const *   cy  = sb->circle_y_ ;
+    float const *   cr  = sb->circle_r_ ;
+    uint8_t *       v   = sb->visible_ ;
+    uint32_t        i   = begin ;
+
+#if defined(SDL_SSE_INTRINSICS)
+    __m128 const l = _mm_set1_ps(cp->left_) ;
+    __m128 const t = _mm_set1_ps(cp->top_) ;
+    __m128 const r = _mm_set1_ps(cp->right_) ;
+    __m128 const b = _mm_set1_ps(cp->bottom_) ;
+
+    for( ; i + 4 <= end ; i += 4)
+    {
+        __m128 const x  = _mm_loadu_ps(&cx[i]) ;
+        __m128 const y  = _mm_loadu_ps(&cy[i]) ;
+        __m128 const rr = _mm_loadu_ps(&cr[i]) ;
+
+        __m128 const in_x = _mm_and_ps(
+            _mm_cmpge_ps(_mm_add_ps(x, rr), l)
+        ,   _mm_cmple_ps(_mm_sub_ps(x, rr), r)
+        ) ;
+        __m128 const in_y = _mm_and_ps(
+            _mm_cmpge_ps(_mm_add_ps(y, rr), t)
+        ,   _mm_cmple_ps(_mm_sub_ps(y, rr), b)
+        ) ;
+
+        int const m = _mm_movemask_ps(_mm_and_ps(in_x, in_y)) ;
+        v[i + 0] = (uint8_t) ((m >> 0) & 1) ;
+        v[i + 1] = (uint8_t) ((m >> 1) & 1) ;
+        v[i + 2] = (uint8_t) ((m >> 2) & 1) ;
+        v[i + 3] = (uint8_t) ((m >> 3) & 1) ;
+    }
+#endif
+
+    for( ; i < end ; ++i)
+    {
+        v[i] = (uint8_t) (
+            cx[i] + cr[i] >= cp->left_
+        &&  cx[i] - cr[i] <= cp->right_
+        &&  cy[i] + cr[i] >= cp->top_
+        &&  cy[i] - cr[i] <= cp->bottom_
+        ) ;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_sprite_batch(
+    sprite_batch *  out_batch
+,   uint32_t const  capacity
+)
+{
+    require(out_batch) ;
+    require(!out_batch->memory_) ;
+    require(capacity) ;
+
+    size_t const submissions_size   = align_16(sizeof(sprite_submission) * capacity) ;
+    size_t const keys_size          = align_16(sizeof(uint64_t) * capacity) ;
+    size_t const indices_size       = align_16(sizeof(uint32_t) * capacity) ;
+    size_t const draws_size         = align_16(sizeof(sprite_batch_draw) * capacity) ;
+    size_t const circles_size       = align_16(sizeof(float) * capacity) ;
+    size_t const visible_size       = align_16(sizeof(uint8_t) * capacity) ;
+    size_t const total_size         = submissions_size + 2 * keys_size + 2 * indices_size + draws_size + 3 * circles_size + visible_size ;
+
+    uint8_t * m = alloc_memory(uint8_t, total_size) ;
+    if(check(m))
+    {
+        return false ;
+    }
+
+    SDL_memset(out_batch, 0, sizeof(sprite_batch)) ;
+
+    out_batch->memory_          = m ;
+    out_batch->submissions_     = (sprite_submission *) m ;
+    m += submissions_size ;
+    out_batch->keys_            = (uint64_t *) m ;
+    m += keys_size ;
+    out_batch->scratch_keys_    = (uint64_t *) m ;
+    m += keys_size ;
+    out_batch->indices_         = (uint32_t *) m ;
+    m += indices_size ;
+    out_batch->scratch_indices_ = (uint32_t *) m ;
+    m += indices_size ;
+    out_batch->draws_           = (sprite_batch_draw *) m ;
+    m += draws_size ;
+    out_batch->circle_x_        = (float *) m ;
+    m += circles_size ;
+    out_batch->circle_y_        = (float *) m ;
+    m += circles_size ;
+    out_batch->circle_r_        = (float *) m ;
+    m += circles_size ;
+    out_batch->visible_         = m ;
+    out_batch->capacity_        = capacity ;
+
+    return true ;
+}
+
+
+void
+destroy_sprite_batch(
+    sprite_batch *  sb
+)
+{
+    require(sb) ;
+
+    if(sb->memory_)
+    {
+        free_memory(sb->memory_) ;
+    }
+
+    SDL_memset(sb, 0, sizeof(sprite_batch)) ;
+}
+
+
+void
+clear_sprite_batch(
+    sprite_batch *  sb
+)
+{
+    require(sb) ;
+    sb->keys_count_     = 0 ;
+    sb->count_          = 0 ;
+    sb->dropped_count_  = 0 ;
+    sb->visible_count_  = 0 ;
+    sb->culled_count_   = 0 ;
+    sb->draws_count_    = 0 ;
+}
+
+
+uint16_t
+add_sprite_batch_atlas(
+    sprite_batch *          sb
+,   sprite_2d_ptr const *   atlas
+)
+{
+    require(sb) ;
+    require(atlas) ;
+    require(atlas->this_) ;
+    require(sb->atlases_count_ < max_sprite_batch_atlases) ;
+
+    uint16_t const idx = (uint16_t) sb->atlases_count_++ ;
+    sb->atlases_[idx] = atlas ;
+    return idx ;
+}
+
+
+uint64_t
+make_sprite_sort_key(
+    uint8_t const   layer
+,   uint8_t const   pipeline
+,   uint16_t const  texture
+,   float const     depth
+)
+{
+    float const     d   = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth) ;
+    uint64_t const  top = ((uint64_t) pipeline << sprite_key_pipeline_shift) | ((uint64_t) layer << sprite_key_layer_shift) ;
+
+    if(sprite_batch_pipeline_opaque == pipeline)
+    {
+        uint64_t const qd = (uint64_t) (d * (float) sprite_key_depth_max) ;
+        return
+            top
+        |   ((uint64_t) texture << sprite_key_opaque_texture_shift)
+        |   ((qd & sprite_key_depth_max) << sprite_key_opaque_depth_shift)
+        ;
+    }
+
+    uint64_t const qd = (uint64_t) ((1.0f - d) * (float) sprite_key_depth_max) ;
+    return
+        top
+    |   ((qd & sprite_key_depth_max) << sprite_key_translucent_depth_shift)
+    |   ((uint64_t) texture << sprite_key_translucent_texture_shift)
+    ;
+}
+
+
+bool
+submit_sprite(
+    sprite_batch *              sb
+,   uint16_t const              atlas
+,   uint16_t const              frame
+,   sprite_transform const *    transform
+,   uint8_t const               layer
+,   uint32_t const              tint
+)
+{
+    require(sb) ;
+    require(transform) ;
+    require(atlas < sb->atlases_count_) ;
+    require(frame < sb->atlases_[atlas]->this_->vertices_count_) ;
+
+    if(sb->count_ >= sb->capacity_)
+    {
+        ++sb->dropped_count_ ;
+        return false ;
+    }
+
+    uint32_t const          i   = sb->count_++ ;
+    sprite_2d_ptr const *   sp  = sb->atlases_[atlas] ;
+    require(frame < sp->this_->infos_count_) ;
+
+    sprite_submission * ss = &sb->submissions_[i] ;
+    ss->transform_  = *transform ;
+    ss->tint_       = tint ;
+    ss->atlas_      = atlas ;
+    ss->frame_      = frame ;
+    ss->z_          = calc_sprite_z(layer, transform->depth_) ;
+
+    // a translucent tint makes any frame translucent.
+    bool const opaque =
+        (sp->infos_[frame].flags_ & rect_2d_info_flag_opaque)
+    &&  0xFF == (tint >> 24)
+    ;
+
+    require(sb->keys_count_ == i) ;
+    sb->keys_[i]    = opaque
+        ? make_sprite_sort_key(0, sprite_batch_pipeline_opaque, atlas, ss->z_)
+        : make_sprite_sort_key(layer, sprite_batch_pipeline_translucent, atlas, transform->depth_)
+        ;
+    sb->indices_[i] = i ;
+    sb->keys_count_ = sb->count_ ;
+
+    // the circle is in the same space as the frame's vertices, it gets the
+    // same scale and rotation. +1 makes up for the integer radius.
+    rect_2d_bounding_info const *   bi  = &sp->infos_[frame].bounding_info_ ;
+
+    float const c   = SDL_cosf(transform->rotation_) ;
+    float const s   = SDL_sinf(transform->rotation_) ;
+    float const ox  = (float) bi->circle_offset_x_ * transform->sx_ ;
+    float const oy  = (float) bi->circle_offset_y_ * transform->sy_ ;
+    float const asx = SDL_fabsf(transform->sx_) ;
+    float const asy = SDL_fabsf(transform->sy_) ;
+
+    sb->circle_x_[i] = transform->px_ + c * ox - s * oy ;
+    sb->circle_y_[i] = transform->py_ + s * ox + c * oy ;
+    sb->circle_r_[i] = (float) (bi->circle_radius_ + 1) * (asx > asy ? asx : asy) ;
+
+    return true ;
+}
+
+
+void
+cull_sprite_batch(
+    sprite_batch *  sb
+,   float const     left
+,   float const     top
+,   float const     right
+,   float const     bottom
+)
+{
+    require(sb) ;
+    require(sb->keys_count_ == sb->count_) ;
+    begin_timed_block() ;
+
+    cull_range_param cp = { 0 } ;
+    cp.sb_      = sb ;
+    cp.left_    = left ;
+    cp.top_     = top ;
+    cp.right_   = right ;
+    cp.bottom_  = bottom ;
+
+    run_parallel_for(cull_range, &cp, sb->count_, sprite_cull_min_range) ;
+
+    // keys and indices are still in submission order, compact them.
+    uint32_t n = 0 ;
+    for(
+        uint32_t i = 0
+    ;   i < sb->count_
+    ;   ++i
+    )
+    {
+        if(sb->visible_[i])
+        {
+            sb->keys_[n]    = sb->keys_[i] ;
+            sb->indices_[n] = sb->indices_[i] ;
+            ++n ;
+        }
+    }
+
+    sb->keys_count_     = n ;
+    sb->visible_count_  = n ;
+    sb->culled_count_   = sb->count_ - n ;
+
+    end_timed_block() ;
+}
+
+
+void
+sort_sprite_batch(
+    sprite_batch *  sb
+)
+{
+    require(sb) ;
+    begin_timed_block() ;
+
+    if(sb->keys_count_ > 1)
+    {
+        radix_sort_keys(
+            sb->keys_
+        ,   sb->indices_
+        ,   sb->scratch_keys_
+        ,   sb->scratch_indices_
+        ,   sb->keys_count_
+        ) ;
+    }
+
+    end_timed_block() ;
+}
+
+
+uint32_t
+write_sprite_batch(
+    sprite_batch *          sb
+,   sprite_submission *     out_submissions
+,   uint32_t const          max_submissions
+)
+{
+    require(sb) ;
+    require(out_submissions) ;
+    begin_timed_block() ;
+
+    uint32_t const      count   = sb->keys_count_ < max_submissions ? sb->keys_count_ : max_submissions ;
+    sprite_batch_draw * draw    = NULL ;
+
+    sb->draws_count_ = 0 ;
+
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        uint64_t const key  = sb->keys_[i] ;
+        out_submissions[i]  = sb->submissions_[sb->indices_[i]] ;
+
+        // a new draw only when pipeline or texture change, the layer or
+        // depth alone does not need one.
+        uint16_t const pipeline = get_sprite_key_pipeline(key) ;
+        uint16_t const texture  = get_sprite_key_texture(key) ;
+        if(
+            !draw
+        ||  draw->pipeline_ != pipeline
+        ||  draw->texture_ != texture
+        )
+        {
+            draw = &sb->draws_[sb->draws_count_++] ;
+            draw->pipeline_         = pipeline ;
+            draw->texture_          = texture ;
+            draw->first_instance_   = i ;
+            draw->instance_count_   = 0 ;
+        }
+
+        ++draw->instance_count_ ;
+    }
+
+    end_timed_block() ;
+    return count ;
+}
+
+
+void
+write_sprite_instances(
+    sprite_batch const *        sb
+,   sprite_submission const *   submissions
+,   uint32_t const              count
+,   sprite_instance *           out_instances
+)
+{
+    require(sb) ;
+    require(submissions || !count) ;
+    require(out_instances || !count) ;
+    begin_timed_block() ;
+
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        sprite_submission const *   ss  = &submissions[i] ;
+        sprite_2d_ptr const *       sp  = sb->atlases_[ss->atlas_] ;
+
+        // made on the stack and stored whole, mapped memory may be write
+        // combined and is never read back.
+        sprite_instance si ;
+        write_sprite_instance(
+            &si
+        ,   &sp->vertices_[ss->frame_]
+        ,   sp->hulls_ ? &sp->hulls_[ss->frame_] : NULL
+        ,   &ss->transform_
+        ,   ss->tint_
+        ,   ss->z_
+        ) ;
+        out_instances[i] = si ;
+    }
+
+    end_timed_block() ;
+}
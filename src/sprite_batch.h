@@ -0,0 +1,202 @@
+#pragma once
+
+
+#include "types.h"
+#include "asset_sprite.h"
+
+
+#define max_sprite_batch_atlases            16
+
+// opaque sprites are drawn first, front to back and writing depth, the
+// translucent ones after them, back to front and blended.
+#define sprite_batch_pipeline_opaque        0
+#define sprite_batch_pipeline_translucent   1
+#define sprite_batch_pipelines_count        2
+
+
+// Where and how a sprite frame is placed. The frame's rect is scaled, rotated
+// around the sprite origin and then moved to px_, py_ in window pixels.
+// depth_ is in [0, 1], 0 is in front.
+typedef struct sprite_transform
+{
+    float   px_ ;
+    float   py_ ;
+    float   sx_ ;
+    float   sy_ ;
+    float   rotation_ ;
+    float   depth_ ;
+
+} sprite_transform ;
+
+
+// One instance per sprite, the four corners are already transformed. The
+// vertex shader places the frame's hull vertex gl_VertexIndex inside of them,
+// st_ holds s | t << 16 per vertex, see rect_2d_hull. z_ goes to the depth
+// buffer, it has the layer and the depth in it.
+typedef struct sprite_instance
+{
+    float       p01_[4] ;
+    float       p23_[4] ;
+    float       t01_[4] ;
+    float       t23_[4] ;
+    uint32_t    st_[max_rect_2d_hull_vertices] ;
+    uint32_t    color_ ;
+    float       z_ ;
+
+} sprite_instance ;
+
+
+typedef struct sprite_submission
+{
+    sprite_transform    transform_ ;
+    uint32_t            tint_ ;
+    uint16_t            atlas_ ;
+    uint16_t            frame_ ;
+    float               z_ ;
+
+} sprite_submission ;
+
+
+// A run of sorted instances which share pipeline and texture, one draw each.
+typedef struct sprite_batch_draw
+{
+    uint16_t    pipeline_ ;
+    uint16_t    texture_ ;
+    uint32_t    first_instance_ ;
+    uint32_t    instance_count_ ;
+
+} sprite_batch_draw ;
+
+
+// Sprites are submitted in any order during update, culled, sorted by a 64
+// bit key and written out as sorted submissions plus the list of draws, the
+// instances are made of them where they are drawn. Frames which are opaque
+// in the atlas and have an opaque tint go to the opaque pipeline, grouped by
+// texture and then front to back, the depth test keeps them in order. The
+// translucent ones are drawn layer by layer and back to front within a
+// layer, sprites from different atlases included. Only those of equal depth
+// are grouped by texture, so mixed atlases cost more draws.
+// The bounding circle of every submission is kept apart from the rest,
+// cull_sprite_batch tests four of them at a time.
+typedef struct sprite_batch
+{
+    sprite_2d_ptr const *   atlases_[max_sprite_batch_atlases] ;
+    uint32_t                atlases_count_ ;
+
+    sprite_submission *     submissions_ ;
+    uint64_t *              keys_ ;
+    uint32_t *              indices_ ;
+    uint64_t *              scratch_keys_ ;
+    uint32_t *              scratch_indices_ ;
+    uint32_t                keys_count_ ;
+    uint32_t                count_ ;
+    uint32_t                capacity_ ;
+    uint32_t                dropped_count_ ;
+
+    float *                 circle_x_ ;
+    float *                 circle_y_ ;
+    float *                 circle_r_ ;
+    uint8_t *               visible_ ;
+    uint32_t                visible_count_ ;
+    uint32_t                culled_count_ ;
+
+    sprite_batch_draw *     draws_ ;
+    uint32_t                draws_count_ ;
+    void *                  memory_ ;
+
+} sprite_batch ;
+
+
+// colors are stored as r, g, b, a bytes, which is VK_FORMAT_R8G8B8A8_UNORM.
+#define make_sprite_tint(r, g, b, a) \
+    ((uint32_t)(r) | ((uint32_t)(g) << 8) | ((uint32_t)(b) << 16) | ((uint32_t)(a) << 24))
+
+#define sprite_tint_white   make_sprite_tint(255, 255, 255, 255)
+
+
+bool
+create_sprite_batch(
+    sprite_batch *  out_batch
+,   uint32_t const  capacity
+) ;
+
+
+void
+destroy_sprite_batch(
+    sprite_batch *  sb
+) ;
+
+
+void
+clear_sprite_batch(
+    sprite_batch *  sb
+) ;
+
+
+uint16_t
+add_sprite_batch_atlas(
+    sprite_batch *          sb
+,   sprite_2d_ptr const *   atlas
+) ;
+
+
+// Opaque keys sort by texture and then depth front to back, translucent ones
+// by depth back to front and then texture.
+uint64_t
+make_sprite_sort_key(
+    uint8_t const   layer
+,   uint8_t const   pipeline
+,   uint16_t const  texture
+,   float const     depth
+) ;
+
+
+bool
+submit_sprite(
+    sprite_batch *              sb
+,   uint16_t const              atlas
+,   uint16_t const              frame
+,   sprite_transform const *    transform
+,   uint8_t const               layer
+,   uint32_t const              tint
+) ;
+
+
+// Drops every submission whose bounding circle is outside of the rect, in
+// window pixels. Runs once after all submissions and before sorting.
+void
+cull_sprite_batch(
+    sprite_batch *  sb
+,   float const     left
+,   float const     top
+,   float const     right
+,   float const     bottom
+) ;
+
+
+void
+sort_sprite_batch(
+    sprite_batch *  sb
+) ;
+
+
+// Copies the sorted submissions out and makes the draws, sb->draws_ counts
+// in those submissions. No instance is made here.
+uint32_t
+write_sprite_batch(
+    sprite_batch *          sb
+,   sprite_submission *     out_submissions
+,   uint32_t const          max_submissions
+) ;
+
+
+// One instance per sorted submission, meant to be written straight into
+// mapped memory. Only the atlases of sb are read, they don't change once
+// added, so this may run on another thread than the one filling the batch.
+void
+write_sprite_instances(
+    sprite_batch const *        sb
+,   sprite_submission const *   submissions
+,   uint32_t const              count
+,   sprite_instance *           out_instances
+) ;
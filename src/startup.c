@@ -0,0 +1,101 @@
+#include "startup.h"
+#include "app.h"
+#include "defines.h"
+#include "log.h"
+
+
+typedef struct startup_timeline
+{
+    uint64_t    begin_[startup_phases_count] ;
+    uint64_t    total_[startup_phases_count] ;
+    uint32_t    depth_[startup_phases_count] ;
+    bool        ended_ ;
+
+} startup_timeline ;
+
+
+static startup_timeline st_ = { 0 } ;
+
+
+static char const * const startup_phase_names[startup_phases_count] =
+{
+    "app"
+,   "instance"
+,   "device"
+,   "swapchain"
+,   "pipelines"
+,   "assets"
+} ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+void
+begin_startup_phase(
+    uint32_t const  phase
+)
+{
+    require(phase < startup_phases_count) ;
+
+    if(st_.ended_)
+    {
+        return ;
+    }
+
+    if(0 == st_.depth_[phase]++)
+    {
+        st_.begin_[phase] = get_app_time() ;
+    }
+}
+
+
+void
+end_startup_phase(
+    uint32_t const  phase
+)
+{
+    require(phase < startup_phases_count) ;
+
+    if(st_.ended_)
+    {
+        return ;
+    }
+
+    require(st_.depth_[phase]) ;
+    if(0 == --st_.depth_[phase])
+    {
+        st_.total_[phase] += get_app_time() - st_.begin_[phase] ;
+    }
+}
+
+
+void
+end_startup_timeline()
+{
+    if(st_.ended_)
+    {
+        return ;
+    }
+    st_.ended_ = true ;
+
+    double const    to_ms   = get_performance_frequency_inverse() * 1000.0 ;
+    uint64_t const  total   = get_app_time() ;
+    uint64_t        phases  = 0 ;
+
+    for(
+        uint32_t i = 0
+    ;   i < startup_phases_count
+    ;   ++i
+    )
+    {
+        require(0 == st_.depth_[i]) ;
+        phases += st_.total_[i] ;
+        log_info("startup %-10s %8.2f ms", startup_phase_names[i], (double) st_.total_[i] * to_ms) ;
+    }
+
+    // phases that ran inside of each other are counted twice.
+    uint64_t const other = total > phases ? total - phases : 0 ;
+    log_info("startup %-10s %8.2f ms", "other", (double) other * to_ms) ;
+    log_info("startup %-10s %8.2f ms", "total", (double) total * to_ms) ;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+
+#include "types.h"
+
+
+// what the startup time is spent on, phases may run more than once.
+#define startup_phase_app           0
+#define startup_phase_instance      1
+#define startup_phase_device        2
+#define startup_phase_swapchain     3
+#define startup_phase_pipelines     4
+#define startup_phase_assets        5
+#define startup_phases_count        6
+
+
+// Adds the time between begin and end to the phase. A phase begun again
+// before it ended is only counted once, so loading an asset inside of
+// another doesn't count twice. After end_startup_timeline both do nothing.
+void
+begin_startup_phase(
+    uint32_t const  phase
+) ;
+
+
+void
+end_startup_phase(
+    uint32_t const  phase
+) ;
+
+
+// Logs the milliseconds of every phase and the time since the app started,
+// the rest of it is in none of the phases.
+void
+end_startup_timeline() ;
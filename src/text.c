@@ -0,0 +1,233 @@
+#include "text.h"
+#include "asset_font.h"
+#include "app.h"
+#include "defines.h"
+#include "check.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static uint32_t
+next_codepoint(
+    char const **   str
+)
+{
+    require(str) ;
+    require(*str) ;
+
+    uint8_t const * s = (uint8_t const *) *str ;
+    uint32_t        c = s[0] ;
+    uint32_t        n = 0 ;
+
+    if(c < 0x80)
+    {
+        n = 0 ;
+    }
+    else if((c & 0xE0) == 0xC0)
+    {
+        c &= 0x1F ;
+        n = 1 ;
+    }
+    else if((c & 0xF0) == 0xE0)
+    {
+        c &= 0x0F ;
+        n = 2 ;
+    }
+    else if((c & 0xF8) == 0xF0)
+    {
+        c &= 0x07 ;
+        n = 3 ;
+    }
+    else
+    {
+        *str += 1 ;
+        return '?' ;
+    }
+
+    for(
+        uint32_t i = 1
+    ;   i <= n
+    ;   ++i
+    )
+    {
+        if((s[i] & 0xC0) != 0x80)
+        {
+            *str += i ;
+            return '?' ;
+        }
+        c = (c << 6) | (s[i] & 0x3F) ;
+    }
+
+    *str += n + 1 ;
+    return c ;
+}
+
+
+static text_instance *
+push_text_instance(
+    text_batch *    tb
+)
+{
+    require(tb) ;
+
+    if(tb->count_ >= tb->capacity_)
+    {
+        return NULL ;
+    }
+
+    return &tb->instances_[tb->count_++] ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_text_batch(
+    text_batch *        out_batch
+,   font_2d_ptr const * font
+,   uint16_t const      group_index
+,   uint32_t const      capacity
+)
+{
+    require(out_batch) ;
+    require(!out_batch->instances_) ;
+    require(font) ;
+    require(font->this_) ;
+    require(group_index < font->this_->groups_count_) ;
+    require(capacity) ;
+
+    out_batch->instances_ = alloc_array(text_instance, capacity) ;
+    if(check(out_batch->instances_))
+    {
+        return false ;
+    }
+
+    out_batch->font_        = font ;
+    out_batch->group_index_ = group_index ;
+    out_batch->count_       = 0 ;
+    out_batch->capacity_    = capacity ;
+
+    return true ;
+}
+
+
+void
+destroy_text_batch(
+    text_batch *    tb
+)
+{
+    require(tb) ;
+
+    if(tb->instances_)
+    {
+        free_memory(tb->instances_) ;
+    }
+
+    SDL_memset(tb, 0, sizeof(text_batch)) ;
+}
+
+
+void
+clear_text_batch(
+    text_batch *    tb
+)
+{
+    require(tb) ;
+    tb->count_ = 0 ;
+}
+
+
+float
+get_text_line_height(
+    text_batch const *  tb
+)
+{
+    require(tb) ;
+    require(tb->font_) ;
+    return tb->font_->groups_[tb->group_index_].line_height_ ;
+}
+
+
+float
+add_text(
+    text_batch *    tb
+,   float const     x
+,   float const     y
+,   uint32_t const  color
+,   char const *    str
+)
+{
+    require(tb) ;
+    require(tb->font_) ;
+    require(str) ;
+
+    font_2d_group const * g = &tb->font_->groups_[tb->group_index_] ;
+    float const baseline = y + g->ascender_ ;
+    float       pen_x    = x ;
+
+    for( ; *str ; )
+    {
+        uint32_t const cp = next_codepoint(&str) ;
+
+        font_2d_glyph const * fg = find_font_glyph(tb->font_, tb->group_index_, cp) ;
+        if(!fg)
+        {
+            pen_x += g->space_advance_ ;
+            continue ;
+        }
+
+        text_instance * ti = push_text_instance(tb) ;
+        if(!ti)
+        {
+            break ;
+        }
+
+        ti->px_     = pen_x + fg->offset_x_ ;
+        ti->py_     = baseline + fg->offset_y_ ;
+        ti->pw_     = fg->w_ ;
+        ti->ph_     = fg->h_ ;
+        ti->u0_     = fg->u0_ ;
+        ti->v0_     = fg->v0_ ;
+        ti->u1_     = fg->u1_ ;
+        ti->v1_     = fg->v1_ ;
+        ti->color_  = color ;
+
+        pen_x += fg->advance_ ;
+    }
+
+    return pen_x ;
+}
+
+
+void
+add_text_rect(
+    text_batch *    tb
+,   float const     x
+,   float const     y
+,   float const     w
+,   float const     h
+,   uint32_t const  color
+)
+{
+    require(tb) ;
+
+    text_instance * ti = push_text_instance(tb) ;
+    if(!ti)
+    {
+        return ;
+    }
+
+    ti->px_     = x ;
+    ti->py_     = y ;
+    ti->pw_     = w ;
+    ti->ph_     = h ;
+    ti->u0_     = -1.0f ;
+    ti->v0_     = -1.0f ;
+    ti->u1_     = -1.0f ;
+    ti->v1_     = -1.0f ;
+    ti->color_  = color ;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+
+#include "types.h"
+
+
+typedef struct font_2d_ptr font_2d_ptr ;
+
+
+// One instance per glyph or solid rect, the text render object draws all of
+// them with a single instanced draw. Positions are in window pixels with the
+// origin in the top left corner. A negative u0_ draws a solid rect, so bars
+// and backgrounds share the draw with the glyphs.
+typedef struct text_instance
+{
+    float       px_ ;
+    float       py_ ;
+    float       pw_ ;
+    float       ph_ ;
+    float       u0_ ;
+    float       v0_ ;
+    float       u1_ ;
+    float       v1_ ;
+    uint32_t    color_ ;
+
+} text_instance ;
+
+
+typedef struct text_batch
+{
+    font_2d_ptr const * font_ ;
+    uint16_t            group_index_ ;
+    text_instance *     instances_ ;
+    uint32_t            count_ ;
+    uint32_t            capacity_ ;
+
+} text_batch ;
+
+
+// colors are stored as r, g, b, a bytes, which is VK_FORMAT_R8G8B8A8_UNORM.
+#define make_text_color(r, g, b, a) \
+    ((uint32_t)(r) | ((uint32_t)(g) << 8) | ((uint32_t)(b) << 16) | ((uint32_t)(a) << 24))
+
+
+bool
+create_text_batch(
+    text_batch *        out_batch
+,   font_2d_ptr const * font
+,   uint16_t const      group_index
+,   uint32_t const      capacity
+) ;
+
+
+void
+destroy_text_batch(
+    text_batch *    tb
+) ;
+
+
+void
+clear_text_batch(
+    text_batch *    tb
+) ;
+
+
+float
+get_text_line_height(
+    text_batch const *  tb
+) ;
+
+
+float
+add_text(
+    text_batch *    tb
+,   float const     x
+,   float const     y
+,   uint32_t const  color
+,   char const *    str
+) ;
+
+
+void
+add_text_rect(
+    text_batch *    tb
+,   float const     x
+,   float const     y
+,   float const     w
+,   float const     h
+,   uint32_t const  color
+) ;
@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../asset_texture.c"
+
+
+// one 4x4 bc3 texture, header, level table and block 16 byte aligned the way
+// threed_atlas writes them.
+#define test_levels_offset  32
+#define test_block_offset   48
+#define test_file_size      64
+
+
+void *
+alloc_memory_impl(
+    size_t const    byte_count
+,   int const       clear_memory
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    return clear_memory ? calloc(1, byte_count) : malloc(byte_count) ;
+}
+
+
+void
+free_memory_impl(
+    void *          mem
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    free(mem) ;
+}
+
+
+void
+dump_texture_2d(
+    texture_2d const *  p
+)
+{
+    (void) p ;
+}
+
+
+static uint8_t  test_file_[test_file_size] ;
+static uint64_t test_file_size_ = test_file_size ;
+
+
+// load_asset_texture reads test_file_, the name isn't looked at.
+bool
+load_file(
+    void **             out_memory
+,   uint64_t *          out_size
+,   char const * const  fullname
+)
+{
+    (void) fullname ;
+
+    *out_memory = malloc(test_file_size_) ;
+    assert(*out_memory) ;
+    memcpy(*out_memory, test_file_, test_file_size_) ;
+    *out_size = test_file_size_ ;
+    return true ;
+}
+
+
+// alpha 255 and 0 with the six steps in between, pixel 0 takes the first,
+// pixel 1 the second and pixel 2 the first step. The colors are pure red and
+// pure blue, pixels 0 to 3 take red, blue and the two thirds between them,
+// the rest is red.
+static uint8_t const test_block[16] =
+{
+    0xff, 0x00
+,   0x88, 0x00, 0x00, 0x00, 0x00, 0x00
+,   0x00, 0xf8
+,   0x1f, 0x00
+,   0xe4, 0x00, 0x00, 0x00
+} ;
+
+
+static uint8_t const test_pixels[4][4] =
+{
+    { 255,   0,   0, 255 }
+,   {   0,   0, 255,   0 }
+,   { 170,   0,  85, 218 }
+,   {  85,   0, 170, 255 }
+} ;
+
+
+void
+make_test_file()
+{
+    memset(test_file_, 0, sizeof(test_file_)) ;
+    test_file_size_ = test_file_size ;
+
+    texture_2d * p = (texture_2d *) test_file_ ;
+    p->tid_             = texture_2d_tid ;
+    p->format_          = texture_2d_format_bc3 ;
+    p->levels_count_    = 1 ;
+    p->width_           = 4 ;
+    p->height_          = 4 ;
+    p->levels_offset_   = test_levels_offset ;
+
+    texture_2d_level * l = (texture_2d_level *) (test_file_ + test_levels_offset) ;
+    l->offset_  = test_block_offset ;
+    l->size_    = 16 ;
+    l->width_   = 4 ;
+    l->height_  = 4 ;
+
+    memcpy(test_file_ + test_block_offset, test_block, sizeof(test_block)) ;
+}
+
+
+void
+test_decode()
+{
+    make_test_file() ;
+
+    texture_2d_ptr tp = load_asset_texture("test.tex") ;
+    assert(tp.this_) ;
+    assert(tp.levels_) ;
+
+    uint8_t pixels[4 * 4 * 4] = { 0 } ;
+    decode_texture_2d_bc3(pixels, tp.this_, &tp.levels_[0]) ;
+
+    for(uint32_t i = 0 ; i < 16 ; ++i)
+    {
+        uint8_t const * e = i < 4 ? test_pixels[i] : test_pixels[0] ;
+        assert(0 == memcmp(&pixels[i * 4], e, 4)) ;
+    }
+
+    free(tp.this_) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+void
+test_reject_broken_levels()
+{
+    texture_2d_level * l = (texture_2d_level *) (test_file_ + test_levels_offset) ;
+
+    // more bytes than a 4x4 bc3 level has.
+    make_test_file() ;
+    l->size_ = 32 ;
+    assert(!load_asset_texture("test.tex").this_) ;
+
+    // past the end of the file.
+    make_test_file() ;
+    l->offset_ = test_file_size - 8 ;
+    assert(!load_asset_texture("test.tex").this_) ;
+
+    // a level which isn't the next of the chain.
+    make_test_file() ;
+    l->width_ = 8 ;
+    assert(!load_asset_texture("test.tex").this_) ;
+
+    // cut off in the middle of the block.
+    make_test_file() ;
+    test_file_size_ = test_file_size - 4 ;
+    assert(!load_asset_texture("test.tex").this_) ;
+
+    printf("%s okay.\n", __func__) ;
+}
+
+
+int
+main(
+    int     argc
+,   char *  argv[]
+)
+{
+    (void) argc ;
+    (void) argv ;
+
+    test_decode() ;
+    test_reject_broken_levels() ;
+    return 0 ;
+}
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include <SDL3/SDL_thread.h>
+
+#include "../frame_packet.c"
+
+
+#define test_instances_capacity 1024
+#define test_packets_count      20000
+
+
+void *
+alloc_memory_impl(
+    size_t const    byte_count
+,   int const       clear_memory
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    return clear_memory ? calloc(1, byte_count) : malloc(byte_count) ;
+}
+
+
+void
+free_memory_impl(
+    void *          mem
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    free(mem) ;
+}
+
+
+// every instance of a packet gets the packet's frame, a packet which is
+// written while it is read shows up as a mix of frames.
+void
+write_packet(
+    frame_mailbox * fm
+)
+{
+    frame_packet * fp = get_back_frame_packet(fm) ;
+    fp->submissions_count_ = 1 + (uint32_t) (fp->frame_ % test_instances_capacity) ;
+    for(uint32_t i = 0 ; i < fp->submissions_count_ ; ++i)
+    {
+        fp->submissions_[i].tint_ = (uint32_t) fp->frame_ ;
+    }
+    put_frame_packet(fm) ;
+}
+
+
+void
+assert_packet(
+    frame_packet const *    fp
+)
+{
+    assert(fp->submissions_count_ == 1 + (uint32_t) (fp->frame_ % test_instances_capacity)) ;
+    for(uint32_t i = 0 ; i < fp->submissions_count_ ; ++i)
+    {
+        assert(fp->submissions_[i].tint_ == (uint32_t) fp->frame_) ;
+    }
+}
+
+
+// packets which weren't taken are dropped, the newest one is drawn once.
+void
+test_newest_wins()
+{
+    frame_mailbox fm = { 0 } ;
+    assert(create_frame_mailbox(&fm, test_instances_capacity)) ;
+
+    assert(!take_frame_packet(&fm)) ;
+
+    write_packet(&fm) ;
+    write_packet(&fm) ;
+    write_packet(&fm) ;
+
+    frame_packet const * fp = take_frame_packet(&fm) ;
+    assert(fp) ;
+    assert(3 == fp->frame_) ;
+    assert_packet(fp) ;
+    assert(!take_frame_packet(&fm)) ;
+
+    // the taken packet isn't handed out to the writer again.
+    write_packet(&fm) ;
+    assert(3 == fp->frame_) ;
+    assert_packet(fp) ;
+
+    fp = take_frame_packet(&fm) ;
+    assert(fp) ;
+    assert(4 == fp->frame_) ;
+
+    destroy_frame_mailbox(&fm) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+static SDL_AtomicInt reader_started_ = { 0 } ;
+
+
+static int
+run_writer(
+    void *  data
+)
+{
+    frame_mailbox * fm = (frame_mailbox *) data ;
+
+    // both threads run at the same time, or there is nothing to test.
+    while(!SDL_GetAtomicInt(&reader_started_))
+    {
+    }
+
+    for(uint32_t i = 0 ; i < test_packets_count ; ++i)
+    {
+        write_packet(fm) ;
+    }
+    return 0 ;
+}
+
+
+// one thread writes as fast as it can while this one takes, every packet
+// taken is whole and newer than the one before.
+void
+test_no_tearing()
+{
+    frame_mailbox fm = { 0 } ;
+    assert(create_frame_mailbox(&fm, test_instances_capacity)) ;
+
+    SDL_Thread * writer = SDL_CreateThread(run_writer, "writer", &fm) ;
+    assert(writer) ;
+
+    uint64_t last_frame     = 0 ;
+    uint32_t taken_count    = 0 ;
+    SDL_SetAtomicInt(&reader_started_, 1) ;
+    while(last_frame < test_packets_count)
+    {
+        frame_packet const * fp = take_frame_packet(&fm) ;
+        if(!fp)
+        {
+            continue ;
+        }
+        assert(fp->frame_ > last_frame) ;
+        assert_packet(fp) ;
+        last_frame = fp->frame_ ;
+        ++taken_count ;
+    }
+
+    SDL_WaitThread(writer, NULL) ;
+    destroy_frame_mailbox(&fm) ;
+    printf("%s okay, %u of %u packets taken.\n", __func__, taken_count, test_packets_count) ;
+}
+
+
+int
+main(
+    int     argc
+,   char *  argv[]
+)
+{
+    (void) argc ;
+    (void) argv ;
+
+    test_newest_wins() ;
+    test_no_tearing() ;
+    return 0 ;
+}
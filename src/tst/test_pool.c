@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../pool.c"
+
+
+void *
+alloc_memory_impl(
+    size_t const    byte_count
+,   int const       clear_memory
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    return clear_memory ? calloc(1, byte_count) : malloc(byte_count) ;
+}
+
+
+void *
+alloc_array_impl(
+    size_t const    count
+,   size_t const    byte_size
+,   int const       clear_memory
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    return clear_memory ? calloc(count, byte_size) : malloc(count * byte_size) ;
+}
+
+
+void
+free_memory_impl(
+    void *          mem
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    free(mem) ;
+}
+
+
+typedef struct element
+{
+    uint32_t    value_ ;
+    uint32_t    pad_ ;
+
+} element ;
+
+
+// a freed slot is handed out again with the next generation, the old handle
+// doesn't find it any more.
+void
+test_generation_reuse()
+{
+    pool p = { 0 } ;
+    assert(create_typed_pool(&p, element, 4)) ;
+
+    pool_handle const a = alloc_pool_element(&p) ;
+    assert(is_pool_handle_valid(&p, a)) ;
+    pool_get(element, &p, a)->value_ = 1 ;
+
+    assert(free_pool_element(&p, a)) ;
+    assert(!is_pool_handle_valid(&p, a)) ;
+    assert(!get_pool_element(&p, a)) ;
+    assert(!free_pool_element(&p, a)) ;
+
+    pool_handle const b = alloc_pool_element(&p) ;
+    assert(b.index_ == a.index_) ;
+    assert(b.generation_ != a.generation_) ;
+    assert(is_pool_handle_valid(&p, b)) ;
+    assert(!is_pool_handle_valid(&p, a)) ;
+
+    // allocated elements are cleared.
+    assert(0 == pool_get(element, &p, b)->value_) ;
+
+    destroy_pool(&p) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+// freeing from the middle moves the last element into the hole, the handles
+// of all others still find their element.
+void
+test_swap_remove()
+{
+    pool p = { 0 } ;
+    assert(create_typed_pool(&p, element, 4)) ;
+
+    pool_handle h[4] = { 0 } ;
+    for(uint32_t i = 0 ; i < 4 ; ++i)
+    {
+        h[i] = alloc_pool_element(&p) ;
+        pool_get(element, &p, h[i])->value_ = 10 + i ;
+    }
+    assert(pool_is_full(&p)) ;
+    assert(invalid_pool_index == alloc_pool_element(&p).index_) ;
+
+    assert(free_pool_element(&p, h[1])) ;
+    assert(3 == pool_count(&p)) ;
+
+    element const * data = pool_data(element, &p) ;
+    assert(10 == data[0].value_) ;
+    assert(13 == data[1].value_) ;
+    assert(12 == data[2].value_) ;
+
+    assert(10 == pool_get(element, &p, h[0])->value_) ;
+    assert(12 == pool_get(element, &p, h[2])->value_) ;
+    assert(13 == pool_get(element, &p, h[3])->value_) ;
+
+    for(uint32_t i = 0 ; i < pool_count(&p) ; ++i)
+    {
+        pool_handle const hi = get_pool_handle_at(&p, i) ;
+        assert(pool_get(element, &p, hi) == pool_at(element, &p, i)) ;
+    }
+
+    clear_pool(&p) ;
+    assert(0 == pool_count(&p)) ;
+    assert(!is_pool_handle_valid(&p, h[0])) ;
+
+    destroy_pool(&p) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+// a stable pool swaps only the index tables, elements stay where they are.
+void
+test_stable()
+{
+    pool p = { 0 } ;
+    assert(create_typed_stable_pool(&p, element, 4)) ;
+
+    pool_handle h[4]    = { 0 } ;
+    element *   e[4]    = { 0 } ;
+    for(uint32_t i = 0 ; i < 4 ; ++i)
+    {
+        h[i] = alloc_pool_element(&p) ;
+        e[i] = pool_get(element, &p, h[i]) ;
+        e[i]->value_ = 10 + i ;
+    }
+
+    assert(free_pool_element(&p, h[0])) ;
+    assert(free_pool_element(&p, h[2])) ;
+    assert(2 == pool_count(&p)) ;
+
+    assert(e[1] == pool_get(element, &p, h[1])) ;
+    assert(e[3] == pool_get(element, &p, h[3])) ;
+    assert(11 == e[1]->value_) ;
+    assert(13 == e[3]->value_) ;
+
+    uint32_t sum = 0 ;
+    for(uint32_t i = 0 ; i < pool_count(&p) ; ++i)
+    {
+        sum += pool_at(element, &p, i)->value_ ;
+    }
+    assert(11 + 13 == sum) ;
+
+    pool_handle const n = alloc_pool_element(&p) ;
+    assert(is_pool_handle_valid(&p, n)) ;
+    assert(e[1] == pool_get(element, &p, h[1])) ;
+    assert(e[3] == pool_get(element, &p, h[3])) ;
+
+    destroy_pool(&p) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+int
+main(
+    int     argc
+,   char *  argv[]
+)
+{
+    (void) argc ;
+    (void) argv ;
+
+    test_generation_reuse() ;
+    test_swap_remove() ;
+    test_stable() ;
+    return 0 ;
+}
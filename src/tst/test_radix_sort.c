@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../sprite_batch.c"
+
+
+#define test_keys_count 4096
+
+
+void *
+alloc_memory_impl(
+    size_t const    byte_count
+,   int const       clear_memory
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    return clear_memory ? calloc(1, byte_count) : malloc(byte_count) ;
+}
+
+
+void
+free_memory_impl(
+    void *          mem
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    free(mem) ;
+}
+
+
+// no workers here, the whole range runs on this thread.
+void
+run_parallel_for(
+    fn_job_range_func * func
+,   void *              param
+,   uint32_t const      count
+,   uint32_t const      min_range
+)
+{
+    (void) min_range ;
+
+    func(param, 0, count) ;
+}
+
+
+static uint64_t keys[test_keys_count] ;
+static uint32_t indices[test_keys_count] ;
+static uint64_t scratch_keys[test_keys_count] ;
+static uint32_t scratch_indices[test_keys_count] ;
+static uint64_t original_keys[test_keys_count] ;
+
+
+// few distinct keys, so most of them are equal to others. The indices are
+// the submission order, which equal keys have to keep.
+void
+fill_keys(
+    uint32_t const  count
+,   uint32_t const  distinct
+)
+{
+    srand(1234) ;
+    for(uint32_t i = 0 ; i < count ; ++i)
+    {
+        uint32_t const r = (uint32_t) rand() % distinct ;
+        keys[i] = make_sprite_sort_key(
+            (uint8_t) (r % 3)
+        ,   (uint8_t) (r % 2)
+        ,   (uint16_t) (r % 5)
+        ,   (float) r / (float) distinct
+        ) ;
+        indices[i]          = i ;
+        original_keys[i]    = keys[i] ;
+    }
+}
+
+
+void
+assert_sorted_and_stable(
+    uint32_t const  count
+)
+{
+    for(uint32_t i = 0 ; i < count ; ++i)
+    {
+        assert(keys[i] == original_keys[indices[i]]) ;
+        if(i > 0)
+        {
+            assert(keys[i - 1] <= keys[i]) ;
+            if(keys[i - 1] == keys[i])
+            {
+                assert(indices[i - 1] < indices[i]) ;
+            }
+        }
+    }
+}
+
+
+void
+test_order_and_stability()
+{
+    fill_keys(test_keys_count, 61) ;
+    radix_sort_keys(keys, indices, scratch_keys, scratch_indices, test_keys_count) ;
+    assert_sorted_and_stable(test_keys_count) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+// every pass is skipped, nothing may move.
+void
+test_equal_keys()
+{
+    fill_keys(test_keys_count, 1) ;
+    radix_sort_keys(keys, indices, scratch_keys, scratch_indices, test_keys_count) ;
+    for(uint32_t i = 0 ; i < test_keys_count ; ++i)
+    {
+        assert(i == indices[i]) ;
+    }
+    printf("%s okay.\n", __func__) ;
+}
+
+
+void
+test_key_order()
+{
+    uint64_t const opaque_near  = make_sprite_sort_key(0, sprite_batch_pipeline_opaque, 0, 0.1f) ;
+    uint64_t const opaque_far   = make_sprite_sort_key(0, sprite_batch_pipeline_opaque, 0, 0.9f) ;
+    uint64_t const blend_near   = make_sprite_sort_key(0, sprite_batch_pipeline_translucent, 0, 0.1f) ;
+    uint64_t const blend_far    = make_sprite_sort_key(0, sprite_batch_pipeline_translucent, 0, 0.9f) ;
+    uint64_t const blend_top    = make_sprite_sort_key(1, sprite_batch_pipeline_translucent, 0, 0.9f) ;
+
+    // opaque first and front to back, translucent back to front, a higher
+    // layer after all lower ones.
+    assert(opaque_near < opaque_far) ;
+    assert(opaque_far < blend_far) ;
+    assert(blend_far < blend_near) ;
+    assert(blend_near < blend_top) ;
+
+    // translucent sprites of two atlases still go back to front, opaque ones
+    // are grouped by atlas first.
+    uint64_t const blend_far_1     = make_sprite_sort_key(0, sprite_batch_pipeline_translucent, 1, 0.9f) ;
+    uint64_t const blend_near_0    = make_sprite_sort_key(0, sprite_batch_pipeline_translucent, 0, 0.1f) ;
+    uint64_t const opaque_far_0    = make_sprite_sort_key(0, sprite_batch_pipeline_opaque, 0, 0.9f) ;
+    uint64_t const opaque_near_1   = make_sprite_sort_key(0, sprite_batch_pipeline_opaque, 1, 0.1f) ;
+    assert(blend_far_1 < blend_near_0) ;
+    assert(opaque_far_0 < opaque_near_1) ;
+    assert(1 == get_sprite_key_texture(blend_far_1)) ;
+    assert(0 == get_sprite_key_texture(blend_near_0)) ;
+    assert(1 == get_sprite_key_texture(opaque_near_1)) ;
+    assert(sprite_batch_pipeline_translucent == get_sprite_key_pipeline(blend_far_1)) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+int
+main(
+    int     argc
+,   char *  argv[]
+)
+{
+    (void) argc ;
+    (void) argv ;
+
+    test_order_and_stability() ;
+    test_equal_keys() ;
+    test_key_order() ;
+    return 0 ;
+}
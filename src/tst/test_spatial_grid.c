@@ -0,0 +1,334 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../spatial_grid.c"
+
+
+#define test_max_items      64
+#define test_item_entries   16
+#define test_many_items     5000
+
+
+void *
+alloc_memory_impl(
+    size_t const    byte_count
+,   int const       clear_memory
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    return clear_memory ? calloc(1, byte_count) : malloc(byte_count) ;
+}
+
+
+void *
+alloc_array_impl(
+    size_t const    count
+,   size_t const    byte_size
+,   int const       clear_memory
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    return clear_memory ? calloc(count, byte_size) : malloc(count * byte_size) ;
+}
+
+
+void
+free_memory_impl(
+    void *          mem
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    free(mem) ;
+}
+
+
+// no workers here, the whole range runs on this thread.
+void
+run_parallel_for(
+    fn_job_range_func * func
+,   void *              param
+,   uint32_t const      count
+,   uint32_t const      min_range
+)
+{
+    (void) min_range ;
+
+    func(param, 0, count) ;
+}
+
+
+bool
+has_item(
+    uint32_t const *    items
+,   uint32_t const      count
+,   uint32_t const      item
+)
+{
+    for(uint32_t i = 0 ; i < count ; ++i)
+    {
+        if(items[i] == item)
+        {
+            return true ;
+        }
+    }
+    return false ;
+}
+
+
+// cells are 10 wide. 0 sits in one cell, 1 spans four, 2 is far away and
+// 3 covers more than max_spatial_grid_item_cells cells.
+void
+add_test_items(
+    spatial_grid *  sg
+)
+{
+    clear_spatial_grid(sg) ;
+    assert(0 == add_spatial_grid_item(sg,    5.0f,    5.0f,  2.0f)) ;
+    assert(1 == add_spatial_grid_item(sg,   10.0f,   10.0f,  3.0f)) ;
+    assert(2 == add_spatial_grid_item(sg, 1000.0f, 1000.0f,  1.0f)) ;
+    assert(3 == add_spatial_grid_item(sg,  -50.0f,  -50.0f, 40.0f)) ;
+    build_spatial_grid(sg) ;
+    assert(1 == sg->oversize_items_count_) ;
+}
+
+
+void
+test_query()
+{
+    spatial_grid sg = { 0 } ;
+    assert(create_spatial_grid(&sg, 10.0f, 64, test_max_items, test_max_items * test_item_entries)) ;
+    add_test_items(&sg) ;
+
+    uint32_t items[test_max_items] = { 0 } ;
+
+    // 1 is in four cells of the rect and still found once.
+    uint32_t count = query_spatial_grid_rect(&sg, 0.0f, 0.0f, 20.0f, 20.0f, items, test_max_items) ;
+    assert(2 == count) ;
+    assert(has_item(items, count, 0)) ;
+    assert(has_item(items, count, 1)) ;
+
+    // oversize items are checked by every query.
+    count = query_spatial_grid_rect(&sg, -20.0f, -20.0f, -15.0f, -15.0f, items, test_max_items) ;
+    assert(1 == count) ;
+    assert(3 == items[0]) ;
+
+    count = query_spatial_grid_rect(&sg, 990.0f, 990.0f, 1010.0f, 1010.0f, items, test_max_items) ;
+    assert(1 == count) ;
+    assert(2 == items[0]) ;
+
+    // a rect around every circle takes all items without testing them.
+    count = query_spatial_grid_rect(&sg, -1000.0f, -1000.0f, 2000.0f, 2000.0f, items, test_max_items) ;
+    assert(4 == count) ;
+
+    // only the cells the items are in count, a strip as wide as the plane
+    // is cut down to them.
+    count = query_spatial_grid_rect(&sg, -1.0e9f, 0.0f, 1.0e9f, 20.0f, items, test_max_items) ;
+    assert(2 == count) ;
+    assert(has_item(items, count, 0)) ;
+    assert(has_item(items, count, 1)) ;
+
+    // the cell of 0 and 1 is hit, their circles aren't. Gathering takes
+    // them anyway, and the oversize 3 as well.
+    count = query_spatial_grid_rect(&sg, 8.0f, 0.0f, 9.0f, 1.0f, items, test_max_items) ;
+    assert(0 == count) ;
+    count = gather_spatial_grid_rect(&sg, 8.0f, 0.0f, 9.0f, 1.0f, items, test_max_items) ;
+    assert(3 == count) ;
+    assert(has_item(items, count, 0)) ;
+    assert(has_item(items, count, 1)) ;
+    assert(has_item(items, count, 3)) ;
+
+    destroy_spatial_grid(&sg) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+void
+test_pick()
+{
+    spatial_grid sg = { 0 } ;
+    assert(create_spatial_grid(&sg, 10.0f, 64, test_max_items, test_max_items * test_item_entries)) ;
+    add_test_items(&sg) ;
+
+    uint32_t items[test_max_items] = { 0 } ;
+
+    uint32_t count = pick_spatial_grid_point(&sg, 5.0f, 5.0f, items, test_max_items) ;
+    assert(1 == count) ;
+    assert(0 == items[0]) ;
+
+    count = pick_spatial_grid_point(&sg, 11.0f, 11.0f, items, test_max_items) ;
+    assert(1 == count) ;
+    assert(1 == items[0]) ;
+
+    count = pick_spatial_grid_point(&sg, -50.0f, -20.0f, items, test_max_items) ;
+    assert(1 == count) ;
+    assert(3 == items[0]) ;
+
+    count = pick_spatial_grid_point(&sg, 500.0f, 500.0f, items, test_max_items) ;
+    assert(0 == count) ;
+
+    destroy_spatial_grid(&sg) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+// two circles which share several cells are one pair, and so are an
+// oversize item and the one it overlaps.
+void
+test_pairs()
+{
+    spatial_grid sg = { 0 } ;
+    assert(create_spatial_grid(&sg, 10.0f, 64, test_max_items, test_max_items * test_item_entries)) ;
+
+    clear_spatial_grid(&sg) ;
+    add_spatial_grid_item(&sg, 10.0f, 10.0f, 4.0f) ;
+    add_spatial_grid_item(&sg, 12.0f, 12.0f, 4.0f) ;
+    add_spatial_grid_item(&sg, 40.0f, 40.0f, 1.0f) ;
+    add_spatial_grid_item(&sg, 30.0f, 30.0f, 40.0f) ;
+    build_spatial_grid(&sg) ;
+
+    uint32_t pairs[2 * test_max_items] = { 0 } ;
+    uint32_t const count = find_spatial_grid_pairs(&sg, pairs, test_max_items) ;
+
+    // 0-1 and every pair with the oversize 3, which reaches all of them.
+    assert(4 == count) ;
+    uint32_t found = 0 ;
+    for(uint32_t i = 0 ; i < count ; ++i)
+    {
+        assert(pairs[2 * i] < pairs[2 * i + 1]) ;
+        found |= 1u << (pairs[2 * i] * 4 + pairs[2 * i + 1]) ;
+    }
+    assert(found == ((1u << 1) | (1u << 3) | (1u << 7) | (1u << 11))) ;
+
+    destroy_spatial_grid(&sg) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+// entries which don't fit spill whole chunks to the oversize items, the
+// queries and pairs find the same items as before.
+void
+test_spill()
+{
+    spatial_grid sg = { 0 } ;
+    assert(create_spatial_grid(&sg, 10.0f, 64, test_max_items, 2)) ;
+
+    clear_spatial_grid(&sg) ;
+    add_spatial_grid_item(&sg, 10.0f, 10.0f, 4.0f) ;
+    add_spatial_grid_item(&sg, 12.0f, 12.0f, 4.0f) ;
+    add_spatial_grid_item(&sg, 40.0f, 40.0f, 1.0f) ;
+    build_spatial_grid(&sg) ;
+
+    assert(3 == sg.spilled_items_count_) ;
+    assert(3 == sg.oversize_items_count_) ;
+    assert(0 == sg.entries_count_) ;
+
+    uint32_t items[test_max_items] = { 0 } ;
+    uint32_t count = query_spatial_grid_rect(&sg, 0.0f, 0.0f, 20.0f, 20.0f, items, test_max_items) ;
+    assert(2 == count) ;
+    assert(has_item(items, count, 0)) ;
+    assert(has_item(items, count, 1)) ;
+
+    uint32_t pairs[2 * test_max_items] = { 0 } ;
+    count = find_spatial_grid_pairs(&sg, pairs, test_max_items) ;
+    assert(1 == count) ;
+    assert(0 == pairs[0] && 1 == pairs[1]) ;
+
+    destroy_spatial_grid(&sg) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+// enough items for several chunks, every chunk writes its own part of each
+// bucket and the result is the same as testing every circle.
+void
+test_chunks()
+{
+    static uint32_t items[test_many_items] ;
+    static float    xs[test_many_items] ;
+    static float    ys[test_many_items] ;
+
+    uint32_t const entries = calc_spatial_grid_item_entries(10.0f, 6.0f) ;
+    assert(9 == entries) ;
+
+    spatial_grid sg = { 0 } ;
+    assert(create_spatial_grid(&sg, 10.0f, 256, test_many_items, test_many_items * entries)) ;
+
+    srand(1234) ;
+    clear_spatial_grid(&sg) ;
+    for(uint32_t i = 0 ; i < test_many_items ; ++i)
+    {
+        xs[i] = (float) (rand() % 2000) - 1000.0f ;
+        ys[i] = (float) (rand() % 2000) - 1000.0f ;
+        assert(i == add_spatial_grid_item(&sg, xs[i], ys[i], 6.0f)) ;
+    }
+    build_spatial_grid(&sg) ;
+    assert(sg.chunks_count_ > 1) ;
+    assert(0 == sg.spilled_items_count_) ;
+
+    // each bucket is in item order.
+    for(uint32_t b = 0 ; b < sg.buckets_count_ ; ++b)
+    {
+        for(uint32_t i = sg.bucket_starts_[b] + 1 ; i < sg.bucket_starts_[b + 1] ; ++i)
+        {
+            assert(sg.entries_[i - 1].item_ <= sg.entries_[i].item_) ;
+        }
+    }
+
+    uint32_t const count = query_spatial_grid_rect(&sg, -100.0f, -50.0f, 300.0f, 250.0f, items, test_many_items) ;
+    uint32_t expected = 0 ;
+    for(uint32_t i = 0 ; i < test_many_items ; ++i)
+    {
+        if(xs[i] + 6.0f >= -100.0f && xs[i] - 6.0f <= 300.0f && ys[i] + 6.0f >= -50.0f && ys[i] - 6.0f <= 250.0f)
+        {
+            assert(has_item(items, count, i)) ;
+            ++expected ;
+        }
+    }
+    assert(expected == count) ;
+
+    destroy_spatial_grid(&sg) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+int
+main(
+    int     argc
+,   char *  argv[]
+)
+{
+    (void) argc ;
+    (void) argv ;
+
+    test_query() ;
+    test_pick() ;
+    test_pairs() ;
+    test_spill() ;
+    test_chunks() ;
+    return 0 ;
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../spirv_reflect.c"
+
+
+// test_spirv_reflect.vert.spv is the spir-v of
+//
+//     #version 450
+//     layout(constant_id = 0) const float alpha = 0.5 ;
+//     layout(location = 1) in vec4 in_color ;
+//     layout(location = 0) in vec2 in_pos ;
+//     layout(set = 0, binding = 0) uniform ubo { vec2 offset ; vec2 scale ; } ;
+//     layout(set = 0, binding = 1) uniform sampler2D tex ;
+//     layout(push_constant) uniform pc { vec4 color ; } ;
+//     void main() { gl_Position = in_color ; }
+//
+// with the inputs declared out of location order and gl_Position as a plain
+// builtin output. Run from src/tst or pass the file.
+#define test_spv_name   "test_spirv_reflect.vert.spv"
+
+
+void *
+alloc_array_impl(
+    size_t const    count
+,   size_t const    byte_size
+,   int const       clear_memory
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    return clear_memory ? calloc(count, byte_size) : malloc(count * byte_size) ;
+}
+
+
+void
+free_memory_impl(
+    void *          mem
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    free(mem) ;
+}
+
+
+void *
+read_spv(
+    char const *    name
+,   uint64_t *      out_size
+)
+{
+    FILE * f = fopen(name, "rb") ;
+    assert(f) ;
+    fseek(f, 0, SEEK_END) ;
+    long const size = ftell(f) ;
+    fseek(f, 0, SEEK_SET) ;
+    assert(size > 0) ;
+
+    void * code = malloc((size_t) size) ;
+    assert(code) ;
+    assert(1 == fread(code, (size_t) size, 1, f)) ;
+    fclose(f) ;
+
+    *out_size = (uint64_t) size ;
+    return code ;
+}
+
+
+void
+test_reflect(
+    char const *    name
+)
+{
+    uint64_t    size = 0 ;
+    void *      code = read_spv(name, &size) ;
+
+    spirv_reflection sr = { 0 } ;
+    assert(reflect_spirv(&sr, code, size)) ;
+
+    assert(VK_SHADER_STAGE_VERTEX_BIT == sr.stage_) ;
+
+    // sorted by location, the builtin output isn't one of them.
+    assert(2 == sr.vertex_inputs_count_) ;
+    assert(0 == sr.vertex_inputs_[0].location_) ;
+    assert(VK_FORMAT_R32G32_SFLOAT == sr.vertex_inputs_[0].format_) ;
+    assert(8 == sr.vertex_inputs_[0].size_) ;
+    assert(1 == sr.vertex_inputs_[1].location_) ;
+    assert(VK_FORMAT_R32G32B32A32_SFLOAT == sr.vertex_inputs_[1].format_) ;
+    assert(16 == sr.vertex_inputs_[1].size_) ;
+
+    assert(2 == sr.descriptor_bindings_count_) ;
+    spirv_descriptor_binding const * ubo = find_spirv_descriptor_binding(&sr, 0, 0) ;
+    assert(ubo) ;
+    assert(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER == ubo->type_) ;
+    assert(1 == ubo->count_) ;
+    assert(16 == ubo->block_size_) ;
+
+    spirv_descriptor_binding const * tex = find_spirv_descriptor_binding(&sr, 0, 1) ;
+    assert(tex) ;
+    assert(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER == tex->type_) ;
+    assert(1 == tex->count_) ;
+    assert(0 == tex->block_size_) ;
+
+    assert(!find_spirv_descriptor_binding(&sr, 0, 2)) ;
+
+    assert(16 == sr.push_constant_size_) ;
+
+    assert(1 == sr.specialization_constants_count_) ;
+    spirv_specialization_constant const * alpha = find_spirv_specialization_constant(&sr, 0) ;
+    assert(alpha) ;
+    float alpha_value = 0.0f ;
+    memcpy(&alpha_value, &alpha->default_value_, sizeof(float)) ;
+    assert(0.5f == alpha_value) ;
+
+    assert(is_spirv_reflection_compatible(&sr, &sr)) ;
+
+    // a truncated module is refused.
+    spirv_reflection broken = { 0 } ;
+    assert(!reflect_spirv(&broken, code, size - 6)) ;
+
+    free(code) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+int
+main(
+    int     argc
+,   char *  argv[]
+)
+{
+    test_reflect(argc > 1 ? argv[1] : test_spv_name) ;
+    return 0 ;
+}
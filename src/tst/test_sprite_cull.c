@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../sprite_batch.c"
+
+
+#define test_sprites_count  7
+
+
+void *
+alloc_memory_impl(
+    size_t const    byte_count
+,   int const       clear_memory
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    return clear_memory ? calloc(1, byte_count) : malloc(byte_count) ;
+}
+
+
+void
+free_memory_impl(
+    void *          mem
+,   char const *    expr
+,   char const *    file
+,   char const *    func
+,   int const       line
+)
+{
+    (void) expr ;
+    (void) file ;
+    (void) func ;
+    (void) line ;
+
+    free(mem) ;
+}
+
+
+// no workers here, the whole range runs on this thread.
+void
+run_parallel_for(
+    fn_job_range_func * func
+,   void *              param
+,   uint32_t const      count
+,   uint32_t const      min_range
+)
+{
+    (void) min_range ;
+
+    func(param, 0, count) ;
+}
+
+
+// one translucent frame whose circle has a radius of 10 around the origin.
+static sprite_2d        test_sprite = { 0 } ;
+static rect_2d_vertices test_vertices = { 0 } ;
+static rect_2d_info     test_info = { 0 } ;
+static sprite_2d_ptr    test_atlas = { 0 } ;
+
+
+void
+make_test_atlas()
+{
+    test_sprite.vertices_count_ = 1 ;
+    test_sprite.infos_count_    = 1 ;
+    test_info.bounding_info_.circle_radius_ = 9 ;
+
+    test_atlas.this_        = &test_sprite ;
+    test_atlas.vertices_    = &test_vertices ;
+    test_atlas.infos_       = &test_info ;
+}
+
+
+// four go through the sse loop and three through the one after it. Only the
+// first and the last are outside of 0..100.
+static float const test_xs[test_sprites_count] = { -30.0f, -5.0f, 5.0f, 50.0f, 99.0f, 105.0f, 115.0f } ;
+static bool const test_visible[test_sprites_count] = { false, true, true, true, true, true, false } ;
+
+
+void
+test_cull()
+{
+    sprite_batch sb = { 0 } ;
+    assert(create_sprite_batch(&sb, test_sprites_count)) ;
+    assert(0 == add_sprite_batch_atlas(&sb, &test_atlas)) ;
+
+    for(uint32_t i = 0 ; i < test_sprites_count ; ++i)
+    {
+        sprite_transform st = { 0 } ;
+        st.px_  = test_xs[i] ;
+        st.py_  = 50.0f ;
+        st.sx_  = 1.0f ;
+        st.sy_  = 1.0f ;
+        assert(submit_sprite(&sb, 0, 0, &st, 0, sprite_tint_white)) ;
+    }
+
+    cull_sprite_batch(&sb, 0.0f, 0.0f, 100.0f, 100.0f) ;
+
+    assert(5 == sb.visible_count_) ;
+    assert(2 == sb.culled_count_) ;
+    assert(5 == sb.keys_count_) ;
+
+    // the kept ones stay in submission order.
+    uint32_t n = 0 ;
+    for(uint32_t i = 0 ; i < test_sprites_count ; ++i)
+    {
+        assert(sb.visible_[i] == test_visible[i]) ;
+        if(test_visible[i])
+        {
+            assert(sb.indices_[n] == i) ;
+            ++n ;
+        }
+    }
+
+    destroy_sprite_batch(&sb) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+// the circle is scaled with the sprite, twice as large reaches twice as far.
+void
+test_cull_scaled()
+{
+    sprite_batch sb = { 0 } ;
+    assert(create_sprite_batch(&sb, 2)) ;
+    assert(0 == add_sprite_batch_atlas(&sb, &test_atlas)) ;
+
+    sprite_transform st = { 0 } ;
+    st.px_  = 115.0f ;
+    st.py_  = 50.0f ;
+    st.sx_  = 2.0f ;
+    st.sy_  = 2.0f ;
+    assert(submit_sprite(&sb, 0, 0, &st, 0, sprite_tint_white)) ;
+
+    st.sx_  = 1.0f ;
+    st.sy_  = 1.0f ;
+    assert(submit_sprite(&sb, 0, 0, &st, 0, sprite_tint_white)) ;
+
+    cull_sprite_batch(&sb, 0.0f, 0.0f, 100.0f, 100.0f) ;
+
+    assert(1 == sb.visible_count_) ;
+    assert(0 == sb.indices_[0]) ;
+
+    destroy_sprite_batch(&sb) ;
+    printf("%s okay.\n", __func__) ;
+}
+
+
+int
+main(
+    int     argc
+,   char *  argv[]
+)
+{
+    (void) argc ;
+    (void) argv ;
+
+    make_test_atlas() ;
+    test_cull() ;
+    test_cull_scaled() ;
+    return 0 ;
+}
@@ -6,8 +6,14 @@
 #include "debug.h"
 #include "math.h"
 #include "vulkan_rob.h"
+#include "vulkan_post.h"
+#include "asset_texture.h"
+#include "shader_watch.h"
+#include "startup.h"
 
 #include <SDL3/SDL_vulkan.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
 #include <cglm/vec2.h>
 #include <cglm/vec3.h>
 #include <cglm/mat4.h>
@@ -58,6 +64,8 @@ static VkFormat const desired_formats[] =
 ,   VK_FORMAT_D32_SFLOAT
 ,   VK_FORMAT_D32_SFLOAT_S8_UINT
 ,   VK_FORMAT_D24_UNORM_S8_UINT
+,   VK_FORMAT_R8G8B8A8_SRGB
+,   VK_FORMAT_BC3_SRGB_BLOCK
 } ;
 static uint32_t const desired_formats_count = array_count(desired_formats) ;
 static_require(array_count(desired_formats) < max_vulkan_desired_format_properties, "fix me!") ;
@@ -67,6 +75,169 @@ static_require(array_count(desired_formats) < max_vulkan_desired_format_properti
 #define max_dump_buffer 4096
 
 
+// bump the version whenever vulkan_device_cache changes.
+#define vulkan_device_cache_magic       0x43445654
+#define vulkan_device_cache_version     1
+#define max_vulkan_device_cache_name    1024
+
+static char const vulkan_device_cache_name[] = "vulkan_device.cache" ;
+static char const vulkan_pipeline_cache_name[] = "vulkan_pipeline.cache" ;
+
+
+// pick_physical_device, the type always outweighs memory and samples.
+#define vulkan_device_score_discrete        40000
+#define vulkan_device_score_integrated      30000
+#define vulkan_device_score_virtual         20000
+#define vulkan_device_score_cpu             10000
+#define vulkan_device_score_mb_per_point    16
+#define vulkan_device_score_max_memory      8000
+#define vulkan_device_score_per_sample      10
+
+
+// --aa auto, every mode is drawn for the warmup frames, which aren't
+// measured, and then for the measured ones.
+#define vulkan_aa_tune_warmup_frames    4
+#define vulkan_aa_tune_frames           16
+
+
+typedef struct vulkan_aa_mode_info
+{
+    char const *            name_ ;
+    VkSampleCountFlagBits   sample_count_ ;
+    VkBool32                sample_shading_ ;
+    VkBool32                post_ ;
+
+} vulkan_aa_mode_info ;
+
+
+static vulkan_aa_mode_info const vulkan_aa_modes[] =
+{
+    {   "off",      VK_SAMPLE_COUNT_1_BIT,  VK_FALSE,   VK_FALSE }
+,   {   "post",     VK_SAMPLE_COUNT_1_BIT,  VK_FALSE,   VK_TRUE }
+,   {   "msaa2",    VK_SAMPLE_COUNT_2_BIT,  VK_FALSE,   VK_FALSE }
+,   {   "msaa2s",   VK_SAMPLE_COUNT_2_BIT,  VK_TRUE,    VK_FALSE }
+,   {   "msaa4",    VK_SAMPLE_COUNT_4_BIT,  VK_FALSE,   VK_FALSE }
+,   {   "msaa4s",   VK_SAMPLE_COUNT_4_BIT,  VK_TRUE,    VK_FALSE }
+,   {   "msaa8",    VK_SAMPLE_COUNT_8_BIT,  VK_FALSE,   VK_FALSE }
+,   {   "msaa8s",   VK_SAMPLE_COUNT_8_BIT,  VK_TRUE,    VK_FALSE }
+} ;
+static_require(array_count(vulkan_aa_modes) == vulkan_aa_modes_count, "fix me!") ;
+
+
+// What query_physical_device_info found out about the picked device, kept in
+// the pref path. It is only used when the device, the driver version and the
+// pipeline cache uuid are the same.
+typedef struct vulkan_device_cache
+{
+    uint32_t                            magic_ ;
+    uint32_t                            version_ ;
+    uint32_t                            vendor_id_ ;
+    uint32_t                            device_id_ ;
+    uint32_t                            driver_version_ ;
+    uint32_t                            api_version_ ;
+    uint8_t                             pipeline_cache_uuid_[VK_UUID_SIZE] ;
+
+    VkPhysicalDeviceFeatures            features_ ;
+    VkPhysicalDeviceMemoryProperties    memory_properties_ ;
+    VkQueueFamilyProperties             queue_family_properties_[max_vulkan_queue_family_properties] ;
+    uint32_t                            queue_family_properties_count_ ;
+    VkBool32                            desired_device_extensions_okay_ ;
+    vulkan_desired_format_properties    desired_format_properties_[max_vulkan_desired_format_properties] ;
+    uint32_t                            desired_format_properties_count_ ;
+
+} vulkan_device_cache ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+typedef struct vulkan_device_memory_allocation
+{
+    VkDeviceMemory  memory_ ;
+    VkDeviceSize    size_ ;
+
+} vulkan_device_memory_allocation ;
+
+
+static vulkan_device_memory_allocation  device_memory_allocations_[max_vulkan_device_memory_allocations] = { 0 } ;
+
+
+static void
+track_device_memory(
+    VkDeviceMemory const    memory
+,   VkDeviceSize const      size
+)
+{
+    require(memory) ;
+    require(vc_->frame_stats_.device_memory_count_ < max_vulkan_device_memory_allocations) ;
+
+    vulkan_device_memory_allocation * a = &device_memory_allocations_[vc_->frame_stats_.device_memory_count_++] ;
+    a->memory_  = memory ;
+    a->size_    = size ;
+    vc_->frame_stats_.device_memory_size_ += size ;
+}
+
+
+void
+free_device_memory(
+    VkDevice const          device
+,   VkDeviceMemory const    memory
+)
+{
+    require(device) ;
+    require(memory) ;
+
+    uint32_t const count = vc_->frame_stats_.device_memory_count_ ;
+
+    for(
+        uint32_t i = 0
+    ;   i < count
+    ;   ++i
+    )
+    {
+        if(device_memory_allocations_[i].memory_ == memory)
+        {
+            vc_->frame_stats_.device_memory_size_ -= device_memory_allocations_[i].size_ ;
+            device_memory_allocations_[i] = device_memory_allocations_[count - 1] ;
+            --vc_->frame_stats_.device_memory_count_ ;
+            break ;
+        }
+    }
+
+    // void vkFreeMemory(
+    //     VkDevice                                    device,
+    //     VkDeviceMemory                              memory,
+    //     const VkAllocationCallbacks*                pAllocator);
+    vkFreeMemory(device, memory, NULL) ;
+}
+
+
+void
+add_vulkan_draw_stats(
+    vulkan_context *    vc
+,   uint32_t const      draw_count
+,   uint32_t const      instance_count
+)
+{
+    require(vc) ;
+    vc->frame_stats_.draw_count_       += draw_count ;
+    vc->frame_stats_.instance_count_   += instance_count ;
+}
+
+
+void
+add_vulkan_cull_stats(
+    vulkan_context *    vc
+,   uint32_t const      visible_count
+,   uint32_t const      culled_count
+)
+{
+    require(vc) ;
+    vc->frame_stats_.visible_count_    += visible_count ;
+    vc->frame_stats_.culled_count_     += culled_count ;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //                                                                            //
 //
@@ -3324,27 +3495,18 @@ has_stencil_component(
 }
 
 
+// What doesn't depend on the surface and is the same for every launch with
+// the same device and driver, this is what the cache holds.
 static bool
-fill_physical_device_info(
+query_physical_device_info(
     vulkan_physical_device_info *   out_physical_device_info
 ,   VkPhysicalDevice                physical_device
-,   VkSurfaceKHR const              surface
+,   VkBool32 const                  enable_dump
 )
 {
     require(out_physical_device_info) ;
     require(physical_device) ;
 
-    out_physical_device_info->device_ = physical_device ;
-
-    // void vkGetPhysicalDeviceProperties(
-    //     VkPhysicalDevice                            physicalDevice,
-    //     VkPhysicalDeviceProperties*                 pProperties);
-    vkGetPhysicalDeviceProperties(
-        physical_device
-    ,   &out_physical_device_info->properties_
-    ) ;
-
-
     // void vkGetPhysicalDeviceFeatures(
     //     VkPhysicalDevice                            physicalDevice,
     //     VkPhysicalDeviceFeatures*                   pFeatures);
@@ -3386,6 +3548,10 @@ fill_physical_device_info(
     ) ;
 
 
+    // the extensions are only needed to check for the desired ones, they
+    // don't stay around.
+    uint32_t device_extensions_count = 0 ;
+
     // VkResult vkEnumerateDeviceExtensionProperties(
     //     VkPhysicalDevice                            physicalDevice,
     //     const char*                                 pLayerName,
@@ -3394,7 +3560,7 @@ fill_physical_device_info(
     if(check_vulkan(vkEnumerateDeviceExtensionProperties(
                 physical_device
             ,   NULL
-            ,   &out_physical_device_info->device_extensions_count_
+            ,   &device_extensions_count
             ,   NULL
             )
         )
@@ -3403,243 +3569,557 @@ fill_physical_device_info(
         return false ;
     }
 
-    log_debug_u32(sizeof(VkExtensionProperties)) ;
-    log_debug_u32(out_physical_device_info->device_extensions_count_) ;
-    require(out_physical_device_info->device_extensions_count_ < max_vulkan_device_extensions)
-    out_physical_device_info->device_extensions_count_ = min_u32(out_physical_device_info->device_extensions_count_, max_vulkan_device_extensions) ;
+    log_debug_u32(device_extensions_count) ;
+    require(device_extensions_count < max_vulkan_device_extensions) ;
+    device_extensions_count = min_u32(device_extensions_count, max_vulkan_device_extensions) ;
 
-    if(check_vulkan(vkEnumerateDeviceExtensionProperties(
-                physical_device
-            ,   NULL
-            ,   &out_physical_device_info->device_extensions_count_
-            ,   out_physical_device_info->device_extensions_
+    if(device_extensions_count)
+    {
+        VkExtensionProperties * device_extensions = alloc_array(VkExtensionProperties, device_extensions_count) ;
+        if(check(device_extensions))
+        {
+            return false ;
+        }
+
+        if(check_vulkan(vkEnumerateDeviceExtensionProperties(
+                    physical_device
+                ,   NULL
+                ,   &device_extensions_count
+                ,   device_extensions
+                )
             )
         )
-    )
-    {
-        return false ;
-    }
+        {
+            free_memory(device_extensions) ;
+            return false ;
+        }
 
-    out_physical_device_info->queue_families_indices_complete_ = find_queue_families(
-        &out_physical_device_info->queue_families_indices_
-    ,   physical_device
-    ,   out_physical_device_info->queue_family_properties_
-    ,   out_physical_device_info->queue_family_properties_count_
-    ,   surface
-    ) ;
+        if(enable_dump)
+        {
+            dump_extension_properties(device_extensions, device_extensions_count) ;
+        }
 
-    if(out_physical_device_info->queue_families_indices_complete_)
-    {
-        add_to_unique_queue_families_indices(
-            out_physical_device_info->unique_queue_families_indices_
-        ,   &out_physical_device_info->unique_queue_families_indices_count_
-        ,   out_physical_device_info->queue_families_indices_.graphics_family_
+        out_physical_device_info->desired_device_extensions_okay_ = has_all_extensions(
+            device_extensions
+        ,   device_extensions_count
+        ,   out_physical_device_info->desired_device_extensions_
+        ,   out_physical_device_info->desired_device_extensions_count_
         ) ;
 
-        add_to_unique_queue_families_indices(
-            out_physical_device_info->unique_queue_families_indices_
-        ,   &out_physical_device_info->unique_queue_families_indices_count_
-        ,   out_physical_device_info->queue_families_indices_.present_family_
-        ) ;
+        free_memory(device_extensions) ;
     }
 
-    add_to_desired_device_extension(
-        out_physical_device_info->desired_device_extensions_
-    ,   &out_physical_device_info->desired_device_extensions_count_
-    ,   vk_khr_swapchain_extension_name
+    create_desired_format_properties(
+        out_physical_device_info->desired_format_properties_
+    ,   &out_physical_device_info->desired_format_properties_count_
+    ,   physical_device
     ) ;
 
+    return true ;
+}
 
-    out_physical_device_info->desired_device_extensions_okay_ = has_all_extensions(
-        out_physical_device_info->device_extensions_
-    ,   out_physical_device_info->device_extensions_count_
-    ,   out_physical_device_info->desired_device_extensions_
-    ,   out_physical_device_info->desired_device_extensions_count_
-    ) ;
-
-    out_physical_device_info->max_usable_sample_count_ = get_max_usuable_sample_count(
-        &out_physical_device_info->properties_
-    ) ;
 
-    out_physical_device_info->sample_count_ = VK_SAMPLE_COUNT_1_BIT ;
+static bool
+is_vulkan_device_cache_for(
+    vulkan_device_cache const *         cache
+,   VkPhysicalDeviceProperties const *  properties
+)
+{
+    require(cache) ;
+    require(properties) ;
 
-    if(check(create_swapchain_support_details(
-                &out_physical_device_info->swapchain_support_details_
-            ,   physical_device
-            ,   surface
-            )
-        )
+    if(
+        cache->vendor_id_       != properties->vendorID
+    ||  cache->device_id_       != properties->deviceID
+    ||  cache->driver_version_  != properties->driverVersion
+    ||  cache->api_version_     != properties->apiVersion
+    ||  0 != SDL_memcmp(cache->pipeline_cache_uuid_, properties->pipelineCacheUUID, VK_UUID_SIZE)
     )
     {
         return false ;
     }
 
-    out_physical_device_info->swapchain_support_details_okay_ = check_if_swapchain_support_is_adequate(
-        &out_physical_device_info->swapchain_support_details_
-    ) ;
-
-    create_desired_format_properties(
-        out_physical_device_info->desired_format_properties_
-    ,   &out_physical_device_info->desired_format_properties_count_
-    ,   physical_device
-    ) ;
+    // the desired formats may have changed since the cache was written.
+    if(cache->desired_format_properties_count_ != desired_formats_count)
+    {
+        return false ;
+    }
 
-    if(check(find_depth_format(
-                &out_physical_device_info->depth_format_
-            ,   out_physical_device_info->desired_format_properties_
-            ,   out_physical_device_info->desired_format_properties_count_
-            )
-        )
+    for(
+        uint32_t i = 0
+    ;   i < desired_formats_count
+    ;   ++i
     )
     {
-        return false ;
+        if(cache->desired_format_properties_[i].format_ != desired_formats[i])
+        {
+            return false ;
+        }
     }
 
     return true ;
 }
 
 
-// static void
-// rate_device_suitability(
-//     uint32_t *                          out_score
-// ,   VkPhysicalDeviceProperties const *  properties
-// ,   VkPhysicalDeviceFeatures const *    features
-// )
-// {
-//     require(out_score) ;
-//     require(properties) ;
-//     require(features) ;
+static void
+get_vulkan_cache_name(
+    char *          out_name
+,   size_t const    out_name_size
+,   char const *    file_name
+)
+{
+    require(out_name) ;
+    require(file_name) ;
+    require(app_->pref_path_) ;
 
-//     uint32_t score = 0 ;
+    size_t n = 0 ;
+    n = SDL_strlcpy(out_name, app_->pref_path_, out_name_size) ;
+    require(n < out_name_size) ;
+    n = SDL_strlcat(out_name, file_name, out_name_size) ;
+    require(n < out_name_size) ;
+}
 
-//     *out_score = score ;
 
-//     if(!features->geometryShader)
-//     {
-//         return ;
-//     }
+// False when there is no cache or it is from another version, which is not
+// an error, the device is queried then.
+static bool
+load_vulkan_device_cache(
+    vulkan_device_cache *   out_cache
+)
+{
+    require(out_cache) ;
+    begin_timed_block() ;
 
-//     if(properties->deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
-//     {
-//         score += 1000 ;
-//     }
+    char name[max_vulkan_device_cache_name] = { 0 } ;
+    get_vulkan_cache_name(name, sizeof(name), vulkan_device_cache_name) ;
 
-//     score += properties->limits.maxImageDimension2D ;
+    SDL_PathInfo info = { 0 } ;
+    if(!SDL_GetPathInfo(name, &info) || sizeof(vulkan_device_cache) != info.size)
+    {
+        end_timed_block() ;
+        return false ;
+    }
 
-//     *out_score = score ;
-// }
+    void *      p = NULL ;
+    uint64_t    s = 0 ;
+    if(check(load_file(&p, &s, name)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    bool const okay = sizeof(vulkan_device_cache) == s ;
+    if(okay)
+    {
+        SDL_memcpy(out_cache, p, sizeof(vulkan_device_cache)) ;
+    }
+    free_memory(p) ;
 
+    end_timed_block() ;
+
+    // the counts index fixed arrays later on, a broken file must not get
+    // past them.
+    return
+        okay
+    &&  vulkan_device_cache_magic   == out_cache->magic_
+    &&  vulkan_device_cache_version == out_cache->version_
+    &&  out_cache->queue_family_properties_count_       <= max_vulkan_queue_family_properties
+    &&  out_cache->desired_format_properties_count_     <= max_vulkan_desired_format_properties
+    &&  out_cache->memory_properties_.memoryTypeCount   <= VK_MAX_MEMORY_TYPES
+    &&  out_cache->memory_properties_.memoryHeapCount   <= VK_MAX_MEMORY_HEAPS
+    ;
+}
 
 
 static void
-fill_physical_devices_info(
-    vulkan_physical_device_info *   out_physical_device_info
-,   VkPhysicalDevice *              devices
-,   uint32_t const                  devices_count
-,   VkSurfaceKHR const              surface
+save_vulkan_device_cache(
+    vulkan_physical_device_info const * pdi
 )
 {
-    require(out_physical_device_info) ;
-    require(devices) ;
+    require(pdi) ;
+    begin_timed_block() ;
 
-    for(
-        uint32_t i = 0
-    ;   i < devices_count
-    ;   ++i
-    )
-    {
-        log_debug_u32(i) ;
+    vulkan_device_cache cache = { 0 } ;
+    cache.magic_                            = vulkan_device_cache_magic ;
+    cache.version_                          = vulkan_device_cache_version ;
+    cache.vendor_id_                        = pdi->properties_.vendorID ;
+    cache.device_id_                        = pdi->properties_.deviceID ;
+    cache.driver_version_                   = pdi->properties_.driverVersion ;
+    cache.api_version_                      = pdi->properties_.apiVersion ;
+    cache.features_                         = pdi->features_ ;
+    cache.memory_properties_                = pdi->memory_properties_ ;
+    cache.queue_family_properties_count_    = pdi->queue_family_properties_count_ ;
+    cache.desired_device_extensions_okay_   = pdi->desired_device_extensions_okay_ ;
+    cache.desired_format_properties_count_  = pdi->desired_format_properties_count_ ;
+    SDL_memcpy(cache.pipeline_cache_uuid_, pdi->properties_.pipelineCacheUUID, VK_UUID_SIZE) ;
+    SDL_memcpy(cache.queue_family_properties_, pdi->queue_family_properties_, sizeof(cache.queue_family_properties_)) ;
+    SDL_memcpy(cache.desired_format_properties_, pdi->desired_format_properties_, sizeof(cache.desired_format_properties_)) ;
+
+    char name[max_vulkan_device_cache_name] = { 0 } ;
+    get_vulkan_cache_name(name, sizeof(name), vulkan_device_cache_name) ;
+
+    // a cache that can't be written only costs the next launch some time.
+    SDL_IOStream * ios = SDL_IOFromFile(name, "wb") ;
+    if(!ios)
+    {
+        log_info("can't write %s: %s", name, SDL_GetError()) ;
+        end_timed_block() ;
+        return ;
+    }
 
-        if(check(fill_physical_device_info(
-                    &out_physical_device_info[i]
-                ,   devices[i]
-                ,   surface
-                )
-            )
-        )
-        {
-            require(0) ;
-        }
+    size_t const written = SDL_WriteIO(ios, &cache, sizeof(cache)) ;
+    bool const closed = SDL_CloseIO(ios) ;
+    if(sizeof(cache) != written || !closed)
+    {
+        log_info("can't write %s: %s", name, SDL_GetError()) ;
+        SDL_RemovePath(name) ;
     }
 
+    end_timed_block() ;
 }
 
 
-static void
-dump_physical_device_info(
-    vulkan_physical_device_info const * physical_device_info
-,   uint32_t const                      physical_device_info_count
+// What vkGetPipelineCacheData wrote last time is only handed to the driver
+// when its header is for this device and pipeline cache uuid, otherwise the
+// cache starts out empty, which is not an error.
+static bool
+create_pipeline_cache(
+    VkPipelineCache *                   out_pipeline_cache
+,   VkDevice const                      device
+,   VkPhysicalDeviceProperties const *  properties
 )
 {
-    for(
-        uint32_t i = 0
-    ;   i < physical_device_info_count
-    ;   ++i
+    require(out_pipeline_cache) ;
+    require(device) ;
+    require(properties) ;
+    begin_timed_block() ;
+
+    char name[max_vulkan_device_cache_name] = { 0 } ;
+    get_vulkan_cache_name(name, sizeof(name), vulkan_pipeline_cache_name) ;
+
+    void *      data = NULL ;
+    uint64_t    size = 0 ;
+
+    SDL_PathInfo info = { 0 } ;
+    if(
+        SDL_GetPathInfo(name, &info)
+    &&  info.size >= sizeof(VkPipelineCacheHeaderVersionOne)
+    &&  !load_file(&data, &size, name)
     )
     {
-        vulkan_physical_device_info const * pdi = &physical_device_info[i] ;
-        dump_physical_device_properties(&pdi->properties_) ;
-        dump_physical_device_features(&pdi->features_) ;
-        dump_physical_device_memory_properties(&pdi->memory_properties_) ;
-        dump_queue_family_properties(pdi->queue_family_properties_, pdi->queue_family_properties_count_) ;
-        dump_extension_properties(pdi->device_extensions_, pdi->device_extensions_count_) ;
-        log_debug_u32(pdi->queue_families_indices_complete_) ;
+        data = NULL ;
+        size = 0 ;
+    }
 
-        log_debug_u32(pdi->unique_queue_families_indices_count_) ;
-        for(
-            uint32_t j = 0
-        ;   j < pdi->unique_queue_families_indices_count_
-        ;   ++j
-        )
+    if(data)
+    {
+        // typedef struct VkPipelineCacheHeaderVersionOne {
+        //     uint32_t                        headerSize;
+        //     VkPipelineCacheHeaderVersion    headerVersion;
+        //     uint32_t                        vendorID;
+        //     uint32_t                        deviceID;
+        //     uint8_t                         pipelineCacheUUID[VK_UUID_SIZE];
+        // } VkPipelineCacheHeaderVersionOne;
+        VkPipelineCacheHeaderVersionOne header = { 0 } ;
+        if(size >= sizeof(header))
         {
-            log_debug_u32(j) ;
-            log_debug_u32(pdi->unique_queue_families_indices_[j]) ;
+            SDL_memcpy(&header, data, sizeof(header)) ;
         }
 
-        log_debug_u32(pdi->desired_device_extensions_okay_) ;
-        log_debug_u32(pdi->desired_device_extensions_count_) ;
-        log_debug_u32(pdi->max_usable_sample_count_) ;
-        log_debug_u32(pdi->swapchain_support_details_.formats_count_) ;
-        log_debug_u32(pdi->swapchain_support_details_.modes_count_) ;
-
-        dump_surface_capabilities(&pdi->swapchain_support_details_.capabilities_) ;
-
-        for(
-            uint32_t j = 0
-        ;   j < pdi->swapchain_support_details_.formats_count_
-        ;   ++j
+        if(
+            size < sizeof(header)
+        ||  header.headerSize < sizeof(header)
+        ||  header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        ||  header.vendorID != properties->vendorID
+        ||  header.deviceID != properties->deviceID
+        ||  0 != SDL_memcmp(header.pipelineCacheUUID, properties->pipelineCacheUUID, VK_UUID_SIZE)
         )
         {
-            log_debug_u32(j) ;
-            dump_surface_format_khr(&pdi->swapchain_support_details_.formats_[j]) ;
-            dump_format_properties(&pdi->swapchain_support_details_.formats_properties_[j]) ;
+            log_info("%s is from another device or driver, it is not used.", name) ;
+            free_memory(data) ;
+            data = NULL ;
+            size = 0 ;
         }
+    }
 
-        for(
-            uint32_t j = 0
-        ;   j < pdi->swapchain_support_details_.modes_count_
-        ;   ++j
-        )
+    // typedef struct VkPipelineCacheCreateInfo {
+    //     VkStructureType               sType;
+    //     const void*                   pNext;
+    //     VkPipelineCacheCreateFlags    flags;
+    //     size_t                        initialDataSize;
+    //     const void*                   pInitialData;
+    // } VkPipelineCacheCreateInfo;
+    VkPipelineCacheCreateInfo pcci = { 0 } ;
+    pcci.sType              = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO ;
+    pcci.pNext              = NULL ;
+    pcci.flags              = 0 ;
+    pcci.initialDataSize    = (size_t) size ;
+    pcci.pInitialData       = data ;
+
+    // VkResult vkCreatePipelineCache(
+    //     VkDevice                                    device,
+    //     const VkPipelineCacheCreateInfo*            pCreateInfo,
+    //     const VkAllocationCallbacks*                pAllocator,
+    //     VkPipelineCache*                            pPipelineCache);
+    VkResult const result = vkCreatePipelineCache(device, &pcci, NULL, out_pipeline_cache) ;
+    if(data)
+    {
+        free_memory(data) ;
+    }
+
+    // a driver may still refuse the data, an empty cache does as well.
+    if(VK_SUCCESS != result)
+    {
+        pcci.initialDataSize    = 0 ;
+        pcci.pInitialData       = NULL ;
+        if(check_vulkan(vkCreatePipelineCache(device, &pcci, NULL, out_pipeline_cache)))
         {
-            log_debug_u32(j) ;
-            log_debug_str(dump_present_mode_khr(pdi->swapchain_support_details_.modes_[j])) ;
+            end_timed_block() ;
+            return false ;
         }
+    }
 
-        log_debug_u32(pdi->desired_format_properties_count_) ;
-        for(
-            uint32_t j = 0
-        ;   j < pdi->desired_format_properties_count_
-        ;   ++j
+    end_timed_block() ;
+    return true ;
+}
+
+
+static void
+save_pipeline_cache(
+    VkDevice const          device
+,   VkPipelineCache const   pipeline_cache
+)
+{
+    require(device) ;
+    require(pipeline_cache) ;
+    begin_timed_block() ;
+
+    // VkResult vkGetPipelineCacheData(
+    //     VkDevice                                    device,
+    //     VkPipelineCache                             pipelineCache,
+    //     size_t*                                     pDataSize,
+    //     void*                                       pData);
+    size_t size = 0 ;
+    if(check_vulkan(vkGetPipelineCacheData(device, pipeline_cache, &size, NULL)) || !size)
+    {
+        end_timed_block() ;
+        return ;
+    }
+
+    uint8_t * data = alloc_memory(uint8_t, size) ;
+    if(check(data))
+    {
+        end_timed_block() ;
+        return ;
+    }
+
+    if(check_vulkan(vkGetPipelineCacheData(device, pipeline_cache, &size, data)))
+    {
+        free_memory(data) ;
+        end_timed_block() ;
+        return ;
+    }
+
+    char name[max_vulkan_device_cache_name] = { 0 } ;
+    get_vulkan_cache_name(name, sizeof(name), vulkan_pipeline_cache_name) ;
+
+    // like the device cache, not writing it only costs the next launch.
+    SDL_IOStream * ios = SDL_IOFromFile(name, "wb") ;
+    if(!ios)
+    {
+        log_info("can't write %s: %s", name, SDL_GetError()) ;
+        free_memory(data) ;
+        end_timed_block() ;
+        return ;
+    }
+
+    size_t const written = SDL_WriteIO(ios, data, size) ;
+    bool const closed = SDL_CloseIO(ios) ;
+    if(size != written || !closed)
+    {
+        log_info("can't write %s: %s", name, SDL_GetError()) ;
+        SDL_RemovePath(name) ;
+    }
+
+    free_memory(data) ;
+    end_timed_block() ;
+}
+
+
+static bool
+fill_physical_device_info(
+    vulkan_physical_device_info *   out_physical_device_info
+,   bool *                          out_cached
+,   VkPhysicalDevice                physical_device
+,   VkSurfaceKHR const              surface
+,   vulkan_device_cache const *     cache
+,   VkBool32 const                  enable_dump
+)
+{
+    require(out_physical_device_info) ;
+    require(out_cached) ;
+    require(physical_device) ;
+
+    SDL_memset(out_physical_device_info, 0, sizeof(vulkan_physical_device_info)) ;
+    out_physical_device_info->device_ = physical_device ;
+
+    // void vkGetPhysicalDeviceProperties(
+    //     VkPhysicalDevice                            physicalDevice,
+    //     VkPhysicalDeviceProperties*                 pProperties);
+    vkGetPhysicalDeviceProperties(
+        physical_device
+    ,   &out_physical_device_info->properties_
+    ) ;
+
+    add_to_desired_device_extension(
+        out_physical_device_info->desired_device_extensions_
+    ,   &out_physical_device_info->desired_device_extensions_count_
+    ,   vk_khr_swapchain_extension_name
+    ) ;
+
+    *out_cached = cache && is_vulkan_device_cache_for(cache, &out_physical_device_info->properties_) ;
+
+    if(*out_cached)
+    {
+        out_physical_device_info->features_                         = cache->features_ ;
+        out_physical_device_info->memory_properties_                = cache->memory_properties_ ;
+        out_physical_device_info->queue_family_properties_count_    = cache->queue_family_properties_count_ ;
+        out_physical_device_info->desired_device_extensions_okay_   = cache->desired_device_extensions_okay_ ;
+        out_physical_device_info->desired_format_properties_count_  = cache->desired_format_properties_count_ ;
+        SDL_memcpy(out_physical_device_info->queue_family_properties_, cache->queue_family_properties_, sizeof(cache->queue_family_properties_)) ;
+        SDL_memcpy(out_physical_device_info->desired_format_properties_, cache->desired_format_properties_, sizeof(cache->desired_format_properties_)) ;
+    }
+    else if(check(query_physical_device_info(out_physical_device_info, physical_device, enable_dump)))
+    {
+        return false ;
+    }
+
+    out_physical_device_info->queue_families_indices_complete_ = find_queue_families(
+        &out_physical_device_info->queue_families_indices_
+    ,   physical_device
+    ,   out_physical_device_info->queue_family_properties_
+    ,   out_physical_device_info->queue_family_properties_count_
+    ,   surface
+    ) ;
+
+    if(out_physical_device_info->queue_families_indices_complete_)
+    {
+        add_to_unique_queue_families_indices(
+            out_physical_device_info->unique_queue_families_indices_
+        ,   &out_physical_device_info->unique_queue_families_indices_count_
+        ,   out_physical_device_info->queue_families_indices_.graphics_family_
+        ) ;
+
+        add_to_unique_queue_families_indices(
+            out_physical_device_info->unique_queue_families_indices_
+        ,   &out_physical_device_info->unique_queue_families_indices_count_
+        ,   out_physical_device_info->queue_families_indices_.present_family_
+        ) ;
+    }
+
+    out_physical_device_info->max_usable_sample_count_ = get_max_usuable_sample_count(
+        &out_physical_device_info->properties_
+    ) ;
+
+    out_physical_device_info->sample_count_ = VK_SAMPLE_COUNT_1_BIT ;
+
+    // depends on the surface, never cached.
+    if(check(create_swapchain_support_details(
+                &out_physical_device_info->swapchain_support_details_
+            ,   physical_device
+            ,   surface
+            )
         )
-        {
-            log_debug_u32(j) ;
-            dump_format_properties(&pdi->desired_format_properties_[j].properties_) ;
-        }
+    )
+    {
+        return false ;
+    }
+
+    out_physical_device_info->swapchain_support_details_okay_ = check_if_swapchain_support_is_adequate(
+        &out_physical_device_info->swapchain_support_details_
+    ) ;
 
-        log_debug_u32(pdi->depth_format_) ;
-        log_debug_str(dump_vk_format(pdi->depth_format_)) ;
+    if(check(find_depth_format(
+                &out_physical_device_info->depth_format_
+            ,   out_physical_device_info->desired_format_properties_
+            ,   out_physical_device_info->desired_format_properties_count_
+            )
+        )
+    )
+    {
+        return false ;
+    }
+
+    return true ;
+}
+
+
+static void
+dump_physical_device_info(
+    vulkan_physical_device_info const * pdi
+)
+{
+    require(pdi) ;
+
+    dump_physical_device_properties(&pdi->properties_) ;
+    dump_physical_device_features(&pdi->features_) ;
+    dump_physical_device_memory_properties(&pdi->memory_properties_) ;
+    dump_queue_family_properties(pdi->queue_family_properties_, pdi->queue_family_properties_count_) ;
+    log_debug_u32(pdi->queue_families_indices_complete_) ;
+
+    log_debug_u32(pdi->unique_queue_families_indices_count_) ;
+    for(
+        uint32_t j = 0
+    ;   j < pdi->unique_queue_families_indices_count_
+    ;   ++j
+    )
+    {
+        log_debug_u32(j) ;
+        log_debug_u32(pdi->unique_queue_families_indices_[j]) ;
+    }
+
+    log_debug_u32(pdi->desired_device_extensions_okay_) ;
+    log_debug_u32(pdi->desired_device_extensions_count_) ;
+    log_debug_u32(pdi->max_usable_sample_count_) ;
+    log_debug_u32(pdi->swapchain_support_details_.formats_count_) ;
+    log_debug_u32(pdi->swapchain_support_details_.modes_count_) ;
+
+    dump_surface_capabilities(&pdi->swapchain_support_details_.capabilities_) ;
+
+    for(
+        uint32_t j = 0
+    ;   j < pdi->swapchain_support_details_.formats_count_
+    ;   ++j
+    )
+    {
+        log_debug_u32(j) ;
+        dump_surface_format_khr(&pdi->swapchain_support_details_.formats_[j]) ;
+        dump_format_properties(&pdi->swapchain_support_details_.formats_properties_[j]) ;
+    }
 
+    for(
+        uint32_t j = 0
+    ;   j < pdi->swapchain_support_details_.modes_count_
+    ;   ++j
+    )
+    {
+        log_debug_u32(j) ;
+        log_debug_str(dump_present_mode_khr(pdi->swapchain_support_details_.modes_[j])) ;
+    }
+
+    log_debug_u32(pdi->desired_format_properties_count_) ;
+    for(
+        uint32_t j = 0
+    ;   j < pdi->desired_format_properties_count_
+    ;   ++j
+    )
+    {
+        log_debug_u32(j) ;
+        dump_format_properties(&pdi->desired_format_properties_[j].properties_) ;
     }
+
+    log_debug_u32(pdi->depth_format_) ;
+    log_debug_str(dump_vk_format(pdi->depth_format_)) ;
 }
 
 
@@ -3674,16 +4154,173 @@ is_physical_device_suiteable(
 }
 
 
+// --gpu takes part of the device name or the pipeline cache uuid, with or
+// without dashes, as logged while scoring.
+static bool
+is_physical_device_override(
+    VkPhysicalDeviceProperties const *  properties
+,   char const *                        gpu
+)
+{
+    require(properties) ;
+    require(gpu) ;
+
+    if(SDL_strcasestr(properties->deviceName, gpu))
+    {
+        return true ;
+    }
+
+    static char const hex[] = "0123456789abcdef" ;
+    uint32_t n = 0 ;
+    for(char const * c = gpu ; *c ; ++c)
+    {
+        if('-' == *c)
+        {
+            continue ;
+        }
+        if(n == 2 * VK_UUID_SIZE)
+        {
+            return false ;
+        }
+        uint8_t const b = properties->pipelineCacheUUID[n / 2] ;
+        char const h = hex[(n & 1) ? (b & 0xf) : (b >> 4)] ;
+        if(h != SDL_tolower(*c))
+        {
+            return false ;
+        }
+        ++n ;
+    }
+
+    return n == 2 * VK_UUID_SIZE ;
+}
+
+
+static void
+format_uuid(
+    char *          out_uuid
+,   uint8_t const * uuid
+)
+{
+    require(out_uuid) ;
+    require(uuid) ;
+
+    static char const hex[] = "0123456789abcdef" ;
+    char * o = out_uuid ;
+    for(
+        uint32_t i = 0
+    ;   i < VK_UUID_SIZE
+    ;   ++i
+    )
+    {
+        if(4 == i || 6 == i || 8 == i || 10 == i)
+        {
+            *o++ = '-' ;
+        }
+        *o++ = hex[uuid[i] >> 4] ;
+        *o++ = hex[uuid[i] & 0xf] ;
+    }
+    *o = 0 ;
+}
+
+
+// Only asks for what is cheap to get, 0 when the device lacks a feature the
+// app can't do without. Device type weighs most, then the device local
+// memory and last the sample count, every part is logged.
+static uint32_t
+score_physical_device(
+    VkPhysicalDevice const  physical_device
+,   uint32_t const          index
+)
+{
+    require(physical_device) ;
+
+    VkPhysicalDeviceProperties          pdp     = { 0 } ;
+    VkPhysicalDeviceFeatures            pdf     = { 0 } ;
+    VkPhysicalDeviceMemoryProperties    pdmp    = { 0 } ;
+    vkGetPhysicalDeviceProperties(physical_device, &pdp) ;
+    vkGetPhysicalDeviceFeatures(physical_device, &pdf) ;
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &pdmp) ;
+
+    uint32_t type_score = 0 ;
+    switch(pdp.deviceType)
+    {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:      type_score = vulkan_device_score_discrete ;     break ;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:    type_score = vulkan_device_score_integrated ;   break ;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:       type_score = vulkan_device_score_virtual ;      break ;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:               type_score = vulkan_device_score_cpu ;          break ;
+    default:                                        type_score = 0 ;                                break ;
+    }
+
+    VkDeviceSize local_size = 0 ;
+    for(
+        uint32_t i = 0
+    ;   i < pdmp.memoryHeapCount
+    ;   ++i
+    )
+    {
+        if(pdmp.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+        {
+            local_size = SDL_max(local_size, pdmp.memoryHeaps[i].size) ;
+        }
+    }
+
+    uint32_t const local_mb         = (uint32_t) SDL_min(local_size >> 20, (VkDeviceSize) UINT32_MAX) ;
+    uint32_t const memory_score     = SDL_min(local_mb / vulkan_device_score_mb_per_point, vulkan_device_score_max_memory) ;
+    uint32_t const samples          = (uint32_t) get_max_usuable_sample_count(&pdp) ;
+    uint32_t const sample_score     = samples * vulkan_device_score_per_sample ;
+    bool const     features_ok      = pdf.geometryShader && pdf.samplerAnisotropy ;
+    uint32_t const score            = features_ok ? type_score + memory_score + sample_score : 0 ;
+
+    char uuid[2 * VK_UUID_SIZE + 5] = { 0 } ;
+    format_uuid(uuid, pdp.pipelineCacheUUID) ;
+
+    log_info(
+        "device %u %s (%s) type=%s(%u) local=%u MB(%u) samples=%u(%u) features=%s score=%u"
+    ,   index
+    ,   pdp.deviceName
+    ,   uuid
+    ,   physical_device_type_to_string(pdp.deviceType)
+    ,   type_score
+    ,   local_mb
+    ,   memory_score
+    ,   samples
+    ,   sample_score
+    ,   features_ok ? "okay" : "missing"
+    ,   score
+    ) ;
+
+    return score ;
+}
+
+
+// Devices are scored from what is cheap to ask for, best first, or the one
+// picked with --gpu first. They are then filled in one after the other into
+// the same info and the first suitable one is kept, the rest is never
+// queried. What the cache holds is taken from it when it was written for
+// the same device and driver.
 static bool
 pick_physical_device(
     vulkan_physical_device_info **      out_physical_device
-,   vulkan_physical_device_info *       physical_devices
+,   bool *                              out_cached
+,   vulkan_physical_device_info *       physical_device_info
+,   VkPhysicalDevice const *            physical_devices
 ,   uint32_t const                      physical_devices_count
+,   VkSurfaceKHR const                  surface
+,   vulkan_device_cache const *         cache
+,   VkBool32 const                      enable_dump
+,   char const *                        gpu
 )
 {
     require(out_physical_device) ;
+    require(out_cached) ;
+    require(physical_device_info) ;
     require(physical_devices) ;
     require(physical_devices_count) ;
+    require(physical_devices_count <= max_vulkan_physical_devices) ;
+
+    uint32_t    order[max_vulkan_physical_devices]  = { 0 } ;
+    uint32_t    scores[max_vulkan_physical_devices] = { 0 } ;
+    bool        overridden                          = false ;
 
     for(
         uint32_t i = 0
@@ -3691,22 +4328,76 @@ pick_physical_device(
     ;   ++i
     )
     {
-        vulkan_physical_device_info * pd = &physical_devices[i] ;
+        scores[i] = score_physical_device(physical_devices[i], i) ;
+
+        if(gpu && !overridden)
+        {
+            VkPhysicalDeviceProperties pdp = { 0 } ;
+            vkGetPhysicalDeviceProperties(physical_devices[i], &pdp) ;
+            if(is_physical_device_override(&pdp, gpu))
+            {
+                log_info("device %u matches --gpu %s, it goes first.", i, gpu) ;
+                scores[i] = UINT32_MAX ;
+                overridden = true ;
+            }
+        }
+
+        // insertion sort, best first and the same scores in their order.
+        uint32_t j = i ;
+        for( ; j > 0 && scores[order[j - 1]] < scores[i] ; --j)
+        {
+            order[j] = order[j - 1] ;
+        }
+        order[j] = i ;
+    }
+
+    if(gpu && !overridden)
+    {
+        log_error("no device matches --gpu %s, picking by score.", gpu) ;
+    }
+
+    for(
+        uint32_t k = 0
+    ;   k < physical_devices_count
+    ;   ++k
+    )
+    {
+        uint32_t const i = order[k] ;
+        if(0 == scores[i])
+        {
+            break ;
+        }
+
+        vulkan_physical_device_info * pd = physical_device_info ;
+        if(!fill_physical_device_info(pd, out_cached, physical_devices[i], surface, cache, enable_dump))
+        {
+            log_error("skipping device %u, its info is incomplete.", i) ;
+            continue ;
+        }
+
+        if(enable_dump)
+        {
+            dump_physical_device_info(pd) ;
+        }
+
         if(is_physical_device_suiteable(pd))
         {
             *out_physical_device = pd ;
             log_debug("picking device %s (%p) max_msaa_samples=%d", pd->properties_.deviceName, pd->device_, pd->max_usable_sample_count_) ;
+            log_info("picked device %u, %s, with score %u, capabilities %s.", i, pd->properties_.deviceName, scores[i], *out_cached ? "cached" : "queried") ;
             return true ;
         }
+
+        log_info("device %u %s is not suitable, trying the next one.", i, pd->properties_.deviceName) ;
     }
 
     *out_physical_device = NULL ;
+    *out_cached = false ;
     require(0) ;
     return false ;
 
 }
 
-
 static bool
 create_logical_device(
     VkDevice *                          out_device
@@ -3855,6 +4546,18 @@ create_queues(
 }
 
 
+// scaled or post processed, the scene isn't drawn to the swapchain image.
+static bool
+uses_scene_image(
+    vulkan_context const *  vc
+)
+{
+    require(vc) ;
+
+    return vc->enable_render_scale_ || vc->enable_post_aa_ ;
+}
+
+
 static bool
 create_framebuffers(
     vulkan_context *    vc
@@ -3873,11 +4576,17 @@ create_framebuffers(
     ;   ++i
     )
     {
+        // scaled or post processed, every frame is drawn to the scene image.
+        VkImageView const target = uses_scene_image(vc)
+            ? vc->scene_image_view_
+            : vc->swapchain_views_[i]
+            ;
+
         if(vc->enable_sampling_)
         {
             attachments[0] = vc->color_image_view_ ;
             attachments[1] = vc->depth_image_view_ ;
-            attachments[2] = vc->swapchain_views_[i] ;
+            attachments[2] = target ;
             attachments_count = 3 ;
             require(attachments[0]) ;
             require(attachments[1]) ;
@@ -3885,7 +4594,7 @@ create_framebuffers(
         }
         else
         {
-            attachments[0] = vc->swapchain_views_[i] ;
+            attachments[0] = target ;
             attachments[1] = vc->depth_image_view_ ;
             attachments_count = 2 ;
             require(attachments[0]) ;
@@ -4023,6 +4732,281 @@ choose_swapchain_extent(
 }
 
 
+// --render-scale <0.5..1> draws at that scale of the window, --gpu-budget <ms>
+// is the gpu time the adaptive scale aims for. Without either the scene is
+// drawn straight to the swapchain image, nothing is blitted. The swapchain
+// images have to be blit destinations in the surface format, pre recorded
+// command buffers can't follow the scale.
+static void
+setup_render_scale(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    require(vc->picked_physical_device_) ;
+
+    char const * const scale    = get_app_arg_value("--render-scale") ;
+    char const * const budget   = get_app_arg_value("--gpu-budget") ;
+
+    vc->render_scale_ = scale
+        ? SDL_clamp((float) SDL_atof(scale), min_vulkan_render_scale, 1.0f)
+        : 1.0f
+        ;
+    vc->gpu_budget_ms_ = budget
+        ? SDL_atof(budget)
+        : 0.0
+        ;
+    vc->enable_adaptive_render_scale_   = !scale && vc->gpu_budget_ms_ > 0.0 ;
+    vc->enable_render_scale_            = vc->enable_adaptive_render_scale_ || vc->render_scale_ < 1.0f ;
+
+    if(!vc->enable_render_scale_)
+    {
+        return ;
+    }
+
+    vulkan_swapchain_support_details const * scsd = &vc->picked_physical_device_->swapchain_support_details_ ;
+
+    VkSurfaceFormatKHR const sf = choose_swapchain_surface_format(
+        scsd->formats_
+    ,   scsd->formats_count_
+    ) ;
+
+    // void vkGetPhysicalDeviceFormatProperties(
+    //     VkPhysicalDevice                            physicalDevice,
+    //     VkFormat                                    format,
+    //     VkFormatProperties*                         pFormatProperties);
+    VkFormatProperties fp = { 0 } ;
+    vkGetPhysicalDeviceFormatProperties(vc->picked_physical_device_->device_, sf.format, &fp) ;
+
+    VkFormatFeatureFlags const blit_features =
+        VK_FORMAT_FEATURE_BLIT_SRC_BIT
+    |   VK_FORMAT_FEATURE_BLIT_DST_BIT
+    |   VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+    ;
+
+    bool const supported =
+        blit_features == (fp.optimalTilingFeatures & blit_features)
+    &&  (scsd->capabilities_.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+    &&  !vc->enable_pre_record_command_buffers_
+    ;
+
+    if(!supported)
+    {
+        log_info("the render scale isn't supported, drawing at the window size.") ;
+        vc->enable_render_scale_            = VK_FALSE ;
+        vc->enable_adaptive_render_scale_   = VK_FALSE ;
+        vc->render_scale_                   = 1.0f ;
+        return ;
+    }
+
+    if(vc->enable_adaptive_render_scale_)
+    {
+        log_info("render scale follows a gpu budget of %.2f ms.", vc->gpu_budget_ms_) ;
+    }
+    else
+    {
+        log_info("render scale %.2f.", vc->render_scale_) ;
+    }
+}
+
+
+static bool
+is_aa_mode_supported(
+    vulkan_context *    vc
+,   uint32_t const      aa_mode
+)
+{
+    require(vc) ;
+    require(vc->picked_physical_device_) ;
+    require(aa_mode < vulkan_aa_modes_count) ;
+
+    vulkan_aa_mode_info const * info = &vulkan_aa_modes[aa_mode] ;
+
+    if(info->sample_count_ > vc->picked_physical_device_->max_usable_sample_count_)
+    {
+        return false ;
+    }
+
+    if(
+        info->sample_shading_
+    &&  !vc->desired_enabled_device_features_.sampleRateShading
+    )
+    {
+        return false ;
+    }
+
+    if(!info->post_)
+    {
+        return true ;
+    }
+
+    // the post pass is recorded every frame and samples the scene linearly.
+    if(vc->enable_pre_record_command_buffers_)
+    {
+        return false ;
+    }
+
+    vulkan_swapchain_support_details const * scsd = &vc->picked_physical_device_->swapchain_support_details_ ;
+
+    VkSurfaceFormatKHR const sf = choose_swapchain_surface_format(
+        scsd->formats_
+    ,   scsd->formats_count_
+    ) ;
+
+    VkFormatProperties fp = { 0 } ;
+    vkGetPhysicalDeviceFormatProperties(vc->picked_physical_device_->device_, sf.format, &fp) ;
+
+    return 0 != (fp.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ;
+}
+
+
+// only the state, the render pass, the images and the pipelines are made
+// with it.
+static void
+apply_aa_mode(
+    vulkan_context *    vc
+,   uint32_t const      aa_mode
+)
+{
+    require(vc) ;
+    require(aa_mode < vulkan_aa_modes_count) ;
+
+    vulkan_aa_mode_info const * info = &vulkan_aa_modes[aa_mode] ;
+
+    vc->aa_mode_                = aa_mode ;
+    vc->sample_count_           = info->sample_count_ ;
+    vc->enable_sampling_        = info->sample_count_ > VK_SAMPLE_COUNT_1_BIT ;
+    vc->enable_sample_shading_  = info->sample_shading_ ;
+    vc->enable_post_aa_         = info->post_ ;
+
+    vc->frame_stats_.aa_mode_   = aa_mode ;
+    vc->frame_stats_.aa_tuning_ = vc->aa_tune_mode_ < vulkan_aa_modes_count ;
+}
+
+
+// the next mode to measure, the best looking ones first. off isn't measured,
+// it is what is left when nothing else fits.
+static uint32_t
+get_next_aa_tune_mode(
+    vulkan_context *    vc
+,   uint32_t const      aa_mode
+)
+{
+    require(vc) ;
+
+    for(
+        uint32_t i = aa_mode
+    ;   i > vulkan_aa_mode_off + 1
+    ;   --i
+    )
+    {
+        if(is_aa_mode_supported(vc, i - 1))
+        {
+            return i - 1 ;
+        }
+    }
+
+    return vulkan_aa_modes_count ;
+}
+
+
+// --aa <mode> picks one of vulkan_aa_modes by name, --aa auto measures them
+// once the render objects draw, see update_aa_tuning. Without it there is no
+// anti aliasing.
+static void
+setup_aa_mode(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+
+    char const * const name = get_app_arg_value("--aa") ;
+
+    vc->aa_tune_mode_   = vulkan_aa_modes_count ;
+    vc->aa_tune_frame_  = 0 ;
+    vc->aa_tune_gpu_ms_ = 0.0 ;
+
+    uint32_t aa_mode = vulkan_aa_mode_off ;
+
+    if(name && 0 == SDL_strcmp(name, "auto"))
+    {
+        if(vc->enable_pre_record_command_buffers_)
+        {
+            log_info("--aa auto needs every frame recorded, anti aliasing is off.") ;
+        }
+        else
+        {
+            vc->aa_tune_mode_ = get_next_aa_tune_mode(vc, vulkan_aa_modes_count) ;
+            if(vc->aa_tune_mode_ < vulkan_aa_modes_count)
+            {
+                aa_mode = vc->aa_tune_mode_ ;
+            }
+        }
+    }
+    else if(name)
+    {
+        aa_mode = vulkan_aa_modes_count ;
+
+        for(
+            uint32_t i = 0
+        ;   i < vulkan_aa_modes_count
+        ;   ++i
+        )
+        {
+            if(0 == SDL_strcmp(vulkan_aa_modes[i].name_, name))
+            {
+                aa_mode = i ;
+            }
+        }
+
+        if(
+            aa_mode == vulkan_aa_modes_count
+        ||  !is_aa_mode_supported(vc, aa_mode)
+        )
+        {
+            log_info("anti aliasing %s isn't supported, anti aliasing is off.", name) ;
+            aa_mode = vulkan_aa_mode_off ;
+        }
+    }
+
+    apply_aa_mode(vc, aa_mode) ;
+
+    log_info("anti aliasing %s%s.", vulkan_aa_modes[aa_mode].name_, vc->frame_stats_.aa_tuning_ ? ", tuning" : "") ;
+}
+
+
+static VkImageUsageFlags
+get_swapchain_image_usage(
+    vulkan_context const *  vc
+)
+{
+    require(vc) ;
+
+    return vc->enable_render_scale_
+        ? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
+        : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+        ;
+}
+
+
+// the part of the swapchain extent drawn to, all of it without a scale.
+static void
+update_render_extent(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+
+    float const scale = vc->enable_render_scale_ ? vc->render_scale_ : 1.0f ;
+
+    vc->render_extent_.width    = max_u32(1, (uint32_t) ((float) vc->swapchain_extent_.width * scale + 0.5f)) ;
+    vc->render_extent_.height   = max_u32(1, (uint32_t) ((float) vc->swapchain_extent_.height * scale + 0.5f)) ;
+    vc->render_extent_.width    = min_u32(vc->render_extent_.width, vc->swapchain_extent_.width) ;
+    vc->render_extent_.height   = min_u32(vc->render_extent_.height, vc->swapchain_extent_.height) ;
+    vc->frame_stats_.render_scale_ = scale ;
+}
+
+
 static bool
 create_swapchain(
     VkSwapchainKHR *                            out_swapchain
@@ -4036,6 +5020,7 @@ create_swapchain(
 ,   vulkan_swapchain_support_details const *    scsd
 ,   vulkan_queue_family_indices const *         qfi
 ,   uint32_t                                    desired_image_count
+,   VkImageUsageFlags const                     usage
 )
 {
     require(out_swapchain) ;
@@ -4132,7 +5117,7 @@ create_swapchain(
     scci.imageColorSpace            = out_surface_format->colorSpace ;
     scci.imageExtent                = *out_extent ;
     scci.imageArrayLayers           = 1 ;
-    scci.imageUsage                 = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT ;
+    scci.imageUsage                 = usage ;
     if(queue_family_indices[0] == queue_family_indices[1])
     {
     scci.imageSharingMode           = VK_SHARING_MODE_EXCLUSIVE ;
@@ -4663,8 +5648,8 @@ create_depth_resource(
             ,   vc->sample_count_
             ,   vc->picked_physical_device_->depth_format_
             ,   VK_IMAGE_TILING_OPTIMAL
-            ,   VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
-            ,   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+            ,   VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+            ,   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT
             )
         )
     )
@@ -4729,6 +5714,8 @@ cleanup_swapchain(
 
     vkDeviceWaitIdle(vc->device_);
 
+    destroy_vulkan_post_framebuffers(vc) ;
+
     if(vc->color_image_view_)
     {
         vkDestroyImageView(vc->device_, vc->color_image_view_, NULL) ;
@@ -4743,10 +5730,28 @@ cleanup_swapchain(
 
     if(vc->color_image_memory_)
     {
-        vkFreeMemory(vc->device_, vc->color_image_memory_, NULL) ;
+        free_device_memory(vc->device_, vc->color_image_memory_) ;
         vc->color_image_memory_ = NULL ;
     }
 
+    if(vc->scene_image_view_)
+    {
+        vkDestroyImageView(vc->device_, vc->scene_image_view_, NULL) ;
+        vc->scene_image_view_ = NULL ;
+    }
+
+    if(vc->scene_image_)
+    {
+        vkDestroyImage(vc->device_, vc->scene_image_, NULL) ;
+        vc->scene_image_ = NULL ;
+    }
+
+    if(vc->scene_image_memory_)
+    {
+        free_device_memory(vc->device_, vc->scene_image_memory_) ;
+        vc->scene_image_memory_ = NULL ;
+    }
+
     if(vc->depth_image_view_)
     {
         vkDestroyImageView(vc->device_, vc->depth_image_view_, NULL) ;
@@ -4761,7 +5766,7 @@ cleanup_swapchain(
 
     if(vc->depth_image_memory_)
     {
-        vkFreeMemory(vc->device_, vc->depth_image_memory_, NULL) ;
+        free_device_memory(vc->device_, vc->depth_image_memory_) ;
         vc->depth_image_memory_ = NULL ;
     }
 
@@ -4833,7 +5838,7 @@ create_color_resource(
             ,   vc->swapchain_surface_format_.format
             ,   VK_IMAGE_TILING_OPTIMAL
             ,   VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
-            ,   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+            ,   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT
             )
         )
     )
@@ -4866,6 +5871,70 @@ create_color_resource(
 }
 
 
+// swapchain sized, so a larger scale needs no new image, only the top left
+// render_extent_ is drawn to and blitted or post processed.
+static bool
+create_scene_resource(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    require(vc->device_) ;
+    begin_timed_block() ;
+
+    update_render_extent(vc) ;
+
+    if(!uses_scene_image(vc))
+    {
+        end_timed_block() ;
+        return true ;
+    }
+
+    if(check(create_image(
+                &vc->scene_image_
+            ,   &vc->scene_image_memory_
+            ,   vc->device_
+            ,   &vc->picked_physical_device_->memory_properties_
+            ,   vc->swapchain_extent_.width
+            ,   vc->swapchain_extent_.height
+            ,   1
+            ,   VK_SAMPLE_COUNT_1_BIT
+            ,   vc->swapchain_surface_format_.format
+            ,   VK_IMAGE_TILING_OPTIMAL
+            ,   VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (vc->enable_post_aa_ ? VK_IMAGE_USAGE_SAMPLED_BIT : VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+            ,   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vc->scene_image_) ;
+    require(vc->scene_image_memory_) ;
+
+    if(check(create_image_views(
+                &vc->scene_image_view_
+            ,   &vc->scene_image_
+            ,   1
+            ,   vc->device_
+            ,   vc->swapchain_surface_format_.format
+            ,   VK_IMAGE_ASPECT_COLOR_BIT
+            ,   1
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vc->scene_image_view_) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
 static bool
 recreate_swapchain(
     vulkan_context *    vc
@@ -4890,6 +5959,7 @@ recreate_swapchain(
             ,   &vc->picked_physical_device_->swapchain_support_details_
             ,   &vc->picked_physical_device_->queue_families_indices_
             ,   vc->desired_swapchain_image_count_
+            ,   get_swapchain_image_usage(vc)
             )
         )
     )
@@ -4921,6 +5991,12 @@ recreate_swapchain(
         return false ;
     }
 
+    if(check(create_scene_resource(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
     if(check(create_depth_resource(vc)))
     {
         end_timed_block() ;
@@ -4933,6 +6009,12 @@ recreate_swapchain(
         return false ;
     }
 
+    if(check(create_vulkan_post_framebuffers(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
     end_timed_block() ;
     return true ;
 }
@@ -4952,6 +6034,7 @@ create_shader_module(
     require(0 == (((uintptr_t)shader_code)&3)) ;
 
     begin_timed_block() ;
+    begin_startup_phase(startup_phase_pipelines) ;
 
     // typedef struct VkShaderModuleCreateInfo {
     //     VkStructureType              sType;
@@ -4981,11 +6064,13 @@ create_shader_module(
         )
     )
     {
+        end_startup_phase(startup_phase_pipelines) ;
         end_timed_block() ;
         return false ;
     }
     require(*out_shader_module) ;
 
+    end_startup_phase(startup_phase_pipelines) ;
     end_timed_block() ;
     return true ;
 
@@ -5015,6 +6100,21 @@ create_render_pass(
     static VkAttachmentDescription  attachments[3] = { 0 } ;
     static uint32_t                 attachments_count = 0 ;
 
+    // the multisampled color and the depth are cleared and never read after
+    // the pass, they don't need to leave the tile memory on tiled gpus.
+
+    // scaled, the scene image is blitted to the swapchain image afterwards,
+    // post processed, it is sampled by the post pass.
+    VkImageLayout present_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR ;
+    if(vc->enable_post_aa_)
+    {
+        present_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ;
+    }
+    else if(vc->enable_render_scale_)
+    {
+        present_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL ;
+    }
+
 
     if(vc->enable_sampling_)
     {
@@ -5024,7 +6124,7 @@ create_render_pass(
         attachments[0].format           = vc->swapchain_surface_format_.format ;
         attachments[0].samples          = vc->sample_count_ ;
         attachments[0].loadOp           = VK_ATTACHMENT_LOAD_OP_CLEAR ;
-        attachments[0].storeOp          = VK_ATTACHMENT_STORE_OP_STORE ;
+        attachments[0].storeOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE ;
         attachments[0].stencilLoadOp    = VK_ATTACHMENT_LOAD_OP_DONT_CARE ;
         attachments[0].stencilStoreOp   = VK_ATTACHMENT_STORE_OP_DONT_CARE ;
         attachments[0].initialLayout    = VK_IMAGE_LAYOUT_UNDEFINED ;
@@ -5034,7 +6134,7 @@ create_render_pass(
         attachments[1].format           = vc->picked_physical_device_->depth_format_ ;
         attachments[1].samples          = vc->sample_count_ ;
         attachments[1].loadOp           = VK_ATTACHMENT_LOAD_OP_CLEAR ;
-        attachments[1].storeOp          = VK_ATTACHMENT_STORE_OP_STORE ;
+        attachments[1].storeOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE ;
         attachments[1].stencilLoadOp    = VK_ATTACHMENT_LOAD_OP_DONT_CARE ;
         attachments[1].stencilStoreOp   = VK_ATTACHMENT_STORE_OP_DONT_CARE ;
         attachments[1].initialLayout    = VK_IMAGE_LAYOUT_UNDEFINED ;
@@ -5048,7 +6148,7 @@ create_render_pass(
         attachments[2].stencilLoadOp    = VK_ATTACHMENT_LOAD_OP_DONT_CARE ;
         attachments[2].stencilStoreOp   = VK_ATTACHMENT_STORE_OP_DONT_CARE ;
         attachments[2].initialLayout    = VK_IMAGE_LAYOUT_UNDEFINED ;
-        attachments[2].finalLayout      = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR ;
+        attachments[2].finalLayout      = present_layout ;
     }
     else
     {
@@ -5062,13 +6162,13 @@ create_render_pass(
         attachments[0].stencilLoadOp    = VK_ATTACHMENT_LOAD_OP_DONT_CARE ;
         attachments[0].stencilStoreOp   = VK_ATTACHMENT_STORE_OP_DONT_CARE ;
         attachments[0].initialLayout    = VK_IMAGE_LAYOUT_UNDEFINED ;
-        attachments[0].finalLayout      = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR ;
+        attachments[0].finalLayout      = present_layout ;
 
         attachments[1].flags            = 0 ;
         attachments[1].format           = vc->picked_physical_device_->depth_format_ ;
         attachments[1].samples          = VK_SAMPLE_COUNT_1_BIT ;
         attachments[1].loadOp           = VK_ATTACHMENT_LOAD_OP_CLEAR ;
-        attachments[1].storeOp          = VK_ATTACHMENT_STORE_OP_STORE ;
+        attachments[1].storeOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE ;
         attachments[1].stencilLoadOp    = VK_ATTACHMENT_LOAD_OP_DONT_CARE ;
         attachments[1].stencilStoreOp   = VK_ATTACHMENT_STORE_OP_DONT_CARE ;
         attachments[1].initialLayout    = VK_IMAGE_LAYOUT_UNDEFINED ;
@@ -5132,14 +6232,42 @@ create_render_pass(
     //     VkAccessFlags           dstAccessMask;
     //     VkDependencyFlags       dependencyFlags;
     // } VkSubpassDependency;
-    static VkSubpassDependency sde = { 0 } ;
-    sde.srcSubpass       = VK_SUBPASS_EXTERNAL ;
-    sde.dstSubpass       = 0 ;
-    sde.srcStageMask     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT ;
-    sde.dstStageMask     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT ;
-    sde.srcAccessMask    = 0 ;
-    sde.dstAccessMask    = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT ;
-    sde.dependencyFlags  = 0 ;
+    static VkSubpassDependency sde[2] = { 0 } ;
+    sde[0].srcSubpass       = VK_SUBPASS_EXTERNAL ;
+    sde[0].dstSubpass       = 0 ;
+    sde[0].srcStageMask     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT ;
+    sde[0].dstStageMask     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT ;
+    sde[0].srcAccessMask    = 0 ;
+    sde[0].dstAccessMask    = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT ;
+    sde[0].dependencyFlags  = 0 ;
+
+    // the scene image is shared by the frames in flight, the blit or post
+    // pass of the frame before has to have read it before it is drawn to
+    // again, and it is only read by this frame's once drawn.
+    if(vc->enable_post_aa_)
+    {
+    sde[0].srcStageMask    |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT ;
+
+    sde[1].srcSubpass       = 0 ;
+    sde[1].dstSubpass       = VK_SUBPASS_EXTERNAL ;
+    sde[1].srcStageMask     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT ;
+    sde[1].dstStageMask     = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT ;
+    sde[1].srcAccessMask    = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT ;
+    sde[1].dstAccessMask    = VK_ACCESS_SHADER_READ_BIT ;
+    sde[1].dependencyFlags  = 0 ;
+    }
+    else if(vc->enable_render_scale_)
+    {
+    sde[0].srcStageMask    |= VK_PIPELINE_STAGE_TRANSFER_BIT ;
+
+    sde[1].srcSubpass       = 0 ;
+    sde[1].dstSubpass       = VK_SUBPASS_EXTERNAL ;
+    sde[1].srcStageMask     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT ;
+    sde[1].dstStageMask     = VK_PIPELINE_STAGE_TRANSFER_BIT ;
+    sde[1].srcAccessMask    = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT ;
+    sde[1].dstAccessMask    = VK_ACCESS_TRANSFER_READ_BIT ;
+    sde[1].dependencyFlags  = 0 ;
+    }
 
     require(attachments_count) ;
     // typedef struct VkRenderPassCreateInfo {
@@ -5161,8 +6289,8 @@ create_render_pass(
     rpci.pAttachments       = attachments ;
     rpci.subpassCount       = 1 ;
     rpci.pSubpasses         = &sd ;
-    rpci.dependencyCount    = 1 ;
-    rpci.pDependencies      = &sde ;
+    rpci.dependencyCount    = uses_scene_image(vc) ? 2 : 1 ;
+    rpci.pDependencies      = sde ;
 
     // VkResult vkCreateRenderPass(
     //     VkDevice                                    device,
@@ -5378,11 +6506,13 @@ begin_record_command_buffer(
     vulkan_context *    vc
 ,   VkCommandBuffer     command_buffer
 ,   VkFramebuffer       frame_buffer
+,   uint32_t const      frame_index
 )
 {
     require(vc) ;
     require(command_buffer) ;
     require(frame_buffer) ;
+    require(frame_index < max_vulkan_frames_in_flight) ;
 
     begin_timed_block() ;
 
@@ -5422,6 +6552,28 @@ begin_record_command_buffer(
         return false ;
     }
 
+    if(vc->enable_timestamps_)
+    {
+        // void vkCmdResetQueryPool(
+        //     VkCommandBuffer                             commandBuffer,
+        //     VkQueryPool                                 queryPool,
+        //     uint32_t                                    firstQuery,
+        //     uint32_t                                    queryCount);
+        vkCmdResetQueryPool(command_buffer, vc->timestamp_query_pool_, 2 * frame_index, 2) ;
+
+        // void vkCmdWriteTimestamp(
+        //     VkCommandBuffer                             commandBuffer,
+        //     VkPipelineStageFlagBits                     pipelineStage,
+        //     VkQueryPool                                 queryPool,
+        //     uint32_t                                    query);
+        vkCmdWriteTimestamp(
+            command_buffer
+        ,   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
+        ,   vc->timestamp_query_pool_
+        ,   2 * frame_index
+        ) ;
+    }
+
     // typedef struct VkRenderPassBeginInfo {
     //     VkStructureType        sType;
     //     const void*            pNext;
@@ -5459,8 +6611,8 @@ begin_record_command_buffer(
     rpbi.framebuffer                = frame_buffer ;
     rpbi.renderArea.offset.x        = 0 ;
     rpbi.renderArea.offset.y        = 0 ;
-    rpbi.renderArea.extent.width    = vc->swapchain_extent_.width ;
-    rpbi.renderArea.extent.height   = vc->swapchain_extent_.height ;
+    rpbi.renderArea.extent.width    = vc->render_extent_.width ;
+    rpbi.renderArea.extent.height   = vc->render_extent_.height ;
     rpbi.clearValueCount            = array_count(cv) ;
     rpbi.pClearValues               = cv ;
 
@@ -5473,8 +6625,8 @@ begin_record_command_buffer(
     static VkViewport viewport = { 0 } ;
     viewport.x          = 0.0f ;
     viewport.y          = 0.0f ;
-    viewport.width      = (float) vc->swapchain_extent_.width ;
-    viewport.height     = (float) vc->swapchain_extent_.height ;
+    viewport.width      = (float) vc->render_extent_.width ;
+    viewport.height     = (float) vc->render_extent_.height ;
     viewport.minDepth   = 0.0f ;
     viewport.maxDepth   = 1.0f ;
 
@@ -5488,8 +6640,8 @@ begin_record_command_buffer(
     static VkRect2D scissor = { 0 } ;
     scissor.offset.x        = 0 ;
     scissor.offset.y        = 0 ;
-    scissor.extent.width    = vc->swapchain_extent_.width ;
-    scissor.extent.height   = vc->swapchain_extent_.height ;
+    scissor.extent.width    = vc->render_extent_.width ;
+    scissor.extent.height   = vc->render_extent_.height ;
 
     // void vkCmdSetScissor(
     //     VkCommandBuffer                             commandBuffer,
@@ -5503,22 +6655,158 @@ begin_record_command_buffer(
 }
 
 
-static bool
-end_record_command_buffer(
+// the render pass left the scene image in TRANSFER_SRC_OPTIMAL, the
+// swapchain image is made a transfer destination, the drawn part of the scene
+// is stretched over it and it is made ready to be presented.
+static void
+record_scene_blit(
     vulkan_context *    vc
 ,   VkCommandBuffer     command_buffer
+,   VkImage const       swapchain_image
 )
 {
     require(vc) ;
     require(command_buffer) ;
+    require(swapchain_image) ;
+    require(vc->scene_image_) ;
+
+    static VkImageMemoryBarrier imb = { 0 } ;
+    imb.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER ;
+    imb.pNext                           = NULL ;
+    imb.srcAccessMask                   = 0 ;
+    imb.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT ;
+    imb.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED ;
+    imb.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL ;
+    imb.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED ;
+    imb.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED ;
+    imb.image                           = swapchain_image ;
+    imb.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT ;
+    imb.subresourceRange.baseMipLevel   = 0 ;
+    imb.subresourceRange.levelCount     = 1 ;
+    imb.subresourceRange.baseArrayLayer = 0 ;
+    imb.subresourceRange.layerCount     = 1 ;
+
+    // the submit waits for the image at the transfer stage.
+    vkCmdPipelineBarrier(
+        command_buffer
+    ,   VK_PIPELINE_STAGE_TRANSFER_BIT
+    ,   VK_PIPELINE_STAGE_TRANSFER_BIT
+    ,   0
+    ,   0
+    ,   NULL
+    ,   0
+    ,   NULL
+    ,   1
+    ,   &imb
+    ) ;
+
+    // typedef struct VkImageBlit {
+    //     VkImageSubresourceLayers    srcSubresource;
+    //     VkOffset3D                  srcOffsets[2];
+    //     VkImageSubresourceLayers    dstSubresource;
+    //     VkOffset3D                  dstOffsets[2];
+    // } VkImageBlit;
+    static VkImageBlit ib = { 0 } ;
+    ib.srcSubresource.aspectMask        = VK_IMAGE_ASPECT_COLOR_BIT ;
+    ib.srcSubresource.mipLevel          = 0 ;
+    ib.srcSubresource.baseArrayLayer    = 0 ;
+    ib.srcSubresource.layerCount        = 1 ;
+    ib.srcOffsets[0].x                  = 0 ;
+    ib.srcOffsets[0].y                  = 0 ;
+    ib.srcOffsets[0].z                  = 0 ;
+    ib.srcOffsets[1].x                  = (int32_t) vc->render_extent_.width ;
+    ib.srcOffsets[1].y                  = (int32_t) vc->render_extent_.height ;
+    ib.srcOffsets[1].z                  = 1 ;
+    ib.dstSubresource.aspectMask        = VK_IMAGE_ASPECT_COLOR_BIT ;
+    ib.dstSubresource.mipLevel          = 0 ;
+    ib.dstSubresource.baseArrayLayer    = 0 ;
+    ib.dstSubresource.layerCount        = 1 ;
+    ib.dstOffsets[0].x                  = 0 ;
+    ib.dstOffsets[0].y                  = 0 ;
+    ib.dstOffsets[0].z                  = 0 ;
+    ib.dstOffsets[1].x                  = (int32_t) vc->swapchain_extent_.width ;
+    ib.dstOffsets[1].y                  = (int32_t) vc->swapchain_extent_.height ;
+    ib.dstOffsets[1].z                  = 1 ;
+
+    // void vkCmdBlitImage(
+    //     VkCommandBuffer                             commandBuffer,
+    //     VkImage                                     srcImage,
+    //     VkImageLayout                               srcImageLayout,
+    //     VkImage                                     dstImage,
+    //     VkImageLayout                               dstImageLayout,
+    //     uint32_t                                    regionCount,
+    //     const VkImageBlit*                          pRegions,
+    //     VkFilter                                    filter);
+    vkCmdBlitImage(
+        command_buffer
+    ,   vc->scene_image_
+    ,   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+    ,   swapchain_image
+    ,   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+    ,   1
+    ,   &ib
+    ,   VK_FILTER_LINEAR
+    ) ;
+
+    imb.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT ;
+    imb.dstAccessMask   = 0 ;
+    imb.oldLayout       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL ;
+    imb.newLayout       = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR ;
+
+    vkCmdPipelineBarrier(
+        command_buffer
+    ,   VK_PIPELINE_STAGE_TRANSFER_BIT
+    ,   VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+    ,   0
+    ,   0
+    ,   NULL
+    ,   0
+    ,   NULL
+    ,   1
+    ,   &imb
+    ) ;
+}
+
+
+static bool
+end_record_command_buffer(
+    vulkan_context *    vc
+,   VkCommandBuffer     command_buffer
+,   uint32_t const      image_index
+,   uint32_t const      frame_index
+)
+{
+    require(vc) ;
+    require(command_buffer) ;
+    require(image_index < vc->swapchain_images_count_) ;
+    require(frame_index < max_vulkan_frames_in_flight) ;
+
+    begin_timed_block() ;
+
 
-    begin_timed_block() ;
-
-
     // void vkCmdEndRenderPass(
     //     VkCommandBuffer                             commandBuffer);
     vkCmdEndRenderPass(command_buffer) ;
 
+    if(vc->enable_post_aa_)
+    {
+        record_vulkan_post(vc, command_buffer, image_index) ;
+    }
+    else if(vc->enable_render_scale_)
+    {
+        record_scene_blit(vc, command_buffer, vc->swapchain_images_[image_index]) ;
+    }
+
+    if(vc->enable_timestamps_)
+    {
+        vkCmdWriteTimestamp(
+            command_buffer
+        ,   VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+        ,   vc->timestamp_query_pool_
+        ,   2 * frame_index + 1
+        ) ;
+    }
+
 
     // VkResult vkEndCommandBuffer(
     //     VkCommandBuffer                             commandBuffer);
@@ -5533,78 +6821,686 @@ end_record_command_buffer(
 }
 
 
-
-
+
+
+static bool
+update_rob(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+
+    begin_timed_block() ;
+
+    vc->frame_stats_.visible_count_ = 0 ;
+    vc->frame_stats_.culled_count_  = 0 ;
+
+    bool update_okay = true ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->render_objects_count_
+    ;   ++i
+    )
+    {
+        vulkan_render_object * vro = &vc->render_objects_[i] ;
+        require(vro->update_func_) ;
+        update_okay &= vro->update_func_(vro->vc_, vro, vc->current_frame_) ;
+    }
+
+    end_timed_block() ;
+    return update_okay ;
+}
+
+
+static bool
+draw_rob(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+
+    begin_timed_block() ;
+
+    if(vc->enable_pre_record_command_buffers_)
+    {
+        end_timed_block() ;
+        return true ;
+    }
+
+    vc->frame_stats_.draw_count_        = 0 ;
+    vc->frame_stats_.instance_count_    = 0 ;
+
+    if(check(begin_record_command_buffer(
+                vc
+            ,   vc->command_buffer_[vc->current_frame_]
+            ,   vc->framebuffers_[vc->image_index_]
+            ,   vc->current_frame_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    bool draw_okay = true ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->render_objects_count_
+    ;   ++i
+    )
+    {
+        vulkan_render_object * vro = &vc->render_objects_[i] ;
+        require(vro->draw_func_) ;
+        draw_okay &= vro->draw_func_(vro->vc_, vro, vc->current_frame_) ;
+    }
+
+    if(check(end_record_command_buffer(
+                vc
+            ,   vc->command_buffer_[vc->current_frame_]
+            ,   vc->image_index_
+            ,   vc->current_frame_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return draw_okay ;
+
+}
+
+
+static bool
+record_rob(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    if(!vc->enable_pre_record_command_buffers_)
+    {
+        end_timed_block() ;
+        return true ;
+    }
+
+    bool record_okay = true ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->frames_in_flight_count_
+    ;   ++i
+    )
+    {
+        // every pre recorded command buffer draws the same, keep the last.
+        vc->frame_stats_.draw_count_        = 0 ;
+        vc->frame_stats_.instance_count_    = 0 ;
+
+        if(check(begin_record_command_buffer(
+                    vc
+                ,   vc->command_buffer_[i]
+                ,   vc->framebuffers_[i]
+                ,   i
+                )
+            )
+        )
+        {
+            end_timed_block() ;
+            return false ;
+        }
+
+        for(
+            uint32_t rob = 0
+        ;   rob < vc->render_objects_count_
+        ;   ++rob
+        )
+        {
+            vulkan_render_object * vro = &vc->render_objects_[rob] ;
+            require(vro->record_func_) ;
+            record_okay &= vro->record_func_(vro->vc_, vro, i) ;
+        }
+
+        if(check(end_record_command_buffer(
+                    vc
+                ,   vc->command_buffer_[i]
+                ,   i
+                ,   i
+                )
+            )
+        )
+        {
+            end_timed_block() ;
+            return false ;
+        }
+    }
+
+    end_timed_block() ;
+    return record_okay ;
+}
+
+
+static bool
+destroy_rob(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    bool destroy_okay = true ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->render_objects_count_
+    ;   ++i
+    )
+    {
+        vulkan_render_object * vro = &vc->render_objects_[i] ;
+        require(vro->destroy_func_) ;
+        destroy_okay &= vro->destroy_func_(vro->vc_, vro) ;
+    }
+
+    end_timed_block() ;
+    return destroy_okay ;
+}
+
+
+
+
+
+static bool
+create_timestamp_query_pool(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    require(vc->picked_physical_device_) ;
+    begin_timed_block() ;
+
+    vulkan_physical_device_info const * pdi = vc->picked_physical_device_ ;
+    uint32_t const gf = pdi->queue_families_indices_.graphics_family_ ;
+    require(gf < pdi->queue_family_properties_count_) ;
+
+    uint32_t const valid_bits = pdi->queue_family_properties_[gf].timestampValidBits ;
+
+    vc->enable_timestamps_ = VK_FALSE ;
+
+    if(
+        !pdi->properties_.limits.timestampComputeAndGraphics
+    ||  0 == valid_bits
+    )
+    {
+        log_info("gpu timestamps not supported, gpu time will not be measured.") ;
+        end_timed_block() ;
+        return true ;
+    }
+
+    vc->timestamp_mask_         = valid_bits < 64 ? ((uint64_t)1 << valid_bits) - 1 : UINT64_MAX ;
+    vc->timestamp_period_ms_    = (double) pdi->properties_.limits.timestampPeriod / 1000000.0 ;
+
+    // typedef struct VkQueryPoolCreateInfo {
+    //     VkStructureType                  sType;
+    //     const void*                      pNext;
+    //     VkQueryPoolCreateFlags           flags;
+    //     VkQueryType                      queryType;
+    //     uint32_t                         queryCount;
+    //     VkQueryPipelineStatisticFlags    pipelineStatistics;
+    // } VkQueryPoolCreateInfo;
+    static VkQueryPoolCreateInfo qpci = { 0 } ;
+    qpci.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO ;
+    qpci.pNext              = NULL ;
+    qpci.flags              = 0 ;
+    qpci.queryType          = VK_QUERY_TYPE_TIMESTAMP ;
+    qpci.queryCount         = 2 * max_vulkan_frames_in_flight ;
+    qpci.pipelineStatistics = 0 ;
+
+    // VkResult vkCreateQueryPool(
+    //     VkDevice                                    device,
+    //     const VkQueryPoolCreateInfo*                pCreateInfo,
+    //     const VkAllocationCallbacks*                pAllocator,
+    //     VkQueryPool*                                pQueryPool);
+    if(check_vulkan(vkCreateQueryPool(
+                vc->device_
+            ,   &qpci
+            ,   NULL
+            ,   &vc->timestamp_query_pool_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vc->timestamp_query_pool_) ;
+
+    vc->enable_timestamps_ = VK_TRUE ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static void
+read_timestamps(
+    vulkan_context *    vc
+,   uint32_t const      frame_index
+)
+{
+    require(vc) ;
+    require(frame_index < max_vulkan_frames_in_flight) ;
+
+    if(
+        !vc->enable_timestamps_
+    ||  !vc->timestamp_written_[frame_index]
+    )
+    {
+        return ;
+    }
+
+    begin_timed_block() ;
+
+    // the fence of this frame has been waited for, so the results are
+    // available and we do not need VK_QUERY_RESULT_WAIT_BIT.
+    uint64_t ts[2] = { 0 } ;
+
+    // VkResult vkGetQueryPoolResults(
+    //     VkDevice                                    device,
+    //     VkQueryPool                                 queryPool,
+    //     uint32_t                                    firstQuery,
+    //     uint32_t                                    queryCount,
+    //     size_t                                      dataSize,
+    //     void*                                       pData,
+    //     VkDeviceSize                                stride,
+    //     VkQueryResultFlags                          flags);
+    VkResult const res = vkGetQueryPoolResults(
+        vc->device_
+    ,   vc->timestamp_query_pool_
+    ,   2 * frame_index
+    ,   2
+    ,   sizeof(ts)
+    ,   ts
+    ,   sizeof(ts[0])
+    ,   VK_QUERY_RESULT_64_BIT
+    ) ;
+
+    if(res == VK_SUCCESS)
+    {
+        uint64_t const delta = ((ts[1] & vc->timestamp_mask_) - (ts[0] & vc->timestamp_mask_)) & vc->timestamp_mask_ ;
+        vc->frame_stats_.gpu_time_ms_ = (double) delta * vc->timestamp_period_ms_ ;
+    }
+
+    end_timed_block() ;
+}
+
+
+// The gpu time goes with the pixels drawn, the square of the scale. Nothing
+// changes while it is between 80% and 100% of the budget, otherwise the
+// scale moves a quarter of the way to the one which would take 90% of it.
+// The time read is the one of this frame in flight, frames_in_flight_count_
+// frames ago, moving slowly keeps the scale from swinging.
+static void
+update_render_scale(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+
+    double const gpu_ms     = vc->frame_stats_.gpu_time_ms_ ;
+    double const budget_ms  = vc->gpu_budget_ms_ ;
+
+    if(
+        !vc->enable_adaptive_render_scale_
+    ||  !vc->enable_timestamps_
+    ||  vc->frame_stats_.aa_tuning_
+    ||  gpu_ms <= 0.0
+    )
+    {
+        return ;
+    }
+
+    if(
+        gpu_ms >= 0.8 * budget_ms
+    &&  gpu_ms <= budget_ms
+    )
+    {
+        return ;
+    }
+
+    float const target  = vc->render_scale_ * (float) SDL_sqrt(0.9 * budget_ms / gpu_ms) ;
+    float const scale   = vc->render_scale_ + 0.25f * (target - vc->render_scale_) ;
+
+    vc->render_scale_ = SDL_clamp(scale, min_vulkan_render_scale, 1.0f) ;
+    update_render_extent(vc) ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static void
+release_retired_pipelines(
+    vulkan_context *    vc
+,   uint32_t const      frames_mask
+)
+{
+    require(vc) ;
+
+    // backwards, the one moved into a freed slot has been looked at already.
+    for(
+        uint32_t i = vc->retired_pipelines_count_
+    ;   i > 0
+    ;   --i
+    )
+    {
+        vulkan_retired_pipeline * vrp = &vc->retired_pipelines_[i - 1] ;
+        vrp->frames_mask_ &= ~frames_mask ;
+        if(vrp->frames_mask_)
+        {
+            continue ;
+        }
+
+        vkDestroyPipeline(vc->device_, vrp->pipeline_, NULL) ;
+        *vrp = vc->retired_pipelines_[--vc->retired_pipelines_count_] ;
+    }
+}
+
+
+static void
+retire_pipeline(
+    vulkan_context *    vc
+,   VkPipeline const    pipeline
+)
+{
+    require(vc) ;
+    require(pipeline) ;
+
+    if(vc->retired_pipelines_count_ == max_vulkan_retired_pipelines)
+    {
+        // reloads faster than the frames, wait instead of keeping more.
+        vkDeviceWaitIdle(vc->device_) ;
+        release_retired_pipelines(vc, UINT32_MAX) ;
+    }
+
+    // called at the frame boundary, after the fence of the current frame has
+    // been waited for. Only the other frames may still draw with it.
+    vulkan_retired_pipeline * vrp = &vc->retired_pipelines_[vc->retired_pipelines_count_++] ;
+    vrp->pipeline_      = pipeline ;
+    vrp->frames_mask_   = ((1u << vc->frames_in_flight_count_) - 1) & ~(1u << vc->current_frame_) ;
+}
+
+
+static bool
+recreate_graphics_pipeline_permutation(
+    vulkan_context *                vc
+,   vulkan_pipeline_permutation *   vpp
+)
+{
+    require(vc) ;
+    require(vpp) ;
+    require(vpp->users_count_) ;
+    begin_timed_block() ;
+
+    VkGraphicsPipelineCreateInfo const * first = vpp->users_create_info_[0] ;
+    require(first) ;
+    require(first->stageCount == vpp->shader_names_count_) ;
+    require(first->stageCount <= max_vulkan_pipeline_shader_stages) ;
+
+    // the modules in the create info were destroyed once the pipeline was
+    // made, every stage is loaded again, not only the one that changed.
+    VkPipelineShaderStageCreateInfo stages[max_vulkan_pipeline_shader_stages] = { 0 } ;
+    bool okay = true ;
+
+    for(
+        uint32_t i = 0
+    ;   i < first->stageCount
+    ;   ++i
+    )
+    {
+        stages[i]           = first->pStages[i] ;
+        stages[i].module    = VK_NULL_HANDLE ;
+
+        if(check(load_shader_file(
+                    &stages[i].module
+                ,   NULL
+                ,   vc->device_
+                ,   vpp->shader_names_[i]
+                )
+            )
+        )
+        {
+            okay = false ;
+            break ;
+        }
+    }
+
+    // the render pass and the samples are the ones in use now, switching
+    // the aa mode makes the pipelines again through here as well.
+    VkPipelineMultisampleStateCreateInfo pmssci = { 0 } ;
+    fill_pipeline_multisample_state_create_info(
+        &pmssci
+    ,   vc->enable_sampling_
+    ,   vc->sample_count_
+    ,   vc->enable_sample_shading_
+    ,   vc->min_sample_shading_
+    ) ;
+
+    VkGraphicsPipelineCreateInfo gpci = *first ;
+    gpci.pStages            = stages ;
+    gpci.pMultisampleState  = &pmssci ;
+    gpci.renderPass         = vc->render_pass_ ;
+
+    VkPipeline pipeline = VK_NULL_HANDLE ;
+
+    if(okay)
+    {
+        if(check_vulkan(vkCreateGraphicsPipelines(
+                    vc->device_
+                ,   vc->pipeline_cache_
+                ,   1
+                ,   &gpci
+                ,   NULL
+                ,   &pipeline
+                )
+            )
+        )
+        {
+            okay = false ;
+        }
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < first->stageCount
+    ;   ++i
+    )
+    {
+        if(stages[i].module)
+        {
+            vkDestroyShaderModule(vc->device_, stages[i].module, NULL) ;
+        }
+    }
+
+    if(!okay)
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(pipeline) ;
+
+    retire_pipeline(vc, vpp->pipeline_) ;
+    vpp->pipeline_ = pipeline ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vpp->users_count_
+    ;   ++i
+    )
+    {
+        *vpp->users_[i] = pipeline ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
 static bool
-update_rob(
-    vulkan_context *    vc
+uses_shader(
+    vulkan_pipeline_permutation const * vpp
+,   char const * const                  shader_full_name
 )
 {
-    require(vc) ;
-
-    begin_timed_block() ;
-
-    bool update_okay = true ;
+    require(vpp) ;
+    require(shader_full_name) ;
 
     for(
         uint32_t i = 0
-    ;   i < vc->render_objects_count_
+    ;   i < vpp->shader_names_count_
     ;   ++i
     )
     {
-        vulkan_render_object * vro = &vc->render_objects_[i] ;
-        require(vro->update_func_) ;
-        update_okay &= vro->update_func_(vro->vc_, vro->param_, vc->current_frame_) ;
+        if(0 == SDL_strcmp(vpp->shader_names_[i], shader_full_name))
+        {
+            return true ;
+        }
     }
 
-    end_timed_block() ;
-    return update_okay ;
+    return false ;
 }
 
 
-static bool
-draw_rob(
+// Returns how many pipelines have been replaced. Anything going wrong keeps
+// the old pipelines, a typo in a shader must not end the app.
+static uint32_t
+reload_shader(
     vulkan_context *    vc
+,   char const * const  shader_full_name
 )
 {
     require(vc) ;
-
+    require(shader_full_name) ;
     begin_timed_block() ;
 
-    if(vc->enable_pre_record_command_buffers_)
+    void *      code = NULL ;
+    uint64_t    size = 0 ;
+
+    if(check(load_file(&code, &size, shader_full_name)))
     {
         end_timed_block() ;
-        return true ;
+        return 0 ;
     }
 
-    if(check(begin_record_command_buffer(
-                vc
-            ,   vc->command_buffer_[vc->current_frame_]
-            ,   vc->framebuffers_[vc->image_index_]
-            )
-        )
+    // the pipeline and descriptor set layouts of the render objects stay as
+    // they are, a shader needing other ones needs a restart.
+    spirv_reflection sr ;
+    spirv_reflection const * cached = NULL ;
+    if(code && reflect_spirv(&sr, code, size))
+    {
+        cached = get_spirv_reflection(shader_full_name, code, size) ;
+    }
+
+    if(code)
+    {
+        free_memory(code) ;
+    }
+
+    if(
+        !cached
+    ||  !is_spirv_reflection_compatible(cached, &sr)
     )
     {
+        log_error("%s changed its interface, restart to use it.", shader_full_name) ;
         end_timed_block() ;
-        return false ;
+        return 0 ;
     }
 
-    bool draw_okay = true ;
+    uint32_t replaced = 0 ;
 
     for(
-        uint32_t i = 0
-    ;   i < vc->render_objects_count_
-    ;   ++i
+        uint32_t i = vc->pipeline_permutations_count_
+    ;   i > 0
+    ;   --i
     )
     {
-        vulkan_render_object * vro = &vc->render_objects_[i] ;
-        require(vro->draw_func_) ;
-        draw_okay &= vro->draw_func_(vro->vc_, vro->param_, vc->current_frame_) ;
+        vulkan_pipeline_permutation * vpp = &vc->pipeline_permutations_[i - 1] ;
+        if(!uses_shader(vpp, shader_full_name))
+        {
+            continue ;
+        }
+
+        // nobody to make it again for, dropped so the next user creates it
+        // from the new shader.
+        if(0 == vpp->users_count_)
+        {
+            retire_pipeline(vc, vpp->pipeline_) ;
+            *vpp = vc->pipeline_permutations_[--vc->pipeline_permutations_count_] ;
+            continue ;
+        }
+
+        if(check(recreate_graphics_pipeline_permutation(vc, vpp)))
+        {
+            log_error("recreating the pipeline for %s failed, the old one stays.", shader_full_name) ;
+            continue ;
+        }
+
+        ++replaced ;
     }
 
-    if(check(end_record_command_buffer(
-                vc
-            ,   vc->command_buffer_[vc->current_frame_]
+    log_info("%s reloaded, %u pipelines replaced.", shader_full_name, replaced) ;
+
+    end_timed_block() ;
+    return replaced ;
+}
+
+
+// Picks up what the shader watch has compiled since the last frame. Called
+// at the frame boundary, the new pipelines are used from this frame on.
+static bool
+reload_changed_shaders(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+
+    char        name[max_shader_watch_name] ;
+    bool        compiled = false ;
+    uint32_t    replaced = 0 ;
+
+    for( ; take_compiled_shader(name, sizeof(name), &compiled) ; )
+    {
+        if(!compiled)
+        {
+            log_error("compiling %s failed, the old one stays.", name) ;
+            continue ;
+        }
+
+        replaced += reload_shader(vc, name) ;
+    }
+
+    if(
+        !replaced
+    ||  !vc->enable_pre_record_command_buffers_
+    )
+    {
+        return true ;
+    }
+
+    begin_timed_block() ;
+
+    // every pre recorded command buffer has the old pipelines in it, they are
+    // recorded again once none of them is pending anymore.
+    if(check_vulkan(vkWaitForFences(
+                vc->device_
+            ,   vc->frames_in_flight_count_
+            ,   vc->in_flight_fence_
+            ,   VK_TRUE
+            ,   UINT64_MAX
             )
         )
     )
@@ -5613,101 +7509,177 @@ draw_rob(
         return false ;
     }
 
-    end_timed_block() ;
-    return draw_okay ;
+    release_retired_pipelines(vc, UINT32_MAX) ;
+
+    if(check(record_rob(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
 
+    end_timed_block() ;
+    return true ;
 }
 
 
+// Everything made with the samples or the scene image is made again, after
+// waiting for the device. Only called at the frame boundary.
 static bool
-record_rob(
+set_aa_mode(
     vulkan_context *    vc
+,   uint32_t const      aa_mode
 )
 {
     require(vc) ;
+    require(aa_mode < vulkan_aa_modes_count) ;
+    require(!vc->enable_pre_record_command_buffers_) ;
     begin_timed_block() ;
 
-    if(!vc->enable_pre_record_command_buffers_)
+    if(check_vulkan(vkDeviceWaitIdle(vc->device_)))
     {
         end_timed_block() ;
-        return true ;
+        return false ;
     }
 
-    bool record_okay = true ;
+    apply_aa_mode(vc, aa_mode) ;
+
+    vkDestroyRenderPass(vc->device_, vc->render_pass_, NULL) ;
+    vc->render_pass_ = NULL ;
+
+    if(check(create_render_pass(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(recreate_swapchain(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
 
     for(
-        uint32_t i = 0
-    ;   i < vc->frames_in_flight_count_
-    ;   ++i
+        uint32_t i = vc->pipeline_permutations_count_
+    ;   i > 0
+    ;   --i
     )
     {
-        if(check(begin_record_command_buffer(
-                    vc
-                ,   vc->command_buffer_[i]
-                ,   vc->framebuffers_[i]
-                )
-            )
-        )
-        {
-            end_timed_block() ;
-            return false ;
-        }
+        vulkan_pipeline_permutation * vpp = &vc->pipeline_permutations_[i - 1] ;
 
-        for(
-            uint32_t rob = 0
-        ;   rob < vc->render_objects_count_
-        ;   ++rob
-        )
+        // nobody to make it again for, the next user creates it.
+        if(0 == vpp->users_count_)
         {
-            vulkan_render_object * vro = &vc->render_objects_[rob] ;
-            require(vro->record_func_) ;
-            record_okay &= vro->record_func_(vro->vc_, vro->param_, i) ;
+            retire_pipeline(vc, vpp->pipeline_) ;
+            *vpp = vc->pipeline_permutations_[--vc->pipeline_permutations_count_] ;
+            continue ;
         }
 
-        if(check(end_record_command_buffer(
-                    vc
-                ,   vc->command_buffer_[i]
-                )
-            )
-        )
+        if(check(recreate_graphics_pipeline_permutation(vc, vpp)))
         {
             end_timed_block() ;
             return false ;
         }
     }
 
+    // the device is idle, nothing draws with the old ones anymore.
+    release_retired_pipelines(vc, UINT32_MAX) ;
+
     end_timed_block() ;
-    return record_okay ;
+    return true ;
 }
 
 
+// --aa auto, every supported mode is drawn for a while, the best looking one
+// whose gpu time is inside the budget is kept. Called once the fence of the
+// current frame has been waited for and its timestamps were read.
 static bool
-destroy_rob(
+update_aa_tuning(
     vulkan_context *    vc
 )
 {
     require(vc) ;
-    begin_timed_block() ;
 
-    bool destroy_okay = true ;
+    if(!vc->frame_stats_.aa_tuning_)
+    {
+        return true ;
+    }
 
-    for(
-        uint32_t i = 0
-    ;   i < vc->render_objects_count_
-    ;   ++i
-    )
+    require(vc->aa_tune_mode_ == vc->aa_mode_) ;
+
+    double const budget_ms = vc->gpu_budget_ms_ > 0.0
+        ? vc->gpu_budget_ms_
+        : default_vulkan_gpu_budget_ms
+        ;
+
+    // the mode drawn with from now on, the next one to measure or the one
+    // picked. off when nothing fits.
+    uint32_t aa_mode = vulkan_aa_mode_off ;
+
+    if(!vc->enable_timestamps_)
     {
-        vulkan_render_object * vro = &vc->render_objects_[i] ;
-        require(vro->destroy_func_) ;
-        destroy_okay &= vro->destroy_func_(vro->vc_, vro->param_) ;
+        vc->aa_tune_mode_ = vulkan_aa_modes_count ;
     }
+    else
+    {
+        ++vc->aa_tune_frame_ ;
 
-    end_timed_block() ;
-    return destroy_okay ;
-}
+        if(vc->aa_tune_frame_ <= vulkan_aa_tune_warmup_frames)
+        {
+            return true ;
+        }
+
+        vc->aa_tune_gpu_ms_ += vc->frame_stats_.gpu_time_ms_ ;
+
+        if(vc->aa_tune_frame_ < vulkan_aa_tune_warmup_frames + vulkan_aa_tune_frames)
+        {
+            return true ;
+        }
+
+        double const gpu_ms = vc->aa_tune_gpu_ms_ / vulkan_aa_tune_frames ;
+        log_info("anti aliasing %s takes %.3f ms.", vulkan_aa_modes[vc->aa_mode_].name_, gpu_ms) ;
+
+        if(gpu_ms <= budget_ms)
+        {
+            aa_mode             = vc->aa_mode_ ;
+            vc->aa_tune_mode_   = vulkan_aa_modes_count ;
+        }
+        else
+        {
+            vc->aa_tune_mode_ = get_next_aa_tune_mode(vc, vc->aa_mode_) ;
+            if(vc->aa_tune_mode_ < vulkan_aa_modes_count)
+            {
+                aa_mode = vc->aa_tune_mode_ ;
+            }
+        }
+    }
+
+    vc->aa_tune_frame_  = 0 ;
+    vc->aa_tune_gpu_ms_ = 0.0 ;
 
+    if(vc->aa_tune_mode_ == vulkan_aa_modes_count)
+    {
+        log_info("anti aliasing %s picked for a gpu budget of %.2f ms.", vulkan_aa_modes[aa_mode].name_, budget_ms) ;
+    }
+
+    begin_timed_block() ;
+
+    if(aa_mode == vc->aa_mode_)
+    {
+        // already drawing with it, only the tuning is over.
+        apply_aa_mode(vc, aa_mode) ;
+        end_timed_block() ;
+        return true ;
+    }
 
+    if(check(set_aa_mode(vc, aa_mode)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
 
+    end_timed_block() ;
+    return true ;
+}
 
 
 static bool
@@ -5741,6 +7713,23 @@ draw_frame(
         return false ;
     }
 
+    read_timestamps(vc, vc->current_frame_) ;
+    update_render_scale(vc) ;
+
+    if(check(update_aa_tuning(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    release_retired_pipelines(vc, 1u << vc->current_frame_) ;
+
+    if(check(reload_changed_shaders(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
     uint32_t image_index = 0 ;
 
     // VkResult vkAcquireNextImageKHR(
@@ -5878,8 +7867,12 @@ draw_frame(
     // } VkPipelineStageFlagBits;
 
 
+    // scaled, the swapchain image is first written by the blit, the post
+    // pass writes it as a color attachment like the scene's render pass.
     VkPipelineStageFlags wait_stages[] = {
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+        vc->enable_render_scale_ && !vc->enable_post_aa_
+            ? VK_PIPELINE_STAGE_TRANSFER_BIT
+            : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
     } ;
 
 
@@ -5923,6 +7916,8 @@ draw_frame(
         return false ;
     }
 
+    vc->timestamp_written_[vc->current_frame_] = vc->enable_timestamps_ ;
+
     VkSwapchainKHR swap_chains[] = {
         vc->swapchain_
     } ;
@@ -5958,13 +7953,15 @@ draw_frame(
     ||  present_ok == VK_ERROR_OUT_OF_DATE_KHR
     ) ;
 
+    // set by the main thread, taken here in one go.
+    bool const resized = 0 != SDL_SetAtomicInt(&vc->resizing_, 0) ;
+
     if(
         present_ok == VK_ERROR_OUT_OF_DATE_KHR
     ||  present_ok == VK_SUBOPTIMAL_KHR
-    ||  vc->resizing_
+    ||  resized
     )
     {
-        vc->resizing_ = VK_FALSE ;
         if(check(recreate_swapchain(vc)))
         {
             end_timed_block() ;
@@ -5974,22 +7971,50 @@ draw_frame(
         vc->image_index_ = 0 ;
         vc->current_frame_ = 0 ;
 
-        if(check(record_rob(vc)))
+        if(check(record_rob(vc)))
+        {
+            end_timed_block() ;
+            return false ;
+        }
+
+        end_timed_block() ;
+        return true ;
+    }
+
+    log_debug("vc->current_frame_=%d, image_index=%d", vc->current_frame_, image_index) ;
+
+    vc->current_frame_ = (vc->current_frame_ + 1) % vc->frames_in_flight_count_ ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+has_memory_type(
+    VkPhysicalDeviceMemoryProperties const *    mp
+,   uint32_t const                              type_filter
+,   VkMemoryPropertyFlags const                 prop
+)
+{
+    require(mp) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < mp->memoryTypeCount
+    ;   ++i
+    )
+    {
+        if(
+            (type_filter & (1 << i))
+        &&  (mp->memoryTypes[i].propertyFlags & prop) == prop
+        )
         {
-            end_timed_block() ;
-            return false ;
+            return true ;
         }
-
-        end_timed_block() ;
-        return true ;
     }
 
-    log_debug("vc->current_frame_=%d, image_index=%d", vc->current_frame_, image_index) ;
-
-    vc->current_frame_ = (vc->current_frame_ + 1) % vc->frames_in_flight_count_ ;
-
-    end_timed_block() ;
-    return true ;
+    return false ;
 }
 
 
@@ -6147,6 +8172,7 @@ create_buffer(
         return false ;
     }
     require(*out_buffer_memory) ;
+    track_device_memory(*out_buffer_memory, mai.allocationSize) ;
 
 
     // VkResult vkBindBufferMemory(
@@ -6335,6 +8361,93 @@ copy_buffer_to_image(
 }
 
 
+// One region per mip level, all levels come from the same staging buffer.
+static bool
+copy_buffer_to_image_levels(
+    VkDevice const              device
+,   VkCommandPool const         command_pool
+,   VkQueue const               graphics_queue
+,   VkBuffer const              buffer
+,   VkImage const               image
+,   texture_2d_level const *    levels
+,   VkDeviceSize const *        offsets
+,   uint32_t const              levels_count
+)
+{
+    require(device) ;
+    require(command_pool) ;
+    require(graphics_queue) ;
+    require(buffer) ;
+    require(image) ;
+    require(levels) ;
+    require(offsets) ;
+    require(levels_count) ;
+    require(levels_count <= max_texture_2d_levels) ;
+
+    begin_timed_block() ;
+
+    VkCommandBuffer command_buffer = NULL ;
+    if(check(begin_single_time_commands(
+                &command_buffer
+            ,   device
+            ,   command_pool
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    static VkBufferImageCopy bic[max_texture_2d_levels] = { 0 } ;
+    for(
+        uint32_t i = 0
+    ;   i < levels_count
+    ;   ++i
+    )
+    {
+        bic[i].bufferOffset                     = offsets[i] ;
+        bic[i].bufferRowLength                  = 0 ;
+        bic[i].bufferImageHeight                = 0 ;
+        bic[i].imageSubresource.aspectMask      = VK_IMAGE_ASPECT_COLOR_BIT ;
+        bic[i].imageSubresource.mipLevel        = i ;
+        bic[i].imageSubresource.baseArrayLayer  = 0 ;
+        bic[i].imageSubresource.layerCount      = 1 ;
+        bic[i].imageOffset.x                    = 0 ;
+        bic[i].imageOffset.y                    = 0 ;
+        bic[i].imageOffset.z                    = 0 ;
+        bic[i].imageExtent.width                = levels[i].width_ ;
+        bic[i].imageExtent.height               = levels[i].height_ ;
+        bic[i].imageExtent.depth                = 1 ;
+    }
+
+    vkCmdCopyBufferToImage(
+        command_buffer
+    ,   buffer
+    ,   image
+    ,   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+    ,   levels_count
+    ,   bic
+    ) ;
+
+    if(check(end_single_time_commands(
+                device
+            ,   command_pool
+            ,   graphics_queue
+            ,   command_buffer
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
 static bool
 create_image(
     VkImage *                                   out_image
@@ -6416,12 +8529,23 @@ create_image(
     VkMemoryRequirements mem_requirements = { 0 } ;
     vkGetImageMemoryRequirements(device, *out_image, &mem_requirements) ;
 
+    // lazily allocated memory is only there on some gpus, mostly tiled ones,
+    // and only for transient attachments. Otherwise plain memory is used.
+    VkMemoryPropertyFlags prop_flags = mem_prop_flags ;
+    if(
+        (prop_flags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+    &&  !has_memory_type(pdmp, mem_requirements.memoryTypeBits, prop_flags)
+    )
+    {
+        prop_flags &= ~VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT ;
+    }
+
     uint32_t desired_memory_type = 0 ;
     if(check(find_memory_type(
                 &desired_memory_type
             ,   pdmp
             ,   mem_requirements.memoryTypeBits
-            ,   mem_prop_flags
+            ,   prop_flags
             )
         )
     )
@@ -6449,6 +8573,7 @@ create_image(
         return false ;
     }
     require(*out_image_memory) ;
+    track_device_memory(*out_image_memory, mai.allocationSize) ;
 
     if(check_vulkan(vkBindImageMemory(
                 device
@@ -6682,6 +8807,304 @@ generate_mipmaps(
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static uint64_t
+hash_pipeline_bytes(
+    uint64_t const  h
+,   void const *    p
+,   size_t const    n
+)
+{
+    // fnv-1a, the key is only hashed when a render object is created.
+    uint8_t const * b = p ;
+    uint64_t        r = h ;
+
+    for(
+        size_t i = 0
+    ;   i < n
+    ;   ++i
+    )
+    {
+        r ^= b[i] ;
+        r *= 0x100000001b3ull ;
+    }
+
+    return r ;
+}
+
+
+#define hash_pipeline_field(h, p, f) hash_pipeline_bytes(h, &(p)->f, sizeof((p)->f))
+
+
+static uint64_t
+hash_pipeline_string(
+    uint64_t const      h
+,   char const * const  s
+)
+{
+    require(s) ;
+    return hash_pipeline_bytes(h, s, SDL_strlen(s) + 1) ;
+}
+
+
+static uint64_t
+calc_graphics_pipeline_permutation_key(
+    VkGraphicsPipelineCreateInfo const *    gpci
+,   char const * const *                    shader_names
+,   uint32_t const                          shader_names_count
+)
+{
+    require(gpci) ;
+    require(shader_names) ;
+    require(shader_names_count == gpci->stageCount) ;
+
+    uint64_t h = 0xcbf29ce484222325ull ;
+
+    // the pointers in the create infos differ for every render object, only
+    // what they point to is hashed.
+    for(
+        uint32_t i = 0
+    ;   i < gpci->stageCount
+    ;   ++i
+    )
+    {
+        VkPipelineShaderStageCreateInfo const * pssci = &gpci->pStages[i] ;
+        h = hash_pipeline_string(h, shader_names[i]) ;
+        h = hash_pipeline_string(h, pssci->pName) ;
+        h = hash_pipeline_field(h, pssci, stage) ;
+
+        VkSpecializationInfo const * si = pssci->pSpecializationInfo ;
+        if(si)
+        {
+            h = hash_pipeline_bytes(h, si->pMapEntries, si->mapEntryCount * sizeof(VkSpecializationMapEntry)) ;
+            h = hash_pipeline_bytes(h, si->pData, si->dataSize) ;
+        }
+    }
+
+    VkPipelineVertexInputStateCreateInfo const * pvisci = gpci->pVertexInputState ;
+    require(pvisci) ;
+    h = hash_pipeline_bytes(h, pvisci->pVertexBindingDescriptions, pvisci->vertexBindingDescriptionCount * sizeof(VkVertexInputBindingDescription)) ;
+    h = hash_pipeline_bytes(h, pvisci->pVertexAttributeDescriptions, pvisci->vertexAttributeDescriptionCount * sizeof(VkVertexInputAttributeDescription)) ;
+
+    VkPipelineInputAssemblyStateCreateInfo const * piasci = gpci->pInputAssemblyState ;
+    require(piasci) ;
+    h = hash_pipeline_field(h, piasci, topology) ;
+    h = hash_pipeline_field(h, piasci, primitiveRestartEnable) ;
+
+    VkPipelineRasterizationStateCreateInfo const * prsci = gpci->pRasterizationState ;
+    require(prsci) ;
+    h = hash_pipeline_field(h, prsci, depthClampEnable) ;
+    h = hash_pipeline_field(h, prsci, rasterizerDiscardEnable) ;
+    h = hash_pipeline_field(h, prsci, polygonMode) ;
+    h = hash_pipeline_field(h, prsci, cullMode) ;
+    h = hash_pipeline_field(h, prsci, frontFace) ;
+    h = hash_pipeline_field(h, prsci, depthBiasEnable) ;
+    h = hash_pipeline_field(h, prsci, lineWidth) ;
+
+    VkPipelineMultisampleStateCreateInfo const * pmssci = gpci->pMultisampleState ;
+    require(pmssci) ;
+    h = hash_pipeline_field(h, pmssci, rasterizationSamples) ;
+    h = hash_pipeline_field(h, pmssci, sampleShadingEnable) ;
+    h = hash_pipeline_field(h, pmssci, minSampleShading) ;
+    h = hash_pipeline_field(h, pmssci, alphaToCoverageEnable) ;
+
+    VkPipelineDepthStencilStateCreateInfo const * pdssci = gpci->pDepthStencilState ;
+    if(pdssci)
+    {
+        h = hash_pipeline_field(h, pdssci, depthTestEnable) ;
+        h = hash_pipeline_field(h, pdssci, depthWriteEnable) ;
+        h = hash_pipeline_field(h, pdssci, depthCompareOp) ;
+        h = hash_pipeline_field(h, pdssci, stencilTestEnable) ;
+    }
+
+    VkPipelineColorBlendStateCreateInfo const * pcbsci = gpci->pColorBlendState ;
+    require(pcbsci) ;
+    h = hash_pipeline_field(h, pcbsci, logicOpEnable) ;
+    h = hash_pipeline_field(h, pcbsci, logicOp) ;
+    h = hash_pipeline_bytes(h, pcbsci->pAttachments, pcbsci->attachmentCount * sizeof(VkPipelineColorBlendAttachmentState)) ;
+
+    VkPipelineDynamicStateCreateInfo const * pdsci = gpci->pDynamicState ;
+    if(pdsci)
+    {
+        h = hash_pipeline_bytes(h, pdsci->pDynamicStates, pdsci->dynamicStateCount * sizeof(VkDynamicState)) ;
+    }
+
+    h = hash_pipeline_field(h, gpci, renderPass) ;
+    h = hash_pipeline_field(h, gpci, subpass) ;
+
+    return h ;
+}
+
+
+bool
+get_graphics_pipeline_permutation(
+    VkPipeline *                            out_pipeline
+,   vulkan_context *                        vc
+,   VkGraphicsPipelineCreateInfo const *    gpci
+,   char const * const *                    shader_names
+,   uint32_t const                          shader_names_count
+)
+{
+    require(out_pipeline) ;
+    require(vc) ;
+    require(vc->device_) ;
+    require(gpci) ;
+    begin_timed_block() ;
+    begin_startup_phase(startup_phase_pipelines) ;
+
+    uint64_t const key = calc_graphics_pipeline_permutation_key(gpci, shader_names, shader_names_count) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->pipeline_permutations_count_
+    ;   ++i
+    )
+    {
+        vulkan_pipeline_permutation * vpp = &vc->pipeline_permutations_[i] ;
+        if(key == vpp->key_)
+        {
+            require(vpp->users_count_ < max_vulkan_render_objects) ;
+            vpp->users_[vpp->users_count_]              = out_pipeline ;
+            vpp->users_create_info_[vpp->users_count_]  = gpci ;
+            ++vpp->users_count_ ;
+            *out_pipeline = vpp->pipeline_ ;
+            end_startup_phase(startup_phase_pipelines) ;
+            end_timed_block() ;
+            return true ;
+        }
+    }
+
+    if(check(vc->pipeline_permutations_count_ < max_vulkan_pipeline_permutations))
+    {
+        end_startup_phase(startup_phase_pipelines) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    // VkResult vkCreateGraphicsPipelines(
+    //     VkDevice                                    device,
+    //     VkPipelineCache                             pipelineCache,
+    //     uint32_t                                    createInfoCount,
+    //     const VkGraphicsPipelineCreateInfo*         pCreateInfos,
+    //     const VkAllocationCallbacks*                pAllocator,
+    //     VkPipeline*                                 pPipelines);
+    if(check_vulkan(vkCreateGraphicsPipelines(
+                vc->device_
+            ,   vc->pipeline_cache_
+            ,   1
+            ,   gpci
+            ,   NULL
+            ,   out_pipeline
+            )
+        )
+    )
+    {
+        end_startup_phase(startup_phase_pipelines) ;
+        end_timed_block() ;
+        return false ;
+    }
+    require(*out_pipeline) ;
+
+    vulkan_pipeline_permutation * vpp = &vc->pipeline_permutations_[vc->pipeline_permutations_count_] ;
+    vpp->key_                   = key ;
+    vpp->pipeline_              = *out_pipeline ;
+    vpp->shader_names_          = shader_names ;
+    vpp->shader_names_count_    = shader_names_count ;
+    vpp->users_[0]              = out_pipeline ;
+    vpp->users_create_info_[0]  = gpci ;
+    vpp->users_count_           = 1 ;
+    ++vc->pipeline_permutations_count_ ;
+
+    log_debug("pipeline permutation %u created for %s", vc->pipeline_permutations_count_, shader_names[0]) ;
+
+    end_startup_phase(startup_phase_pipelines) ;
+    end_timed_block() ;
+    return true ;
+}
+
+
+void
+release_graphics_pipeline_permutation(
+    vulkan_context *    vc
+,   VkPipeline *        pipeline
+)
+{
+    require(vc) ;
+    require(pipeline) ;
+    require(*pipeline) ;
+    begin_timed_block() ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->pipeline_permutations_count_
+    ;   ++i
+    )
+    {
+        vulkan_pipeline_permutation * vpp = &vc->pipeline_permutations_[i] ;
+        if(*pipeline != vpp->pipeline_)
+        {
+            continue ;
+        }
+
+        for(
+            uint32_t u = 0
+        ;   u < vpp->users_count_
+        ;   ++u
+        )
+        {
+            if(pipeline == vpp->users_[u])
+            {
+                --vpp->users_count_ ;
+                vpp->users_[u]              = vpp->users_[vpp->users_count_] ;
+                vpp->users_create_info_[u]  = vpp->users_create_info_[vpp->users_count_] ;
+                *pipeline = NULL ;
+                end_timed_block() ;
+                return ;
+            }
+        }
+    }
+
+    require(0) ;
+    end_timed_block() ;
+}
+
+
+static void
+destroy_graphics_pipeline_permutations(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->pipeline_permutations_count_
+    ;   ++i
+    )
+    {
+        vulkan_pipeline_permutation * vpp = &vc->pipeline_permutations_[i] ;
+        require(0 == vpp->users_count_) ;
+
+        // void vkDestroyPipeline(
+        //     VkDevice                                    device,
+        //     VkPipeline                                  pipeline,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroyPipeline(vc->device_, vpp->pipeline_, NULL) ;
+        vpp->pipeline_  = NULL ;
+        vpp->key_       = 0 ;
+    }
+    vc->pipeline_permutations_count_ = 0 ;
+
+    // the device is idle, nothing draws with them anymore.
+    release_retired_pipelines(vc, UINT32_MAX) ;
+
+    end_timed_block() ;
+}
+
+
 static bool
 create_render_object(
     vulkan_context *        vc
@@ -6698,11 +9121,15 @@ create_render_object(
     vo->draw_func_      = vr->draw_func_ ;
     vo->update_func_    = vr->update_func_ ;
     vo->record_func_    = vr->record_func_ ;
+    vo->simulate_func_  = vr->simulate_func_ ;
+    vo->pack_func_      = vr->pack_func_ ;
     vo->destroy_func_   = vr->destroy_func_;
     vo->param_          = vr->param_ ;
+    vo->handle_         = vr->handle_ ;
     vo->vc_             = vc ;
+    vo->animated_       = vr->animated_ ;
 
-    if(check(vo->create_func_(vc, vo->param_)))
+    if(check(vo->create_func_(vc, vo)))
     {
         end_timed_block() ;
         return false ;
@@ -6736,8 +9163,23 @@ destroy_vulkan_instance(
 
     cleanup_swapchain(vc) ;
 
+    destroy_vulkan_post(vc) ;
+
     check(destroy_rob(vc)) ;
 
+    destroy_graphics_pipeline_permutations(vc) ;
+
+    if(vc->timestamp_query_pool_)
+    {
+        // void vkDestroyQueryPool(
+        //     VkDevice                                    device,
+        //     VkQueryPool                                 queryPool,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroyQueryPool(vc->device_, vc->timestamp_query_pool_, NULL) ;
+        vc->timestamp_query_pool_   = NULL ;
+        vc->enable_timestamps_      = VK_FALSE ;
+    }
+
     if(vc->render_pass_)
     {
         // void vkDestroyRenderPass(
@@ -6793,6 +9235,18 @@ destroy_vulkan_instance(
     }
 
 
+    if(vc->pipeline_cache_)
+    {
+        save_pipeline_cache(vc->device_, vc->pipeline_cache_) ;
+
+        // void vkDestroyPipelineCache(
+        //     VkDevice                                    device,
+        //     VkPipelineCache                             pipelineCache,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroyPipelineCache(vc->device_, vc->pipeline_cache_, NULL) ;
+        vc->pipeline_cache_ = NULL ;
+    }
+
     if(vc_->device_)
     {
         // void vkDestroyDevice(
@@ -6829,6 +9283,10 @@ int
 create_vulkan()
 {
     begin_timed_block() ;
+    begin_startup_phase(startup_phase_instance) ;
+
+    // the long lists of everything the instance and the device support.
+    vc_->enable_dump_ = has_app_arg("--dump-vulkan") ;
 
     vc_->enable_pre_record_command_buffers_ = VK_FALSE ;
     //vc_->enable_pre_record_command_buffers_ = VK_TRUE ;
@@ -6841,11 +9299,12 @@ create_vulkan()
     vc_->desired_swapchain_image_count_     = 2 ;
     require(vc_->frames_in_flight_count_ < max_vulkan_frames_in_flight) ;
 
-    vc_->min_sample_shading_ = 0.2f ;
+    // the msaa shading modes run the fragment shader for every sample.
+    vc_->min_sample_shading_ = 1.0f ;
 
     vc_->desired_sampler_aniso_ = 1.0f ;
 
-    vc_->resizing_ = VK_FALSE ;
+    SDL_SetAtomicInt(&vc_->resizing_, 0) ;
 
     vc_->desired_enabled_device_features_.samplerAnisotropy = VK_TRUE ;
     vc_->desired_enabled_device_features_.logicOp           = VK_TRUE ;
@@ -6854,10 +9313,13 @@ create_vulkan()
         &vc_->platform_instance_extensions_count_
     ) ;
 
-    dump_char_star_array(
-        vc_->platform_instance_extensions_
-    ,   vc_->platform_instance_extensions_count_
-    ) ;
+    if(vc_->enable_dump_)
+    {
+        dump_char_star_array(
+            vc_->platform_instance_extensions_
+        ,   vc_->platform_instance_extensions_count_
+        ) ;
+    }
 
     if(check(create_instance_extensions_properties(
                 &vc_->instance_extensions_properties_
@@ -6866,15 +9328,19 @@ create_vulkan()
         )
     )
     {
+        end_startup_phase(startup_phase_instance) ;
         end_timed_block() ;
         return false ;
     }
 
-    dump_extension_properties(
-        vc_->instance_extensions_properties_
-    ,   vc_->instance_extensions_properties_count_
-    ) ;
-
+    if(vc_->enable_dump_)
+    {
+        dump_extension_properties(
+            vc_->instance_extensions_properties_
+        ,   vc_->instance_extensions_properties_count_
+        ) ;
+    }
+
     for(
         uint32_t i = 0
     ;   i < vc_->platform_instance_extensions_count_
@@ -6897,10 +9363,13 @@ create_vulkan()
         ) ;
     }
 
-    dump_char_star_array(
-        vc_->desired_extensions_
-    ,   vc_->desired_extensions_count_
-    ) ;
+    if(vc_->enable_dump_)
+    {
+        dump_char_star_array(
+            vc_->desired_extensions_
+        ,   vc_->desired_extensions_count_
+        ) ;
+    }
 
     check(has_all_extensions(
             vc_->instance_extensions_properties_
@@ -6919,14 +9388,18 @@ create_vulkan()
         )
     )
     {
+        end_startup_phase(startup_phase_instance) ;
         end_timed_block() ;
         return false ;
     }
 
-    dump_layer_properties(
-        vc_->layer_properties_
-    ,   vc_->layer_properties_count_
-    ) ;
+    if(vc_->enable_dump_)
+    {
+        dump_layer_properties(
+            vc_->layer_properties_
+        ,   vc_->layer_properties_count_
+        ) ;
+    }
 
     add_to_layers(
         vc_->desired_layers_
@@ -6934,10 +9407,13 @@ create_vulkan()
     ,   vk_layer_khronos_validation_name
     ) ;
 
-    dump_char_star_array(
-        vc_->desired_layers_
-    ,   vc_->desired_layers_count_
-    ) ;
+    if(vc_->enable_dump_)
+    {
+        dump_char_star_array(
+            vc_->desired_layers_
+        ,   vc_->desired_layers_count_
+        ) ;
+    }
 
     check(has_all_layer_properties(
             vc_->layer_properties_
@@ -6958,6 +9434,7 @@ create_vulkan()
         )
     )
     {
+        end_startup_phase(startup_phase_instance) ;
         end_timed_block() ;
         return false ;
     }
@@ -6972,6 +9449,7 @@ create_vulkan()
         )
     )
     {
+        end_startup_phase(startup_phase_instance) ;
         end_timed_block() ;
         return false ;
     }
@@ -6983,10 +9461,14 @@ create_vulkan()
         )
     )
     {
+        end_startup_phase(startup_phase_instance) ;
         end_timed_block() ;
         return false ;
     }
 
+    end_startup_phase(startup_phase_instance) ;
+    begin_startup_phase(startup_phase_device) ;
+
     if(check(create_physical_devices(
                 vc_->physical_devices_
             ,   &vc_->physical_devices_count_
@@ -6995,36 +9477,45 @@ create_vulkan()
         )
     )
     {
+        end_startup_phase(startup_phase_device) ;
         end_timed_block() ;
         return false ;
     }
 
     log_debug_u32(vc_->physical_devices_count_) ;
 
-    fill_physical_devices_info(
-        vc_->physical_devices_info_
-    ,   vc_->physical_devices_
-    ,   vc_->physical_devices_count_
-    ,   vc_->surface_
-    ) ;
-
-    dump_physical_device_info(
-        vc_->physical_devices_info_
-    ,   vc_->physical_devices_count_
-    ) ;
+    vulkan_device_cache cache = { 0 } ;
+    bool const cache_loaded = load_vulkan_device_cache(&cache) ;
+    bool cached = false ;
 
     if(check(pick_physical_device(
                 &vc_->picked_physical_device_
-            ,   vc_->physical_devices_info_
+            ,   &cached
+            ,   &vc_->physical_device_info_
+            ,   vc_->physical_devices_
             ,   vc_->physical_devices_count_
+            ,   vc_->surface_
+            ,   cache_loaded ? &cache : NULL
+            ,   vc_->enable_dump_
+            ,   get_app_arg_value("--gpu")
             )
         )
     )
     {
+        end_startup_phase(startup_phase_device) ;
         end_timed_block() ;
         return false ;
     }
 
+    vc_->physical_device_info_cached_ = cached ;
+    if(!cached)
+    {
+        save_vulkan_device_cache(vc_->picked_physical_device_) ;
+    }
+
+    // for the msaa shading modes, they aren't offered without it.
+    vc_->desired_enabled_device_features_.sampleRateShading = vc_->picked_physical_device_->features_.sampleRateShading ;
+
     if(check(create_logical_device(
                 &vc_->device_
             ,   vc_->picked_physical_device_->device_
@@ -7040,11 +9531,26 @@ create_vulkan()
         )
     )
     {
+        end_startup_phase(startup_phase_device) ;
         end_timed_block() ;
         return false ;
     }
     require(vc_->device_) ;
 
+    if(check(create_pipeline_cache(
+                &vc_->pipeline_cache_
+            ,   vc_->device_
+            ,   &vc_->picked_physical_device_->properties_
+            )
+        )
+    )
+    {
+        end_startup_phase(startup_phase_device) ;
+        end_timed_block() ;
+        return false ;
+    }
+    require(vc_->pipeline_cache_) ;
+
     if(check(create_queues(
                 &vc_->graphics_queue_
             ,   &vc_->present_queue_
@@ -7055,18 +9561,26 @@ create_vulkan()
         )
     )
     {
+        end_startup_phase(startup_phase_device) ;
         end_timed_block() ;
         return false ;
     }
     require(vc_->graphics_queue_) ;
     require(vc_->present_queue_) ;
 
+    end_startup_phase(startup_phase_device) ;
+    begin_startup_phase(startup_phase_swapchain) ;
+
     if(check(create_command_pool(vc_)))
     {
+        end_startup_phase(startup_phase_swapchain) ;
         end_timed_block() ;
         return false ;
     }
 
+    setup_render_scale(vc_) ;
+    setup_aa_mode(vc_) ;
+
     if(check(create_swapchain(
                 &vc_->swapchain_
             ,   &vc_->swapchain_surface_format_
@@ -7079,10 +9593,12 @@ create_vulkan()
             ,   &vc_->picked_physical_device_->swapchain_support_details_
             ,   &vc_->picked_physical_device_->queue_families_indices_
             ,   vc_->desired_swapchain_image_count_
+            ,   get_swapchain_image_usage(vc_)
             )
         )
     )
     {
+        end_startup_phase(startup_phase_swapchain) ;
         end_timed_block() ;
         return false ;
     }
@@ -7100,6 +9616,7 @@ create_vulkan()
         )
     )
     {
+        end_startup_phase(startup_phase_swapchain) ;
         end_timed_block() ;
         return false ;
     }
@@ -7114,40 +9631,83 @@ create_vulkan()
 
     if(check(create_color_resource(vc_)))
     {
+        end_startup_phase(startup_phase_swapchain) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_scene_resource(vc_)))
+    {
+        end_startup_phase(startup_phase_swapchain) ;
         end_timed_block() ;
         return false ;
     }
 
     if(check(create_depth_resource(vc_)))
     {
+        end_startup_phase(startup_phase_swapchain) ;
         end_timed_block() ;
         return false ;
     }
 
     if(check(create_render_pass(vc_)))
     {
+        end_startup_phase(startup_phase_swapchain) ;
         end_timed_block() ;
         return false ;
     }
 
     if(check(create_framebuffers(vc_)))
     {
+        end_startup_phase(startup_phase_swapchain) ;
         end_timed_block() ;
         return false ;
     }
 
+    // only when it is used or may be picked by --aa auto.
+    if(
+        is_aa_mode_supported(vc_, vulkan_aa_mode_post)
+    &&  (vc_->enable_post_aa_ || vc_->frame_stats_.aa_tuning_)
+    )
+    {
+        if(check(create_vulkan_post(vc_)))
+        {
+            end_startup_phase(startup_phase_swapchain) ;
+            end_timed_block() ;
+            return false ;
+        }
+
+        if(check(create_vulkan_post_framebuffers(vc_)))
+        {
+            end_startup_phase(startup_phase_swapchain) ;
+            end_timed_block() ;
+            return false ;
+        }
+    }
+
     if(check(create_sync_objects(vc_)))
     {
+        end_startup_phase(startup_phase_swapchain) ;
         end_timed_block() ;
         return false ;
     }
 
     if(check(create_command_buffer(vc_)))
     {
+        end_startup_phase(startup_phase_swapchain) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_timestamp_query_pool(vc_)))
+    {
+        end_startup_phase(startup_phase_swapchain) ;
         end_timed_block() ;
         return false ;
     }
 
+    end_startup_phase(startup_phase_swapchain) ;
+
     // ------------------
 
 
@@ -7174,25 +9734,154 @@ destroy_vulkan()
 
 
 int
-draw_vulkan()
+draw_vulkan(
+    frame_packet const *    fp
+)
 {
+    require(fp) ;
     begin_timed_block() ;
 
+    vc_->frame_packet_ = fp ;
+
     if(check(draw_frame(vc_)))
     {
         end_timed_block() ;
         return false ;
     }
 
+    SDL_LockSpinlock(&vc_->frame_stats_lock_) ;
+    vc_->published_frame_stats_ = vc_->frame_stats_ ;
+    SDL_UnlockSpinlock(&vc_->frame_stats_lock_) ;
+
     end_timed_block() ;
     return true ;
 }
 
 
+int
+simulate_vulkan(
+    float const step_seconds
+,   bool *      out_changed
+)
+{
+    require(out_changed) ;
+    begin_timed_block() ;
+
+    bool simulate_okay = true ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc_->render_objects_count_
+    ;   ++i
+    )
+    {
+        vulkan_render_object * vro = &vc_->render_objects_[i] ;
+        if(vro->simulate_func_)
+        {
+            bool changed = false ;
+            simulate_okay &= vro->simulate_func_(vro->vc_, vro, step_seconds, &changed) ;
+            *out_changed |= changed ;
+        }
+    }
+
+    end_timed_block() ;
+    return simulate_okay ;
+}
+
+
+int
+pack_vulkan(
+    frame_packet *  fp
+)
+{
+    require(fp) ;
+    begin_timed_block() ;
+
+    // the window as it is now, the render thread doesn't look at app_.
+    fp->camera_.offset_x_   = app_->half_window_width_float_ ;
+    fp->camera_.offset_y_   = app_->half_window_height_float_ ;
+    fp->camera_.scale_x_    = app_->inverse_half_window_width_float_ ;
+    fp->camera_.scale_y_    = app_->inverse_half_window_height_float_ ;
+    fp->show_overlay_       = app_->show_overlay_ ;
+
+    bool pack_okay = true ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc_->render_objects_count_
+    ;   ++i
+    )
+    {
+        vulkan_render_object * vro = &vc_->render_objects_[i] ;
+        if(vro->pack_func_)
+        {
+            pack_okay &= vro->pack_func_(vro->vc_, vro, fp) ;
+        }
+    }
+
+    end_timed_block() ;
+    return pack_okay ;
+}
+
+
+bool
+is_vulkan_animated()
+{
+    // the modes are measured on frames drawn one after the other.
+    if(vc_->frame_stats_.aa_tuning_)
+    {
+        return true ;
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < vc_->render_objects_count_
+    ;   ++i
+    )
+    {
+        if(vc_->render_objects_[i].animated_)
+        {
+            return true ;
+        }
+    }
+
+    return false ;
+}
+
+
+bool
+get_vulkan_frame_stats(
+    vulkan_frame_stats *    out_stats
+,   char const **           out_device_name
+)
+{
+    require(out_stats) ;
+    require(out_device_name) ;
+    require(vc_->picked_physical_device_) ;
+
+    SDL_LockSpinlock(&vc_->frame_stats_lock_) ;
+    *out_stats = vc_->published_frame_stats_ ;
+    SDL_UnlockSpinlock(&vc_->frame_stats_lock_) ;
+
+    *out_device_name    = vc_->picked_physical_device_->properties_.deviceName ;
+    return VK_TRUE == vc_->enable_timestamps_ ;
+}
+
+
+char const *
+get_vulkan_aa_mode_name(
+    uint32_t const  aa_mode
+)
+{
+    require(aa_mode < vulkan_aa_modes_count) ;
+    return vulkan_aa_modes[aa_mode].name_ ;
+}
+
+
 void
 resize_vulkan()
 {
-    vc_->resizing_ = VK_TRUE ;
+    SDL_SetAtomicInt(&vc_->resizing_, 1) ;
 }
 
 
@@ -7235,6 +9924,75 @@ add_desriptor_set_layout_binding(
 }
 
 
+void
+add_reflected_descriptor_set_layout_bindings(
+    VkDescriptorSetLayoutBinding *          bindings
+,   uint32_t *                              bindings_count
+,   uint32_t const                          bindings_count_max
+,   spirv_reflection const * const *        reflections
+,   uint32_t const                          reflections_count
+)
+{
+    require(bindings) ;
+    require(bindings_count) ;
+    require(reflections) ;
+    begin_timed_block() ;
+
+    for(
+        uint32_t i = 0
+    ;   i < reflections_count
+    ;   ++i
+    )
+    {
+        spirv_reflection const * sr = reflections[i] ;
+        require(sr) ;
+
+        for(
+            uint32_t j = 0
+        ;   j < sr->descriptor_bindings_count_
+        ;   ++j
+        )
+        {
+            spirv_descriptor_binding const * sdb = &sr->descriptor_bindings_[j] ;
+            require(0 == sdb->set_) ;
+            require(1 == sdb->count_) ;
+
+            VkDescriptorSetLayoutBinding * dslb = NULL ;
+            for(
+                uint32_t k = 0
+            ;   k < *bindings_count
+            ;   ++k
+            )
+            {
+                if(bindings[k].binding == sdb->binding_)
+                {
+                    dslb = &bindings[k] ;
+                    break ;
+                }
+            }
+
+            if(dslb)
+            {
+                require(dslb->descriptorType == sdb->type_) ;
+                dslb->stageFlags |= sr->stage_ ;
+                continue ;
+            }
+
+            add_desriptor_set_layout_binding(
+                bindings
+            ,   bindings_count
+            ,   bindings_count_max
+            ,   sdb->binding_
+            ,   sdb->type_
+            ,   sr->stage_
+            ) ;
+        }
+    }
+
+    end_timed_block() ;
+}
+
+
 bool
 create_descriptor_set_layout(
     VkDescriptorSetLayout *                 out_layout
@@ -7352,6 +10110,39 @@ add_descriptor_pool_size(
 }
 
 
+void
+add_descriptor_pool_sizes_from_bindings(
+    VkDescriptorPoolSize *                  pool_sizes
+,   uint32_t *                              pool_sizes_count
+,   uint32_t const                          pool_sizes_count_max
+,   VkDescriptorSetLayoutBinding const *    bindings
+,   uint32_t const                          bindings_count
+,   uint32_t const                          frames_in_flight_count
+)
+{
+    require(bindings) ;
+    begin_timed_block() ;
+
+    for(
+        uint32_t i = 0
+    ;   i < bindings_count
+    ;   ++i
+    )
+    {
+        require(1 == bindings[i].descriptorCount) ;
+        add_descriptor_pool_size(
+            pool_sizes
+        ,   pool_sizes_count
+        ,   pool_sizes_count_max
+        ,   bindings[i].descriptorType
+        ,   frames_in_flight_count
+        ) ;
+    }
+
+    end_timed_block() ;
+}
+
+
 bool
 create_descriptor_pool(
     VkDescriptorPool *              out_descriptor_pool
@@ -7493,14 +10284,86 @@ create_uniform_buffers(
     require(out_uniform_buffers_memory) ;
     require(out_uniform_buffers_mapped) ;
     require(device) ;
-    require(uniform_buffer_size) ;
+    require(uniform_buffer_size) ;
+    require(pdmp) ;
+    require(frames_in_flight_count) ;
+    require(frames_in_flight_count < max_vulkan_frames_in_flight) ;
+
+    begin_timed_block() ;
+
+    VkDeviceSize const buffer_size = uniform_buffer_size ;
+
+    for(
+        uint32_t i = 0
+    ;   i < frames_in_flight_count
+    ;   ++i
+    )
+    {
+        if(check(create_buffer(
+                    &out_uniform_buffers[i]
+                ,   &out_uniform_buffers_memory[i]
+                ,   device
+                ,   pdmp
+                ,   buffer_size
+                ,   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                ,   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+                )
+            )
+        )
+        {
+            end_timed_block() ;
+            return false ;
+        }
+        require(out_uniform_buffers[i]) ;
+        require(out_uniform_buffers_memory[i]) ;
+
+        if(check_vulkan(vkMapMemory(
+                    device
+                ,   out_uniform_buffers_memory[i]
+                ,   0
+                ,   buffer_size
+                ,   0
+                ,   &out_uniform_buffers_mapped[i]
+                )
+            )
+        )
+        {
+            end_timed_block() ;
+            return false ;
+        }
+        require(out_uniform_buffers_mapped[i]) ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+bool
+create_dynamic_vertex_buffers(
+    VkBuffer *                                  out_vertex_buffers
+,   VkDeviceMemory *                            out_vertex_buffers_memory
+,   void **                                     out_vertex_buffers_mapped
+,   VkDevice const                              device
+,   uint32_t const                              vertex_buffer_size
+,   VkPhysicalDeviceMemoryProperties const *    pdmp
+,   uint32_t const                              frames_in_flight_count
+)
+{
+    require(out_vertex_buffers) ;
+    require(out_vertex_buffers_memory) ;
+    require(out_vertex_buffers_mapped) ;
+    require(device) ;
+    require(vertex_buffer_size) ;
     require(pdmp) ;
     require(frames_in_flight_count) ;
     require(frames_in_flight_count < max_vulkan_frames_in_flight) ;
 
     begin_timed_block() ;
 
-    VkDeviceSize const buffer_size = uniform_buffer_size ;
+    // one persistently mapped buffer per frame in flight, the cpu rewrites
+    // the one of the current frame while the gpu still reads the others.
+    VkDeviceSize const buffer_size = vertex_buffer_size ;
 
     for(
         uint32_t i = 0
@@ -7509,12 +10372,12 @@ create_uniform_buffers(
     )
     {
         if(check(create_buffer(
-                    &out_uniform_buffers[i]
-                ,   &out_uniform_buffers_memory[i]
+                    &out_vertex_buffers[i]
+                ,   &out_vertex_buffers_memory[i]
                 ,   device
                 ,   pdmp
                 ,   buffer_size
-                ,   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                ,   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
                 ,   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
                 )
             )
@@ -7523,16 +10386,16 @@ create_uniform_buffers(
             end_timed_block() ;
             return false ;
         }
-        require(out_uniform_buffers[i]) ;
-        require(out_uniform_buffers_memory[i]) ;
+        require(out_vertex_buffers[i]) ;
+        require(out_vertex_buffers_memory[i]) ;
 
         if(check_vulkan(vkMapMemory(
                     device
-                ,   out_uniform_buffers_memory[i]
+                ,   out_vertex_buffers_memory[i]
                 ,   0
                 ,   buffer_size
                 ,   0
-                ,   &out_uniform_buffers_mapped[i]
+                ,   &out_vertex_buffers_mapped[i]
                 )
             )
         )
@@ -7540,7 +10403,7 @@ create_uniform_buffers(
             end_timed_block() ;
             return false ;
         }
-        require(out_uniform_buffers_mapped[i]) ;
+        require(out_vertex_buffers_mapped[i]) ;
     }
 
     end_timed_block() ;
@@ -7570,6 +10433,7 @@ create_texture_image(
     require(graphics_queue) ;
     require(pdmp) ;
     begin_timed_block() ;
+    begin_startup_phase(startup_phase_assets) ;
 
     int tx_width    = 0 ;
     int tx_height   = 0 ;
@@ -7595,6 +10459,7 @@ create_texture_image(
 
     if(check(pixels && image_size))
     {
+        end_startup_phase(startup_phase_assets) ;
         end_timed_block() ;
         return false ;
     }
@@ -7625,6 +10490,7 @@ create_texture_image(
         )
     )
     {
+        end_startup_phase(startup_phase_assets) ;
         end_timed_block() ;
         return false ;
     }
@@ -7644,6 +10510,7 @@ create_texture_image(
         )
     )
     {
+        end_startup_phase(startup_phase_assets) ;
         end_timed_block() ;
         return false ;
     }
@@ -7672,6 +10539,7 @@ create_texture_image(
         )
     )
     {
+        end_startup_phase(startup_phase_assets) ;
         end_timed_block() ;
         return false ;
     }
@@ -7690,6 +10558,7 @@ create_texture_image(
         )
     )
     {
+        end_startup_phase(startup_phase_assets) ;
         end_timed_block() ;
         return false ;
     }
@@ -7706,6 +10575,7 @@ create_texture_image(
         )
     )
     {
+        end_startup_phase(startup_phase_assets) ;
         end_timed_block() ;
         return false ;
     }
@@ -7725,6 +10595,7 @@ create_texture_image(
             )
         )
         {
+            end_startup_phase(startup_phase_assets) ;
             end_timed_block() ;
             return false ;
         }
@@ -7743,14 +10614,255 @@ create_texture_image(
             )
         )
         {
+            end_startup_phase(startup_phase_assets) ;
             end_timed_block() ;
             return false ;
         }
     }
 
     vkDestroyBuffer(device, staging_buffer, NULL) ;
-    vkFreeMemory(device, staging_buffer_memory, NULL) ;
+    free_device_memory(device, staging_buffer_memory) ;
+
+    end_startup_phase(startup_phase_assets) ;
+    end_timed_block() ;
+    return true ;
+}
+
+
+// Uploads the mip chain threed_atlas wrote, no decode and no blits. A bc3
+// texture the device can't sample is decoded to rgba8 on the cpu.
+bool
+create_texture_image_from_asset(
+    VkImage *                                   out_image
+,   VkDeviceMemory *                            out_image_memory
+,   uint32_t *                                  out_mip_levels
+,   VkFormat *                                  out_format
+,   char const * const                          full_name
+,   VkDevice const                              device
+,   VkCommandPool const                         command_pool
+,   VkQueue const                               graphics_queue
+,   vulkan_physical_device_info const *         pdi
+,   uint32_t const                              desired_mip_levels
+)
+{
+    require(out_image) ;
+    require(out_image_memory) ;
+    require(out_mip_levels) ;
+    require(out_format) ;
+    require(full_name) ;
+    require(device) ;
+    require(command_pool) ;
+    require(graphics_queue) ;
+    require(pdi) ;
+    begin_timed_block() ;
+    begin_startup_phase(startup_phase_assets) ;
+
+    texture_2d_ptr tp = load_asset_texture(full_name) ;
+    if(check(tp.this_))
+    {
+        end_startup_phase(startup_phase_assets) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    texture_2d const * p = tp.this_ ;
+
+    uint32_t levels_count = p->levels_count_ ;
+    if(0 != desired_mip_levels && desired_mip_levels < levels_count)
+    {
+        levels_count = desired_mip_levels ;
+    }
+    *out_mip_levels = levels_count ;
+
+    VkFormatProperties fp = { 0 } ;
+    bool decode = false ;
+    *out_format = VK_FORMAT_R8G8B8A8_SRGB ;
+    if(texture_2d_format_bc3 == p->format_)
+    {
+        *out_format = VK_FORMAT_BC3_SRGB_BLOCK ;
+        decode = !(
+            find_format_properties(
+                &fp
+            ,   pdi->desired_format_properties_
+            ,   pdi->desired_format_properties_count_
+            ,   VK_FORMAT_BC3_SRGB_BLOCK
+            )
+        &&  (fp.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
+        ) ;
+        if(decode)
+        {
+            log_info("bc3 is not supported, decoding %s to rgba8.", full_name) ;
+            *out_format = VK_FORMAT_R8G8B8A8_SRGB ;
+        }
+    }
+
+    log_debug_u32(p->width_) ;
+    log_debug_u32(p->height_) ;
+    log_debug_u32(*out_mip_levels) ;
+
+    // offsets stay 16 byte aligned, which is what a bc3 block needs.
+    VkDeviceSize offsets[max_texture_2d_levels] = { 0 } ;
+    VkDeviceSize image_size = 0 ;
+    for(
+        uint32_t i = 0
+    ;   i < levels_count
+    ;   ++i
+    )
+    {
+        texture_2d_level const * l = &tp.levels_[i] ;
+        VkDeviceSize const size = decode ? (VkDeviceSize) l->width_ * l->height_ * 4 : l->size_ ;
+        offsets[i] = image_size ;
+        image_size += (size + 15) & ~(VkDeviceSize) 15 ;
+    }
+
+    VkBuffer staging_buffer                 = NULL ;
+    VkDeviceMemory staging_buffer_memory    = NULL ;
+
+    if(check(create_buffer(
+                &staging_buffer
+            ,   &staging_buffer_memory
+            ,   device
+            ,   &pdi->memory_properties_
+            ,   image_size
+            ,   VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+            ,   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            )
+        )
+    )
+    {
+        free_memory(tp.this_) ;
+        end_startup_phase(startup_phase_assets) ;
+        end_timed_block() ;
+        return false ;
+    }
+    require(staging_buffer) ;
+    require(staging_buffer_memory) ;
+
+    void * data = NULL ;
+
+    if(check_vulkan(vkMapMemory(
+                device
+            ,   staging_buffer_memory
+            ,   0
+            ,   image_size
+            ,   0
+            ,   &data
+            )
+        )
+    )
+    {
+        free_memory(tp.this_) ;
+        end_startup_phase(startup_phase_assets) ;
+        end_timed_block() ;
+        return false ;
+    }
+    require(data) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < levels_count
+    ;   ++i
+    )
+    {
+        texture_2d_level const * l = &tp.levels_[i] ;
+        uint8_t * dst = (uint8_t *) data + offsets[i] ;
+        if(decode)
+        {
+            decode_texture_2d_bc3(dst, p, l) ;
+        }
+        else
+        {
+            SDL_memcpy(dst, asset_ref(uint8_t, p, l->offset_), l->size_) ;
+        }
+    }
+
+    vkUnmapMemory(device, staging_buffer_memory) ;
+
+    if(check(create_image(
+                out_image
+            ,   out_image_memory
+            ,   device
+            ,   &pdi->memory_properties_
+            ,   p->width_
+            ,   p->height_
+            ,   *out_mip_levels
+            ,   VK_SAMPLE_COUNT_1_BIT
+            ,   *out_format
+            ,   VK_IMAGE_TILING_OPTIMAL
+            ,   VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+            ,   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+            )
+        )
+    )
+    {
+        free_memory(tp.this_) ;
+        end_startup_phase(startup_phase_assets) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(transition_image_layout(
+                device
+            ,   command_pool
+            ,   graphics_queue
+            ,   *out_image
+            ,   *out_format
+            ,   VK_IMAGE_LAYOUT_UNDEFINED
+            ,   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+            ,   *out_mip_levels
+            )
+        )
+    )
+    {
+        free_memory(tp.this_) ;
+        end_startup_phase(startup_phase_assets) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(copy_buffer_to_image_levels(
+                device
+            ,   command_pool
+            ,   graphics_queue
+            ,   staging_buffer
+            ,   *out_image
+            ,   tp.levels_
+            ,   offsets
+            ,   levels_count
+            )
+        )
+    )
+    {
+        free_memory(tp.this_) ;
+        end_startup_phase(startup_phase_assets) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(transition_image_layout(
+                device
+            ,   command_pool
+            ,   graphics_queue
+            ,   *out_image
+            ,   *out_format
+            ,   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+            ,   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+            ,   *out_mip_levels
+            )
+        )
+    )
+    {
+        free_memory(tp.this_) ;
+        end_startup_phase(startup_phase_assets) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    vkDestroyBuffer(device, staging_buffer, NULL) ;
+    free_device_memory(device, staging_buffer_memory) ;
+    free_memory(tp.this_) ;
 
+    end_startup_phase(startup_phase_assets) ;
     end_timed_block() ;
     return true ;
 }
@@ -7763,6 +10875,25 @@ create_texture_image_view(
 ,   VkImage const       image
 ,   uint32_t const      mip_levels
 )
+{
+    return create_texture_image_view_with_format(
+        out_image_view
+    ,   device
+    ,   image
+    ,   VK_FORMAT_R8G8B8A8_SRGB
+    ,   mip_levels
+    ) ;
+}
+
+
+bool
+create_texture_image_view_with_format(
+    VkImageView *       out_image_view
+,   VkDevice const      device
+,   VkImage const       image
+,   VkFormat const      format
+,   uint32_t const      mip_levels
+)
 {
     require(out_image_view) ;
     require(device) ;
@@ -7774,7 +10905,7 @@ create_texture_image_view(
                 out_image_view
             ,   device
             ,   image
-            ,   VK_FORMAT_R8G8B8A8_SRGB
+            ,   format
             ,   VK_IMAGE_ASPECT_COLOR_BIT
             ,   mip_levels
             )
@@ -8262,7 +11393,7 @@ create_vertex_buffer(
     }
 
     vkDestroyBuffer(device, staging_buffer, NULL) ;
-    vkFreeMemory(device, staging_buffer_memory, NULL) ;
+    free_device_memory(device, staging_buffer_memory) ;
 
     end_timed_block() ;
     return true ;
@@ -8380,7 +11511,7 @@ create_index_buffer(
     }
 
     vkDestroyBuffer(device, staging_buffer, NULL) ;
-    vkFreeMemory(device, staging_buffer_memory, NULL) ;
+    free_device_memory(device, staging_buffer_memory) ;
 
     end_timed_block() ;
     return true ;
@@ -8389,9 +11520,10 @@ create_index_buffer(
 
 bool
 load_shader_file(
-    VkShaderModule *    out_shader_module
-,   VkDevice const      device
-,   char const * const  shader_full_name
+    VkShaderModule *            out_shader_module
+,   spirv_reflection const **   out_reflection
+,   VkDevice const              device
+,   char const * const          shader_full_name
 )
 {
     require(out_shader_module) ;
@@ -8412,6 +11544,17 @@ load_shader_file(
     require(code) ;
     require(size) ;
 
+    if(out_reflection)
+    {
+        *out_reflection = get_spirv_reflection(shader_full_name, code, size) ;
+        if(check(*out_reflection))
+        {
+            free_memory(code) ;
+            end_timed_block() ;
+            return false ;
+        }
+    }
+
 
     if(check(create_shader_module(
                 out_shader_module
@@ -8437,6 +11580,79 @@ load_shader_file(
 }
 
 
+void
+add_specialization_constant(
+    vulkan_specialization *     vs
+,   spirv_reflection const *    reflection
+,   uint32_t const              constant_id
+,   uint32_t const              value
+)
+{
+    require(vs) ;
+    require(reflection) ;
+    require(vs->count_ < max_vulkan_specialization_constants) ;
+    require(find_spirv_specialization_constant(reflection, constant_id)) ;
+    begin_timed_block() ;
+
+    uint32_t const idx = vs->count_ ;
+
+    // typedef struct VkSpecializationMapEntry {
+    //     uint32_t    constantID;
+    //     uint32_t    offset;
+    //     size_t      size;
+    // } VkSpecializationMapEntry;
+    VkSpecializationMapEntry * sme = &vs->map_entries_[idx] ;
+    sme->constantID  = constant_id ;
+    sme->offset      = idx * sizeof(uint32_t) ;
+    sme->size        = sizeof(uint32_t) ;
+
+    vs->data_[idx] = value ;
+
+    ++ vs->count_ ;
+
+    end_timed_block() ;
+}
+
+
+void
+add_specialization_constant_f32(
+    vulkan_specialization *     vs
+,   spirv_reflection const *    reflection
+,   uint32_t const              constant_id
+,   float const                 value
+)
+{
+    uint32_t bits = 0 ;
+    static_require(sizeof(bits) == sizeof(value), "float is expected to be 32 bits.") ;
+    SDL_memcpy(&bits, &value, sizeof(bits)) ;
+    add_specialization_constant(vs, reflection, constant_id, bits) ;
+}
+
+
+VkSpecializationInfo const *
+fill_specialization_info(
+    vulkan_specialization *     vs
+)
+{
+    require(vs) ;
+    begin_timed_block() ;
+
+    // typedef struct VkSpecializationInfo {
+    //     uint32_t                           mapEntryCount;
+    //     const VkSpecializationMapEntry*    pMapEntries;
+    //     size_t                             dataSize;
+    //     const void*                        pData;
+    // } VkSpecializationInfo;
+    vs->info_.mapEntryCount  = vs->count_ ;
+    vs->info_.pMapEntries    = vs->map_entries_ ;
+    vs->info_.dataSize       = vs->count_ * sizeof(uint32_t) ;
+    vs->info_.pData          = vs->data_ ;
+
+    end_timed_block() ;
+    return &vs->info_ ;
+}
+
+
 void
 add_pipeline_shader_stage_create_info(
     VkPipelineShaderStageCreateInfo *   pipeline_shader_stage_create_infos
@@ -8444,6 +11660,7 @@ add_pipeline_shader_stage_create_info(
 ,   uint32_t const                      pipeline_shader_stage_create_infos_count_max
 ,   VkShaderModule const                shader_module
 ,   VkShaderStageFlagBits const         stage_flag_bits
+,   VkSpecializationInfo const *        specialization_info
 )
 {
     require(pipeline_shader_stage_create_infos) ;
@@ -8469,7 +11686,7 @@ add_pipeline_shader_stage_create_info(
     pssci->stage                 = stage_flag_bits ;
     pssci->module                = shader_module ;
     pssci->pName                 = "main" ;
-    pssci->pSpecializationInfo   = NULL ;
+    pssci->pSpecializationInfo   = specialization_info ;
 
     ++ *pipeline_shader_stage_create_infos_count ;
     end_timed_block() ;
@@ -8481,6 +11698,7 @@ fill_vertex_input_binding_description(
     VkVertexInputBindingDescription *   vertex_input_binding_description
 ,   uint32_t const                      binding
 ,   uint32_t const                      stride
+,   VkVertexInputRate const             input_rate
 )
 {
     require(vertex_input_binding_description) ;
@@ -8493,7 +11711,7 @@ fill_vertex_input_binding_description(
     // } VkVertexInputBindingDescription;
     vertex_input_binding_description->binding     = binding ;
     vertex_input_binding_description->stride      = stride ;
-    vertex_input_binding_description->inputRate   = VK_VERTEX_INPUT_RATE_VERTEX ;
+    vertex_input_binding_description->inputRate   = input_rate ;
 
     end_timed_block() ;
 }
@@ -8528,6 +11746,49 @@ add_vertex_input_attribute_description(
 }
 
 
+void
+add_reflected_vertex_input_attribute_descriptions(
+    VkVertexInputAttributeDescription *     vertex_input_attribute_descriptions
+,   uint32_t *                              vertex_input_attribute_descriptions_count
+,   uint32_t const                          vertex_input_attribute_descriptions_count_max
+,   spirv_reflection const *                reflection
+,   uint32_t const                          binding
+,   vulkan_vertex_input_layout const *      layouts
+,   uint32_t const                          layouts_count
+)
+{
+    require(reflection) ;
+    require(VK_SHADER_STAGE_VERTEX_BIT == reflection->stage_) ;
+    require(layouts_count == reflection->vertex_inputs_count_) ;
+    begin_timed_block() ;
+
+    for(
+        uint32_t i = 0
+    ;   i < reflection->vertex_inputs_count_
+    ;   ++i
+    )
+    {
+        spirv_vertex_input const * svi = &reflection->vertex_inputs_[i] ;
+        require(layouts) ;
+        require(svi->location_ < layouts_count) ;
+
+        vulkan_vertex_input_layout const * vvil = &layouts[svi->location_] ;
+
+        add_vertex_input_attribute_description(
+            vertex_input_attribute_descriptions
+        ,   vertex_input_attribute_descriptions_count
+        ,   vertex_input_attribute_descriptions_count_max
+        ,   svi->location_
+        ,   binding
+        ,   VK_FORMAT_UNDEFINED == vvil->format_ ? svi->format_ : vvil->format_
+        ,   vvil->offset_
+        ) ;
+    }
+
+    end_timed_block() ;
+}
+
+
 void
 fill_pipeline_vertex_input_state_create_info(
     VkPipelineVertexInputStateCreateInfo *      pvisci
@@ -8551,7 +11812,7 @@ fill_pipeline_vertex_input_state_create_info(
     pvisci->sType                            = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO ;
     pvisci->pNext                            = NULL ;
     pvisci->flags                            = 0 ;
-    pvisci->vertexBindingDescriptionCount    = 1 ;
+    pvisci->vertexBindingDescriptionCount    = vertex_input_binding_description ? 1 : 0 ;
     pvisci->pVertexBindingDescriptions       = vertex_input_binding_description ;
     pvisci->vertexAttributeDescriptionCount  = vertex_input_attribute_descriptions_count ;
     pvisci->pVertexAttributeDescriptions     = vertex_input_attribute_descriptions ;
@@ -8827,10 +12088,11 @@ fill_pipeline_multisample_state_create_info(
 void
 fill_pipeline_color_blend_attachment_state(
     VkPipelineColorBlendAttachmentState *   pcbas
-,   VkBool32 const                          enable_blending
+,   uint32_t const                          blend_mode
 )
 {
     require(pcbas) ;
+    require(blend_mode <= vulkan_blend_mode_premultiplied_alpha) ;
     begin_timed_block() ;
     // typedef struct VkPipelineColorBlendAttachmentState {
     //     VkBool32                 blendEnable;
@@ -8842,7 +12104,7 @@ fill_pipeline_color_blend_attachment_state(
     //     VkBlendOp                alphaBlendOp;
     //     VkColorComponentFlags    colorWriteMask;
     // } VkPipelineColorBlendAttachmentState;
-    if(enable_blending)
+    if(vulkan_blend_mode_alpha == blend_mode)
     {
         // transparency
         pcbas->blendEnable           = VK_TRUE ;
@@ -8854,6 +12116,18 @@ fill_pipeline_color_blend_attachment_state(
         pcbas->alphaBlendOp          = VK_BLEND_OP_ADD ;
         pcbas->colorWriteMask        = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT ;
     }
+    else if(vulkan_blend_mode_premultiplied_alpha == blend_mode)
+    {
+        // the color is already weighted, alpha composites like the color.
+        pcbas->blendEnable           = VK_TRUE ;
+        pcbas->srcColorBlendFactor   = VK_BLEND_FACTOR_ONE ;
+        pcbas->dstColorBlendFactor   = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA ;
+        pcbas->colorBlendOp          = VK_BLEND_OP_ADD ;
+        pcbas->srcAlphaBlendFactor   = VK_BLEND_FACTOR_ONE ;
+        pcbas->dstAlphaBlendFactor   = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA ;
+        pcbas->alphaBlendOp          = VK_BLEND_OP_ADD ;
+        pcbas->colorWriteMask        = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT ;
+    }
     else
     {
         pcbas->blendEnable           = VK_FALSE ;
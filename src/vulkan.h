@@ -3,6 +3,11 @@
 
 #include <vulkan/vulkan.h>
 #include "types.h"
+#include "pool.h"
+#include "spirv_reflect.h"
+#include "frame_packet.h"
+
+#include <SDL3/SDL_atomic.h>
 
 
 #define max_vulkan_desired_extensions           8
@@ -17,13 +22,66 @@
 #define max_vulkan_desired_format_properties    8
 #define max_vulkan_swapchain_images             8
 #define max_vulkan_frames_in_flight             4
-#define max_vulkan_render_objects               2
+#define max_vulkan_render_objects               4
+#define max_vulkan_device_memory_allocations    256
+#define max_vulkan_specialization_constants     8
+#define max_vulkan_pipeline_permutations        32
+#define max_vulkan_pipeline_shader_stages       4
+#define max_vulkan_retired_pipelines            32
+
+
+// fill_pipeline_color_blend_attachment_state, premultiplied alpha expects
+// the shader to output color already multiplied by alpha.
+#define vulkan_blend_mode_none                  0
+#define vulkan_blend_mode_alpha                 1
+#define vulkan_blend_mode_premultiplied_alpha   2
+
+
+// the scene is drawn at a scale of the swapchain extent and blitted to it, the
+// scale follows the gpu time to stay under the budget given with --gpu-budget.
+// --aa auto uses the default budget without one.
+#define min_vulkan_render_scale                 0.5f
+#define default_vulkan_gpu_budget_ms            14.0
+
+
+// the anti aliasing modes, from the cheapest to the best looking. post is a
+// fxaa pass over the scene image, the msaa modes resolve in the render pass,
+// the shading ones run the fragment shader for more than one sample. With
+// vulkan_aa_mode_auto every supported mode is measured after startup and the
+// best one inside the gpu budget is kept.
+#define vulkan_aa_mode_off                      0
+#define vulkan_aa_mode_post                     1
+#define vulkan_aa_mode_msaa_2                   2
+#define vulkan_aa_mode_msaa_2_shading           3
+#define vulkan_aa_mode_msaa_4                   4
+#define vulkan_aa_mode_msaa_4_shading           5
+#define vulkan_aa_mode_msaa_8                   6
+#define vulkan_aa_mode_msaa_8_shading           7
+#define vulkan_aa_modes_count                   8
+#define vulkan_aa_mode_auto                     vulkan_aa_modes_count
 
 
 typedef struct vulkan_context vulkan_context ;
-
-typedef bool (fn_rob_func)(vulkan_context * vc, void * p) ;
-typedef bool (fn_rob_update_func)(vulkan_context * vc, void * p, uint32_t const current_frame) ;
+typedef struct vulkan_render_object vulkan_render_object ;
+
+typedef bool (fn_rob_func)(vulkan_context * vc, vulkan_render_object * vro) ;
+typedef bool (fn_rob_update_func)(vulkan_context * vc, vulkan_render_object * vro, uint32_t const current_frame) ;
+typedef bool (fn_rob_simulate_func)(vulkan_context * vc, vulkan_render_object * vro, float const step_seconds, bool * out_changed) ;
+typedef bool (fn_rob_pack_func)(vulkan_context * vc, vulkan_render_object * vro, frame_packet * fp) ;
+
+
+// simulate_func_ is optional, it runs at the fixed simulation rate and
+// update_func_ draws between its last two states, see app_->simulation_alpha_.
+// It sets out_changed when the step changed what is drawn, steps which leave
+// the render object as it was don't cause a frame.
+// pack_func_ is optional as well. It runs on the main thread after the
+// simulation and puts what is to be drawn into the frame packet. update_,
+// draw_ and record_func_ run on the render thread, what they draw comes from
+// the packet in vc->frame_packet_.
+// animated_ is set for render objects which look different every frame,
+// whatever was simulated, e.g. turned by the app time on the render thread.
+// Without them a frame is only drawn when something changed, see
+// app_->redraw_.
 
 typedef struct vulkan_render_object
 {
@@ -31,9 +89,13 @@ typedef struct vulkan_render_object
     fn_rob_update_func *    draw_func_ ;
     fn_rob_update_func *    update_func_ ;
     fn_rob_update_func *    record_func_ ;
+    fn_rob_simulate_func *  simulate_func_ ;
+    fn_rob_pack_func *      pack_func_ ;
     fn_rob_func *           destroy_func_ ;
     void *                  param_ ;
+    pool_handle             handle_ ;
     vulkan_context *        vc_ ;
+    bool                    animated_ ;
 
 } vulkan_render_object ;
 
@@ -81,9 +143,6 @@ typedef struct vulkan_physical_device_info
     VkQueueFamilyProperties     queue_family_properties_[max_vulkan_queue_family_properties] ;
     uint32_t                    queue_family_properties_count_ ;
 
-    VkExtensionProperties       device_extensions_[max_vulkan_device_extensions] ;
-    uint32_t                    device_extensions_count_ ;
-
     vulkan_queue_family_indices queue_families_indices_ ;
     VkBool32                    queue_families_indices_complete_ ;
 
@@ -107,6 +166,75 @@ typedef struct vulkan_physical_device_info
 } vulkan_physical_device_info ;
 
 
+// Where a reflected vertex input lives in the vertex struct, indexed by the
+// location. VK_FORMAT_UNDEFINED keeps the reflected format, anything else is
+// for packed data the shader sees unpacked, like an unorm color as vec4.
+typedef struct vulkan_vertex_input_layout
+{
+    uint32_t    offset_ ;
+    VkFormat    format_ ;
+
+} vulkan_vertex_input_layout ;
+
+
+// Values for the layout(constant_id = n) constants of one shader stage. All
+// of them are 4 bytes, a glsl bool is a VkBool32.
+typedef struct vulkan_specialization
+{
+    VkSpecializationMapEntry    map_entries_[max_vulkan_specialization_constants] ;
+    uint32_t                    data_[max_vulkan_specialization_constants] ;
+    uint32_t                    count_ ;
+    VkSpecializationInfo        info_ ;
+
+} vulkan_specialization ;
+
+
+// A pipeline is shared by every render object which asks for the same
+// shaders, specialization constants and fixed function and render pass
+// state. The key is a hash over all of them. The users are remembered by
+// where they keep the handle and the create info they asked with, a shader
+// reload creates the pipeline again from the first of them and hands the
+// new handle to all.
+typedef struct vulkan_pipeline_permutation
+{
+    uint64_t                                key_ ;
+    VkPipeline                              pipeline_ ;
+    char const * const *                    shader_names_ ;
+    uint32_t                                shader_names_count_ ;
+
+    VkPipeline *                            users_[max_vulkan_render_objects] ;
+    VkGraphicsPipelineCreateInfo const *    users_create_info_[max_vulkan_render_objects] ;
+    uint32_t                                users_count_ ;
+
+} vulkan_pipeline_permutation ;
+
+
+// A replaced pipeline is kept until every frame that may have been recorded
+// with it has been waited for.
+typedef struct vulkan_retired_pipeline
+{
+    VkPipeline  pipeline_ ;
+    uint32_t    frames_mask_ ;
+
+} vulkan_retired_pipeline ;
+
+
+typedef struct vulkan_frame_stats
+{
+    uint32_t        draw_count_ ;
+    uint32_t        instance_count_ ;
+    uint32_t        visible_count_ ;
+    uint32_t        culled_count_ ;
+    double          gpu_time_ms_ ;
+    float           render_scale_ ;
+    uint32_t        aa_mode_ ;
+    VkBool32        aa_tuning_ ;
+    VkDeviceSize    device_memory_size_ ;
+    uint32_t        device_memory_count_ ;
+
+} vulkan_frame_stats ;
+
+
 typedef struct vulkan_context
 {
     uint32_t                platform_instance_extensions_count_ ;
@@ -134,7 +262,11 @@ typedef struct vulkan_context
 
     uint32_t                    physical_devices_count_ ;
     VkPhysicalDevice            physical_devices_[max_vulkan_physical_devices] ;
-    vulkan_physical_device_info physical_devices_info_[max_vulkan_physical_devices] ;
+
+    // only one device is looked at a time, the first suitable one is kept.
+    vulkan_physical_device_info physical_device_info_ ;
+    VkBool32                    physical_device_info_cached_ ;
+    VkBool32                    enable_dump_ ;
 
 
     VkSurfaceKHR    surface_ ;
@@ -146,6 +278,10 @@ typedef struct vulkan_context
     VkQueue graphics_queue_ ;
     VkQueue present_queue_ ;
 
+    // every pipeline is made through it, it is kept in the pref path
+    // between runs.
+    VkPipelineCache pipeline_cache_ ;
+
     VkSwapchainKHR      swapchain_ ;
     VkSurfaceFormatKHR  swapchain_surface_format_ ;
     VkPresentModeKHR    swapchain_present_mode_ ;
@@ -166,7 +302,7 @@ typedef struct vulkan_context
     VkFence     in_flight_fence_[max_vulkan_frames_in_flight] ;
     uint32_t    current_frame_ ;
     uint32_t    image_index_ ;
-    VkBool32    resizing_ ;
+    SDL_AtomicInt   resizing_ ;
 
     float               desired_sampler_aniso_ ; //maxSamplerAnisotropy
 
@@ -183,11 +319,53 @@ typedef struct vulkan_context
     VkDeviceMemory  color_image_memory_ ;
     VkImageView     color_image_view_ ;
 
+    // with enable_render_scale_ the scene is drawn to the top left
+    // render_extent_ of scene_image_, which is blitted to the swapchain image.
+    VkBool32        enable_render_scale_ ;
+    VkBool32        enable_adaptive_render_scale_ ;
+    float           render_scale_ ;
+    double          gpu_budget_ms_ ;
+    VkExtent2D      render_extent_ ;
+    VkImage         scene_image_ ;
+    VkDeviceMemory  scene_image_memory_ ;
+    VkImageView     scene_image_view_ ;
+
+    // with enable_post_aa_ the scene image is drawn to the swapchain image by
+    // the post pass instead of the blit. While aa_tune_mode_ is below
+    // vulkan_aa_modes_count the modes are being measured, aa_tune_frame_
+    // counts the frames of the one in use.
+    uint32_t        aa_mode_ ;
+    VkBool32        enable_post_aa_ ;
+    uint32_t        aa_tune_mode_ ;
+    uint32_t        aa_tune_frame_ ;
+    double          aa_tune_gpu_ms_ ;
+
     vulkan_render_object    render_objects_[max_vulkan_render_objects] ;
     uint32_t                render_objects_count_ ;
 
     VkBool32    enable_pre_record_command_buffers_ ;
 
+    VkBool32    enable_timestamps_ ;
+    VkQueryPool timestamp_query_pool_ ;
+    uint64_t    timestamp_mask_ ;
+    double      timestamp_period_ms_ ;
+    VkBool32    timestamp_written_[max_vulkan_frames_in_flight] ;
+
+    vulkan_frame_stats  frame_stats_ ;
+
+    // frame_stats_ as of the last frame drawn, for the main thread.
+    vulkan_frame_stats  published_frame_stats_ ;
+    SDL_SpinLock        frame_stats_lock_ ;
+
+    // the packet being drawn, NULL before the first.
+    frame_packet const *    frame_packet_ ;
+
+    vulkan_pipeline_permutation pipeline_permutations_[max_vulkan_pipeline_permutations] ;
+    uint32_t                    pipeline_permutations_count_ ;
+
+    vulkan_retired_pipeline     retired_pipelines_[max_vulkan_retired_pipelines] ;
+    uint32_t                    retired_pipelines_count_ ;
+
 } vulkan_context ;
 
 
@@ -199,8 +377,48 @@ void
 destroy_vulkan() ;
 
 
+// Draws fp, from the render thread.
+int
+draw_vulkan(
+    frame_packet const *    fp
+) ;
+
+
+// One fixed simulation step for every render object which has one,
+// out_changed is set when any of them changed.
+int
+simulate_vulkan(
+    float const step_seconds
+,   bool *      out_changed
+) ;
+
+
+// Fills fp for the frame to be drawn next, from the main thread.
 int
-draw_vulkan() ;
+pack_vulkan(
+    frame_packet *  fp
+) ;
+
+
+// True when a render object is animated_ and every frame has to be drawn.
+bool
+is_vulkan_animated() ;
+
+
+// The stats of the frame drawn last and the name of the device, from the
+// main thread. False when the gpu time isn't measured.
+bool
+get_vulkan_frame_stats(
+    vulkan_frame_stats *    out_stats
+,   char const **           out_device_name
+) ;
+
+
+// "off", "post", "msaa2", "msaa2s" and so on, as given to --aa.
+char const *
+get_vulkan_aa_mode_name(
+    uint32_t const  aa_mode
+) ;
 
 void
 resize_vulkan() ;
@@ -216,6 +434,29 @@ int
 pre_record_command_buffers() ;
 
 
+void
+add_vulkan_draw_stats(
+    vulkan_context *    vc
+,   uint32_t const      draw_count
+,   uint32_t const      instance_count
+) ;
+
+
+void
+add_vulkan_cull_stats(
+    vulkan_context *    vc
+,   uint32_t const      visible_count
+,   uint32_t const      culled_count
+) ;
+
+
+void
+free_device_memory(
+    VkDevice const          device
+,   VkDeviceMemory const    memory
+) ;
+
+
 void
 add_desriptor_set_layout_binding(
     VkDescriptorSetLayoutBinding *  bindings
@@ -227,6 +468,18 @@ add_desriptor_set_layout_binding(
 ) ;
 
 
+// Adds the bindings of all stages, a binding used by more than one stage is
+// added once with the stage flags combined. Only set 0 is supported.
+void
+add_reflected_descriptor_set_layout_bindings(
+    VkDescriptorSetLayoutBinding *          bindings
+,   uint32_t *                              bindings_count
+,   uint32_t const                          bindings_count_max
+,   spirv_reflection const * const *        reflections
+,   uint32_t const                          reflections_count
+) ;
+
+
 bool
 create_descriptor_set_layout(
     VkDescriptorSetLayout *                 out_layout
@@ -254,6 +507,17 @@ add_descriptor_pool_size(
 ) ;
 
 
+void
+add_descriptor_pool_sizes_from_bindings(
+    VkDescriptorPoolSize *                  pool_sizes
+,   uint32_t *                              pool_sizes_count
+,   uint32_t const                          pool_sizes_count_max
+,   VkDescriptorSetLayoutBinding const *    bindings
+,   uint32_t const                          bindings_count
+,   uint32_t const                          frames_in_flight_count
+) ;
+
+
 bool
 create_descriptor_pool(
     VkDescriptorPool *              out_descriptor_pool
@@ -286,6 +550,18 @@ create_uniform_buffers(
 ) ;
 
 
+bool
+create_dynamic_vertex_buffers(
+    VkBuffer *                                  out_vertex_buffers
+,   VkDeviceMemory *                            out_vertex_buffers_memory
+,   void **                                     out_vertex_buffers_mapped
+,   VkDevice const                              device
+,   uint32_t const                              vertex_buffer_size
+,   VkPhysicalDeviceMemoryProperties const *    pdmp
+,   uint32_t const                              frames_in_flight_count
+) ;
+
+
 
 bool
 create_texture_image(
@@ -301,6 +577,21 @@ create_texture_image(
 ) ;
 
 
+bool
+create_texture_image_from_asset(
+    VkImage *                                   out_image
+,   VkDeviceMemory *                            out_image_memory
+,   uint32_t *                                  out_mip_levels
+,   VkFormat *                                  out_format
+,   char const * const                          full_name
+,   VkDevice const                              device
+,   VkCommandPool const                         command_pool
+,   VkQueue const                               graphics_queue
+,   vulkan_physical_device_info const *         pdi
+,   uint32_t const                              desired_mip_levels
+) ;
+
+
 bool
 create_texture_image_view(
     VkImageView *       out_image_view
@@ -310,6 +601,16 @@ create_texture_image_view(
 ) ;
 
 
+bool
+create_texture_image_view_with_format(
+    VkImageView *       out_image_view
+,   VkDevice const      device
+,   VkImage const       image
+,   VkFormat const      format
+,   uint32_t const      mip_levels
+) ;
+
+
 bool
 create_texture_sampler(
     VkSampler *     out_sampler
@@ -413,14 +714,44 @@ create_index_buffer(
 ) ;
 
 
+// out_reflection is optional, the reflection is cached by name.
 bool
 load_shader_file(
-    VkShaderModule *    out_shader_module
-,   VkDevice const      device
-,   char const * const  shader_full_name
+    VkShaderModule *            out_shader_module
+,   spirv_reflection const **   out_reflection
+,   VkDevice const              device
+,   char const * const          shader_full_name
 ) ;
 
 
+// The reflection of the shader is required to have every constant, so a
+// renamed or removed constant_id doesn't go unnoticed.
+void
+add_specialization_constant(
+    vulkan_specialization *     vs
+,   spirv_reflection const *    reflection
+,   uint32_t const              constant_id
+,   uint32_t const              value
+) ;
+
+
+void
+add_specialization_constant_f32(
+    vulkan_specialization *     vs
+,   spirv_reflection const *    reflection
+,   uint32_t const              constant_id
+,   float const                 value
+) ;
+
+
+VkSpecializationInfo const *
+fill_specialization_info(
+    vulkan_specialization *     vs
+) ;
+
+
+// specialization_info is optional, it has to stay valid until the pipeline
+// is created.
 void
 add_pipeline_shader_stage_create_info(
     VkPipelineShaderStageCreateInfo *   pipeline_shader_stage_create_infos
@@ -428,6 +759,7 @@ add_pipeline_shader_stage_create_info(
 ,   uint32_t const                      pipeline_shader_stage_create_infos_count_max
 ,   VkShaderModule const                shader_module
 ,   VkShaderStageFlagBits const         stage_flag_bits
+,   VkSpecializationInfo const *        specialization_info
 ) ;
 
 
@@ -436,6 +768,7 @@ fill_vertex_input_binding_description(
     VkVertexInputBindingDescription *   vertex_input_binding_description
 ,   uint32_t const                      binding
 ,   uint32_t const                      stride
+,   VkVertexInputRate const             input_rate
 ) ;
 
 
@@ -451,6 +784,21 @@ add_vertex_input_attribute_description(
 ) ;
 
 
+// Adds one attribute per reflected vertex input. The layouts are required
+// to cover exactly the inputs the shader has, so a shader and its vertex
+// struct can't drift apart silently.
+void
+add_reflected_vertex_input_attribute_descriptions(
+    VkVertexInputAttributeDescription *     vertex_input_attribute_descriptions
+,   uint32_t *                              vertex_input_attribute_descriptions_count
+,   uint32_t const                          vertex_input_attribute_descriptions_count_max
+,   spirv_reflection const *                reflection
+,   uint32_t const                          binding
+,   vulkan_vertex_input_layout const *      layouts
+,   uint32_t const                          layouts_count
+) ;
+
+
 void
 fill_pipeline_vertex_input_state_create_info(
     VkPipelineVertexInputStateCreateInfo *      pvisci
@@ -537,7 +885,7 @@ fill_pipeline_multisample_state_create_info(
 void
 fill_pipeline_color_blend_attachment_state(
     VkPipelineColorBlendAttachmentState *   pcbas
-,   VkBool32 const                          enable_blending
+,   uint32_t const                          blend_mode
 ) ;
 
 
@@ -577,3 +925,30 @@ fill_graphics_pipeline_create_info(
 ) ;
 
 
+// Returns the pipeline of an equal permutation or creates it. shader_names
+// are the files the stages were loaded from, in the order of pStages. Render
+// objects sharing a pipeline have their own but identical pipeline layouts,
+// they come from the reflection of the same shaders, so they are compatible.
+// out_pipeline, gpci and what it points to, apart from the shader modules,
+// and shader_names have to stay valid until the pipeline is released, a
+// reloaded shader replaces *out_pipeline at a frame boundary. Render objects
+// kept in a pool need a stable one, see create_stable_pool.
+bool
+get_graphics_pipeline_permutation(
+    VkPipeline *                            out_pipeline
+,   vulkan_context *                        vc
+,   VkGraphicsPipelineCreateInfo const *    gpci
+,   char const * const *                    shader_names
+,   uint32_t const                          shader_names_count
+) ;
+
+
+// Pipelines stay cached when their last user is gone, they are destroyed
+// together with the render pass. *pipeline is cleared.
+void
+release_graphics_pipeline_permutation(
+    vulkan_context *    vc
+,   VkPipeline *        pipeline
+) ;
+
+
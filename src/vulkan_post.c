@@ -0,0 +1,640 @@
+#include "vulkan_post.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "log.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+
+#define max_vulkan_post_dynamic_states  2
+
+
+static char const * const shader_names[] =
+{
+    "ass/shaders/post_shader.vert.spv"
+,   "ass/shaders/post_shader.frag.spv"
+} ;
+
+
+// the push constant block of post_shader.vert and .frag.
+typedef struct post_push_constants
+{
+    float   uv_scale_[2] ;
+    float   texel_[2] ;
+
+} post_push_constants ;
+
+
+typedef struct vulkan_post
+{
+    VkRenderPass            render_pass_ ;
+    VkFramebuffer           framebuffers_[max_vulkan_swapchain_images] ;
+    uint32_t                framebuffers_count_ ;
+
+    VkDescriptorSetLayout   descriptor_set_layout_ ;
+    VkDescriptorPool        descriptor_pool_ ;
+    VkDescriptorSet         descriptor_set_ ;
+    VkSampler               sampler_ ;
+
+    VkPipelineLayout        pipeline_layout_ ;
+    VkPipeline              pipeline_ ;
+
+} vulkan_post ;
+
+
+static vulkan_post vp_ = { 0 } ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+static bool
+create_post_render_pass(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    // every pixel is written, what was in the image before doesn't matter.
+    static VkAttachmentDescription ad = { 0 } ;
+    ad.flags            = 0 ;
+    ad.format           = vc->swapchain_surface_format_.format ;
+    ad.samples          = VK_SAMPLE_COUNT_1_BIT ;
+    ad.loadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE ;
+    ad.storeOp          = VK_ATTACHMENT_STORE_OP_STORE ;
+    ad.stencilLoadOp    = VK_ATTACHMENT_LOAD_OP_DONT_CARE ;
+    ad.stencilStoreOp   = VK_ATTACHMENT_STORE_OP_DONT_CARE ;
+    ad.initialLayout    = VK_IMAGE_LAYOUT_UNDEFINED ;
+    ad.finalLayout      = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR ;
+
+    static VkAttachmentReference color_ar = { 0 } ;
+    color_ar.attachment = 0 ;
+    color_ar.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL ;
+
+    static VkSubpassDescription sd = { 0 } ;
+    sd.flags                    = 0 ;
+    sd.pipelineBindPoint        = VK_PIPELINE_BIND_POINT_GRAPHICS ;
+    sd.inputAttachmentCount     = 0 ;
+    sd.pInputAttachments        = NULL ;
+    sd.colorAttachmentCount     = 1 ;
+    sd.pColorAttachments        = &color_ar ;
+    sd.pResolveAttachments      = NULL ;
+    sd.pDepthStencilAttachment  = NULL ;
+    sd.preserveAttachmentCount  = 0 ;
+    sd.pPreserveAttachments     = NULL ;
+
+    // the submit waits for the swapchain image at the color output stage.
+    static VkSubpassDependency sde = { 0 } ;
+    sde.srcSubpass       = VK_SUBPASS_EXTERNAL ;
+    sde.dstSubpass       = 0 ;
+    sde.srcStageMask     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT ;
+    sde.dstStageMask     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT ;
+    sde.srcAccessMask    = 0 ;
+    sde.dstAccessMask    = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT ;
+    sde.dependencyFlags  = 0 ;
+
+    static VkRenderPassCreateInfo rpci = { 0 } ;
+    rpci.sType              = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO ;
+    rpci.pNext              = NULL ;
+    rpci.flags              = 0 ;
+    rpci.attachmentCount    = 1 ;
+    rpci.pAttachments       = &ad ;
+    rpci.subpassCount       = 1 ;
+    rpci.pSubpasses         = &sd ;
+    rpci.dependencyCount    = 1 ;
+    rpci.pDependencies      = &sde ;
+
+    if(check_vulkan(vkCreateRenderPass(
+                vc->device_
+            ,   &rpci
+            ,   NULL
+            ,   &vp_.render_pass_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vp_.render_pass_) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+create_post_descriptor_set(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    VkDescriptorSetLayoutBinding    bindings[1] = { 0 } ;
+    uint32_t                        bindings_count = 0 ;
+
+    add_desriptor_set_layout_binding(
+        bindings
+    ,   &bindings_count
+    ,   array_count(bindings)
+    ,   0
+    ,   VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+    ,   VK_SHADER_STAGE_FRAGMENT_BIT
+    ) ;
+
+    if(check(create_descriptor_set_layout(
+                &vp_.descriptor_set_layout_
+            ,   vc->device_
+            ,   bindings
+            ,   bindings_count
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    // one set, it is only written while no frame is in flight.
+    VkDescriptorPoolSize    pool_sizes[1] = { 0 } ;
+    uint32_t                pool_sizes_count = 0 ;
+
+    add_descriptor_pool_size(
+        pool_sizes
+    ,   &pool_sizes_count
+    ,   array_count(pool_sizes)
+    ,   VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+    ,   1
+    ) ;
+
+    if(check(create_descriptor_pool(
+                &vp_.descriptor_pool_
+            ,   vc->device_
+            ,   pool_sizes
+            ,   pool_sizes_count
+            ,   1
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_descriptor_sets(
+                &vp_.descriptor_set_
+            ,   vc->device_
+            ,   vp_.descriptor_set_layout_
+            ,   vp_.descriptor_pool_
+            ,   1
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vp_.descriptor_set_) ;
+
+    if(check(create_texture_sampler(
+                &vp_.sampler_
+            ,   vc->device_
+            ,   1
+            ,   VK_FALSE
+            ,   1.0f
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+create_post_pipeline(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    require(vp_.render_pass_) ;
+    require(vp_.descriptor_set_layout_) ;
+    begin_timed_block() ;
+
+    static VkPipelineLayoutCreateInfo plci = { 0 } ;
+    fill_pipeline_layout_create_info(
+        &plci
+    ,   &vp_.descriptor_set_layout_
+    ,   1
+    ) ;
+
+    // typedef struct VkPushConstantRange {
+    //     VkShaderStageFlags    stageFlags;
+    //     uint32_t              offset;
+    //     uint32_t              size;
+    // } VkPushConstantRange;
+    static VkPushConstantRange pcr = { 0 } ;
+    pcr.stageFlags  = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT ;
+    pcr.offset      = 0 ;
+    pcr.size        = sizeof(post_push_constants) ;
+
+    plci.pushConstantRangeCount = 1 ;
+    plci.pPushConstantRanges    = &pcr ;
+
+    if(check_vulkan(vkCreatePipelineLayout(
+                vc->device_
+            ,   &plci
+            ,   NULL
+            ,   &vp_.pipeline_layout_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vp_.pipeline_layout_) ;
+
+    VkShaderModule vert_shader = VK_NULL_HANDLE ;
+    VkShaderModule frag_shader = VK_NULL_HANDLE ;
+
+    if(check(load_shader_file(&vert_shader, NULL, vc->device_, shader_names[0])))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(load_shader_file(&frag_shader, NULL, vc->device_, shader_names[1])))
+    {
+        vkDestroyShaderModule(vc->device_, vert_shader, NULL) ;
+        end_timed_block() ;
+        return false ;
+    }
+
+    VkPipelineShaderStageCreateInfo stages[2] = { 0 } ;
+    uint32_t                        stages_count = 0 ;
+
+    add_pipeline_shader_stage_create_info(
+        stages
+    ,   &stages_count
+    ,   array_count(stages)
+    ,   vert_shader
+    ,   VK_SHADER_STAGE_VERTEX_BIT
+    ,   NULL
+    ) ;
+
+    add_pipeline_shader_stage_create_info(
+        stages
+    ,   &stages_count
+    ,   array_count(stages)
+    ,   frag_shader
+    ,   VK_SHADER_STAGE_FRAGMENT_BIT
+    ,   NULL
+    ) ;
+
+    // the triangle comes from gl_VertexIndex, no vertex buffer.
+    VkPipelineVertexInputStateCreateInfo pvisci = { 0 } ;
+    fill_pipeline_vertex_input_state_create_info(&pvisci, NULL, NULL, 0) ;
+
+    VkPipelineInputAssemblyStateCreateInfo piasci = { 0 } ;
+    fill_pipeline_input_assembly_state_create_info(&piasci, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_FALSE) ;
+
+    VkViewport  viewport    = { 0 } ;
+    VkRect2D    scissor     = { 0 } ;
+    fill_viewport(&viewport, 0, 0, vc->swapchain_extent_.width, vc->swapchain_extent_.height, 0, 1) ;
+    fill_scissor(&scissor, 0, 0, vc->swapchain_extent_.width, vc->swapchain_extent_.height) ;
+
+    VkPipelineViewportStateCreateInfo pvsci = { 0 } ;
+    fill_pipeline_viewport_state_create_info(&pvsci, &viewport, &scissor) ;
+
+    VkDynamicState  dynamic_states[max_vulkan_post_dynamic_states] = { 0 } ;
+    uint32_t        dynamic_states_count = 0 ;
+    add_to_dynamic_state(dynamic_states, &dynamic_states_count, max_vulkan_post_dynamic_states, VK_DYNAMIC_STATE_VIEWPORT) ;
+    add_to_dynamic_state(dynamic_states, &dynamic_states_count, max_vulkan_post_dynamic_states, VK_DYNAMIC_STATE_SCISSOR) ;
+
+    VkPipelineDynamicStateCreateInfo pdsci = { 0 } ;
+    fill_pipeline_dynamic_state_create_info(&pdsci, dynamic_states, dynamic_states_count) ;
+
+    VkPipelineRasterizationStateCreateInfo prsci = { 0 } ;
+    fill_pipeline_rasterization_state_create_info(&prsci, VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE) ;
+
+    VkPipelineMultisampleStateCreateInfo pmssci = { 0 } ;
+    fill_pipeline_multisample_state_create_info(&pmssci, VK_FALSE, VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 1.0f) ;
+
+    VkPipelineColorBlendAttachmentState pcbas = { 0 } ;
+    fill_pipeline_color_blend_attachment_state(&pcbas, vulkan_blend_mode_none) ;
+
+    VkPipelineColorBlendStateCreateInfo pcbsci = { 0 } ;
+    fill_pipeline_color_blend_state_create_info(&pcbsci, VK_FALSE, VK_LOGIC_OP_COPY, &pcbas) ;
+
+    VkPipelineDepthStencilStateCreateInfo pdssci = { 0 } ;
+    fill_pipeline_depth_stencil_state_create_info(&pdssci, VK_FALSE, VK_FALSE, VK_COMPARE_OP_ALWAYS) ;
+
+    VkGraphicsPipelineCreateInfo gpci = { 0 } ;
+    fill_graphics_pipeline_create_info(
+        &gpci
+    ,   vp_.pipeline_layout_
+    ,   vp_.render_pass_
+    ,   stages
+    ,   stages_count
+    ,   &pvisci
+    ,   &piasci
+    ,   &pvsci
+    ,   &prsci
+    ,   &pmssci
+    ,   &pdssci
+    ,   &pcbsci
+    ,   &pdsci
+    ) ;
+
+    bool const created = !check_vulkan(vkCreateGraphicsPipelines(
+            vc->device_
+        ,   vc->pipeline_cache_
+        ,   1
+        ,   &gpci
+        ,   NULL
+        ,   &vp_.pipeline_
+        )
+    ) ;
+
+    vkDestroyShaderModule(vc->device_, vert_shader, NULL) ;
+    vkDestroyShaderModule(vc->device_, frag_shader, NULL) ;
+
+    end_timed_block() ;
+    return created ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//
+bool
+create_vulkan_post(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    require(vc->device_) ;
+    require(!vp_.render_pass_) ;
+    begin_timed_block() ;
+
+    if(check(create_post_render_pass(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_post_descriptor_set(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_post_pipeline(vc)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+void
+destroy_vulkan_post(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    destroy_vulkan_post_framebuffers(vc) ;
+
+    if(vp_.pipeline_)
+    {
+        vkDestroyPipeline(vc->device_, vp_.pipeline_, NULL) ;
+    }
+
+    if(vp_.pipeline_layout_)
+    {
+        vkDestroyPipelineLayout(vc->device_, vp_.pipeline_layout_, NULL) ;
+    }
+
+    if(vp_.sampler_)
+    {
+        vkDestroySampler(vc->device_, vp_.sampler_, NULL) ;
+    }
+
+    // the set goes with its pool.
+    if(vp_.descriptor_pool_)
+    {
+        vkDestroyDescriptorPool(vc->device_, vp_.descriptor_pool_, NULL) ;
+    }
+
+    if(vp_.descriptor_set_layout_)
+    {
+        vkDestroyDescriptorSetLayout(vc->device_, vp_.descriptor_set_layout_, NULL) ;
+    }
+
+    if(vp_.render_pass_)
+    {
+        vkDestroyRenderPass(vc->device_, vp_.render_pass_, NULL) ;
+    }
+
+    SDL_memset(&vp_, 0, sizeof(vulkan_post)) ;
+
+    end_timed_block() ;
+}
+
+
+bool
+create_vulkan_post_framebuffers(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+    require(vc->swapchain_images_count_ < max_vulkan_swapchain_images) ;
+    require(0 == vp_.framebuffers_count_) ;
+
+    if(!vp_.render_pass_)
+    {
+        return true ;
+    }
+
+    begin_timed_block() ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->swapchain_images_count_
+    ;   ++i
+    )
+    {
+        static VkFramebufferCreateInfo fbci = { 0 } ;
+        fbci.sType              = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO ;
+        fbci.pNext              = NULL ;
+        fbci.flags              = 0 ;
+        fbci.renderPass         = vp_.render_pass_ ;
+        fbci.attachmentCount    = 1 ;
+        fbci.pAttachments       = &vc->swapchain_views_[i] ;
+        fbci.width              = vc->swapchain_extent_.width ;
+        fbci.height             = vc->swapchain_extent_.height ;
+        fbci.layers             = 1 ;
+
+        if(check_vulkan(vkCreateFramebuffer(
+                    vc->device_
+                ,   &fbci
+                ,   NULL
+                ,   &vp_.framebuffers_[i]
+                )
+            )
+        )
+        {
+            end_timed_block() ;
+            return false ;
+        }
+        require(vp_.framebuffers_[i]) ;
+        ++vp_.framebuffers_count_ ;
+    }
+
+    // without the post pass there is no scene image to point at.
+    if(vc->scene_image_view_)
+    {
+        static VkDescriptorImageInfo dii = { 0 } ;
+        dii.sampler     = vp_.sampler_ ;
+        dii.imageView   = vc->scene_image_view_ ;
+        dii.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ;
+
+        static VkWriteDescriptorSet wds = { 0 } ;
+        wds.sType               = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET ;
+        wds.pNext               = NULL ;
+        wds.dstSet              = vp_.descriptor_set_ ;
+        wds.dstBinding          = 0 ;
+        wds.dstArrayElement     = 0 ;
+        wds.descriptorCount     = 1 ;
+        wds.descriptorType      = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ;
+        wds.pImageInfo          = &dii ;
+        wds.pBufferInfo         = NULL ;
+        wds.pTexelBufferView    = NULL ;
+
+        vkUpdateDescriptorSets(vc->device_, 1, &wds, 0, NULL) ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+void
+destroy_vulkan_post_framebuffers(
+    vulkan_context *    vc
+)
+{
+    require(vc) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vp_.framebuffers_count_
+    ;   ++i
+    )
+    {
+        vkDestroyFramebuffer(vc->device_, vp_.framebuffers_[i], NULL) ;
+        vp_.framebuffers_[i] = NULL ;
+    }
+
+    vp_.framebuffers_count_ = 0 ;
+}
+
+
+void
+record_vulkan_post(
+    vulkan_context *    vc
+,   VkCommandBuffer     command_buffer
+,   uint32_t const      image_index
+)
+{
+    require(vc) ;
+    require(command_buffer) ;
+    require(vp_.pipeline_) ;
+    require(image_index < vp_.framebuffers_count_) ;
+
+    static VkRenderPassBeginInfo rpbi = { 0 } ;
+    rpbi.sType                      = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO ;
+    rpbi.pNext                      = NULL ;
+    rpbi.renderPass                 = vp_.render_pass_ ;
+    rpbi.framebuffer                = vp_.framebuffers_[image_index] ;
+    rpbi.renderArea.offset.x        = 0 ;
+    rpbi.renderArea.offset.y        = 0 ;
+    rpbi.renderArea.extent          = vc->swapchain_extent_ ;
+    rpbi.clearValueCount            = 0 ;
+    rpbi.pClearValues               = NULL ;
+
+    vkCmdBeginRenderPass(command_buffer, &rpbi, VK_SUBPASS_CONTENTS_INLINE) ;
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vp_.pipeline_) ;
+
+    VkViewport viewport = { 0 } ;
+    fill_viewport(&viewport, 0, 0, vc->swapchain_extent_.width, vc->swapchain_extent_.height, 0, 1) ;
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport) ;
+
+    VkRect2D scissor = { 0 } ;
+    fill_scissor(&scissor, 0, 0, vc->swapchain_extent_.width, vc->swapchain_extent_.height) ;
+    vkCmdSetScissor(command_buffer, 0, 1, &scissor) ;
+
+    // void vkCmdBindDescriptorSets(
+    //     VkCommandBuffer                             commandBuffer,
+    //     VkPipelineBindPoint                         pipelineBindPoint,
+    //     VkPipelineLayout                            layout,
+    //     uint32_t                                    firstSet,
+    //     uint32_t                                    descriptorSetCount,
+    //     const VkDescriptorSet*                      pDescriptorSets,
+    //     uint32_t                                    dynamicOffsetCount,
+    //     const uint32_t*                             pDynamicOffsets);
+    vkCmdBindDescriptorSets(
+        command_buffer
+    ,   VK_PIPELINE_BIND_POINT_GRAPHICS
+    ,   vp_.pipeline_layout_
+    ,   0
+    ,   1
+    ,   &vp_.descriptor_set_
+    ,   0
+    ,   NULL
+    ) ;
+
+    // the scene image is swapchain sized, render_extent_ of it was drawn.
+    float const w = (float) vc->swapchain_extent_.width ;
+    float const h = (float) vc->swapchain_extent_.height ;
+
+    post_push_constants ppc = { 0 } ;
+    ppc.uv_scale_[0]    = (float) vc->render_extent_.width / w ;
+    ppc.uv_scale_[1]    = (float) vc->render_extent_.height / h ;
+    ppc.texel_[0]       = 1.0f / w ;
+    ppc.texel_[1]       = 1.0f / h ;
+
+    // void vkCmdPushConstants(
+    //     VkCommandBuffer                             commandBuffer,
+    //     VkPipelineLayout                            layout,
+    //     VkShaderStageFlags                          stageFlags,
+    //     uint32_t                                    offset,
+    //     uint32_t                                    size,
+    //     const void*                                 pValues);
+    vkCmdPushConstants(
+        command_buffer
+    ,   vp_.pipeline_layout_
+    ,   VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
+    ,   0
+    ,   sizeof(post_push_constants)
+    ,   &ppc
+    ) ;
+
+    vkCmdDraw(command_buffer, 3, 1, 0, 0) ;
+
+    vkCmdEndRenderPass(command_buffer) ;
+}
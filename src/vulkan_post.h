@@ -0,0 +1,44 @@
+#pragma once
+
+
+#include "vulkan.h"
+
+
+// The post process anti aliasing. Instead of the blit the scene image is
+// drawn to the swapchain image in a render pass of its own, through a cut
+// down fxaa which stretches the drawn part of the scene over the window as
+// well. Only made when the surface format can be sampled linearly.
+bool
+create_vulkan_post(
+    vulkan_context *    vc
+) ;
+
+
+void
+destroy_vulkan_post(
+    vulkan_context *    vc
+) ;
+
+
+// One for every swapchain image, made again with the swapchain. They also
+// point the pass at the scene image, which is made again with it too.
+bool
+create_vulkan_post_framebuffers(
+    vulkan_context *    vc
+) ;
+
+
+void
+destroy_vulkan_post_framebuffers(
+    vulkan_context *    vc
+) ;
+
+
+// After the scene's render pass, which left the scene image in
+// SHADER_READ_ONLY_OPTIMAL. Leaves the swapchain image ready to present.
+void
+record_vulkan_post(
+    vulkan_context *    vc
+,   VkCommandBuffer     command_buffer
+,   uint32_t const      image_index
+) ;
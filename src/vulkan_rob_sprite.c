@@ -1,6 +1,7 @@
 #include "app.h"
 #include "vulkan_rob.h"
 #include "vulkan.h"
+#include "pool.h"
 #include "defines.h"
 #include "debug.h"
 #include "check.h"
@@ -69,6 +70,10 @@ typedef struct vulkan_rob
     VkShaderModule  vert_shader_ ;
     VkShaderModule  frag_shader_ ;
 
+    spirv_reflection const *   vert_reflection_ ;
+    spirv_reflection const *   frag_reflection_ ;
+    vulkan_specialization      vert_specialization_ ;
+
 
     VkPipelineShaderStageCreateInfo pipeline_shader_stage_create_infos_[max_vulkan_pipeline_shader_stage_create_infos] ;
     uint32_t                        pipeline_shader_stage_create_infos_count_ ;
@@ -98,7 +103,20 @@ typedef struct vulkan_rob
 } vulkan_rob ;
 
 
-static vulkan_rob   the_vulkan_rob_ = { 0 } ;
+static pool     rob_pool_ = { 0 } ;
+
+
+static vulkan_rob *
+get_rob(
+    vulkan_render_object const *    vro
+)
+{
+    require(vro) ;
+    require(vro->param_ == &rob_pool_) ;
+    vulkan_rob * vr = pool_get(vulkan_rob, &rob_pool_, vro->handle_) ;
+    require(vr) ;
+    return vr ;
+}
 
 
 //////////////////////////////////////7
@@ -136,6 +154,14 @@ static float const t3u = 0.0f ;
 static float const t3v = tth ;
 
 
+// indexed by the shader input location.
+static vulkan_vertex_input_layout const vertex_input_layouts[] =
+{
+    { offsetof(vertex, pos), VK_FORMAT_UNDEFINED }
+,   { offsetof(vertex, uv),  VK_FORMAT_UNDEFINED }
+} ;
+
+
 static vertex const vertices[] =
 {
     { {p0x, p0y}, {t0u, t0v} }
@@ -159,6 +185,17 @@ static uint32_t const   indices_count = array_count(indices) ;
 #define max_ubo_instance_count  32
 
 
+// layout(constant_id = n) in sprite_shader.vert
+#define max_instance_constant_id    0
+
+
+static char const * const shader_names[] =
+{
+    "ass/shaders/sprite_shader.vert.spv"
+,   "ass/shaders/sprite_shader.frag.spv"
+} ;
+
+
 typedef struct uniform_buffer_object
 {
     vec2 offset_ ;
@@ -308,6 +345,7 @@ record_command_buffer(
     //     int32_t                                     vertexOffset,
     //     uint32_t                                    firstInstance);
     vkCmdDrawIndexed(command_buffer, indices_count, max_ubo_instance_count, 0, 0, 0) ;
+    add_vulkan_draw_stats(vc, 1, max_ubo_instance_count) ;
 
     end_timed_block() ;
     return true ;
@@ -318,16 +356,15 @@ record_command_buffer(
 
 static bool
 update_rob(
-    vulkan_context *    vc
-,   void *              param
-,   uint32_t const      current_frame
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
 )
 {
     require(vc) ;
     begin_timed_block() ;
 
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
 
     update_uniform_buffer(vc, vr, current_frame) ;
 
@@ -338,15 +375,14 @@ update_rob(
 
 static bool
 record_rob(
-    vulkan_context *    vc
-,   void *              param
-,   uint32_t const      current_frame
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
 )
 {
     require(vc) ;
     begin_timed_block() ;
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
 
     require(current_frame < vc->frames_in_flight_count_) ;
 
@@ -370,15 +406,14 @@ record_rob(
 
 static bool
 draw_rob(
-    vulkan_context *    vc
-,   void *              param
-,   uint32_t const      current_frame
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
 )
 {
     require(vc) ;
     begin_timed_block() ;
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
     require(current_frame < vc->frames_in_flight_count_) ;
 
     if(vc->enable_pre_record_command_buffers_)
@@ -407,15 +442,14 @@ draw_rob(
 
 static bool
 destroy_rob(
-    vulkan_context *    vc
-,   void *              param
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
 )
 {
     require(vc) ;
     begin_timed_block() ;
 
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
 
     if(vr->texture_sampler_)
     {
@@ -445,7 +479,7 @@ destroy_rob(
 
     if(vr->texture_image_memory_)
     {
-        vkFreeMemory(vc->device_, vr->texture_image_memory_, NULL) ;
+        free_device_memory(vc->device_, vr->texture_image_memory_) ;
         vr->texture_image_memory_ = NULL ;
     }
 
@@ -457,7 +491,7 @@ destroy_rob(
     {
         vkDestroyBuffer(vc->device_, vr->uniform_buffers_[i], NULL) ;
         vr->uniform_buffers_[i] = NULL ;
-        vkFreeMemory(vc->device_, vr->uniform_buffers_memory_[i], NULL) ;
+        free_device_memory(vc->device_, vr->uniform_buffers_memory_[i]) ;
         vr->uniform_buffers_memory_[i] = NULL ;
     }
 
@@ -491,7 +525,7 @@ destroy_rob(
 
     if(vr->index_buffer_memory_)
     {
-        vkFreeMemory(vc->device_, vr->index_buffer_memory_, NULL) ;
+        free_device_memory(vc->device_, vr->index_buffer_memory_) ;
         vr->index_buffer_memory_ = NULL ;
     }
 
@@ -513,18 +547,13 @@ destroy_rob(
         //     VkDeviceMemory                              memory,
         //     const VkAllocationCallbacks*                pAllocator);
         //     }
-        vkFreeMemory(vc->device_, vr->vertex_buffer_memory_, NULL) ;
+        free_device_memory(vc->device_, vr->vertex_buffer_memory_) ;
         vr->vertex_buffer_memory_ = NULL ;
     }
 
     if(vr->graphics_pipeline_)
     {
-        // void vkDestroyPipeline(
-        //     VkDevice                                    device,
-        //     VkPipeline                                  pipeline,
-        //     const VkAllocationCallbacks*                pAllocator);
-        vkDestroyPipeline(vc->device_, vr->graphics_pipeline_, NULL) ;
-        vr->graphics_pipeline_ = NULL ;
+        release_graphics_pipeline_permutation(vc, &vr->graphics_pipeline_) ;
     }
 
     if(vr->pipeline_layout_)
@@ -537,6 +566,12 @@ destroy_rob(
         vr->pipeline_layout_ = NULL ;
     }
 
+    check(free_pool_element(&rob_pool_, vro->handle_)) ;
+    if(0 == pool_count(&rob_pool_))
+    {
+        destroy_pool(&rob_pool_) ;
+    }
+
     end_timed_block() ;
     return true ;
 }
@@ -544,15 +579,14 @@ destroy_rob(
 
 static bool
 create_rob(
-    vulkan_context *    vc
-,   void *              param
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
 )
 {
     require(vc) ;
     begin_timed_block() ;
 
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
 
     // 1 == means no mip maps
     // 0 == auto mipmap generation
@@ -569,22 +603,50 @@ create_rob(
 
     require(vr->texture_anisotropy_ <= vc->picked_physical_device_->properties_.limits.maxSamplerAnisotropy) ;
 
-    add_desriptor_set_layout_binding(
-        vr->descriptor_set_layout_bindings_
-    ,   &vr->descriptor_set_layout_bindings_count_
-    ,   max_vulkan_descriptor_set_layout_binding
-    ,   0
-    ,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
-    ,   VK_SHADER_STAGE_VERTEX_BIT
-    ) ;
+    if(check(load_shader_file(
+                &vr->vert_shader_
+            ,   &vr->vert_reflection_
+            ,   vc->device_
+            ,   shader_names[0]
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->vert_shader_) ;
+    require(vr->vert_reflection_) ;
+
+    if(check(load_shader_file(
+                &vr->frag_shader_
+            ,   &vr->frag_reflection_
+            ,   vc->device_
+            ,   shader_names[1]
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->frag_shader_) ;
+    require(vr->frag_reflection_) ;
+
+    // the glsl uniform block and uniform_buffer_object have to match.
+    spirv_descriptor_binding const * ubo_binding = find_spirv_descriptor_binding(vr->vert_reflection_, 0, 0) ;
+    require(ubo_binding) ;
+    require(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER == ubo_binding->type_) ;
+    require(uniform_buffer_object_size == ubo_binding->block_size_) ;
 
-    add_desriptor_set_layout_binding(
+    spirv_reflection const * reflections[] = { vr->vert_reflection_, vr->frag_reflection_ } ;
+
+    add_reflected_descriptor_set_layout_bindings(
         vr->descriptor_set_layout_bindings_
     ,   &vr->descriptor_set_layout_bindings_count_
     ,   max_vulkan_descriptor_set_layout_binding
-    ,   1
-    ,   VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
-    ,   VK_SHADER_STAGE_FRAGMENT_BIT
+    ,   reflections
+    ,   array_count(reflections)
     ) ;
 
     if(check(create_descriptor_set_layout(
@@ -621,20 +683,12 @@ create_rob(
     require(vr->pipeline_layout_) ;
 
     require(0 == vr->descriptor_pool_sizes_count_) ;
-    add_descriptor_pool_size(
+    add_descriptor_pool_sizes_from_bindings(
         vr->descriptor_pool_sizes_
     ,   &vr->descriptor_pool_sizes_count_
     ,   max_vulkan_descriptor_pool_size
-    ,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
-    ,   vc->frames_in_flight_count_
-    ) ;
-    require(1 == vr->descriptor_pool_sizes_count_) ;
-
-    add_descriptor_pool_size(
-        vr->descriptor_pool_sizes_
-    ,   &vr->descriptor_pool_sizes_count_
-    ,   max_vulkan_descriptor_pool_size
-    ,   VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+    ,   vr->descriptor_set_layout_bindings_
+    ,   vr->descriptor_set_layout_bindings_count_
     ,   vc->frames_in_flight_count_
     ) ;
 
@@ -824,31 +878,12 @@ create_rob(
     require(vr->index_buffer_) ;
     require(vr->index_buffer_memory_) ;
 
-    if(check(load_shader_file(
-                &vr->vert_shader_
-            ,   vc->device_
-            ,   "ass/shaders/sprite_shader.vert.spv"
-            )
-        )
-    )
-    {
-        end_timed_block() ;
-        return false ;
-    }
-    require(vr->vert_shader_) ;
-
-    if(check(load_shader_file(
-                &vr->frag_shader_
-            ,   vc->device_
-            ,   "ass/shaders/sprite_shader.frag.spv"
-            )
-        )
-    )
-    {
-        end_timed_block() ;
-        return false ;
-    }
-    require(vr->frag_shader_) ;
+    add_specialization_constant(
+        &vr->vert_specialization_
+    ,   vr->vert_reflection_
+    ,   max_instance_constant_id
+    ,   max_ubo_instance_count
+    ) ;
 
     add_pipeline_shader_stage_create_info(
         vr->pipeline_shader_stage_create_infos_
@@ -856,6 +891,7 @@ create_rob(
     ,   max_vulkan_pipeline_shader_stage_create_infos
     ,   vr->vert_shader_
     ,   VK_SHADER_STAGE_VERTEX_BIT
+    ,   fill_specialization_info(&vr->vert_specialization_)
     ) ;
 
     add_pipeline_shader_stage_create_info(
@@ -864,44 +900,26 @@ create_rob(
     ,   max_vulkan_pipeline_shader_stage_create_infos
     ,   vr->frag_shader_
     ,   VK_SHADER_STAGE_FRAGMENT_BIT
+    ,   NULL
     ) ;
 
     fill_vertex_input_binding_description(
         &vr->vertex_input_binding_description_
     ,   0
     ,   vertex_size
+    ,   VK_VERTEX_INPUT_RATE_VERTEX
     ) ;
 
-    add_vertex_input_attribute_description(
-        vr->vertex_input_attribute_descriptions_
-    ,   &vr->vertex_input_attribute_descriptions_count_
-    ,   max_vulkan_vertex_input_attribute_descriptions
-    ,   0
-    ,   0
-    ,   VK_FORMAT_R32G32_SFLOAT
-    ,   offsetof(vertex, pos)
-    ) ;
-
-    add_vertex_input_attribute_description(
+    add_reflected_vertex_input_attribute_descriptions(
         vr->vertex_input_attribute_descriptions_
     ,   &vr->vertex_input_attribute_descriptions_count_
     ,   max_vulkan_vertex_input_attribute_descriptions
-    ,   1
+    ,   vr->vert_reflection_
     ,   0
-    ,   VK_FORMAT_R32G32_SFLOAT
-    ,   offsetof(vertex, uv)
+    ,   vertex_input_layouts
+    ,   array_count(vertex_input_layouts)
     ) ;
 
-    // add_vertex_input_attribute_description(
-    //     vr->vertex_input_attribute_descriptions_
-    // ,   &vr->vertex_input_attribute_descriptions_count_
-    // ,   max_vulkan_vertex_input_attribute_descriptions
-    // ,   2
-    // ,   0
-    // ,   VK_FORMAT_R32G32B32_SFLOAT
-    // ,   offsetof(vertex, color)
-    // ) ;
-
     fill_pipeline_vertex_input_state_create_info(
         &vr->pipeline_vertex_input_state_create_info_
     ,   &vr->vertex_input_binding_description_
@@ -977,7 +995,7 @@ create_rob(
 
     fill_pipeline_color_blend_attachment_state(
         &vr->pipeline_color_blend_attachment_state_
-    ,   VK_FALSE
+    ,   vulkan_blend_mode_none
     ) ;
 
     fill_pipeline_color_blend_state_create_info(
@@ -1010,20 +1028,12 @@ create_rob(
     ,   &vr->pipeline_dynamic_state_create_info_
     ) ;
 
-    // VkResult vkCreateGraphicsPipelines(
-    //     VkDevice                                    device,
-    //     VkPipelineCache                             pipelineCache,
-    //     uint32_t                                    createInfoCount,
-    //     const VkGraphicsPipelineCreateInfo*         pCreateInfos,
-    //     const VkAllocationCallbacks*                pAllocator,
-    //     VkPipeline*                                 pPipelines);
-    if(check_vulkan(vkCreateGraphicsPipelines(
-                vc->device_
-            ,   VK_NULL_HANDLE
-            ,   1
+    if(check(get_graphics_pipeline_permutation(
+                &vr->graphics_pipeline_
+            ,   vc
             ,   &vr->graphics_pipeline_create_info_
-            ,   NULL
-            ,   &vr->graphics_pipeline_
+            ,   shader_names
+            ,   array_count(shader_names)
             )
         )
     )
@@ -1050,12 +1060,24 @@ make_rob_sprite(
 {
     require(out_rob) ;
 
+    if(!rob_pool_.memory_)
+    {
+        check(create_typed_stable_pool(&rob_pool_, vulkan_rob, max_vulkan_render_objects)) ;
+    }
+
+    pool_handle const h = alloc_pool_element(&rob_pool_) ;
+    require(is_pool_handle_valid(&rob_pool_, h)) ;
+
     out_rob->create_func_   = create_rob ;
     out_rob->draw_func_     = draw_rob ;
     out_rob->update_func_   = update_rob ;
     out_rob->record_func_   = record_rob ;
+    out_rob->simulate_func_ = NULL ;
+    out_rob->pack_func_     = NULL ;
     out_rob->destroy_func_  = destroy_rob ;
-    out_rob->param_         = &the_vulkan_rob_ ;
+    out_rob->param_         = &rob_pool_ ;
+    out_rob->handle_        = h ;
     out_rob->vc_            = NULL ;
+    out_rob->animated_      = true ;
 }
 
@@ -1,5 +1,6 @@
 #include "app.h"
 #include "vulkan.h"
+#include "pool.h"
 #include "defines.h"
 #include "debug.h"
 #include "check.h"
@@ -70,6 +71,9 @@ typedef struct vulkan_rob
     VkShaderModule  vert_shader_ ;
     VkShaderModule  frag_shader_ ;
 
+    spirv_reflection const *   vert_reflection_ ;
+    spirv_reflection const *   frag_reflection_ ;
+
 
     VkPipelineShaderStageCreateInfo pipeline_shader_stage_create_infos_[max_vulkan_pipeline_shader_stage_create_infos] ;
     uint32_t                        pipeline_shader_stage_create_infos_count_ ;
@@ -96,12 +100,27 @@ typedef struct vulkan_rob
     VkDynamicState  dynamic_states_[max_vulkan_dynamic_states] ;
     uint32_t        dynamic_states_count_ ;
 
+    sprite_2d_ptr   sprite_asset_ptr_ ;
+    pool            sprites_ ;
+
 } vulkan_rob ;
 
 
 
-static vulkan_rob       the_vulkan_rob_ = { 0 } ;
-static sprite_2d_ptr    the_sprite_asset_ptr_ = { 0 } ;
+static pool     rob_pool_ = { 0 } ;
+
+
+static vulkan_rob *
+get_rob(
+    vulkan_render_object const *    vro
+)
+{
+    require(vro) ;
+    require(vro->param_ == &rob_pool_) ;
+    vulkan_rob * vr = pool_get(vulkan_rob, &rob_pool_, vro->handle_) ;
+    require(vr) ;
+    return vr ;
+}
 
 
 //////////////////////////////////////7
@@ -133,6 +152,13 @@ static uint32_t const   indices_count = array_count(indices) ;
 #define max_ubo_instance_count  32
 
 
+static char const * const shader_names[] =
+{
+    "ass/shaders/sprite_animation_shader.vert.spv"
+,   "ass/shaders/sprite_animation_shader.frag.spv"
+} ;
+
+
 typedef struct uniform_buffer_object
 {
     vec4 pos_[max_ubo_instance_count][4] ;
@@ -164,17 +190,14 @@ typedef struct sprite
 } sprite ;
 
 
-//static sprite sprites_[max_vulkan_frames_in_flight][max_ubo_instance_count] = { 0 } ;
-static sprite sprites_[max_ubo_instance_count] = { 0 } ;
-
-
 static rect_2d_vertices *
 get_rect_2d_vertices(
-    sprite const * s
+    sprite_2d_ptr const *   p
+,   sprite const *          s
 )
 {
+    require(p) ;
     require(s) ;
-    sprite_2d_ptr * p = &the_sprite_asset_ptr_ ;
     uint16_t const fc = p->groups_[s->group_index_].frame_count_ ;
     uint16_t const fs = p->groups_[s->group_index_].frame_start_ ;
 
@@ -204,9 +227,18 @@ get_rect_2d_vertices(
 
 
 
-static void
-init_sprites()
+static bool
+init_sprites(
+    vulkan_rob *    vr
+)
 {
+    require(vr) ;
+
+    if(check(create_typed_pool(&vr->sprites_, sprite, max_ubo_instance_count)))
+    {
+        return false ;
+    }
+
     float angle = 0.0f ;
     float angle_inc = 2.0f * M_PI / max_ubo_instance_count ;
     float ox  = app_->half_window_width_float_ - half_spw ;
@@ -214,36 +246,34 @@ init_sprites()
     float oxr = app_->half_window_width_float_ - half_spw ;
     float oyr = app_->half_window_height_float_ - half_sph ;
 
-    // for(
-    //     uint32_t fif = 0
-    // ;   fif < max_vulkan_frames_in_flight
-    // ;   ++fif
-    // )
+    for(
+        uint32_t i = 0
+    ;   i < max_ubo_instance_count
+    ;   ++i
+    )
     {
-        for(
-            uint32_t i = 0
-        ;   i < max_ubo_instance_count
-        ;   ++i
-        )
-        {
-            //sprite * spr = &sprites_[fif][i] ;
-            sprite * spr = &sprites_[i] ;
-            spr->group_index_ = i % 2 ;
-            spr->anim_phase_ = (i*2) % 60 ;
-            spr->px_ = ox + oxr * sinf(angle) ;
-            spr->py_ = oy + oyr * cosf(angle) ;
-            angle += angle_inc ;
-        }
+        pool_handle const h = alloc_pool_element(&vr->sprites_) ;
+        sprite * spr = pool_get(sprite, &vr->sprites_, h) ;
+        require(spr) ;
+        spr->group_index_ = i % 2 ;
+        spr->anim_phase_ = (i*2) % 60 ;
+        spr->px_ = ox + oxr * sinf(angle) ;
+        spr->py_ = oy + oyr * cosf(angle) ;
+        angle += angle_inc ;
     }
+
+    return true ;
 }
 
 
 static void
 init_sprites_2(
-    uint32_t const  current_frame
+    vulkan_rob *    vr
+,   uint32_t const  current_frame
 ,   float const     delta_time
 )
 {
+    require(vr) ;
     require(current_frame < max_vulkan_frames_in_flight) ;
 
     float angle = delta_time ;
@@ -253,14 +283,16 @@ init_sprites_2(
     float oxr = app_->half_window_width_float_ - half_spw ;
     float oyr = app_->half_window_height_float_ - half_sph ;
 
+    sprite *        sprites         = pool_data(sprite, &vr->sprites_) ;
+    uint32_t const  sprites_count   = pool_count(&vr->sprites_) ;
+
     for(
         uint32_t i = 0
-    ;   i < max_ubo_instance_count
+    ;   i < sprites_count
     ;   ++i
     )
     {
-        //sprite * spr = &sprites_[current_frame][i] ;
-        sprite * spr = &sprites_[i] ;
+        sprite * spr = &sprites[i] ;
         ++spr->anim_phase_ ;
         if(spr->group_index_ == 0)
         {
@@ -307,7 +339,7 @@ update_uniform_buffer(
     // float const oy = app_->half_window_height_float_ - half_sph ;
     // float const oxr = 6.0f * half_spw * sinf(fractional_seconds * 0.5f) ;
     // float const oyr = 4.0f * half_sph * sinf(fractional_seconds * 0.5f) ;
-    init_sprites_2(current_frame, fractional_seconds) ;
+    init_sprites_2(vr, current_frame, fractional_seconds) ;
 
     uniform_buffer_object * ubo = &ubos[current_frame] ;
 
@@ -316,15 +348,18 @@ update_uniform_buffer(
     ubo->scale_[0]  = app_->inverse_half_window_width_float_ ;
     ubo->scale_[1]  = app_->inverse_half_window_height_float_ ;
 
+    sprite const *  sprites         = pool_data(sprite, &vr->sprites_) ;
+    uint32_t const  sprites_count   = pool_count(&vr->sprites_) ;
+    require(sprites_count <= max_ubo_instance_count) ;
+
     for(
         uint32_t i = 0
-    ;   i < max_ubo_instance_count
+    ;   i < sprites_count
     ;   ++i
     )
     {
-        //sprite * spr = &sprites_[current_frame][i] ;
-        sprite * spr = &sprites_[i] ;
-        SDL_memcpy(&ubo->pos_[i], get_rect_2d_vertices(spr), sizeof(rect_2d_vertices)) ;
+        sprite const * spr = &sprites[i] ;
+        SDL_memcpy(&ubo->pos_[i], get_rect_2d_vertices(&vr->sprite_asset_ptr_, spr), sizeof(rect_2d_vertices)) ;
         ubo->ori_[i][0] = spr->px_ ;
         ubo->ori_[i][1] = spr->py_ ;
         ubo->ori_[i][2] = 0 ;
@@ -411,7 +446,8 @@ record_command_buffer(
     //     uint32_t                                    firstIndex,
     //     int32_t                                     vertexOffset,
     //     uint32_t                                    firstInstance);
-    vkCmdDrawIndexed(command_buffer, indices_count, max_ubo_instance_count, 0, 0, 0) ;
+    vkCmdDrawIndexed(command_buffer, indices_count, pool_count(&vr->sprites_), 0, 0, 0) ;
+    add_vulkan_draw_stats(vc, 1, pool_count(&vr->sprites_)) ;
 
     end_timed_block() ;
     return true ;
@@ -420,16 +456,15 @@ record_command_buffer(
 
 static bool
 update_rob(
-    vulkan_context *    vc
-,   void *              param
-,   uint32_t const      current_frame
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
 )
 {
     require(vc) ;
     begin_timed_block() ;
 
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
 
     update_uniform_buffer(vc, vr, current_frame) ;
 
@@ -440,15 +475,14 @@ update_rob(
 
 static bool
 record_rob(
-    vulkan_context *    vc
-,   void *              param
-,   uint32_t const      current_frame
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
 )
 {
     require(vc) ;
     begin_timed_block() ;
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
 
     require(current_frame < vc->frames_in_flight_count_) ;
 
@@ -472,15 +506,14 @@ record_rob(
 
 static bool
 draw_rob(
-    vulkan_context *    vc
-,   void *              param
-,   uint32_t const      current_frame
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
 )
 {
     require(vc) ;
     begin_timed_block() ;
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
     require(current_frame < vc->frames_in_flight_count_) ;
 
     if(vc->enable_pre_record_command_buffers_)
@@ -509,15 +542,14 @@ draw_rob(
 
 static bool
 destroy_rob(
-    vulkan_context *    vc
-,   void *              param
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
 )
 {
     require(vc) ;
     begin_timed_block() ;
 
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
 
     if(vr->texture_sampler_)
     {
@@ -547,7 +579,7 @@ destroy_rob(
 
     if(vr->texture_image_memory_)
     {
-        vkFreeMemory(vc->device_, vr->texture_image_memory_, NULL) ;
+        free_device_memory(vc->device_, vr->texture_image_memory_) ;
         vr->texture_image_memory_ = NULL ;
     }
 
@@ -559,7 +591,7 @@ destroy_rob(
     {
         vkDestroyBuffer(vc->device_, vr->uniform_buffers_[i], NULL) ;
         vr->uniform_buffers_[i] = NULL ;
-        vkFreeMemory(vc->device_, vr->uniform_buffers_memory_[i], NULL) ;
+        free_device_memory(vc->device_, vr->uniform_buffers_memory_[i]) ;
         vr->uniform_buffers_memory_[i] = NULL ;
     }
 
@@ -593,7 +625,7 @@ destroy_rob(
 
     if(vr->index_buffer_memory_)
     {
-        vkFreeMemory(vc->device_, vr->index_buffer_memory_, NULL) ;
+        free_device_memory(vc->device_, vr->index_buffer_memory_) ;
         vr->index_buffer_memory_ = NULL ;
     }
 
@@ -615,18 +647,13 @@ destroy_rob(
         //     VkDeviceMemory                              memory,
         //     const VkAllocationCallbacks*                pAllocator);
         //     }
-        vkFreeMemory(vc->device_, vr->vertex_buffer_memory_, NULL) ;
+        free_device_memory(vc->device_, vr->vertex_buffer_memory_) ;
         vr->vertex_buffer_memory_ = NULL ;
     }
 
     if(vr->graphics_pipeline_)
     {
-        // void vkDestroyPipeline(
-        //     VkDevice                                    device,
-        //     VkPipeline                                  pipeline,
-        //     const VkAllocationCallbacks*                pAllocator);
-        vkDestroyPipeline(vc->device_, vr->graphics_pipeline_, NULL) ;
-        vr->graphics_pipeline_ = NULL ;
+        release_graphics_pipeline_permutation(vc, &vr->graphics_pipeline_) ;
     }
 
     if(vr->pipeline_layout_)
@@ -639,6 +666,20 @@ destroy_rob(
         vr->pipeline_layout_ = NULL ;
     }
 
+    destroy_pool(&vr->sprites_) ;
+
+    if(vr->sprite_asset_ptr_.this_)
+    {
+        free_memory(vr->sprite_asset_ptr_.this_) ;
+        vr->sprite_asset_ptr_.this_ = NULL ;
+    }
+
+    check(free_pool_element(&rob_pool_, vro->handle_)) ;
+    if(0 == pool_count(&rob_pool_))
+    {
+        destroy_pool(&rob_pool_) ;
+    }
+
     end_timed_block() ;
     return true ;
 }
@@ -646,15 +687,14 @@ destroy_rob(
 
 static bool
 create_rob(
-    vulkan_context *    vc
-,   void *              param
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
 )
 {
     require(vc) ;
     begin_timed_block() ;
 
-    vulkan_rob *    vr = &the_vulkan_rob_ ;
-    require(vr == param) ;
+    vulkan_rob *    vr = get_rob(vro) ;
 
     // 1 == means no mip maps
     // 0 == auto mipmap generation
@@ -671,22 +711,50 @@ create_rob(
 
     require(vr->texture_anisotropy_ <= vc->picked_physical_device_->properties_.limits.maxSamplerAnisotropy) ;
 
-    add_desriptor_set_layout_binding(
-        vr->descriptor_set_layout_bindings_
-    ,   &vr->descriptor_set_layout_bindings_count_
-    ,   max_vulkan_descriptor_set_layout_binding
-    ,   0
-    ,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
-    ,   VK_SHADER_STAGE_VERTEX_BIT
-    ) ;
+    if(check(load_shader_file(
+                &vr->vert_shader_
+            ,   &vr->vert_reflection_
+            ,   vc->device_
+            ,   shader_names[0]
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->vert_shader_) ;
+    require(vr->vert_reflection_) ;
 
-    add_desriptor_set_layout_binding(
+    if(check(load_shader_file(
+                &vr->frag_shader_
+            ,   &vr->frag_reflection_
+            ,   vc->device_
+            ,   shader_names[1]
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->frag_shader_) ;
+    require(vr->frag_reflection_) ;
+
+    // the glsl uniform block and uniform_buffer_object have to match.
+    spirv_descriptor_binding const * ubo_binding = find_spirv_descriptor_binding(vr->vert_reflection_, 0, 0) ;
+    require(ubo_binding) ;
+    require(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER == ubo_binding->type_) ;
+    require(uniform_buffer_object_size == ubo_binding->block_size_) ;
+
+    spirv_reflection const * reflections[] = { vr->vert_reflection_, vr->frag_reflection_ } ;
+
+    add_reflected_descriptor_set_layout_bindings(
         vr->descriptor_set_layout_bindings_
     ,   &vr->descriptor_set_layout_bindings_count_
     ,   max_vulkan_descriptor_set_layout_binding
-    ,   1
-    ,   VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
-    ,   VK_SHADER_STAGE_FRAGMENT_BIT
+    ,   reflections
+    ,   array_count(reflections)
     ) ;
 
     if(check(create_descriptor_set_layout(
@@ -723,20 +791,12 @@ create_rob(
     require(vr->pipeline_layout_) ;
 
     require(0 == vr->descriptor_pool_sizes_count_) ;
-    add_descriptor_pool_size(
+    add_descriptor_pool_sizes_from_bindings(
         vr->descriptor_pool_sizes_
     ,   &vr->descriptor_pool_sizes_count_
     ,   max_vulkan_descriptor_pool_size
-    ,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
-    ,   vc->frames_in_flight_count_
-    ) ;
-    require(1 == vr->descriptor_pool_sizes_count_) ;
-
-    add_descriptor_pool_size(
-        vr->descriptor_pool_sizes_
-    ,   &vr->descriptor_pool_sizes_count_
-    ,   max_vulkan_descriptor_pool_size
-    ,   VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+    ,   vr->descriptor_set_layout_bindings_
+    ,   vr->descriptor_set_layout_bindings_count_
     ,   vc->frames_in_flight_count_
     ) ;
 
@@ -926,38 +986,13 @@ create_rob(
     require(vr->index_buffer_) ;
     require(vr->index_buffer_memory_) ;
 
-    if(check(load_shader_file(
-                &vr->vert_shader_
-            ,   vc->device_
-            ,   "ass/shaders/sprite_animation_shader.vert.spv"
-            )
-        )
-    )
-    {
-        end_timed_block() ;
-        return false ;
-    }
-    require(vr->vert_shader_) ;
-
-    if(check(load_shader_file(
-                &vr->frag_shader_
-            ,   vc->device_
-            ,   "ass/shaders/sprite_animation_shader.frag.spv"
-            )
-        )
-    )
-    {
-        end_timed_block() ;
-        return false ;
-    }
-    require(vr->frag_shader_) ;
-
     add_pipeline_shader_stage_create_info(
         vr->pipeline_shader_stage_create_infos_
     ,   &vr->pipeline_shader_stage_create_infos_count_
     ,   max_vulkan_pipeline_shader_stage_create_infos
     ,   vr->vert_shader_
     ,   VK_SHADER_STAGE_VERTEX_BIT
+    ,   NULL
     ) ;
 
     add_pipeline_shader_stage_create_info(
@@ -966,44 +1001,27 @@ create_rob(
     ,   max_vulkan_pipeline_shader_stage_create_infos
     ,   vr->frag_shader_
     ,   VK_SHADER_STAGE_FRAGMENT_BIT
+    ,   NULL
     ) ;
 
     fill_vertex_input_binding_description(
         &vr->vertex_input_binding_description_
     ,   0
     ,   vertex_size
+    ,   VK_VERTEX_INPUT_RATE_VERTEX
     ) ;
 
-    add_vertex_input_attribute_description(
+    // the corners come from the uniform buffer, the shader has no inputs.
+    add_reflected_vertex_input_attribute_descriptions(
         vr->vertex_input_attribute_descriptions_
     ,   &vr->vertex_input_attribute_descriptions_count_
     ,   max_vulkan_vertex_input_attribute_descriptions
+    ,   vr->vert_reflection_
     ,   0
+    ,   NULL
     ,   0
-    ,   VK_FORMAT_R32G32_SFLOAT
-    ,   offsetof(vertex, pos)
-    ) ;
-
-    add_vertex_input_attribute_description(
-        vr->vertex_input_attribute_descriptions_
-    ,   &vr->vertex_input_attribute_descriptions_count_
-    ,   max_vulkan_vertex_input_attribute_descriptions
-    ,   1
-    ,   0
-    ,   VK_FORMAT_R32G32_SFLOAT
-    ,   offsetof(vertex, uv)
     ) ;
 
-    // add_vertex_input_attribute_description(
-    //     vr->vertex_input_attribute_descriptions_
-    // ,   &vr->vertex_input_attribute_descriptions_count_
-    // ,   max_vulkan_vertex_input_attribute_descriptions
-    // ,   2
-    // ,   0
-    // ,   VK_FORMAT_R32G32B32_SFLOAT
-    // ,   offsetof(vertex, color)
-    // ) ;
-
     fill_pipeline_vertex_input_state_create_info(
         &vr->pipeline_vertex_input_state_create_info_
     ,   &vr->vertex_input_binding_description_
@@ -1079,7 +1097,7 @@ create_rob(
 
     fill_pipeline_color_blend_attachment_state(
         &vr->pipeline_color_blend_attachment_state_
-    ,   VK_FALSE
+    ,   vulkan_blend_mode_none
     ) ;
 
     fill_pipeline_color_blend_state_create_info(
@@ -1112,20 +1130,12 @@ create_rob(
     ,   &vr->pipeline_dynamic_state_create_info_
     ) ;
 
-    // VkResult vkCreateGraphicsPipelines(
-    //     VkDevice                                    device,
-    //     VkPipelineCache                             pipelineCache,
-    //     uint32_t                                    createInfoCount,
-    //     const VkGraphicsPipelineCreateInfo*         pCreateInfos,
-    //     const VkAllocationCallbacks*                pAllocator,
-    //     VkPipeline*                                 pPipelines);
-    if(check_vulkan(vkCreateGraphicsPipelines(
-                vc->device_
-            ,   VK_NULL_HANDLE
-            ,   1
+    if(check(get_graphics_pipeline_permutation(
+                &vr->graphics_pipeline_
+            ,   vc
             ,   &vr->graphics_pipeline_create_info_
-            ,   NULL
-            ,   &vr->graphics_pipeline_
+            ,   shader_names
+            ,   array_count(shader_names)
             )
         )
     )
@@ -1140,8 +1150,13 @@ create_rob(
     vkDestroyShaderModule(vc->device_, vr->frag_shader_, NULL) ;
     vr->frag_shader_ = NULL ;
 
-    the_sprite_asset_ptr_ = load_asset_sprite("ass/sprites/test_cube_suzanne/test_cube_suzanne.sprf") ;
-    init_sprites() ;
+    vr->sprite_asset_ptr_ = load_asset_sprite("ass/sprites/test_cube_suzanne/test_cube_suzanne.sprf") ;
+
+    if(check(init_sprites(vr)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
 
     end_timed_block() ;
     return true ;
@@ -1155,12 +1170,24 @@ make_rob_sprite_animation(
 {
     require(out_rob) ;
 
+    if(!rob_pool_.memory_)
+    {
+        check(create_typed_stable_pool(&rob_pool_, vulkan_rob, max_vulkan_render_objects)) ;
+    }
+
+    pool_handle const h = alloc_pool_element(&rob_pool_) ;
+    require(is_pool_handle_valid(&rob_pool_, h)) ;
+
     out_rob->create_func_   = create_rob ;
     out_rob->draw_func_     = draw_rob ;
     out_rob->update_func_   = update_rob ;
     out_rob->record_func_   = record_rob ;
+    out_rob->simulate_func_ = NULL ;
+    out_rob->pack_func_     = NULL ;
     out_rob->destroy_func_  = destroy_rob ;
-    out_rob->param_         = &the_vulkan_rob_ ;
+    out_rob->param_         = &rob_pool_ ;
+    out_rob->handle_        = h ;
     out_rob->vc_            = NULL ;
+    out_rob->animated_      = true ;
 }
 
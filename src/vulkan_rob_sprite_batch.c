@@ -0,0 +1,1715 @@
+#include "app.h"
+#include "vulkan.h"
+#include "pool.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "log.h"
+#include "asset_sprite.h"
+#include "sprite_batch.h"
+#include "sprite_animation.h"
+#include "spatial_grid.h"
+#include "frame_packet.h"
+
+
+#include <cglm/vec2.h>
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_filesystem.h>
+
+
+#define max_vulkan_descriptor_set_layout_binding        4
+#define max_vulkan_descriptor_pool_size                 4
+#define max_vulkan_pipeline_shader_stage_create_infos   2
+#define max_vulkan_vertex_input_attribute_descriptions  7
+#define max_vulkan_dynamic_states                       2
+#define max_vulkan_descriptor_buffer_infos              1
+#define max_vulkan_descriptor_image_infos               1
+#define max_vulkan_write_descriptor_sets                2
+
+
+// Every atlas has its own texture and descriptor sets, a draw binds the set
+// of the atlas its sprites come from.
+typedef struct vulkan_rob_atlas
+{
+    sprite_2d_ptr       sprite_asset_ptr_ ;
+
+    uint32_t            texture_mip_levels_ ;
+    VkFormat            texture_format_ ;
+    VkImage             texture_image_ ;
+    VkDeviceMemory      texture_image_memory_ ;
+    VkImageView         texture_image_view_ ;
+    VkSampler           texture_sampler_ ;
+
+    VkDescriptorSet                 descriptor_sets_[max_vulkan_frames_in_flight] ;
+    VkDescriptorBufferInfo          descriptor_buffer_infos_[max_vulkan_frames_in_flight * max_vulkan_descriptor_buffer_infos] ;
+    uint32_t                        descriptor_buffer_infos_count_ ;
+    VkDescriptorImageInfo           descriptor_image_infos_[max_vulkan_frames_in_flight * max_vulkan_descriptor_image_infos] ;
+    uint32_t                        descriptor_image_infos_count_ ;
+    VkWriteDescriptorSet            write_descriptor_sets_[max_vulkan_frames_in_flight * max_vulkan_write_descriptor_sets] ;
+    uint32_t                        write_descriptor_sets_count_ ;
+
+    VkDescriptorPoolSize            descriptor_pool_sizes_[max_vulkan_descriptor_pool_size] ;
+    uint32_t                        descriptor_pool_sizes_count_ ;
+    VkDescriptorPool                descriptor_pool_ ;
+
+} vulkan_rob_atlas ;
+
+
+// The opaque and the translucent pipeline differ in blending, depth writes
+// and the fragment specialization, the other states are shared.
+typedef struct vulkan_rob_pipeline
+{
+    vulkan_specialization           frag_specialization_ ;
+
+    VkPipelineShaderStageCreateInfo pipeline_shader_stage_create_infos_[max_vulkan_pipeline_shader_stage_create_infos] ;
+    uint32_t                        pipeline_shader_stage_create_infos_count_ ;
+
+    VkPipelineColorBlendAttachmentState     pipeline_color_blend_attachment_state_ ;
+    VkPipelineColorBlendStateCreateInfo     pipeline_color_blend_state_create_info_ ;
+    VkPipelineDepthStencilStateCreateInfo   pipeline_depth_stencil_state_create_info_ ;
+    VkGraphicsPipelineCreateInfo            graphics_pipeline_create_info_ ;
+    VkPipeline                              graphics_pipeline_ ;
+
+} vulkan_rob_pipeline ;
+
+
+typedef struct vulkan_rob
+{
+    VkDescriptorSetLayoutBinding    descriptor_set_layout_bindings_[max_vulkan_descriptor_set_layout_binding] ;
+    uint32_t                        descriptor_set_layout_bindings_count_ ;
+    VkDescriptorSetLayout           descriptor_set_layout_ ;
+
+    VkBuffer        uniform_buffers_[max_vulkan_frames_in_flight] ;
+    VkDeviceMemory  uniform_buffers_memory_[max_vulkan_frames_in_flight] ;
+    void *          uniform_buffers_mapped_[max_vulkan_frames_in_flight] ;
+
+    VkPipelineLayoutCreateInfo      pipeline_layout_create_info_ ;
+    VkPipelineLayout                pipeline_layout_ ;
+
+    VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info_ ;
+
+    VkBool32            texture_enable_anisotropy_ ;
+    float               texture_anisotropy_ ;
+
+    vulkan_rob_atlas    atlases_[max_sprite_batch_atlases] ;
+    uint32_t            atlases_count_ ;
+    bool                premultiplied_alpha_ ;
+
+    VkBuffer        vertex_buffers_[max_vulkan_frames_in_flight] ;
+    VkDeviceMemory  vertex_buffers_memory_[max_vulkan_frames_in_flight] ;
+    void *          vertex_buffers_mapped_[max_vulkan_frames_in_flight] ;
+    VkBuffer        index_buffer_ ;
+    VkDeviceMemory  index_buffer_memory_ ;
+
+    VkShaderModule  vert_shader_ ;
+    VkShaderModule  frag_shader_ ;
+
+    spirv_reflection const *   vert_reflection_ ;
+    spirv_reflection const *   frag_reflection_ ;
+
+    vulkan_rob_pipeline        pipelines_[sprite_batch_pipelines_count] ;
+
+    VkVertexInputBindingDescription vertex_input_binding_description_ ;
+
+    VkVertexInputAttributeDescription   vertex_input_attribute_descriptions_[max_vulkan_vertex_input_attribute_descriptions] ;
+    uint32_t                            vertex_input_attribute_descriptions_count_ ;
+
+    VkPipelineVertexInputStateCreateInfo    pipeline_vertex_input_state_create_info_ ;
+    VkPipelineInputAssemblyStateCreateInfo  pipeline_input_assembly_state_create_info_ ;
+    VkPipelineViewportStateCreateInfo       pipeline_viewport_state_create_info_ ;
+    VkPipelineDynamicStateCreateInfo        pipeline_dynamic_state_create_info_ ;
+    VkPipelineRasterizationStateCreateInfo  pipeline_rasterization_state_create_info_ ;
+    VkPipelineMultisampleStateCreateInfo    pipeline_multisample_state_create_info_ ;
+
+    VkViewport  viewport_ ;
+    VkRect2D    scissor_ ;
+
+    VkDynamicState  dynamic_states_[max_vulkan_dynamic_states] ;
+    uint32_t        dynamic_states_count_ ;
+
+    sprite_batch    batch_ ;
+    sprite_animator animator_ ;
+    float           scene_time_ ;
+    pool            sprites_ ;
+    spatial_grid    grid_ ;
+    uint32_t *      candidate_sprites_ ;
+    uint32_t        sprite_count_ ;
+    uint32_t        instance_capacity_ ;
+
+} vulkan_rob ;
+
+
+
+static pool     rob_pool_ = { 0 } ;
+
+
+static vulkan_rob *
+get_rob(
+    vulkan_render_object const *    vro
+)
+{
+    require(vro) ;
+    require(vro->param_ == &rob_pool_) ;
+    vulkan_rob * vr = pool_get(vulkan_rob, &rob_pool_, vro->handle_) ;
+    require(vr) ;
+    return vr ;
+}
+
+
+// a fan over the hull, max_rect_2d_hull_vertices of it.
+static uint16_t const indices[] =
+{
+    0, 1, 2
+,   0, 2, 3
+,   0, 3, 4
+,   0, 4, 5
+,   0, 5, 6
+,   0, 6, 7
+} ;
+static_require(array_count(indices) == (max_rect_2d_hull_vertices - 2) * 3, "fix me!") ;
+static uint32_t const   indices_size = sizeof(indices) ;
+static uint32_t const   indices_count = array_count(indices) ;
+
+
+// indexed by the shader input location.
+static vulkan_vertex_input_layout const vertex_input_layouts[] =
+{
+    { offsetof(sprite_instance, p01_),   VK_FORMAT_UNDEFINED }
+,   { offsetof(sprite_instance, p23_),   VK_FORMAT_UNDEFINED }
+,   { offsetof(sprite_instance, t01_),   VK_FORMAT_UNDEFINED }
+,   { offsetof(sprite_instance, t23_),   VK_FORMAT_UNDEFINED }
+,   { offsetof(sprite_instance, st_[0]), VK_FORMAT_UNDEFINED }
+,   { offsetof(sprite_instance, st_[4]), VK_FORMAT_UNDEFINED }
+,   { offsetof(sprite_instance, color_), VK_FORMAT_R8G8B8A8_UNORM }
+,   { offsetof(sprite_instance, z_),     VK_FORMAT_UNDEFINED }
+} ;
+
+
+// layout(constant_id = n) in sprite_batch_shader.frag
+#define alpha_cutoff_constant_id        0
+#define premultiplied_alpha_constant_id 1
+
+#define sprite_batch_alpha_cutoff   0.1f
+
+
+static char const * const shader_names[] =
+{
+    "ass/shaders/sprite_batch_shader.vert.spv"
+,   "ass/shaders/sprite_batch_shader.frag.spv"
+} ;
+
+
+typedef struct uniform_buffer_object
+{
+    vec2 offset_ ;
+    vec2 scale_ ;
+
+} uniform_buffer_object ;
+
+
+static uint32_t const uniform_buffer_object_size = sizeof(uniform_buffer_object) ;
+
+
+// texture_asset_name_ is the precomputed mip chain threed_atlas writes,
+// without it the png is loaded and its mips are made on the gpu.
+typedef struct atlas_file
+{
+    char const *    sprite_name_ ;
+    char const *    texture_name_ ;
+    char const *    texture_asset_name_ ;
+
+} atlas_file ;
+
+
+static atlas_file const atlas_files[] =
+{
+    {   "ass/sprites/test_cube_suzanne/test_cube_suzanne.sprf"
+    ,   "ass/sprites/test_cube_suzanne/test_cube_suzanne_0.png"
+    ,   "ass/sprites/test_cube_suzanne/test_cube_suzanne_0.tex"
+    }
+} ;
+
+
+//////////////////////////////////////7
+
+#define scene_grid_cell_size    256.0f
+#define scene_grid_buckets      1024
+
+
+static float const spw = 256.0f ;
+static float const sph = 256.0f ;
+static float const half_spw = spw / 2.0f ;
+static float const half_sph = sph / 2.0f ;
+
+
+// px_, py_ are from the last simulation step, prev_ from the one before and
+// draw_ in between for the frame being drawn.
+typedef struct sprite
+{
+    float       px_ ;
+    float       py_ ;
+    float       prev_px_ ;
+    float       prev_py_ ;
+    float       draw_px_ ;
+    float       draw_py_ ;
+    uint16_t    atlas_index_ ;
+    uint16_t    group_index_ ;
+    uint32_t    animation_ ;
+    uint8_t     layer_ ;
+} sprite ;
+
+
+// both frames while an animation blends between groups, faded by the tint.
+static void
+submit_animated_sprite(
+    vulkan_rob *                vr
+,   sprite const *              spr
+,   sprite_transform const *    st
+)
+{
+    require(vr) ;
+    require(spr) ;
+    require(st) ;
+
+    sprite_animator const * sa  = &vr->animator_ ;
+    uint32_t const          a   = spr->animation_ ;
+    float const             w   = sa->blend_weight_[a] ;
+
+    if(w <= 0.0f)
+    {
+        submit_sprite(&vr->batch_, spr->atlas_index_, sa->frame_[a], st, spr->layer_, sprite_tint_white) ;
+        return ;
+    }
+
+    uint8_t const blend_alpha = (uint8_t) (w * 255.0f + 0.5f) ;
+    submit_sprite(&vr->batch_, spr->atlas_index_, sa->blend_frame_[a], st, spr->layer_, make_sprite_tint(255, 255, 255, blend_alpha)) ;
+    submit_sprite(&vr->batch_, spr->atlas_index_, sa->frame_[a], st, spr->layer_, make_sprite_tint(255, 255, 255, 255 - blend_alpha)) ;
+}
+
+
+// the positions only depend on the scene time, the previous ones are kept
+// for drawing in between two steps.
+static void
+move_sprites(
+    vulkan_rob *    vr
+)
+{
+    require(vr) ;
+
+    float angle = vr->scene_time_ * 0.5f ;
+    float angle_inc = 2.0f * M_PI / vr->sprite_count_ ;
+    float ox  = app_->half_window_width_float_ - half_spw ;
+    float oy  = app_->half_window_height_float_ - half_sph ;
+    float oxr = app_->half_window_width_float_ - half_spw ;
+    float oyr = app_->half_window_height_float_ - half_sph ;
+
+    sprite *        sprites         = pool_data(sprite, &vr->sprites_) ;
+    uint32_t const  sprites_count   = pool_count(&vr->sprites_) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < sprites_count
+    ;   ++i
+    )
+    {
+        sprite * spr = &sprites[i] ;
+        spr->prev_px_ = spr->px_ ;
+        spr->prev_py_ = spr->py_ ;
+        if(spr->group_index_ == 0)
+        {
+            spr->px_ = ox + oxr * sinf(angle) * cosf(angle*0.1f) ;
+            spr->py_ = oy + oyr * cosf(angle) ;
+        }
+        else
+        {
+            spr->px_ = ox + oxr * sinf(-angle) * cosf(-angle*0.3f);
+            spr->py_ = oy + oyr * cosf(-angle) ;
+        }
+        angle += angle_inc ;
+    }
+}
+
+
+static void
+destroy_scene(
+    vulkan_rob *    vr
+)
+{
+    require(vr) ;
+
+    if(vr->candidate_sprites_)
+    {
+        free_memory(vr->candidate_sprites_) ;
+        vr->candidate_sprites_ = NULL ;
+    }
+    destroy_spatial_grid(&vr->grid_) ;
+    destroy_pool(&vr->sprites_) ;
+    destroy_sprite_animator(&vr->animator_) ;
+    vr->sprite_count_ = 0 ;
+}
+
+
+static bool
+init_scene(
+    vulkan_rob *    vr
+,   uint32_t const  sprite_count
+)
+{
+    require(vr) ;
+    require(sprite_count) ;
+    begin_timed_block() ;
+
+    vr->sprite_count_ = sprite_count ;
+
+    if(check(create_typed_pool(&vr->sprites_, sprite, sprite_count)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    // reserved for the largest group circle, so a build never runs out.
+    float max_radius = 0.0f ;
+    for(
+        uint32_t i = 0
+    ;   i < vr->atlases_count_
+    ;   ++i
+    )
+    {
+        sprite_2d_ptr const * sp = &vr->atlases_[i].sprite_asset_ptr_ ;
+        for(
+            uint32_t g = 0
+        ;   g < sp->this_->groups_count_
+        ;   ++g
+        )
+        {
+            float const r = (float) (sp->groups_[g].bounding_info_.circle_radius_ + 1) ;
+            max_radius = r > max_radius ? r : max_radius ;
+        }
+    }
+
+    uint32_t const item_entries = calc_spatial_grid_item_entries(scene_grid_cell_size, max_radius) ;
+    if(check(create_spatial_grid(&vr->grid_, scene_grid_cell_size, scene_grid_buckets, sprite_count, sprite_count * item_entries)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    vr->candidate_sprites_ = alloc_array(uint32_t, sprite_count) ;
+    if(check(vr->candidate_sprites_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_sprite_animator(&vr->animator_, sprite_count)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < vr->atlases_count_
+    ;   ++i
+    )
+    {
+        uint16_t animator_atlas = 0 ;
+        if(check(add_sprite_animator_atlas(&vr->animator_, &vr->atlases_[i].sprite_asset_ptr_, &animator_atlas)))
+        {
+            end_timed_block() ;
+            return false ;
+        }
+        require(animator_atlas == i) ;
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < sprite_count
+    ;   ++i
+    )
+    {
+        pool_handle const h = alloc_pool_element(&vr->sprites_) ;
+        sprite * spr = pool_get(sprite, &vr->sprites_, h) ;
+        require(spr) ;
+        spr->atlas_index_   = 0 ;
+        spr->group_index_   = i % 2 ;
+        spr->animation_     = add_sprite_animation(&vr->animator_, spr->atlas_index_, spr->group_index_, (float) ((i % 30) * sprite_animation_default_frame_ms)) ;
+        spr->layer_         = (uint8_t) (i % 2) ;
+    }
+
+    // twice, so the first frame doesn't move in from the origin.
+    move_sprites(vr) ;
+    move_sprites(vr) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static void
+simulate_scene(
+    vulkan_rob *    vr
+,   float const     step_seconds
+)
+{
+    require(vr) ;
+    begin_timed_block() ;
+
+    vr->scene_time_ += step_seconds ;
+    move_sprites(vr) ;
+    update_sprite_animations(&vr->animator_, step_seconds) ;
+
+    end_timed_block() ;
+}
+
+
+static void
+update_scene(
+    vulkan_rob *        vr
+,   frame_packet *      fp
+,   float const         alpha
+)
+{
+    require(vr) ;
+    require(fp) ;
+    begin_timed_block() ;
+
+    sprite *        sprites         = pool_data(sprite, &vr->sprites_) ;
+    uint32_t const  sprites_count   = pool_count(&vr->sprites_) ;
+
+    clear_spatial_grid(&vr->grid_) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < sprites_count
+    ;   ++i
+    )
+    {
+        sprite * spr = &sprites[i] ;
+        spr->draw_px_ = spr->prev_px_ + (spr->px_ - spr->prev_px_) * alpha ;
+        spr->draw_py_ = spr->prev_py_ + (spr->py_ - spr->prev_py_) * alpha ;
+
+        // the group's circle covers every frame of the animation, so the
+        // grid doesn't need to know which frame is shown.
+        sprite_2d_ptr const *           sp  = &vr->atlases_[spr->atlas_index_].sprite_asset_ptr_ ;
+        rect_2d_bounding_info const *   bi  = &sp->groups_[spr->group_index_].bounding_info_ ;
+        add_spatial_grid_item(
+            &vr->grid_
+        ,   spr->draw_px_ + (float) bi->circle_offset_x_
+        ,   spr->draw_py_ + (float) bi->circle_offset_y_
+        ,   (float) (bi->circle_radius_ + 1)
+        ) ;
+    }
+
+    build_spatial_grid(&vr->grid_) ;
+
+    // the grid only looks at cells, the batch tests the circles of what it
+    // hands out.
+    uint32_t const candidates_count = gather_spatial_grid_rect(
+        &vr->grid_
+    ,   0.0f
+    ,   0.0f
+    ,   app_->window_width_float_
+    ,   app_->window_height_float_
+    ,   vr->candidate_sprites_
+    ,   vr->sprite_count_
+    ) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < candidates_count
+    ;   ++i
+    )
+    {
+        sprite const * spr = &sprites[vr->candidate_sprites_[i]] ;
+
+        // lower on screen is closer to the viewer.
+        sprite_transform st = { 0 } ;
+        st.px_          = spr->draw_px_ ;
+        st.py_          = spr->draw_py_ ;
+        st.sx_          = 1.0f ;
+        st.sy_          = 1.0f ;
+        st.rotation_    = 0.0f ;
+        st.depth_       = 1.0f - spr->draw_py_ * app_->inverse_half_window_height_float_ * 0.5f ;
+
+        submit_animated_sprite(vr, spr, &st) ;
+    }
+
+    cull_sprite_batch(
+        &vr->batch_
+    ,   0.0f
+    ,   0.0f
+    ,   app_->window_width_float_
+    ,   app_->window_height_float_
+    ) ;
+
+    // submissions, a blending sprite has two. Sprites the grid left out
+    // count as culled once.
+    fp->visible_count_ += vr->batch_.visible_count_ ;
+    fp->culled_count_  += vr->batch_.culled_count_ + sprites_count - candidates_count ;
+
+    end_timed_block() ;
+}
+
+
+// on the main thread, the batch and the scene are only touched here and by
+// simulate_scene.
+static bool
+pack_scene(
+    vulkan_rob *        vr
+,   frame_packet *      fp
+)
+{
+    require(vr) ;
+    require(fp) ;
+    begin_timed_block() ;
+
+    // made again with the new count, e.g. for the next step of a bench.
+    if(app_->scene_sprite_count_ != vr->sprite_count_)
+    {
+        destroy_scene(vr) ;
+        if(check(init_scene(vr, app_->scene_sprite_count_)))
+        {
+            end_timed_block() ;
+            return false ;
+        }
+    }
+
+    clear_sprite_batch(&vr->batch_) ;
+
+    update_scene(vr, fp, app_->simulation_alpha_) ;
+
+    sort_sprite_batch(&vr->batch_) ;
+
+    fp->submissions_count_ = write_sprite_batch(
+        &vr->batch_
+    ,   fp->submissions_
+    ,   fp->submissions_capacity_
+    ) ;
+
+    require(vr->batch_.draws_count_ <= fp->submissions_capacity_) ;
+    fp->draws_count_ = vr->batch_.draws_count_ ;
+    SDL_memcpy(fp->draws_, vr->batch_.draws_, sizeof(sprite_batch_draw) * fp->draws_count_) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static void
+update_buffers(
+    vulkan_context *    vc
+,   vulkan_rob *        vr
+,   uint32_t const      current_frame
+)
+{
+    require(vc) ;
+    require(current_frame < max_vulkan_frames_in_flight) ;
+    require(current_frame < vc->frames_in_flight_count_) ;
+    require(vr) ;
+
+    frame_packet const * fp = vc->frame_packet_ ;
+    require(fp) ;
+
+    add_vulkan_cull_stats(vc, fp->visible_count_, fp->culled_count_) ;
+
+    // the instances are made right in the mapped buffer, the atlases of the
+    // batch are all this reads of it.
+    require(fp->submissions_count_ <= vr->instance_capacity_) ;
+    write_sprite_instances(
+        &vr->batch_
+    ,   fp->submissions_
+    ,   fp->submissions_count_
+    ,   (sprite_instance *) vr->vertex_buffers_mapped_[current_frame]
+    ) ;
+
+    uniform_buffer_object ubo = { 0 } ;
+    ubo.offset_[0] = fp->camera_.offset_x_ ;
+    ubo.offset_[1] = fp->camera_.offset_y_ ;
+    ubo.scale_[0]  = fp->camera_.scale_x_ ;
+    ubo.scale_[1]  = fp->camera_.scale_y_ ;
+
+    SDL_memcpy(vr->uniform_buffers_mapped_[current_frame], &ubo, uniform_buffer_object_size) ;
+}
+
+
+static bool
+record_command_buffer(
+    vulkan_context *    vc
+,   vulkan_rob *        vr
+,   VkCommandBuffer     command_buffer
+,   uint32_t const      current_frame
+)
+{
+    require(vc) ;
+    require(vr) ;
+    require(command_buffer) ;
+    require(current_frame < max_vulkan_frames_in_flight) ;
+
+    begin_timed_block() ;
+
+    // pre recorded command buffers are recorded before the first packet.
+    frame_packet const * fp = vc->frame_packet_ ;
+    if(!fp || !fp->draws_count_)
+    {
+        end_timed_block() ;
+        return true ;
+    }
+
+    VkBuffer vertex_buffers[] = { vr->vertex_buffers_[current_frame] } ;
+    VkDeviceSize offsets[] = { 0 } ;
+
+    // void vkCmdBindVertexBuffers(
+    //     VkCommandBuffer                             commandBuffer,
+    //     uint32_t                                    firstBinding,
+    //     uint32_t                                    bindingCount,
+    //     const VkBuffer*                             pBuffers,
+    //     const VkDeviceSize*                         pOffsets);
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets) ;
+
+
+    // void vkCmdBindIndexBuffer(
+    //     VkCommandBuffer                             commandBuffer,
+    //     VkBuffer                                    buffer,
+    //     VkDeviceSize                                offset,
+    //     VkIndexType                                 indexType);
+    vkCmdBindIndexBuffer(
+        command_buffer
+    ,   vr->index_buffer_
+    ,   0
+    ,   VK_INDEX_TYPE_UINT16
+    ) ;
+
+    uint32_t bound_pipeline = UINT32_MAX ;
+    uint32_t bound_texture  = UINT32_MAX ;
+
+    for(
+        uint32_t i = 0
+    ;   i < fp->draws_count_
+    ;   ++i
+    )
+    {
+        sprite_batch_draw const * d = &fp->draws_[i] ;
+        require(d->pipeline_ < sprite_batch_pipelines_count) ;
+        require(d->texture_ < vr->atlases_count_) ;
+
+        // the draws are sorted by pipeline, each is bound once at most.
+        if(d->pipeline_ != bound_pipeline)
+        {
+            bound_pipeline = d->pipeline_ ;
+
+            // void vkCmdBindPipeline(
+            //     VkCommandBuffer                             commandBuffer,
+            //     VkPipelineBindPoint                         pipelineBindPoint,
+            //     VkPipeline                                  pipeline);
+            vkCmdBindPipeline(
+                command_buffer
+            ,   VK_PIPELINE_BIND_POINT_GRAPHICS
+            ,   vr->pipelines_[bound_pipeline].graphics_pipeline_
+            ) ;
+        }
+
+        if(d->texture_ != bound_texture)
+        {
+            bound_texture = d->texture_ ;
+
+            // void vkCmdBindDescriptorSets(
+            //     VkCommandBuffer                             commandBuffer,
+            //     VkPipelineBindPoint                         pipelineBindPoint,
+            //     VkPipelineLayout                            layout,
+            //     uint32_t                                    firstSet,
+            //     uint32_t                                    descriptorSetCount,
+            //     const VkDescriptorSet*                      pDescriptorSets,
+            //     uint32_t                                    dynamicOffsetCount,
+            //     const uint32_t*                             pDynamicOffsets);
+            vkCmdBindDescriptorSets(
+                command_buffer
+            ,   VK_PIPELINE_BIND_POINT_GRAPHICS
+            ,   vr->pipeline_layout_
+            ,   0
+            ,   1
+            ,   &vr->atlases_[bound_texture].descriptor_sets_[current_frame]
+            ,   0
+            ,   NULL
+            ) ;
+        }
+
+        // void vkCmdDrawIndexed(
+        //     VkCommandBuffer                             commandBuffer,
+        //     uint32_t                                    indexCount,
+        //     uint32_t                                    instanceCount,
+        //     uint32_t                                    firstIndex,
+        //     int32_t                                     vertexOffset,
+        //     uint32_t                                    firstInstance);
+        vkCmdDrawIndexed(command_buffer, indices_count, d->instance_count_, 0, 0, d->first_instance_) ;
+        add_vulkan_draw_stats(vc, 1, d->instance_count_) ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+update_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    update_buffers(vc, vr, current_frame) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+simulate_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   float const             step_seconds
+,   bool *                  out_changed
+)
+{
+    require(vc) ;
+    require(out_changed) ;
+    begin_timed_block() ;
+
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    simulate_scene(vr, step_seconds) ;
+
+    // the sprites follow the scene time, every step moves them.
+    *out_changed = true ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+pack_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   frame_packet *          fp
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    if(check(pack_scene(vr, fp)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+record_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    require(current_frame < vc->frames_in_flight_count_) ;
+
+    if(check(record_command_buffer(
+                vc
+            ,   vr
+            ,   vc->command_buffer_[current_frame]
+            ,   current_frame
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+draw_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+    vulkan_rob *    vr = get_rob(vro) ;
+    require(current_frame < vc->frames_in_flight_count_) ;
+
+    if(vc->enable_pre_record_command_buffers_)
+    {
+        end_timed_block() ;
+        return true ;
+    }
+
+    if(check(record_command_buffer(
+                vc
+            ,   vr
+            ,   vc->command_buffer_[current_frame]
+            ,   current_frame
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static void
+destroy_atlas(
+    vulkan_context *    vc
+,   vulkan_rob_atlas *  va
+)
+{
+    require(vc) ;
+    require(va) ;
+
+    if(va->texture_sampler_)
+    {
+        // void vkDestroySampler(
+        //     VkDevice                                    device,
+        //     VkSampler                                   sampler,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroySampler(vc->device_, va->texture_sampler_, NULL) ;
+        va->texture_sampler_ = NULL ;
+    }
+
+    if(va->texture_image_view_)
+    {
+        vkDestroyImageView(vc->device_, va->texture_image_view_, NULL) ;
+        va->texture_image_view_ = NULL ;
+    }
+
+    if(va->texture_image_)
+    {
+        // void vkDestroyImage(
+        // VkDevice                                    device,
+        // VkImage                                     image,
+        // const VkAllocationCallbacks*                pAllocator);
+        vkDestroyImage(vc->device_, va->texture_image_, NULL) ;
+        va->texture_image_ = NULL ;
+    }
+
+    if(va->texture_image_memory_)
+    {
+        free_device_memory(vc->device_, va->texture_image_memory_) ;
+        va->texture_image_memory_ = NULL ;
+    }
+
+    if(va->descriptor_pool_)
+    {
+        // void vkDestroyDescriptorPool(
+        //     VkDevice                                    device,
+        //     VkDescriptorPool                            descriptorPool,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroyDescriptorPool(vc->device_, va->descriptor_pool_, NULL) ;
+        va->descriptor_pool_ = NULL ;
+    }
+
+    if(va->sprite_asset_ptr_.this_)
+    {
+        free_memory(va->sprite_asset_ptr_.this_) ;
+        va->sprite_asset_ptr_.this_ = NULL ;
+    }
+}
+
+
+static bool
+destroy_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vr->atlases_count_
+    ;   ++i
+    )
+    {
+        destroy_atlas(vc, &vr->atlases_[i]) ;
+    }
+    vr->atlases_count_ = 0 ;
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->frames_in_flight_count_
+    ;   ++i
+    )
+    {
+        vkDestroyBuffer(vc->device_, vr->uniform_buffers_[i], NULL) ;
+        vr->uniform_buffers_[i] = NULL ;
+        free_device_memory(vc->device_, vr->uniform_buffers_memory_[i]) ;
+        vr->uniform_buffers_memory_[i] = NULL ;
+    }
+
+    if(vr->descriptor_set_layout_)
+    {
+        // void vkDestroyDescriptorSetLayout(
+        //     VkDevice                                    device,
+        //     VkDescriptorSetLayout                       descriptorSetLayout,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroyDescriptorSetLayout(vc->device_, vr->descriptor_set_layout_, NULL) ;
+        vr->descriptor_set_layout_ = NULL ;
+    }
+
+
+    if(vr->index_buffer_)
+    {
+        vkDestroyBuffer(vc->device_, vr->index_buffer_, NULL) ;
+        vr->index_buffer_ = NULL ;
+    }
+
+    if(vr->index_buffer_memory_)
+    {
+        free_device_memory(vc->device_, vr->index_buffer_memory_) ;
+        vr->index_buffer_memory_ = NULL ;
+    }
+
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->frames_in_flight_count_
+    ;   ++i
+    )
+    {
+        if(vr->vertex_buffers_[i])
+        {
+            vkDestroyBuffer(vc->device_, vr->vertex_buffers_[i], NULL) ;
+            vr->vertex_buffers_[i] = NULL ;
+        }
+
+        if(vr->vertex_buffers_memory_[i])
+        {
+            free_device_memory(vc->device_, vr->vertex_buffers_memory_[i]) ;
+            vr->vertex_buffers_memory_[i] = NULL ;
+        }
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < sprite_batch_pipelines_count
+    ;   ++i
+    )
+    {
+        if(vr->pipelines_[i].graphics_pipeline_)
+        {
+            release_graphics_pipeline_permutation(vc, &vr->pipelines_[i].graphics_pipeline_) ;
+        }
+    }
+
+    if(vr->pipeline_layout_)
+    {
+        // void vkDestroyPipelineLayout(
+        //     VkDevice                                    device,
+        //     VkPipelineLayout                            pipelineLayout,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroyPipelineLayout(vc->device_, vr->pipeline_layout_, NULL) ;
+        vr->pipeline_layout_ = NULL ;
+    }
+
+    destroy_scene(vr) ;
+    destroy_sprite_batch(&vr->batch_) ;
+
+    check(free_pool_element(&rob_pool_, vro->handle_)) ;
+    if(0 == pool_count(&rob_pool_))
+    {
+        destroy_pool(&rob_pool_) ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+create_atlas(
+    vulkan_context *        vc
+,   vulkan_rob *            vr
+,   vulkan_rob_atlas *      va
+,   atlas_file const *      af
+)
+{
+    require(vc) ;
+    require(vr) ;
+    require(va) ;
+    require(af) ;
+    begin_timed_block() ;
+
+    // 1 == means no mip maps
+    // 0 == auto mipmap generation
+    va->texture_mip_levels_ = 1 ;
+
+    // allow mipmapping when optimal tiling support is available
+    if(
+        vc->picked_physical_device_->swapchain_support_details_.formats_properties_->optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)
+    {
+        va->texture_mip_levels_ = 0 ;
+    }
+
+    va->sprite_asset_ptr_ = load_asset_sprite(af->sprite_name_) ;
+    if(check(va->sprite_asset_ptr_.this_))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    require(0 == va->descriptor_pool_sizes_count_) ;
+    add_descriptor_pool_sizes_from_bindings(
+        va->descriptor_pool_sizes_
+    ,   &va->descriptor_pool_sizes_count_
+    ,   max_vulkan_descriptor_pool_size
+    ,   vr->descriptor_set_layout_bindings_
+    ,   vr->descriptor_set_layout_bindings_count_
+    ,   vc->frames_in_flight_count_
+    ) ;
+
+    if(check(create_descriptor_pool(
+                &va->descriptor_pool_
+            ,   vc->device_
+            ,   va->descriptor_pool_sizes_
+            ,   va->descriptor_pool_sizes_count_
+            ,   vc->frames_in_flight_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(va->descriptor_pool_) ;
+
+    if(check(create_descriptor_sets(
+                va->descriptor_sets_
+            ,   vc->device_
+            ,   vr->descriptor_set_layout_
+            ,   va->descriptor_pool_
+            ,   vc->frames_in_flight_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    SDL_PathInfo info = { 0 } ;
+    if(
+        af->texture_asset_name_
+    &&  SDL_GetPathInfo(af->texture_asset_name_, &info)
+    &&  SDL_PATHTYPE_FILE == info.type
+    )
+    {
+        if(check(create_texture_image_from_asset(
+                    &va->texture_image_
+                ,   &va->texture_image_memory_
+                ,   &va->texture_mip_levels_
+                ,   &va->texture_format_
+                ,   af->texture_asset_name_
+                ,   vc->device_
+                ,   vc->command_pool_
+                ,   vc->graphics_queue_
+                ,   vc->picked_physical_device_
+                ,   va->texture_mip_levels_
+                )
+            )
+        )
+        {
+            end_timed_block() ;
+            return false ;
+        }
+    }
+    else
+    {
+        va->texture_format_ = VK_FORMAT_R8G8B8A8_SRGB ;
+
+        if(check(create_texture_image(
+                    &va->texture_image_
+                ,   &va->texture_image_memory_
+                ,   &va->texture_mip_levels_
+                ,   af->texture_name_
+                ,   vc->device_
+                ,   vc->command_pool_
+                ,   vc->graphics_queue_
+                ,   &vc->picked_physical_device_->memory_properties_
+                ,   va->texture_mip_levels_
+                )
+            )
+        )
+        {
+            end_timed_block() ;
+            return false ;
+        }
+    }
+
+    if(check(create_texture_image_view_with_format(
+                &va->texture_image_view_
+            ,   vc->device_
+            ,   va->texture_image_
+            ,   va->texture_format_
+            ,   va->texture_mip_levels_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_texture_sampler(
+                &va->texture_sampler_
+            ,   vc->device_
+            ,   va->texture_mip_levels_
+            ,   vr->texture_enable_anisotropy_
+            ,   vr->texture_anisotropy_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    add_descriptor_buffer_info(
+        va->descriptor_buffer_infos_
+    ,   &va->descriptor_buffer_infos_count_
+    ,   max_vulkan_descriptor_buffer_infos
+    ,   vc->frames_in_flight_count_
+    ,   vr->uniform_buffers_
+    ,   0
+    ,   uniform_buffer_object_size
+    ) ;
+
+    add_descriptor_image_info(
+        va->descriptor_image_infos_
+    ,   &va->descriptor_image_infos_count_
+    ,   max_vulkan_descriptor_image_infos
+    ,   vc->frames_in_flight_count_
+    ,   va->texture_image_view_
+    ,   va->texture_sampler_
+    ) ;
+
+    add_write_descriptor_buffer_set(
+        va->write_descriptor_sets_
+    ,   &va->write_descriptor_sets_count_
+    ,   max_vulkan_write_descriptor_sets
+    ,   va->descriptor_sets_
+    ,   vc->frames_in_flight_count_
+    ,   va->descriptor_buffer_infos_
+    ,   va->descriptor_buffer_infos_count_
+    ,   max_vulkan_descriptor_buffer_infos
+    ,   vc->frames_in_flight_count_
+    ,   0
+    ,   0
+    ,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+    ) ;
+
+    add_write_descriptor_image_set(
+        va->write_descriptor_sets_
+    ,   &va->write_descriptor_sets_count_
+    ,   max_vulkan_write_descriptor_sets
+    ,   va->descriptor_sets_
+    ,   vc->frames_in_flight_count_
+    ,   va->descriptor_image_infos_
+    ,   va->descriptor_image_infos_count_
+    ,   max_vulkan_descriptor_image_infos
+    ,   vc->frames_in_flight_count_
+    ,   0
+    ,   1
+    ,   VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+    ) ;
+
+    update_descriptor_sets(
+        va->write_descriptor_sets_
+    ,   va->write_descriptor_sets_count_
+    ,   max_vulkan_write_descriptor_sets
+    ,   vc->device_
+    ,   vc->frames_in_flight_count_
+    ) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+// Opaque sprites write depth and don't blend, the frames have full alpha so
+// they take the variant without discard whatever the atlases hold. The
+// translucent ones are tested against that depth without writing it.
+static bool
+create_pipeline(
+    vulkan_context *    vc
+,   vulkan_rob *        vr
+,   uint32_t const      pipeline
+)
+{
+    require(vc) ;
+    require(vr) ;
+    require(pipeline < sprite_batch_pipelines_count) ;
+    begin_timed_block() ;
+
+    vulkan_rob_pipeline *   vp      = &vr->pipelines_[pipeline] ;
+    bool const              opaque  = sprite_batch_pipeline_opaque == pipeline ;
+
+    add_specialization_constant_f32(
+        &vp->frag_specialization_
+    ,   vr->frag_reflection_
+    ,   alpha_cutoff_constant_id
+    ,   sprite_batch_alpha_cutoff
+    ) ;
+
+    // premultiplied atlases are blended and never discard, which keeps the
+    // early fragment tests, straight ones keep the alpha test instead.
+    add_specialization_constant(
+        &vp->frag_specialization_
+    ,   vr->frag_reflection_
+    ,   premultiplied_alpha_constant_id
+    ,   (opaque || vr->premultiplied_alpha_) ? VK_TRUE : VK_FALSE
+    ) ;
+
+    add_pipeline_shader_stage_create_info(
+        vp->pipeline_shader_stage_create_infos_
+    ,   &vp->pipeline_shader_stage_create_infos_count_
+    ,   max_vulkan_pipeline_shader_stage_create_infos
+    ,   vr->vert_shader_
+    ,   VK_SHADER_STAGE_VERTEX_BIT
+    ,   NULL
+    ) ;
+
+    add_pipeline_shader_stage_create_info(
+        vp->pipeline_shader_stage_create_infos_
+    ,   &vp->pipeline_shader_stage_create_infos_count_
+    ,   max_vulkan_pipeline_shader_stage_create_infos
+    ,   vr->frag_shader_
+    ,   VK_SHADER_STAGE_FRAGMENT_BIT
+    ,   fill_specialization_info(&vp->frag_specialization_)
+    ) ;
+
+    uint32_t blend_mode = vulkan_blend_mode_none ;
+    if(!opaque && vr->premultiplied_alpha_)
+    {
+        blend_mode = vulkan_blend_mode_premultiplied_alpha ;
+    }
+
+    fill_pipeline_color_blend_attachment_state(
+        &vp->pipeline_color_blend_attachment_state_
+    ,   blend_mode
+    ) ;
+
+    fill_pipeline_color_blend_state_create_info(
+        &vp->pipeline_color_blend_state_create_info_
+    ,   VK_FALSE
+    ,   VK_LOGIC_OP_COPY
+    ,   &vp->pipeline_color_blend_attachment_state_
+    ) ;
+
+    fill_pipeline_depth_stencil_state_create_info(
+        &vp->pipeline_depth_stencil_state_create_info_
+    ,   VK_TRUE
+    ,   opaque ? VK_TRUE : VK_FALSE
+    ,   VK_COMPARE_OP_LESS
+    ) ;
+
+    fill_graphics_pipeline_create_info(
+        &vp->graphics_pipeline_create_info_
+    ,   vr->pipeline_layout_
+    ,   vc->render_pass_
+    ,   vp->pipeline_shader_stage_create_infos_
+    ,   vp->pipeline_shader_stage_create_infos_count_
+    ,   &vr->pipeline_vertex_input_state_create_info_
+    ,   &vr->pipeline_input_assembly_state_create_info_
+    ,   &vr->pipeline_viewport_state_create_info_
+    ,   &vr->pipeline_rasterization_state_create_info_
+    ,   &vr->pipeline_multisample_state_create_info_
+    ,   &vp->pipeline_depth_stencil_state_create_info_
+    ,   &vp->pipeline_color_blend_state_create_info_
+    ,   &vr->pipeline_dynamic_state_create_info_
+    ) ;
+
+    if(check(get_graphics_pipeline_permutation(
+                &vp->graphics_pipeline_
+            ,   vc
+            ,   &vp->graphics_pipeline_create_info_
+            ,   shader_names
+            ,   array_count(shader_names)
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vp->graphics_pipeline_) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+create_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    vr->texture_enable_anisotropy_  = VK_TRUE ;
+    vr->texture_anisotropy_         = 1.0f ;
+
+    require(vr->texture_anisotropy_ <= vc->picked_physical_device_->properties_.limits.maxSamplerAnisotropy) ;
+
+    // whatever the batch writes has to fit into a frame packet.
+    vr->instance_capacity_ = app_->scene_instance_capacity_ ;
+
+    if(check(create_sprite_batch(&vr->batch_, vr->instance_capacity_)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(load_shader_file(
+                &vr->vert_shader_
+            ,   &vr->vert_reflection_
+            ,   vc->device_
+            ,   shader_names[0]
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->vert_shader_) ;
+    require(vr->vert_reflection_) ;
+
+    if(check(load_shader_file(
+                &vr->frag_shader_
+            ,   &vr->frag_reflection_
+            ,   vc->device_
+            ,   shader_names[1]
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->frag_shader_) ;
+    require(vr->frag_reflection_) ;
+
+    // the glsl uniform block and uniform_buffer_object have to match.
+    spirv_descriptor_binding const * ubo_binding = find_spirv_descriptor_binding(vr->vert_reflection_, 0, 0) ;
+    require(ubo_binding) ;
+    require(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER == ubo_binding->type_) ;
+    require(uniform_buffer_object_size == ubo_binding->block_size_) ;
+
+    spirv_reflection const * reflections[] = { vr->vert_reflection_, vr->frag_reflection_ } ;
+
+    add_reflected_descriptor_set_layout_bindings(
+        vr->descriptor_set_layout_bindings_
+    ,   &vr->descriptor_set_layout_bindings_count_
+    ,   max_vulkan_descriptor_set_layout_binding
+    ,   reflections
+    ,   array_count(reflections)
+    ) ;
+
+    if(check(create_descriptor_set_layout(
+                &vr->descriptor_set_layout_
+            ,   vc->device_
+            ,   vr->descriptor_set_layout_bindings_
+            ,   vr->descriptor_set_layout_bindings_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    fill_pipeline_layout_create_info(
+        &vr->pipeline_layout_create_info_
+    ,   &vr->descriptor_set_layout_
+    ,   1
+    ) ;
+
+    if(check_vulkan(vkCreatePipelineLayout(
+                vc->device_
+            ,   &vr->pipeline_layout_create_info_
+            ,   NULL
+            ,   &vr->pipeline_layout_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->pipeline_layout_) ;
+
+    if(check(create_uniform_buffers(
+                vr->uniform_buffers_
+            ,   vr->uniform_buffers_memory_
+            ,   vr->uniform_buffers_mapped_
+            ,   vc->device_
+            ,   uniform_buffer_object_size
+            ,   &vc->picked_physical_device_->memory_properties_
+            ,   vc->frames_in_flight_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    static_require(array_count(atlas_files) <= max_sprite_batch_atlases, "too many atlases") ;
+
+    for(
+        uint32_t i = 0
+    ;   i < array_count(atlas_files)
+    ;   ++i
+    )
+    {
+        vulkan_rob_atlas * va = &vr->atlases_[vr->atlases_count_++] ;
+
+        if(check(create_atlas(vc, vr, va, &atlas_files[i])))
+        {
+            end_timed_block() ;
+            return false ;
+        }
+
+        // one pipeline draws all atlases, they have to agree on their alpha.
+        bool const premultiplied_alpha = 0 != (va->sprite_asset_ptr_.this_->flags_ & sprite_2d_flag_premultiplied_alpha) ;
+        if(0 == i)
+        {
+            vr->premultiplied_alpha_ = premultiplied_alpha ;
+        }
+        else if(premultiplied_alpha != vr->premultiplied_alpha_)
+        {
+            log_error("%s mixes premultiplied and straight alpha with the other atlases.", atlas_files[i].sprite_name_) ;
+            end_timed_block() ;
+            return false ;
+        }
+
+        add_sprite_batch_atlas(&vr->batch_, &va->sprite_asset_ptr_) ;
+    }
+
+    // one buffer per frame in flight, persistently mapped. update_rob writes
+    // the sorted instances of its frame while the others are still in use.
+    if(check(create_dynamic_vertex_buffers(
+                vr->vertex_buffers_
+            ,   vr->vertex_buffers_memory_
+            ,   vr->vertex_buffers_mapped_
+            ,   vc->device_
+            ,   sizeof(sprite_instance) * vr->instance_capacity_
+            ,   &vc->picked_physical_device_->memory_properties_
+            ,   vc->frames_in_flight_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_index_buffer(
+                &vr->index_buffer_
+            ,   &vr->index_buffer_memory_
+            ,   vc->device_
+            ,   vc->command_pool_
+            ,   vc->graphics_queue_
+            ,   &vc->picked_physical_device_->memory_properties_
+            ,   indices
+            ,   indices_size
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->index_buffer_) ;
+    require(vr->index_buffer_memory_) ;
+
+    fill_vertex_input_binding_description(
+        &vr->vertex_input_binding_description_
+    ,   0
+    ,   sizeof(sprite_instance)
+    ,   VK_VERTEX_INPUT_RATE_INSTANCE
+    ) ;
+
+    add_reflected_vertex_input_attribute_descriptions(
+        vr->vertex_input_attribute_descriptions_
+    ,   &vr->vertex_input_attribute_descriptions_count_
+    ,   max_vulkan_vertex_input_attribute_descriptions
+    ,   vr->vert_reflection_
+    ,   0
+    ,   vertex_input_layouts
+    ,   array_count(vertex_input_layouts)
+    ) ;
+
+    fill_pipeline_vertex_input_state_create_info(
+        &vr->pipeline_vertex_input_state_create_info_
+    ,   &vr->vertex_input_binding_description_
+    ,   vr->vertex_input_attribute_descriptions_
+    ,   vr->vertex_input_attribute_descriptions_count_
+    ) ;
+
+    fill_pipeline_input_assembly_state_create_info(
+        &vr->pipeline_input_assembly_state_create_info_
+    ,   VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+    ,   VK_FALSE
+    ) ;
+
+    fill_viewport(
+        &vr->viewport_
+    ,   0
+    ,   0
+    ,   vc->swapchain_extent_.width
+    ,   vc->swapchain_extent_.height
+    ,   0
+    ,   1
+    ) ;
+
+    fill_scissor(
+        &vr->scissor_
+    ,   0
+    ,   0
+    ,   vc->swapchain_extent_.width
+    ,   vc->swapchain_extent_.height
+    ) ;
+
+
+    fill_pipeline_viewport_state_create_info(
+        &vr->pipeline_viewport_state_create_info_
+    ,   &vr->viewport_
+    ,   &vr->scissor_
+    ) ;
+
+    add_to_dynamic_state(
+        vr->dynamic_states_
+    ,   &vr->dynamic_states_count_
+    ,   max_vulkan_dynamic_states
+    ,   VK_DYNAMIC_STATE_VIEWPORT
+    ) ;
+
+    add_to_dynamic_state(
+        vr->dynamic_states_
+    ,   &vr->dynamic_states_count_
+    ,   max_vulkan_dynamic_states
+    ,   VK_DYNAMIC_STATE_SCISSOR
+    ) ;
+
+    fill_pipeline_dynamic_state_create_info(
+        &vr->pipeline_dynamic_state_create_info_
+    ,   vr->dynamic_states_
+    ,   vr->dynamic_states_count_
+    ) ;
+
+    fill_pipeline_rasterization_state_create_info(
+        &vr->pipeline_rasterization_state_create_info_
+    ,   VK_POLYGON_MODE_FILL
+    ,   VK_CULL_MODE_NONE
+    ,   VK_FRONT_FACE_COUNTER_CLOCKWISE
+    ) ;
+
+    fill_pipeline_multisample_state_create_info(
+        &vr->pipeline_multisample_state_create_info_
+    ,   vc->enable_sampling_
+    ,   vc->sample_count_
+    ,   vc->enable_sample_shading_
+    ,   vc->min_sample_shading_
+    ) ;
+
+    for(
+        uint32_t i = 0
+    ;   i < sprite_batch_pipelines_count
+    ;   ++i
+    )
+    {
+        if(check(create_pipeline(vc, vr, i)))
+        {
+            end_timed_block() ;
+            return false ;
+        }
+    }
+
+    vkDestroyShaderModule(vc->device_, vr->vert_shader_, NULL) ;
+    vr->vert_shader_ = NULL ;
+    vkDestroyShaderModule(vc->device_, vr->frag_shader_, NULL) ;
+    vr->frag_shader_ = NULL ;
+
+    if(check(init_scene(vr, app_->scene_sprite_count_)))
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+void
+make_rob_sprite_batch(
+    vulkan_render_object *  out_rob
+)
+{
+    require(out_rob) ;
+
+    if(!rob_pool_.memory_)
+    {
+        check(create_typed_stable_pool(&rob_pool_, vulkan_rob, max_vulkan_render_objects)) ;
+    }
+
+    pool_handle const h = alloc_pool_element(&rob_pool_) ;
+    require(is_pool_handle_valid(&rob_pool_, h)) ;
+
+    out_rob->create_func_   = create_rob ;
+    out_rob->draw_func_     = draw_rob ;
+    out_rob->update_func_   = update_rob ;
+    out_rob->record_func_   = record_rob ;
+    out_rob->simulate_func_ = simulate_rob ;
+    out_rob->pack_func_     = pack_rob ;
+    out_rob->destroy_func_  = destroy_rob ;
+    out_rob->param_         = &rob_pool_ ;
+    out_rob->handle_        = h ;
+    out_rob->vc_            = NULL ;
+    out_rob->animated_      = false ;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+
+typedef struct vulkan_render_object vulkan_render_object ;
+
+
+void
+make_rob_sprite_batch(
+    vulkan_render_object *  out_rob
+) ;
@@ -0,0 +1,1031 @@
+#include "app.h"
+#include "vulkan.h"
+#include "pool.h"
+#include "defines.h"
+#include "debug.h"
+#include "check.h"
+#include "log.h"
+#include "asset_font.h"
+#include "text.h"
+#include "overlay.h"
+
+
+#include <cglm/vec2.h>
+
+#include <SDL3/SDL_stdinc.h>
+
+
+#define max_vulkan_descriptor_set_layout_binding        4
+#define max_vulkan_descriptor_pool_size                 4
+#define max_vulkan_pipeline_shader_stage_create_infos   2
+#define max_vulkan_vertex_input_attribute_descriptions  3
+#define max_vulkan_dynamic_states                       2
+#define max_vulkan_descriptor_buffer_infos              1
+#define max_vulkan_descriptor_image_infos               1
+#define max_vulkan_write_descriptor_sets                2
+
+
+typedef struct vulkan_rob
+{
+    VkDescriptorSetLayoutBinding    descriptor_set_layout_bindings_[max_vulkan_descriptor_set_layout_binding] ;
+    uint32_t                        descriptor_set_layout_bindings_count_ ;
+    VkDescriptorSetLayout           descriptor_set_layout_ ;
+    VkDescriptorSet                 descriptor_sets_[max_vulkan_frames_in_flight] ;
+
+    VkDescriptorBufferInfo          descriptor_buffer_infos_[max_vulkan_frames_in_flight * max_vulkan_descriptor_buffer_infos] ;
+    uint32_t                        descriptor_buffer_infos_count_ ;
+    VkDescriptorImageInfo           descriptor_image_infos_[max_vulkan_frames_in_flight * max_vulkan_descriptor_image_infos] ;
+    uint32_t                        descriptor_image_infos_count_ ;
+    VkWriteDescriptorSet            write_descriptor_sets_[max_vulkan_frames_in_flight * max_vulkan_write_descriptor_sets] ;
+    uint32_t                        write_descriptor_sets_count_ ;
+
+    VkDescriptorPoolSize            descriptor_pool_sizes_[max_vulkan_descriptor_pool_size] ;
+    uint32_t                        descriptor_pool_sizes_count_ ;
+    VkDescriptorPool                descriptor_pool_ ;
+
+    VkBuffer        uniform_buffers_[max_vulkan_frames_in_flight] ;
+    VkDeviceMemory  uniform_buffers_memory_[max_vulkan_frames_in_flight] ;
+    void *          uniform_buffers_mapped_[max_vulkan_frames_in_flight] ;
+
+    VkPipelineLayoutCreateInfo      pipeline_layout_create_info_ ;
+    VkPipelineLayout                pipeline_layout_ ;
+    VkPipeline                      graphics_pipeline_ ;
+
+    VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info_ ;
+
+    uint32_t            texture_mip_levels_ ;
+    VkImage             texture_image_ ;
+    VkDeviceMemory      texture_image_memory_ ;
+    VkImageView         texture_image_view_ ;
+    VkSampler           texture_sampler_ ;
+    VkBool32            texture_enable_anisotropy_ ;
+    float               texture_anisotropy_ ;
+
+    VkBuffer        vertex_buffers_[max_vulkan_frames_in_flight] ;
+    VkDeviceMemory  vertex_buffers_memory_[max_vulkan_frames_in_flight] ;
+    void *          vertex_buffers_mapped_[max_vulkan_frames_in_flight] ;
+    VkBuffer        index_buffer_ ;
+    VkDeviceMemory  index_buffer_memory_ ;
+
+    VkShaderModule  vert_shader_ ;
+    VkShaderModule  frag_shader_ ;
+
+    spirv_reflection const *   vert_reflection_ ;
+    spirv_reflection const *   frag_reflection_ ;
+
+
+    VkPipelineShaderStageCreateInfo pipeline_shader_stage_create_infos_[max_vulkan_pipeline_shader_stage_create_infos] ;
+    uint32_t                        pipeline_shader_stage_create_infos_count_ ;
+
+    VkVertexInputBindingDescription vertex_input_binding_description_ ;
+
+    VkVertexInputAttributeDescription   vertex_input_attribute_descriptions_[max_vulkan_vertex_input_attribute_descriptions] ;
+    uint32_t                            vertex_input_attribute_descriptions_count_ ;
+
+    VkPipelineVertexInputStateCreateInfo    pipeline_vertex_input_state_create_info_ ;
+    VkPipelineInputAssemblyStateCreateInfo  pipeline_input_assembly_state_create_info_ ;
+    VkPipelineViewportStateCreateInfo       pipeline_viewport_state_create_info_ ;
+    VkPipelineDynamicStateCreateInfo        pipeline_dynamic_state_create_info_ ;
+    VkPipelineRasterizationStateCreateInfo  pipeline_rasterization_state_create_info_ ;
+    VkPipelineMultisampleStateCreateInfo    pipeline_multisample_state_create_info_ ;
+    VkPipelineColorBlendAttachmentState     pipeline_color_blend_attachment_state_ ;
+    VkPipelineColorBlendStateCreateInfo     pipeline_color_blend_state_create_info_ ;
+    VkPipelineDepthStencilStateCreateInfo   pipeline_depth_stencil_state_create_info_ ;
+    VkGraphicsPipelineCreateInfo            graphics_pipeline_create_info_ ;
+
+    VkViewport  viewport_ ;
+    VkRect2D    scissor_ ;
+
+    VkDynamicState  dynamic_states_[max_vulkan_dynamic_states] ;
+    uint32_t        dynamic_states_count_ ;
+
+    font_2d_ptr     font_asset_ptr_ ;
+    text_batch      batch_ ;
+    uint32_t        instances_count_[max_vulkan_frames_in_flight] ;
+
+} vulkan_rob ;
+
+
+
+static pool     rob_pool_ = { 0 } ;
+
+
+static vulkan_rob *
+get_rob(
+    vulkan_render_object const *    vro
+)
+{
+    require(vro) ;
+    require(vro->param_ == &rob_pool_) ;
+    vulkan_rob * vr = pool_get(vulkan_rob, &rob_pool_, vro->handle_) ;
+    require(vr) ;
+    return vr ;
+}
+
+
+#define max_text_instance_count 4096
+
+
+static uint16_t const indices[] =
+{
+    0, 1, 2
+,   2, 3, 0
+} ;
+static uint32_t const   indices_size = sizeof(indices) ;
+static uint32_t const   indices_count = array_count(indices) ;
+
+
+// indexed by the shader input location.
+static vulkan_vertex_input_layout const vertex_input_layouts[] =
+{
+    { offsetof(text_instance, px_),    VK_FORMAT_UNDEFINED }
+,   { offsetof(text_instance, u0_),    VK_FORMAT_UNDEFINED }
+,   { offsetof(text_instance, color_), VK_FORMAT_R8G8B8A8_UNORM }
+} ;
+
+
+static char const * const shader_names[] =
+{
+    "ass/shaders/text_shader.vert.spv"
+,   "ass/shaders/text_shader.frag.spv"
+} ;
+
+
+typedef struct uniform_buffer_object
+{
+    vec2 offset_ ;
+    vec2 scale_ ;
+
+} uniform_buffer_object ;
+
+
+static uint32_t const uniform_buffer_object_size = sizeof(uniform_buffer_object) ;
+static uint32_t const instance_buffer_size = sizeof(text_instance) * max_text_instance_count ;
+
+
+static void
+update_buffers(
+    vulkan_context *    vc
+,   vulkan_rob *        vr
+,   uint32_t const      current_frame
+)
+{
+    require(vc) ;
+    require(current_frame < max_vulkan_frames_in_flight) ;
+    require(current_frame < vc->frames_in_flight_count_) ;
+    require(vr) ;
+
+    frame_packet const * fp = vc->frame_packet_ ;
+    require(fp) ;
+
+    build_overlay(&vr->batch_, vc) ;
+
+    uniform_buffer_object ubo = { 0 } ;
+    ubo.offset_[0] = fp->camera_.offset_x_ ;
+    ubo.offset_[1] = fp->camera_.offset_y_ ;
+    ubo.scale_[0]  = fp->camera_.scale_x_ ;
+    ubo.scale_[1]  = fp->camera_.scale_y_ ;
+
+    SDL_memcpy(vr->uniform_buffers_mapped_[current_frame], &ubo, uniform_buffer_object_size) ;
+
+    require(vr->batch_.count_ <= max_text_instance_count) ;
+    vr->instances_count_[current_frame] = vr->batch_.count_ ;
+
+    if(vr->batch_.count_)
+    {
+        SDL_memcpy(
+            vr->vertex_buffers_mapped_[current_frame]
+        ,   vr->batch_.instances_
+        ,   sizeof(text_instance) * vr->batch_.count_
+        ) ;
+    }
+}
+
+
+static bool
+record_command_buffer(
+    vulkan_context *    vc
+,   vulkan_rob *        vr
+,   VkCommandBuffer     command_buffer
+,   VkDescriptorSet     descriptor_set
+,   uint32_t const      current_frame
+)
+{
+    require(vc) ;
+    require(vr) ;
+    require(command_buffer) ;
+    require(descriptor_set) ;
+    require(current_frame < max_vulkan_frames_in_flight) ;
+
+    begin_timed_block() ;
+
+    uint32_t const instances_count = vr->instances_count_[current_frame] ;
+    if(!instances_count)
+    {
+        end_timed_block() ;
+        return true ;
+    }
+
+    // void vkCmdBindPipeline(
+    //     VkCommandBuffer                             commandBuffer,
+    //     VkPipelineBindPoint                         pipelineBindPoint,
+    //     VkPipeline                                  pipeline);
+    vkCmdBindPipeline(
+        command_buffer
+    ,   VK_PIPELINE_BIND_POINT_GRAPHICS
+    ,   vr->graphics_pipeline_
+    ) ;
+
+    VkBuffer vertex_buffers[] = { vr->vertex_buffers_[current_frame] } ;
+    VkDeviceSize offsets[] = { 0 } ;
+
+    // void vkCmdBindVertexBuffers(
+    //     VkCommandBuffer                             commandBuffer,
+    //     uint32_t                                    firstBinding,
+    //     uint32_t                                    bindingCount,
+    //     const VkBuffer*                             pBuffers,
+    //     const VkDeviceSize*                         pOffsets);
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets) ;
+
+
+    // void vkCmdBindIndexBuffer(
+    //     VkCommandBuffer                             commandBuffer,
+    //     VkBuffer                                    buffer,
+    //     VkDeviceSize                                offset,
+    //     VkIndexType                                 indexType);
+    vkCmdBindIndexBuffer(
+        command_buffer
+    ,   vr->index_buffer_
+    ,   0
+    ,   VK_INDEX_TYPE_UINT16
+    ) ;
+
+    // void vkCmdBindDescriptorSets(
+    //     VkCommandBuffer                             commandBuffer,
+    //     VkPipelineBindPoint                         pipelineBindPoint,
+    //     VkPipelineLayout                            layout,
+    //     uint32_t                                    firstSet,
+    //     uint32_t                                    descriptorSetCount,
+    //     const VkDescriptorSet*                      pDescriptorSets,
+    //     uint32_t                                    dynamicOffsetCount,
+    //     const uint32_t*                             pDynamicOffsets);
+    vkCmdBindDescriptorSets(
+        command_buffer
+    ,   VK_PIPELINE_BIND_POINT_GRAPHICS
+    ,   vr->pipeline_layout_
+    ,   0
+    ,   1
+    ,   &descriptor_set
+    ,   0
+    ,   NULL
+    ) ;
+
+    // void vkCmdDrawIndexed(
+    //     VkCommandBuffer                             commandBuffer,
+    //     uint32_t                                    indexCount,
+    //     uint32_t                                    instanceCount,
+    //     uint32_t                                    firstIndex,
+    //     int32_t                                     vertexOffset,
+    //     uint32_t                                    firstInstance);
+    vkCmdDrawIndexed(command_buffer, indices_count, instances_count, 0, 0, 0) ;
+    add_vulkan_draw_stats(vc, 1, instances_count) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+update_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    update_buffers(vc, vr, current_frame) ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+record_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    require(current_frame < vc->frames_in_flight_count_) ;
+
+    if(check(record_command_buffer(
+                vc
+            ,   vr
+            ,   vc->command_buffer_[current_frame]
+            ,   vr->descriptor_sets_[current_frame]
+            ,   current_frame
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+draw_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+,   uint32_t const          current_frame
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+    vulkan_rob *    vr = get_rob(vro) ;
+    require(current_frame < vc->frames_in_flight_count_) ;
+
+    if(vc->enable_pre_record_command_buffers_)
+    {
+        end_timed_block() ;
+        return true ;
+    }
+
+    if(check(record_command_buffer(
+                vc
+            ,   vr
+            ,   vc->command_buffer_[current_frame]
+            ,   vr->descriptor_sets_[current_frame]
+            ,   current_frame
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+destroy_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    if(vr->texture_sampler_)
+    {
+        // void vkDestroySampler(
+        //     VkDevice                                    device,
+        //     VkSampler                                   sampler,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroySampler(vc->device_, vr->texture_sampler_, NULL) ;
+        vr->texture_sampler_ = NULL ;
+    }
+
+    if(vr->texture_image_view_)
+    {
+        vkDestroyImageView(vc->device_, vr->texture_image_view_, NULL) ;
+        vr->texture_image_view_ = NULL ;
+    }
+
+    if(vr->texture_image_)
+    {
+        // void vkDestroyImage(
+        // VkDevice                                    device,
+        // VkImage                                     image,
+        // const VkAllocationCallbacks*                pAllocator);
+        vkDestroyImage(vc->device_, vr->texture_image_, NULL) ;
+        vr->texture_image_ = NULL ;
+    }
+
+    if(vr->texture_image_memory_)
+    {
+        free_device_memory(vc->device_, vr->texture_image_memory_) ;
+        vr->texture_image_memory_ = NULL ;
+    }
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->frames_in_flight_count_
+    ;   ++i
+    )
+    {
+        vkDestroyBuffer(vc->device_, vr->uniform_buffers_[i], NULL) ;
+        vr->uniform_buffers_[i] = NULL ;
+        free_device_memory(vc->device_, vr->uniform_buffers_memory_[i]) ;
+        vr->uniform_buffers_memory_[i] = NULL ;
+    }
+
+    if(vr->descriptor_pool_)
+    {
+        // void vkDestroyDescriptorPool(
+        //     VkDevice                                    device,
+        //     VkDescriptorPool                            descriptorPool,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroyDescriptorPool(vc->device_, vr->descriptor_pool_, NULL) ;
+        vr->descriptor_pool_ = NULL ;
+    }
+
+
+    if(vr->descriptor_set_layout_)
+    {
+        // void vkDestroyDescriptorSetLayout(
+        //     VkDevice                                    device,
+        //     VkDescriptorSetLayout                       descriptorSetLayout,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroyDescriptorSetLayout(vc->device_, vr->descriptor_set_layout_, NULL) ;
+        vr->descriptor_set_layout_ = NULL ;
+    }
+
+
+    if(vr->index_buffer_)
+    {
+        vkDestroyBuffer(vc->device_, vr->index_buffer_, NULL) ;
+        vr->index_buffer_ = NULL ;
+    }
+
+    if(vr->index_buffer_memory_)
+    {
+        free_device_memory(vc->device_, vr->index_buffer_memory_) ;
+        vr->index_buffer_memory_ = NULL ;
+    }
+
+
+    for(
+        uint32_t i = 0
+    ;   i < vc->frames_in_flight_count_
+    ;   ++i
+    )
+    {
+        if(vr->vertex_buffers_[i])
+        {
+            vkDestroyBuffer(vc->device_, vr->vertex_buffers_[i], NULL) ;
+            vr->vertex_buffers_[i] = NULL ;
+        }
+
+        if(vr->vertex_buffers_memory_[i])
+        {
+            free_device_memory(vc->device_, vr->vertex_buffers_memory_[i]) ;
+            vr->vertex_buffers_memory_[i] = NULL ;
+        }
+    }
+
+    if(vr->graphics_pipeline_)
+    {
+        release_graphics_pipeline_permutation(vc, &vr->graphics_pipeline_) ;
+    }
+
+    if(vr->pipeline_layout_)
+    {
+        // void vkDestroyPipelineLayout(
+        //     VkDevice                                    device,
+        //     VkPipelineLayout                            pipelineLayout,
+        //     const VkAllocationCallbacks*                pAllocator);
+        vkDestroyPipelineLayout(vc->device_, vr->pipeline_layout_, NULL) ;
+        vr->pipeline_layout_ = NULL ;
+    }
+
+    destroy_text_batch(&vr->batch_) ;
+
+    if(vr->font_asset_ptr_.this_)
+    {
+        free_memory(vr->font_asset_ptr_.this_) ;
+        vr->font_asset_ptr_.this_ = NULL ;
+    }
+
+    check(free_pool_element(&rob_pool_, vro->handle_)) ;
+    if(0 == pool_count(&rob_pool_))
+    {
+        destroy_pool(&rob_pool_) ;
+    }
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+static bool
+create_rob(
+    vulkan_context *        vc
+,   vulkan_render_object *  vro
+)
+{
+    require(vc) ;
+    begin_timed_block() ;
+
+    vulkan_rob *    vr = get_rob(vro) ;
+
+    // glyphs are drawn 1:1, no mip maps needed.
+    vr->texture_mip_levels_         = 1 ;
+    vr->texture_enable_anisotropy_  = VK_FALSE ;
+    vr->texture_anisotropy_         = 1.0f ;
+
+    vr->font_asset_ptr_ = load_asset_font("ass/fonts/overlay_font.font") ;
+    require(1 == vr->font_asset_ptr_.this_->textures_count_) ;
+
+    if(check(create_text_batch(
+                &vr->batch_
+            ,   &vr->font_asset_ptr_
+            ,   0
+            ,   max_text_instance_count
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    require(vr->texture_anisotropy_ <= vc->picked_physical_device_->properties_.limits.maxSamplerAnisotropy) ;
+
+    if(check(load_shader_file(
+                &vr->vert_shader_
+            ,   &vr->vert_reflection_
+            ,   vc->device_
+            ,   shader_names[0]
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->vert_shader_) ;
+    require(vr->vert_reflection_) ;
+
+    if(check(load_shader_file(
+                &vr->frag_shader_
+            ,   &vr->frag_reflection_
+            ,   vc->device_
+            ,   shader_names[1]
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->frag_shader_) ;
+    require(vr->frag_reflection_) ;
+
+    // the glsl uniform block and uniform_buffer_object have to match.
+    spirv_descriptor_binding const * ubo_binding = find_spirv_descriptor_binding(vr->vert_reflection_, 0, 0) ;
+    require(ubo_binding) ;
+    require(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER == ubo_binding->type_) ;
+    require(uniform_buffer_object_size == ubo_binding->block_size_) ;
+
+    spirv_reflection const * reflections[] = { vr->vert_reflection_, vr->frag_reflection_ } ;
+
+    add_reflected_descriptor_set_layout_bindings(
+        vr->descriptor_set_layout_bindings_
+    ,   &vr->descriptor_set_layout_bindings_count_
+    ,   max_vulkan_descriptor_set_layout_binding
+    ,   reflections
+    ,   array_count(reflections)
+    ) ;
+
+    if(check(create_descriptor_set_layout(
+                &vr->descriptor_set_layout_
+            ,   vc->device_
+            ,   vr->descriptor_set_layout_bindings_
+            ,   vr->descriptor_set_layout_bindings_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    fill_pipeline_layout_create_info(
+        &vr->pipeline_layout_create_info_
+    ,   &vr->descriptor_set_layout_
+    ,   1
+    ) ;
+
+    if(check_vulkan(vkCreatePipelineLayout(
+                vc->device_
+            ,   &vr->pipeline_layout_create_info_
+            ,   NULL
+            ,   &vr->pipeline_layout_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->pipeline_layout_) ;
+
+    require(0 == vr->descriptor_pool_sizes_count_) ;
+    add_descriptor_pool_sizes_from_bindings(
+        vr->descriptor_pool_sizes_
+    ,   &vr->descriptor_pool_sizes_count_
+    ,   max_vulkan_descriptor_pool_size
+    ,   vr->descriptor_set_layout_bindings_
+    ,   vr->descriptor_set_layout_bindings_count_
+    ,   vc->frames_in_flight_count_
+    ) ;
+
+    if(check(create_descriptor_pool(
+                &vr->descriptor_pool_
+            ,   vc->device_
+            ,   vr->descriptor_pool_sizes_
+            ,   vr->descriptor_pool_sizes_count_
+            ,   vc->frames_in_flight_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->descriptor_pool_) ;
+
+    if(check(create_descriptor_sets(
+                vr->descriptor_sets_
+            ,   vc->device_
+            ,   vr->descriptor_set_layout_
+            ,   vr->descriptor_pool_
+            ,   vc->frames_in_flight_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->descriptor_sets_) ;
+
+    if(check(create_uniform_buffers(
+                vr->uniform_buffers_
+            ,   vr->uniform_buffers_memory_
+            ,   vr->uniform_buffers_mapped_
+            ,   vc->device_
+            ,   uniform_buffer_object_size
+            ,   &vc->picked_physical_device_->memory_properties_
+            ,   vc->frames_in_flight_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_texture_image(
+                &vr->texture_image_
+            ,   &vr->texture_image_memory_
+            ,   &vr->texture_mip_levels_
+            ,   "ass/fonts/overlay_font_0.png"
+            ,   vc->device_
+            ,   vc->command_pool_
+            ,   vc->graphics_queue_
+            ,   &vc->picked_physical_device_->memory_properties_
+            ,   vr->texture_mip_levels_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_texture_image_view(
+                &vr->texture_image_view_
+            ,   vc->device_
+            ,   vr->texture_image_
+            ,   vr->texture_mip_levels_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_texture_sampler(
+                &vr->texture_sampler_
+            ,   vc->device_
+            ,   vr->texture_mip_levels_
+            ,   vr->texture_enable_anisotropy_
+            ,   vr->texture_anisotropy_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    add_descriptor_buffer_info(
+        vr->descriptor_buffer_infos_
+    ,   &vr->descriptor_buffer_infos_count_
+    ,   max_vulkan_descriptor_buffer_infos
+    ,   vc->frames_in_flight_count_
+    ,   vr->uniform_buffers_
+    ,   0
+    ,   uniform_buffer_object_size
+    ) ;
+
+    add_descriptor_image_info(
+        vr->descriptor_image_infos_
+    ,   &vr->descriptor_image_infos_count_
+    ,   max_vulkan_descriptor_image_infos
+    ,   vc->frames_in_flight_count_
+    ,   vr->texture_image_view_
+    ,   vr->texture_sampler_
+    ) ;
+
+    add_write_descriptor_buffer_set(
+        vr->write_descriptor_sets_
+    ,   &vr->write_descriptor_sets_count_
+    ,   max_vulkan_write_descriptor_sets
+    ,   vr->descriptor_sets_
+    ,   vc->frames_in_flight_count_
+    ,   vr->descriptor_buffer_infos_
+    ,   vr->descriptor_buffer_infos_count_
+    ,   max_vulkan_descriptor_buffer_infos
+    ,   vc->frames_in_flight_count_
+    ,   0
+    ,   0
+    ,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+    ) ;
+
+    add_write_descriptor_image_set(
+        vr->write_descriptor_sets_
+    ,   &vr->write_descriptor_sets_count_
+    ,   max_vulkan_write_descriptor_sets
+    ,   vr->descriptor_sets_
+    ,   vc->frames_in_flight_count_
+    ,   vr->descriptor_image_infos_
+    ,   vr->descriptor_image_infos_count_
+    ,   max_vulkan_descriptor_image_infos
+    ,   vc->frames_in_flight_count_
+    ,   0
+    ,   1
+    ,   VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+    ) ;
+
+    update_descriptor_sets(
+        vr->write_descriptor_sets_
+    ,   vr->write_descriptor_sets_count_
+    ,   max_vulkan_write_descriptor_sets
+    ,   vc->device_
+    ,   vc->frames_in_flight_count_
+    ) ;
+
+    if(check(create_dynamic_vertex_buffers(
+                vr->vertex_buffers_
+            ,   vr->vertex_buffers_memory_
+            ,   vr->vertex_buffers_mapped_
+            ,   vc->device_
+            ,   instance_buffer_size
+            ,   &vc->picked_physical_device_->memory_properties_
+            ,   vc->frames_in_flight_count_
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+
+    if(check(create_index_buffer(
+                &vr->index_buffer_
+            ,   &vr->index_buffer_memory_
+            ,   vc->device_
+            ,   vc->command_pool_
+            ,   vc->graphics_queue_
+            ,   &vc->picked_physical_device_->memory_properties_
+            ,   indices
+            ,   indices_size
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->index_buffer_) ;
+    require(vr->index_buffer_memory_) ;
+
+    add_pipeline_shader_stage_create_info(
+        vr->pipeline_shader_stage_create_infos_
+    ,   &vr->pipeline_shader_stage_create_infos_count_
+    ,   max_vulkan_pipeline_shader_stage_create_infos
+    ,   vr->vert_shader_
+    ,   VK_SHADER_STAGE_VERTEX_BIT
+    ,   NULL
+    ) ;
+
+    add_pipeline_shader_stage_create_info(
+        vr->pipeline_shader_stage_create_infos_
+    ,   &vr->pipeline_shader_stage_create_infos_count_
+    ,   max_vulkan_pipeline_shader_stage_create_infos
+    ,   vr->frag_shader_
+    ,   VK_SHADER_STAGE_FRAGMENT_BIT
+    ,   NULL
+    ) ;
+
+    fill_vertex_input_binding_description(
+        &vr->vertex_input_binding_description_
+    ,   0
+    ,   sizeof(text_instance)
+    ,   VK_VERTEX_INPUT_RATE_INSTANCE
+    ) ;
+
+    add_reflected_vertex_input_attribute_descriptions(
+        vr->vertex_input_attribute_descriptions_
+    ,   &vr->vertex_input_attribute_descriptions_count_
+    ,   max_vulkan_vertex_input_attribute_descriptions
+    ,   vr->vert_reflection_
+    ,   0
+    ,   vertex_input_layouts
+    ,   array_count(vertex_input_layouts)
+    ) ;
+
+    fill_pipeline_vertex_input_state_create_info(
+        &vr->pipeline_vertex_input_state_create_info_
+    ,   &vr->vertex_input_binding_description_
+    ,   vr->vertex_input_attribute_descriptions_
+    ,   vr->vertex_input_attribute_descriptions_count_
+    ) ;
+
+    fill_pipeline_input_assembly_state_create_info(
+        &vr->pipeline_input_assembly_state_create_info_
+    ,   VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+    ,   VK_FALSE
+    ) ;
+
+    fill_viewport(
+        &vr->viewport_
+    ,   0
+    ,   0
+    ,   vc->swapchain_extent_.width
+    ,   vc->swapchain_extent_.height
+    ,   0
+    ,   1
+    ) ;
+
+    fill_scissor(
+        &vr->scissor_
+    ,   0
+    ,   0
+    ,   vc->swapchain_extent_.width
+    ,   vc->swapchain_extent_.height
+    ) ;
+
+
+    fill_pipeline_viewport_state_create_info(
+        &vr->pipeline_viewport_state_create_info_
+    ,   &vr->viewport_
+    ,   &vr->scissor_
+    ) ;
+
+    add_to_dynamic_state(
+        vr->dynamic_states_
+    ,   &vr->dynamic_states_count_
+    ,   max_vulkan_dynamic_states
+    ,   VK_DYNAMIC_STATE_VIEWPORT
+    ) ;
+
+    add_to_dynamic_state(
+        vr->dynamic_states_
+    ,   &vr->dynamic_states_count_
+    ,   max_vulkan_dynamic_states
+    ,   VK_DYNAMIC_STATE_SCISSOR
+    ) ;
+
+    fill_pipeline_dynamic_state_create_info(
+        &vr->pipeline_dynamic_state_create_info_
+    ,   vr->dynamic_states_
+    ,   vr->dynamic_states_count_
+    ) ;
+
+    fill_pipeline_rasterization_state_create_info(
+        &vr->pipeline_rasterization_state_create_info_
+    ,   VK_POLYGON_MODE_FILL
+    ,   VK_CULL_MODE_NONE
+    ,   VK_FRONT_FACE_COUNTER_CLOCKWISE
+    ) ;
+
+    fill_pipeline_multisample_state_create_info(
+        &vr->pipeline_multisample_state_create_info_
+    ,   vc->enable_sampling_
+    ,   vc->sample_count_
+    ,   vc->enable_sample_shading_
+    ,   vc->min_sample_shading_
+    ) ;
+
+    fill_pipeline_color_blend_attachment_state(
+        &vr->pipeline_color_blend_attachment_state_
+    ,   vulkan_blend_mode_alpha
+    ) ;
+
+    fill_pipeline_color_blend_state_create_info(
+        &vr->pipeline_color_blend_state_create_info_
+    ,   VK_FALSE
+    ,   VK_LOGIC_OP_COPY
+    ,   &vr->pipeline_color_blend_attachment_state_
+    ) ;
+
+    // the overlay is drawn last and always on top.
+    fill_pipeline_depth_stencil_state_create_info(
+        &vr->pipeline_depth_stencil_state_create_info_
+    ,   VK_FALSE
+    ,   VK_FALSE
+    ,   VK_COMPARE_OP_ALWAYS
+    ) ;
+
+    fill_graphics_pipeline_create_info(
+        &vr->graphics_pipeline_create_info_
+    ,   vr->pipeline_layout_
+    ,   vc->render_pass_
+    ,   vr->pipeline_shader_stage_create_infos_
+    ,   vr->pipeline_shader_stage_create_infos_count_
+    ,   &vr->pipeline_vertex_input_state_create_info_
+    ,   &vr->pipeline_input_assembly_state_create_info_
+    ,   &vr->pipeline_viewport_state_create_info_
+    ,   &vr->pipeline_rasterization_state_create_info_
+    ,   &vr->pipeline_multisample_state_create_info_
+    ,   &vr->pipeline_depth_stencil_state_create_info_
+    ,   &vr->pipeline_color_blend_state_create_info_
+    ,   &vr->pipeline_dynamic_state_create_info_
+    ) ;
+
+    if(check(get_graphics_pipeline_permutation(
+                &vr->graphics_pipeline_
+            ,   vc
+            ,   &vr->graphics_pipeline_create_info_
+            ,   shader_names
+            ,   array_count(shader_names)
+            )
+        )
+    )
+    {
+        end_timed_block() ;
+        return false ;
+    }
+    require(vr->graphics_pipeline_) ;
+
+    vkDestroyShaderModule(vc->device_, vr->vert_shader_, NULL) ;
+    vr->vert_shader_ = NULL ;
+    vkDestroyShaderModule(vc->device_, vr->frag_shader_, NULL) ;
+    vr->frag_shader_ = NULL ;
+
+    end_timed_block() ;
+    return true ;
+}
+
+
+void
+make_rob_text(
+    vulkan_render_object *  out_rob
+)
+{
+    require(out_rob) ;
+
+    if(!rob_pool_.memory_)
+    {
+        check(create_typed_stable_pool(&rob_pool_, vulkan_rob, max_vulkan_render_objects)) ;
+    }
+
+    pool_handle const h = alloc_pool_element(&rob_pool_) ;
+    require(is_pool_handle_valid(&rob_pool_, h)) ;
+
+    out_rob->create_func_   = create_rob ;
+    out_rob->draw_func_     = draw_rob ;
+    out_rob->update_func_   = update_rob ;
+    out_rob->record_func_   = record_rob ;
+    out_rob->simulate_func_ = NULL ;
+    out_rob->pack_func_     = NULL ;
+    out_rob->destroy_func_  = destroy_rob ;
+    out_rob->param_         = &rob_pool_ ;
+    out_rob->handle_        = h ;
+    out_rob->vc_            = NULL ;
+    out_rob->animated_      = false ;
+}
+